@@ -0,0 +1,124 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_AttachVolume.c
+ *
+ * Description :
+ *  Attach a mounted volume so that EduBfM can access its device directly.
+ *
+ * Exports:
+ *  Four EduBfM_AttachVolume(VolNo, char *)
+ */
+
+
+#define _GNU_SOURCE /* for O_DIRECT */
+#include <fcntl.h>  /* for open */
+#include <unistd.h> /* for close */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_AttachVolume()
+ *================================*/
+/*
+ * Function: Four EduBfM_AttachVolume(VolNo, char *)
+ *
+ * Description :
+ *  Open the device of the volume for EduBfM. The volume must consist of
+ *  the single device 'devName'. The background writer writes trains only
+ *  to attached volumes.
+ *  The trains of the volume listed in the warm-up file, if one was set by
+ *  EduBfM_SetWarmUpFile(), are read into the buffer pools before the call
+ *  returns; if that fails, the volume is detached again.
+ *  The device is also opened for the direct I/O (BfMConfig.directIO); if
+ *  its file system does not support the direct I/O, the buffer pools read
+ *  and write the volume through the page cache.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_EDUBFM - bad parameter, or too many attached volumes
+ *    eDEVICEIOERR_EDUBFM - the device cannot be opened
+ *    eBADWARMUPFILE_EDUBFM - the warm-up file is not a warm-up file
+ *    some errors caused by function calls
+ */
+Four EduBfM_AttachVolume(
+    VolNo               volNo,          /* IN volume number */
+    char                *devName)       /* IN device name of the volume */
+{
+    Four                e;              /* error code */
+    BfMDevice           *dev;
+    Four                fd;
+
+
+    /*@ check if the parameters are valid. */
+    if (volNo < 0 || devName == NULL) ERR(eBADPARAMETER_EDUBFM);
+    if (edubfm_FindDevice(volNo) != NULL) ERR(eBADPARAMETER_EDUBFM);
+
+    dev = edubfm_FindDevice(NIL);
+    if (dev == NULL) ERR(eBADPARAMETER_EDUBFM);
+
+    fd = open(devName, O_RDWR);
+    if (fd < 0) ERR(eDEVICEIOERR_EDUBFM);
+
+    dev->fd = fd;
+    dev->directFd = open(devName, O_RDWR | O_DIRECT);
+    if (dev->directFd < 0) dev->directFd = NIL;
+    dev->volNo = volNo;
+
+    e = edubfm_LoadWarmUp(volNo);
+    if (e < eNOERROR) {
+        EduBfM_DetachVolume(volNo);
+        ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* EduBfM_AttachVolume() */
@@ -0,0 +1,272 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_Bench.c
+ *
+ * Description :
+ *  Benchmark driver of EduBfM.
+ *  Format and mount a volume, allocate pages on it, and run the
+ *  benchmarks given on the command line (all benchmarks if none).
+ *
+ *  Usage: EduBfM_Bench [benchmark ...]
+ *
+ *  Benchmarks:
+ *   policy  - hit ratios of the buffer replacement policies under a mixed
+ *             workload of point accesses to a hot set and sequential scans
+ *   lookup  - lookup time of the page table versus the hash table chained
+ *             through the buffer table, on keys of consecutive pages of
+ *             several volumes
+ *   alloc   - how the buffers are allocated on misses (free buffer list,
+ *             clean list, or policy search) in a cold start, a
+ *             sequential scan, and the mixed workload of 'policy', which
+ *             is also run dirtying pages under every policy
+ *   writer  - foreground flushes of dirty victims with and without the
+ *             background writer, under a workload dirtying every page it
+ *             accesses; the pages are read back to check what was written
+ *   flush   - time of EduBfM_FlushAll() on a large pool of dirty pages,
+ *             one train at a time versus sorted and vectored writes
+ *             submitted to each I/O engine at several depths
+ *   prefetch - sequential scan with and without EduBfM_PrefetchTrains()
+ *             on each I/O engine
+ *   ring    - hit ratio of a hot set of point accesses interleaved with a
+ *             full scan, with and without an access strategy for the scan
+ *             under each buffer replacement policy
+ *   scale   - throughput of EduBfM_GetTrain()/EduBfM_FreeTrain() pairs
+ *             from 1 to 64 threads, on a hot set fitting the pool and on
+ *             a working set twice as large as the pool
+ *   stats   - statistics of the page pool after the miss mix of 'scale'
+ *             on STATS_THREADS threads, printed as text and JSON
+ *   resize  - hit ratio and time of EduBfM_ResizePool() as the page pool
+ *             grows and shrinks with a page fixed, and resizes while
+ *             threads access the pages
+ *   balance - hit ratio of a fixed even split of a memory budget between
+ *             the page pool and the large object train pool versus the
+ *             split adapted by EduBfM_SetMemoryBudget(), as the workload
+ *             switches between the pools
+ *   frames  - time of hits on random pages of a large page pool whose
+ *             frames are backed by pages of each kind, unbound and spread
+ *             over the NUMA nodes, after the frames are moved in place
+ *   warmup  - misses and latency of the first accesses after a restart,
+ *             from a cold page pool and from a pool warmed up by the file
+ *             saved by EduBfM_FlushAll() (see EduBfM_SetWarmUpFile())
+ *   trace   - cost of a hit with and without a trace captured by
+ *             EduBfM_SetTrace(), and the misses of a mixed workload with
+ *             updates, whose trace is left in bench.trace for EduBfM_Sim
+ *   direct  - throughput of random accesses with updates to a working set
+ *             larger than the page pool, and the memory held by the pool
+ *             and by the page cache for the volume, with buffered I/O from
+ *             a cold and a warm page cache and with the direct I/O
+ *   compress - disk reads of a skewed workload on pages filled like
+ *             slotted pages, without and with the compressed cache of
+ *             EduBfM_SetCompressedCache() as large as the page pool, and
+ *             how the cache shrinks under a scan and grows back
+ *   extension - reads of the volume by a skewed workload mixed with a scan,
+ *             without and with an extension file of the page pool (see
+ *             EduBfM_SetExtensionFile()), bench.ext, ten times as large
+ *             as the pool
+ *   dirty   - time of EduBfM_FlushAll() on a large page pool holding a few
+ *             dirty pages, which depends on the dirty pages only
+ *   optimistic - binary searches of pages laid out like B+-tree nodes by
+ *             threads fixing and latching them versus reading them by
+ *             EduBfM_OptimisticRead(), alone and against a thread
+ *             updating the pages, checking that no search saw a torn page
+ *   swizzle - random descents of a three-level tree of pages fixing each
+ *             node by EduBfM_GetTrain() versus through references swizzled
+ *             by EduBfM_GetTrainSwizzled(), with a page pool holding the
+ *             whole tree and with one too small for the leaves
+ *   pagesize - scans of a table and lookups of an index on the volume
+ *             with pages of 4, 8, 16, and 64 KB (see EduBfM_SetPageSize()),
+ *             through a page pool of as many bytes of frames
+ *   async   - lookups of random leaves of the tree of 'swizzle' with the
+ *             direct I/O, one at a time by EduBfM_GetTrain() versus
+ *             batches of lookups kept in flight by EduBfM_GetTrainAsync()
+ *             and EduBfM_PollTrains() on each I/O engine
+ *   check   - checks that threads reading stamped pages see the right
+ *             stamps by EduBfM_OptimisticRead() while the pool is resized
+ *             and while it is discarded, and by fixes claiming each
+ *             other's victims, with no buffer left fixed or mislaid
+ *
+ *  The benchmarks are kept by feature in EduBfM_BenchPolicy.c,
+ *  EduBfM_BenchLookUp.c, EduBfM_BenchFlush.c, EduBfM_BenchRead.c,
+ *  EduBfM_BenchThreads.c, EduBfM_BenchMemory.c, EduBfM_BenchCache.c,
+ *  and EduBfM_BenchTree.c, and share the fixtures of EduBfM_BenchModule.c.
+ *
+ *  EduBfM_Bench exits with a nonzero status if a benchmark failed or
+ *  any of them read a wrong page.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "EduBfM_BenchModule.h"
+
+
+typedef Four (*BenchFunc)(Four);
+
+typedef struct {
+    char        *name;
+    BenchFunc   func;
+} Bench;
+
+static Bench benches[] = {
+    { "policy", bench_Policy },
+    { "lookup", bench_LookUp },
+    { "alloc", bench_Alloc },
+    { "writer", bench_Writer },
+    { "flush", bench_Flush },
+    { "prefetch", bench_Prefetch },
+    { "ring", bench_Ring },
+    { "scale", bench_Scale },
+    { "stats", bench_Stats },
+    { "resize", bench_Resize },
+    { "balance", bench_Balance },
+    { "frames", bench_Frames },
+    { "warmup", bench_WarmUp },
+    { "trace", bench_Trace },
+    { "direct", bench_Direct },
+    { "compress", bench_ZCache },
+    { "extension", bench_Extension },
+    { "dirty", bench_Dirty },
+    { "optimistic", bench_Optimistic },
+    { "swizzle", bench_Swizzle },
+    { "pagesize", bench_PageSize },
+    { "async", bench_Async },
+    { "check", bench_Check },
+    { NULL, NULL }
+};
+
+
+
+Four main(
+    int         argc,
+    char        **argv)
+{
+    Four        e;
+    Four        i, j;
+    Four        handle;
+    char        *devNames[1];
+    Four        numPagesInDevices[1];
+    Four        volId;
+    XactID      xactId;
+
+    e = LRDS_Init();
+    if (e < eNOERROR) {
+        printf("LRDS_Init failed!!!\n");
+        exit(1);
+    }
+
+    e = LRDS_AllocHandle(&handle);
+    if (e < eNOERROR) {
+        printf("LRDS_AllocHandle failed!!!\n");
+        LRDS_Final();
+        exit(1);
+    }
+
+    devNames[0] = BENCH_VOLUME_NAME;
+    numPagesInDevices[0] = BENCH_VOLUME_PAGES;
+    volId = BENCH_VOLUME_ID;
+
+    e = LRDS_FormatDataVolume(1, devNames, "bench", volId, BENCH_EXTENT_SIZE, numPagesInDevices, BENCH_EXTENT_SIZE);
+    if (e < eNOERROR) {
+        printf("LRDS_FormatDataVolume failed!!!\n");
+        LRDS_FreeHandle(handle);
+        LRDS_Final();
+        exit(1);
+    }
+
+    e = LRDS_Mount(1, devNames, &volId);
+    if (e < eNOERROR) {
+        printf("LRDS_Mount failed!!!\n");
+        LRDS_FreeHandle(handle);
+        LRDS_Final();
+        exit(1);
+    }
+
+    e = LRDS_BeginTransaction(&xactId, X_RR_RR);
+    if (e < eNOERROR) {
+        printf("LRDS_BeginTransaction failed!!!\n");
+        LRDS_Dismount(volId);
+        LRDS_FreeHandle(handle);
+        LRDS_Final();
+        exit(1);
+    }
+
+    e = bench_AllocPages(volId);
+
+    for (i = 0; e >= eNOERROR && benches[i].name != NULL; i++) {
+        for (j = 1; j < argc; j++)
+            if (strcmp(argv[j], benches[i].name) == 0) break;
+        if (argc > 1 && j == argc) continue;
+
+        e = benches[i].func(volId);
+    }
+
+    if (e < eNOERROR) {
+        printf("EduBfM_Bench failed!!! (%d: %s)\n", e, Err_GetErrName(e));
+        LRDS_AbortTransaction(&xactId);
+    }
+    else {
+        e = EduBfM_FlushAll();
+        if (e >= eNOERROR) e = LRDS_CommitTransaction(&xactId);
+        if (e < eNOERROR) printf("LRDS_CommitTransaction failed!!!\n");
+    }
+
+    /* the storage system gets the frames of its buffer tables back */
+    EduBfM_Final();
+
+    LRDS_Dismount(volId);
+    LRDS_FreeHandle(handle);
+    LRDS_Final();
+
+    return (e < eNOERROR || benchWrong > 0) ? 1 : 0;
+}
@@ -0,0 +1,882 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchCache.c
+ *
+ * Description:
+ *  Benchmarks of what the page pool keeps beyond its frames: the warm-up
+ *  file read after a restart, the trace of the accesses, the compressed
+ *  cache, and the extension file.
+ *
+ * Exports:
+ *  Four bench_WarmUp(Four)
+ *  Four bench_Trace(Four)
+ *  Four bench_ZCache(Four)
+ *  Four bench_Extension(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "EduBfM_BenchModule.h"
+
+
+/*
+ * Definition for the benchmarks of this module
+ */
+/* warmup benchmark */
+#define WARMUP_FILE_NAME        "bench.warm"
+#define WARMUP_NUM_BUFS         1024    /* buffers of the page pool */
+#define WARMUP_PAGES            4096    /* pages accessed */
+#define WARMUP_HOT_PAGES        768     /* hot set: catalog pages, upper levels of B+-trees */
+#define WARMUP_HOT_PERCENT      90      /* percentage of accesses to the hot set */
+#define WARMUP_ACCESSES         20000   /* accesses before the restart and after it */
+#define WARMUP_FIRST            2000    /* the first accesses after the restart */
+
+/* trace benchmark */
+#define TRACE_FILE_NAME         "bench.trace"
+#define TRACE_NUM_BUFS          128     /* buffers of the page pool */
+#define TRACE_HOT_PAGES         64      /* pages of the point accesses */
+#define TRACE_ROUNDS            200
+#define TRACE_POINTS            50      /* point accesses per round */
+#define TRACE_SCAN_STEP         25      /* pages scanned per round */
+#define TRACE_DIRTY_EVERY       4       /* one in this many point accesses updates the page */
+#define TRACE_HITS              (1 << 20) /* hits timed with and without the trace */
+
+/* compress benchmark */
+#define ZCACHE_NUM_BUFS         512     /* buffers of the page pool, and pages of the compressed cache */
+#define ZCACHE_PAGES            4096    /* pages accessed */
+#define ZCACHE_WARM_PAGES       1536    /* pages of the skewed accesses */
+#define ZCACHE_WARM_PERCENT     80      /* percentage of accesses to the warm pages */
+#define ZCACHE_ACCESSES         40000   /* accesses per run */
+#define ZCACHE_DIRTY_EVERY      8       /* one in this many accesses updates the page */
+#define ZCACHE_SCANS            3       /* scans of all the pages in the scan run */
+#define ZCACHE_FILL_MIN         40      /* % of a page filled by records, at least */
+#define ZCACHE_FILL_MAX         90      /* and at most */
+
+/* extension benchmark */
+#define EXT_FILE_NAME           "bench.ext"
+#define EXT_NUM_BUFS            256     /* buffers of the page pool */
+#define EXT_NUM_TRAINS          2560    /* trains of the extension file */
+#define EXT_HOT_PAGES           2048    /* pages of the random accesses */
+#define EXT_SCAN_PAGES          4096    /* pages of the scan, after the hot pages */
+#define EXT_HOT_PERCENT         80      /* percentage of the accesses to the hot pages */
+#define EXT_ACCESSES            40000   /* accesses per run */
+#define EXT_DIRTY_EVERY         8       /* one in this many accesses updates the page */
+
+
+
+/*@================================
+ * bench_WarmUpAccesses()
+ *================================*/
+/*
+ * Function: Four bench_WarmUpAccesses(PageID *, Four *, Four *, double *)
+ *
+ * Description:
+ *  Do WARMUP_ACCESSES accesses, WARMUP_HOT_PERCENT% of them to the hot
+ *  set, and count the misses of the first WARMUP_FIRST accesses and of
+ *  all of them. The latency of each access is stored in 'ns' unless it is
+ *  NULL.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_WarmUpAccesses(
+    PageID      *pids,          /* IN pages accessed */
+    Four        *nFirstMisses,  /* OUT misses of the first accesses */
+    Four        *nMisses,       /* OUT misses of all accesses */
+    double      *ns)            /* OUT latency of each access, or NULL */
+{
+    Four        e;
+    Four        i, n;
+    Boolean     hit;
+    double      t0;
+
+    seed = 1;
+    *nFirstMisses = *nMisses = 0;
+    for (i = 0; i < WARMUP_ACCESSES; i++) {
+        if (bench_Random(100) < WARMUP_HOT_PERCENT) n = bench_Random(WARMUP_HOT_PAGES);
+        else n = WARMUP_HOT_PAGES + bench_Random(WARMUP_PAGES - WARMUP_HOT_PAGES);
+
+        t0 = bench_Now();
+        e = bench_Access(&pids[n], PAGE_BUF, &hit);
+        if (e < eNOERROR) ERR(e);
+        if (ns != NULL) ns[i] = bench_Now() - t0;
+
+        if (!hit) {
+            (*nMisses)++;
+            if (i < WARMUP_FIRST) (*nFirstMisses)++;
+        }
+    }
+
+    return(eNOERROR);
+
+} /* bench_WarmUpAccesses() */
+
+
+
+/*@================================
+ * bench_CompareDouble()
+ *================================*/
+/*
+ * Function: int bench_CompareDouble(const void *, const void *)
+ *
+ * Description:
+ *  qsort() comparison of two doubles.
+ */
+static int bench_CompareDouble(
+    const void  *a,             /* IN value */
+    const void  *b)             /* IN value */
+{
+    double      x = *(const double *)a;
+    double      y = *(const double *)b;
+
+    return((x < y) ? -1 : (x > y));
+
+} /* bench_CompareDouble() */
+
+
+
+/*@================================
+ * bench_WarmUpRun()
+ *================================*/
+/*
+ * Function: Four bench_WarmUpRun(char *, Four, PageID *, char *)
+ *
+ * Description:
+ *  Restart: empty the page pool, detach the volume, and drop its pages
+ *  from the page cache. Then attach the volume again with the given
+ *  warm-up file (none if NULL), and print the time of the attach, the
+ *  misses of the accesses which follow, and their latency.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four bench_WarmUpRun(
+    char        *name,          /* IN name of the run */
+    Four        volId,          /* IN volume identifier */
+    PageID      *pids,          /* IN pages accessed */
+    char        *fileName)      /* IN warm-up file or NULL */
+{
+    Four        e;
+    Four        nFirstMisses, nMisses;
+    double      t0, attach, total;
+    double      *ns;
+    Four        i;
+
+    ns = (double *)malloc(sizeof(double) * WARMUP_ACCESSES);
+    if (ns == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    e = bench_EmptyPool();
+    if (e >= eNOERROR) e = EduBfM_DetachVolume(volId);
+    if (e < eNOERROR) {
+        free(ns);
+        ERR(e);
+    }
+
+    /* read the pages from the disk, not from the page cache */
+    bench_DropCache();
+
+    e = EduBfM_SetWarmUpFile(fileName);
+    if (e >= eNOERROR) {
+        t0 = bench_Now();
+        e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+        attach = bench_Now() - t0;
+    }
+    if (e >= eNOERROR) e = EduBfM_SetWarmUpFile(NULL);
+    if (e >= eNOERROR) e = bench_WarmUpAccesses(pids, &nFirstMisses, &nMisses, ns);
+    if (e < eNOERROR) {
+        free(ns);
+        ERR(e);
+    }
+
+    for (total = 0, i = 0; i < WARMUP_ACCESSES; i++) total += ns[i];
+    qsort(ns, WARMUP_FIRST, sizeof(double), bench_CompareDouble);
+
+    printf("%-12s %11.2f %12d %10d %10.2f %10.1f\n", name, attach / 1e6, nFirstMisses, nMisses,
+           total / 1e6, ns[WARMUP_FIRST * 99 / 100] / 1e3);
+
+    free(ns);
+
+    return(eNOERROR);
+
+} /* bench_WarmUpRun() */
+
+
+
+/*@================================
+ * bench_WarmUp()
+ *================================*/
+/*
+ * Function: Four bench_WarmUp(Four)
+ *
+ * Description:
+ *  Bring a page pool of WARMUP_NUM_BUFS buffers to a steady state under
+ *  a workload skewed to a hot set, save its trains to a warm-up file by
+ *  EduBfM_FlushAll(), and compare the accesses after a restart from a
+ *  cold pool with those after a restart warmed up from the file.
+ *  The p99 column is the 99th percentile latency of the first
+ *  WARMUP_FIRST accesses.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_WarmUp(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        nFirstMisses, nMisses;
+    PageID      *pids;
+    BenchPool   pool;
+
+    pids = (PageID *)malloc(sizeof(PageID) * WARMUP_PAGES);
+    if (pids == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    e = bench_NewPages(volId, WARMUP_PAGES, pids);
+    if (e >= eNOERROR) e = bench_BigPool(&pool, WARMUP_NUM_BUFS);
+    if (e < eNOERROR) {
+        free(pids);
+        ERR(e);
+    }
+
+    printf("\n[warmup] %d buffers, %d accesses to %d pages, %d%% of them to %d hot pages\n",
+           WARMUP_NUM_BUFS, WARMUP_ACCESSES, WARMUP_PAGES, WARMUP_HOT_PERCENT, WARMUP_HOT_PAGES);
+    printf("%-12s %11s %12s %10s %10s %10s\n", "restart", "attach msec", "first misses", "misses",
+           "msec", "p99 usec");
+
+    e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    if (e >= eNOERROR) {
+        /* the steady state before the restart, saved by EduBfM_FlushAll() */
+        e = bench_WarmUpAccesses(pids, &nFirstMisses, &nMisses, NULL);
+        if (e >= eNOERROR) e = EduBfM_SetWarmUpFile(WARMUP_FILE_NAME);
+        if (e >= eNOERROR) e = EduBfM_FlushAll();
+        if (e >= eNOERROR) e = EduBfM_SetWarmUpFile(NULL);
+
+        if (e >= eNOERROR) e = bench_WarmUpRun("cold", volId, pids, NULL);
+        if (e >= eNOERROR) e = bench_WarmUpRun("warmed up", volId, pids, WARMUP_FILE_NAME);
+        EduBfM_SetWarmUpFile(NULL);
+        EduBfM_DetachVolume(volId);
+    }
+    remove(WARMUP_FILE_NAME);
+
+    e = bench_RestorePool(&pool, e);
+    free(pids);
+
+    return(e);
+
+} /* bench_WarmUp() */
+
+
+
+/*@================================
+ * bench_TraceHits()
+ *================================*/
+/*
+ * Function: Four bench_TraceHits(double *)
+ *
+ * Description:
+ *  Time TRACE_HITS hits on the hot pages, which are in the pool.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_TraceHits(
+    double      *ns)            /* OUT ns per hit */
+{
+    Four        e;
+    Four        i, n;
+    char        *buf;
+    double      t0;
+
+    seed = 1;
+    t0 = bench_Now();
+    for (i = 0; i < TRACE_HITS; i++) {
+        n = bench_Random(TRACE_HOT_PAGES);
+        e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    *ns = (bench_Now() - t0) / TRACE_HITS;
+
+    return(eNOERROR);
+
+} /* bench_TraceHits() */
+
+
+
+/*@================================
+ * bench_TraceMix()
+ *================================*/
+/*
+ * Function: Four bench_TraceMix(UEight *, UEight *)
+ *
+ * Description:
+ *  Run the mixed workload from an empty pool: every round does point
+ *  accesses to the hot pages, updating one in TRACE_DIRTY_EVERY of them,
+ *  and scans the next pages of the others. Return the calls of
+ *  EduBfM_GetTrain() and the misses.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_TraceMix(
+    UEight      *nLookups,      /* OUT calls of EduBfM_GetTrain() */
+    UEight      *nMisses)       /* OUT misses */
+{
+    Four        e;
+    Four        round, i, n;
+    Four        scanPos = 0;
+    char        *buf;
+    BfMStats    before, after;
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+    e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    seed = 1;
+    for (round = 0; round < TRACE_ROUNDS; round++) {
+        for (i = 0; i < TRACE_POINTS; i++) {
+            n = bench_Random(TRACE_HOT_PAGES);
+            e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+            if (bench_Random(TRACE_DIRTY_EVERY) == 0) {
+                buf[PAGESIZE - 1]++;
+                e = EduBfM_SetDirty(&pageIds[n], PAGE_BUF);
+                if (e < eNOERROR) ERR(e);
+            }
+            e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        for (i = 0; i < TRACE_SCAN_STEP; i++) {
+            n = TRACE_HOT_PAGES + scanPos;
+            scanPos = (scanPos + 1) % (BENCH_NUM_PAGES - TRACE_HOT_PAGES);
+            e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+            e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+        }
+    }
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+    *nLookups = after.nLookups - before.nLookups;
+    *nMisses = after.nMisses - before.nMisses;
+
+    return(eNOERROR);
+
+} /* bench_TraceMix() */
+
+
+
+/*@================================
+ * bench_Trace()
+ *================================*/
+/*
+ * Function: Four bench_Trace(Four)
+ *
+ * Description:
+ *  Compare the time of a hit with and without a trace being captured,
+ *  and capture the trace of the mixed workload of bench_TraceMix() on a
+ *  page pool of TRACE_NUM_BUFS buffers under CLOCK. The trace is left in
+ *  TRACE_FILE_NAME; "EduBfM_Sim bench.trace CLOCK 128" replays it with
+ *  the same misses.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Trace(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        fd;
+    double      offNs, onNs;
+    UEight      nLookups, nMisses;
+    BenchPool   pool;
+
+    e = bench_BigPool(&pool, TRACE_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[trace] %d buffers, %d hits on %d pages; %d rounds of %d point accesses, 1 in %d updating, + %d scanned pages\n",
+           TRACE_NUM_BUFS, TRACE_HITS, TRACE_HOT_PAGES, TRACE_ROUNDS, TRACE_POINTS, TRACE_DIRTY_EVERY, TRACE_SCAN_STEP);
+
+    e = bench_TraceMix(&nLookups, &nMisses);
+    if (e >= eNOERROR) e = bench_TraceHits(&offNs);
+    if (e >= eNOERROR) e = EduBfM_SetTrace(TRACE_FILE_NAME);
+    if (e >= eNOERROR) e = bench_TraceHits(&onNs);
+    if (e >= eNOERROR) e = EduBfM_SetTrace(NULL);
+
+    /* the trace of the mixed workload alone */
+    if (e >= eNOERROR) e = bench_EmptyPool();
+    if (e >= eNOERROR) e = EduBfM_SetTrace(TRACE_FILE_NAME);
+    if (e >= eNOERROR) e = bench_TraceMix(&nLookups, &nMisses);
+    if (e >= eNOERROR) e = EduBfM_SetTrace(NULL);
+
+    if (e >= eNOERROR) {
+        fd = open(TRACE_FILE_NAME, O_RDONLY);
+        printf("%-24s %10.1f\n", "ns/hit, no trace", offNs);
+        printf("%-24s %10.1f\n", "ns/hit, trace", onNs);
+        printf("%-24s %10llu misses of %llu fixes, trace of %ld bytes in %s\n", "mixed workload, CLOCK",
+               nMisses, nLookups, (fd >= 0) ? (long)lseek(fd, 0, SEEK_END) : -1L, TRACE_FILE_NAME);
+        if (fd >= 0) close(fd);
+    }
+    else
+        EduBfM_SetTrace(NULL);
+
+    e = bench_RestorePool(&pool, e);
+
+    return(e);
+
+} /* bench_Trace() */
+
+
+
+/*@================================
+ * bench_FillPage()
+ *================================*/
+/*
+ * Function: void bench_FillPage(char *, Four)
+ *
+ * Description:
+ *  Fill a page like a slotted page: records of words from a small
+ *  vocabulary and numbers from the start of the page, a slot of each at
+ *  the end, and free space between them. The stamp at the end of the
+ *  page is left to the caller.
+ */
+static void bench_FillPage(
+    char        *buf,           /* OUT page */
+    Four        n)              /* IN page number */
+{
+    static char *words[] = { "KAIST", "Odysseus", "COSMOS", "object", "record", "index",
+                             "student", "course", "Daejeon", "buffer", "B+-tree", "2024" };
+    Four        len, fill, off, nSlots, i;
+    Two         slot;
+
+    memset(buf, 0, PAGESIZE);
+    fill = PAGESIZE * (ZCACHE_FILL_MIN + bench_Random(ZCACHE_FILL_MAX - ZCACHE_FILL_MIN + 1)) / 100;
+
+    /* slots grow from the end of the page, before the stamp */
+    for (off = 16, nSlots = 0; off < fill; nSlots++) {
+        slot = (Two)off;
+        memcpy(buf + PAGESIZE - sizeof(Four) - (nSlots + 1) * sizeof(Two), &slot, sizeof(Two));
+
+        len = sprintf(buf + off, "%d:%d:", n, nSlots);
+        for (i = 2 + bench_Random(6); i > 0 && off + len + 16 < fill; i--)
+            len += sprintf(buf + off + len, "%s,%d;", words[bench_Random(12)], bench_Random(100000));
+        off += len + 1;
+
+        if (off + 64 + (nSlots + 2) * sizeof(Two) > PAGESIZE) break;
+    }
+    memcpy(buf, &nSlots, sizeof(Four));
+
+} /* bench_FillPage() */
+
+
+
+/*@================================
+ * bench_ZCacheRun()
+ *================================*/
+/*
+ * Function: Four bench_ZCacheRun(char *, PageID *, Four *, Boolean)
+ *
+ * Description:
+ *  Do ZCACHE_ACCESSES accesses, ZCACHE_WARM_PERCENT% of them to the warm
+ *  pages, or ZCACHE_SCANS scans of all the pages if 'scan' is TRUE, and
+ *  print the misses, the reads of the disk, and the trains kept by the
+ *  compressed cache afterwards. One in ZCACHE_DIRTY_EVERY accesses stamps
+ *  the page anew, and every access checks the stamp the page was last
+ *  given.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_ZCacheRun(
+    char        *name,          /* IN name of the run */
+    PageID      *pids,          /* IN pages accessed */
+    Four        *stamps,        /* INOUT stamps of the pages */
+    Boolean     scan)           /* IN TRUE for the scans */
+{
+    Four        e;
+    Four        i, n, nAccesses;
+    Four        nWrong = 0;
+    Four        nTrains;
+    Eight       bytes, target;
+    char        *buf;
+    double      t0, elapsed;
+    BfMStats    before, after;
+
+    e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    nAccesses = (scan) ? ZCACHE_PAGES * ZCACHE_SCANS : ZCACHE_ACCESSES;
+
+    t0 = bench_Now();
+    for (i = 0; i < nAccesses; i++) {
+        if (scan) n = i % ZCACHE_PAGES;
+        else if (bench_Random(100) < ZCACHE_WARM_PERCENT) n = bench_Random(ZCACHE_WARM_PAGES);
+        else n = bench_Random(ZCACHE_PAGES);
+
+        e = EduBfM_GetTrain(&pids[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+
+        if (memcmp(buf + PAGESIZE - sizeof(Four), &stamps[n], sizeof(Four)) != 0) nWrong++;
+        if (i % ZCACHE_DIRTY_EVERY == 0) {
+            stamps[n]++;
+            memcpy(buf + PAGESIZE - sizeof(Four), &stamps[n], sizeof(Four));
+            e = EduBfM_SetDirty(&pids[n], PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        e = EduBfM_FreeTrain(&pids[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    elapsed = bench_Now() - t0;
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+    edubfm_ZCacheUsage(&nTrains, &bytes, &target);
+
+    benchWrong += nWrong;
+    printf("%-14s %8d %8llu %8llu %10.1f %8d %9.2f %6.2f %10.2f %7d\n", name, nAccesses,
+           after.nMisses - before.nMisses,
+           (after.nMisses - before.nMisses) - (after.nCompressedHits - before.nCompressedHits),
+           elapsed / 1e6, nTrains, (double)bytes / (1 << 20),
+           (bytes > 0) ? (double)nTrains * PAGESIZE / bytes : 0.0, (double)target / (1 << 20), nWrong);
+
+    return(eNOERROR);
+
+} /* bench_ZCacheRun() */
+
+
+
+/*@================================
+ * bench_ZCache()
+ *================================*/
+/*
+ * Function: Four bench_ZCache(Four)
+ *
+ * Description:
+ *  Fill ZCACHE_PAGES pages like slotted pages and access them through a
+ *  page pool of ZCACHE_NUM_BUFS buffers reading by the direct I/O, so
+ *  that every read goes to the disk, first without a compressed cache,
+ *  then with one of as many pages as the pool. The cache then sees scans
+ *  which miss it, and the skewed workload again. The columns give the
+ *  misses of the pool, the misses which read the disk, the trains kept by
+ *  the cache afterwards, their images, how many times smaller than the
+ *  trains they are, and the target size of the cache; the last column is
+ *  the number of accesses which found a wrong stamp.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_ZCache(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        i;
+    char        *buf;
+    PageID      *pids;
+    Four        *stamps;
+    BfMConfig   cfg;
+    BenchPool   pool;
+
+    pids = (PageID *)malloc(sizeof(PageID) * ZCACHE_PAGES);
+    stamps = (Four *)malloc(sizeof(Four) * ZCACHE_PAGES);
+    if (pids == NULL || stamps == NULL) {
+        free(pids);
+        free(stamps);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    e = bench_NewPages(volId, ZCACHE_PAGES, pids);
+    if (e >= eNOERROR) e = bench_BigPool(&pool, ZCACHE_NUM_BUFS);
+    if (e < eNOERROR) {
+        free(pids);
+        free(stamps);
+        ERR(e);
+    }
+
+    printf("\n[compress] %d buffers, %d pages filled %d-%d%% like slotted pages, %d%% of the accesses to %d pages, 1 in %d updating\n",
+           ZCACHE_NUM_BUFS, ZCACHE_PAGES, ZCACHE_FILL_MIN, ZCACHE_FILL_MAX, ZCACHE_WARM_PERCENT,
+           ZCACHE_WARM_PAGES, ZCACHE_DIRTY_EVERY);
+    printf("%-14s %8s %8s %8s %10s %8s %9s %6s %10s %7s\n", "cache", "accesses", "misses", "reads",
+           "msec", "trains", "image MB", "ratio", "target MB", "wrong");
+
+    e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    if (e >= eNOERROR) {
+        seed = 1;
+        for (i = 0; e >= eNOERROR && i < ZCACHE_PAGES; i++) {
+            stamps[i] = i;
+            e = EduBfM_GetTrain(&pids[i], &buf, PAGE_BUF);
+            if (e < eNOERROR) break;
+            bench_FillPage(buf, i);
+            memcpy(buf + PAGESIZE - sizeof(Four), &stamps[i], sizeof(Four));
+            e = EduBfM_SetDirty(&pids[i], PAGE_BUF);
+            if (e >= eNOERROR) e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+        }
+
+        if (e >= eNOERROR) e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+        if (e >= eNOERROR) {
+            cfg.directIO = TRUE;
+            e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+        }
+
+        if (e >= eNOERROR) e = bench_EmptyPool();
+        if (e >= eNOERROR) e = bench_ZCacheRun("none", pids, stamps, FALSE);
+
+        if (e >= eNOERROR) e = bench_EmptyPool();
+        if (e >= eNOERROR) e = EduBfM_SetCompressedCache(ZCACHE_NUM_BUFS);
+        if (e >= eNOERROR) e = bench_ZCacheRun("compressed", pids, stamps, FALSE);
+        if (e >= eNOERROR) e = bench_ZCacheRun("scans", pids, stamps, TRUE);
+        if (e >= eNOERROR) e = bench_ZCacheRun("skewed again", pids, stamps, FALSE);
+
+        EduBfM_SetCompressedCache(0);
+        EduBfM_DetachVolume(volId);
+    }
+
+    e = bench_RestorePool(&pool, e);
+    free(pids);
+    free(stamps);
+
+    return(e);
+
+} /* bench_ZCache() */
+
+
+
+/*@================================
+ * bench_ExtensionRun()
+ *================================*/
+/*
+ * Function: Four bench_ExtensionRun(char *, PageID *, Four *, Four *)
+ *
+ * Description:
+ *  Do EXT_ACCESSES accesses, EXT_HOT_PERCENT% of them to random hot pages
+ *  and the others to the next page of the scan, and print the misses,
+ *  those served by the extension file and those which read the volume,
+ *  the trains written to the file, and the trains it holds afterwards.
+ *  One in EXT_DIRTY_EVERY accesses stamps the page anew, and every access
+ *  checks the stamp the page was last given.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_ExtensionRun(
+    char        *name,          /* IN name of the run */
+    PageID      *pids,          /* IN pages accessed */
+    Four        *stamps,        /* INOUT stamps of the pages */
+    Four        *scanPos)       /* INOUT next page of the scan */
+{
+    Four        e;
+    Four        i, n;
+    Four        nWrong = 0;
+    char        *buf;
+    double      t0, elapsed;
+    BfMStats    before, after;
+
+    e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    t0 = bench_Now();
+    for (i = 0; i < EXT_ACCESSES; i++) {
+        if (bench_Random(100) < EXT_HOT_PERCENT) n = bench_Random(EXT_HOT_PAGES);
+        else {
+            n = EXT_HOT_PAGES + *scanPos;
+            *scanPos = (*scanPos + 1) % EXT_SCAN_PAGES;
+        }
+
+        e = EduBfM_GetTrain(&pids[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+
+        if (memcmp(buf + PAGESIZE - sizeof(Four), &stamps[n], sizeof(Four)) != 0) nWrong++;
+        if (i % EXT_DIRTY_EVERY == 0) {
+            stamps[n]++;
+            memcpy(buf + PAGESIZE - sizeof(Four), &stamps[n], sizeof(Four));
+            e = EduBfM_SetDirty(&pids[n], PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        e = EduBfM_FreeTrain(&pids[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    elapsed = bench_Now() - t0;
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+
+    benchWrong += nWrong;
+    printf("%-16s %8d %8llu %8llu %8llu %8llu %8d %10.1f %7d\n", name, EXT_ACCESSES,
+           after.nMisses - before.nMisses,
+           after.nExtensionHits - before.nExtensionHits,
+           (after.nMisses - before.nMisses) - (after.nExtensionHits - before.nExtensionHits),
+           after.nExtensionWrites - before.nExtensionWrites,
+           edubfm_ExtensionUsage(PAGE_BUF), elapsed / 1e6, nWrong);
+
+    return(eNOERROR);
+
+} /* bench_ExtensionRun() */
+
+
+
+/*@================================
+ * bench_Extension()
+ *================================*/
+/*
+ * Function: Four bench_Extension(Four)
+ *
+ * Description:
+ *  Access EXT_HOT_PAGES pages at random, mixed with a scan of other
+ *  EXT_SCAN_PAGES pages, through a page pool of EXT_NUM_BUFS buffers
+ *  reading by the direct I/O, first without an extension file, then
+ *  twice with one of EXT_NUM_TRAINS trains, which holds the hot pages
+ *  once they have been evicted twice. The columns give the misses of the
+ *  pool, those served by the file, those which read the volume, the
+ *  trains written to the file, and the trains it holds afterwards; the
+ *  last column is the number of accesses which found a wrong stamp.
+ *  The file is on the disk of the volume here; on a local SSD in front of
+ *  a slower volume, a read of the file is that much cheaper.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_Extension(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        i;
+    Four        nPages = EXT_HOT_PAGES + EXT_SCAN_PAGES;
+    Four        scanPos = 0;
+    char        *buf;
+    PageID      *pids;
+    Four        *stamps;
+    BfMConfig   cfg;
+    BenchPool   pool;
+
+    pids = (PageID *)malloc(sizeof(PageID) * nPages);
+    stamps = (Four *)malloc(sizeof(Four) * nPages);
+    if (pids == NULL || stamps == NULL) {
+        free(pids);
+        free(stamps);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    e = bench_NewPages(volId, nPages, pids);
+    if (e >= eNOERROR) e = bench_BigPool(&pool, EXT_NUM_BUFS);
+    if (e < eNOERROR) {
+        free(pids);
+        free(stamps);
+        ERR(e);
+    }
+
+    printf("\n[extension] %d buffers, %d%% of the accesses to %d pages at random, the others scanning %d pages, 1 in %d updating\n",
+           EXT_NUM_BUFS, EXT_HOT_PERCENT, EXT_HOT_PAGES, EXT_SCAN_PAGES, EXT_DIRTY_EVERY);
+    printf("%-16s %8s %8s %8s %8s %8s %8s %10s %7s\n", "extension", "accesses", "misses", "ext hits",
+           "reads", "ext wr", "trains", "msec", "wrong");
+
+    e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    if (e >= eNOERROR) {
+        seed = 1;
+        for (i = 0; e >= eNOERROR && i < nPages; i++) {
+            stamps[i] = i;
+            e = EduBfM_GetTrain(&pids[i], &buf, PAGE_BUF);
+            if (e < eNOERROR) break;
+            memset(buf, 0, PAGESIZE);
+            memcpy(buf + PAGESIZE - sizeof(Four), &stamps[i], sizeof(Four));
+            e = EduBfM_SetDirty(&pids[i], PAGE_BUF);
+            if (e >= eNOERROR) e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+        }
+
+        if (e >= eNOERROR) e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+        if (e >= eNOERROR) {
+            cfg.directIO = TRUE;
+            e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+        }
+
+        if (e >= eNOERROR) e = bench_EmptyPool();
+        if (e >= eNOERROR) e = bench_ExtensionRun("none", pids, stamps, &scanPos);
+
+        if (e >= eNOERROR) e = bench_EmptyPool();
+        if (e >= eNOERROR) e = EduBfM_SetExtensionFile(PAGE_BUF, EXT_FILE_NAME, EXT_NUM_TRAINS);
+        if (e >= eNOERROR) e = bench_ExtensionRun("extension", pids, stamps, &scanPos);
+        if (e >= eNOERROR) e = bench_ExtensionRun("extension again", pids, stamps, &scanPos);
+
+        EduBfM_SetExtensionFile(PAGE_BUF, NULL, 0);
+        remove(EXT_FILE_NAME);
+        EduBfM_DetachVolume(volId);
+    }
+
+    e = bench_RestorePool(&pool, e);
+    free(pids);
+    free(stamps);
+
+    return(e);
+
+} /* bench_Extension() */
@@ -0,0 +1,450 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchFlush.c
+ *
+ * Description:
+ *  Benchmarks of the writes of the dirty pages: the background writer,
+ *  EduBfM_FlushAll() on each I/O engine, and EduBfM_FlushAll() on a
+ *  large pool holding a few dirty pages.
+ *
+ * Exports:
+ *  Four bench_Writer(Four)
+ *  Four bench_Flush(Four)
+ *  Four bench_Dirty(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "EduBfM_BenchModule.h"
+
+
+/*
+ * Definition for the benchmarks of this module
+ */
+/* writer benchmark */
+#define WRITER_PAGES            300     /* pages accessed at random */
+#define WRITER_ACCESSES         4000
+#define WRITER_WORK_USEC        50      /* work done on each page while it is fixed */
+#define WRITER_DIRTY_LOW        20      /* watermarks of the background writer */
+#define WRITER_DIRTY_HIGH       50
+
+/* flush benchmark */
+#define FLUSH_NUM_BUFS          8192    /* buffers of the page pool */
+
+/* dirty benchmark */
+#define DIRTY_NUM_BUFS          32000   /* buffers of the page pool */
+#define DIRTY_PAGES             1024    /* pages in the pool */
+#define DIRTY_FLUSHES           200     /* flushes timed for each number of dirty pages */
+
+
+
+/*@================================
+ * bench_WriterRun()
+ *================================*/
+/*
+ * Function: Four bench_WriterRun(char *, Four, Four)
+ *
+ * Description:
+ *  Run the dirtying workload with the given watermarks, print how the
+ *  victims were cleaned, and check the contents of the pages after
+ *  reading them again from the volume.
+ *  Each access stamps the last word of the page with the access number.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_WriterRun(
+    char        *name,          /* IN name of the run */
+    Four        dirtyLow,       /* IN low watermark */
+    Four        dirtyHigh)      /* IN high watermark (0: no background writer) */
+{
+    Four        e;
+    Four        i, n;
+    Four        nWrong;
+    char        *buf;
+    double      start, elapsed;
+    BfMConfig   cfg;
+    BfMStats    before, after;
+    static Four stamps[WRITER_PAGES];
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+    cfg.dirtyLow = dirtyLow;
+    cfg.dirtyHigh = dirtyHigh;
+    e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    seed = 1;
+    start = bench_Now();
+    for (i = 1; i <= WRITER_ACCESSES; i++) {
+        n = bench_Random(WRITER_PAGES);
+
+        e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+
+        memcpy(buf + PAGESIZE - sizeof(Four), &i, sizeof(Four));
+        stamps[n] = i;
+        while (bench_Now() - start < i * WRITER_WORK_USEC * 1e3);
+
+        e = EduBfM_SetDirty(&pageIds[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+
+        e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    elapsed = (bench_Now() - start) / 1e9;
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+
+    cfg.dirtyLow = cfg.dirtyHigh = 0;
+    e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+
+    for (nWrong = 0, n = 0; n < WRITER_PAGES; n++) {
+        if (stamps[n] == 0) continue;
+
+        e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        if (memcmp(buf + PAGESIZE - sizeof(Four), &stamps[n], sizeof(Four)) != 0) nWrong++;
+        e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    benchWrong += nWrong;
+    printf("%-10s %8llu %14llu %14llu %10llu %9.3f %7d\n", name,
+           (after.nFreeAllocs - before.nFreeAllocs) + (after.nCleanAllocs - before.nCleanAllocs)
+           + (after.nSweepAllocs - before.nSweepAllocs),
+           after.nVictimFlushes - before.nVictimFlushes, after.nWriterFlushes - before.nWriterFlushes,
+           after.nAvoidedFlushes - before.nAvoidedFlushes, elapsed, nWrong);
+
+    return(eNOERROR);
+
+} /* bench_WriterRun() */
+
+
+
+/*@================================
+ * bench_Writer()
+ *================================*/
+/*
+ * Function: Four bench_Writer(Four)
+ *
+ * Description:
+ *  Compare the number of dirty victims the foreground has to write
+ *  without and with the background writer. The last column is the number
+ *  of pages whose contents read back from the volume are wrong.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Writer(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    char        name[32];
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[writer] %d buffers, %d accesses to %d pages, %d usec of work per access\n",
+           BE_NBUFS(PAGE_BUF), WRITER_ACCESSES, WRITER_PAGES, WRITER_WORK_USEC);
+    printf("%-10s %8s %14s %14s %10s %9s %7s\n", "writer", "misses", "victim flushes",
+           "writer flushes", "avoided", "seconds", "wrong");
+
+    e = bench_WriterRun("off", 0, 0);
+    if (e >= eNOERROR) {
+        sprintf(name, "%d%%-%d%%", WRITER_DIRTY_LOW, WRITER_DIRTY_HIGH);
+        e = bench_WriterRun(name, WRITER_DIRTY_LOW, WRITER_DIRTY_HIGH);
+    }
+
+    EduBfM_DetachVolume(volId);
+
+    return(e);
+
+} /* bench_Writer() */
+
+
+
+/*@================================
+ * bench_FlushRun()
+ *================================*/
+/*
+ * Function: Four bench_FlushRun(char *, PageID *, Four, Four, Boolean)
+ *
+ * Description:
+ *  Dirty every buffer of the page pool with the given pages in random
+ *  order and print the time to write them out, either by
+ *  EduBfM_FlushAll() with the given I/O engine (not changed if NIL) and
+ *  flushDepth, or one by one in reverse buffer order as EduBfM_FlushAll()
+ *  did before trains were sorted.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_FlushRun(
+    char        *name,          /* IN name of the run */
+    PageID      *pids,          /* IN pages to be dirtied */
+    Four        engine,         /* IN BFM_IOENGINE_xxx or NIL */
+    Four        depth,          /* IN flushDepth of the pool */
+    Boolean     perTrain)       /* IN TRUE to flush one train at a time */
+{
+    Four        e;
+    Four        i, j, n;
+    char        *buf;
+    Four        *order;
+    double      t0, elapsed;
+    BfMConfig   cfg;
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+    cfg.flushDepth = depth;
+    e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+    if (engine != NIL) {
+        e = EduBfM_SetIOEngine(engine);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    n = BE_NBUFS(PAGE_BUF);
+
+    order = (Four *)malloc(sizeof(Four) * n);
+    if (order == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    for (i = 0; i < n; i++) order[i] = i;
+    seed = 1;
+    for (i = n - 1; i > 0; i--) {
+        j = bench_Random(i + 1);
+        e = order[i]; order[i] = order[j]; order[j] = e;
+    }
+
+    for (i = 0; i < n; i++) {
+        e = EduBfM_GetTrain(&pids[order[i]], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        buf[PAGESIZE - 1]++;
+        e = EduBfM_SetDirty(&pids[order[i]], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        e = EduBfM_FreeTrain(&pids[order[i]], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    free(order);
+
+    t0 = bench_Now();
+    if (perTrain) {
+        for (i = n - 1; i >= 0; i--) {
+            e = edubfm_FlushTrain((TrainID *)&BI_KEY(PAGE_BUF, i), PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+        }
+    }
+    else {
+        e = EduBfM_FlushAll();
+        if (e < eNOERROR) ERR(e);
+    }
+    elapsed = bench_Now() - t0;
+
+    printf("%-24s %10.2f %10.1f\n", name, elapsed / 1e6, (double)n * PAGESIZE / (elapsed / 1e9) / (1 << 20));
+
+    return(eNOERROR);
+
+} /* bench_FlushRun() */
+
+
+
+/*@================================
+ * bench_Flush()
+ *================================*/
+/*
+ * Function: Four bench_Flush(Four)
+ *
+ * Description:
+ *  Measure the time to flush a page pool of FLUSH_NUM_BUFS dirty buffers.
+ *  The buffer pool of the storage system is replaced by a larger one for
+ *  the benchmark.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Flush(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    PageID      *pids;
+    BenchPool   pool;
+
+    pids = (PageID *)malloc(sizeof(PageID) * FLUSH_NUM_BUFS);
+    if (pids == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    e = bench_NewPages(volId, FLUSH_NUM_BUFS, pids);
+    if (e >= eNOERROR) e = bench_BigPool(&pool, FLUSH_NUM_BUFS);
+    if (e < eNOERROR) {
+        free(pids);
+        ERR(e);
+    }
+
+    printf("\n[flush] %d dirty pages dirtied in random order, page cache not synced\n", FLUSH_NUM_BUFS);
+    printf("%-24s %10s %10s\n", "flush", "msec", "MB/s");
+
+    e = bench_FlushRun("per train", pids, NIL, 0, TRUE);
+    if (e >= eNOERROR) e = bench_FlushRun("sorted, detached", pids, NIL, 0, FALSE);
+    if (e >= eNOERROR) e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    if (e >= eNOERROR) {
+        e = bench_FlushRun("threads, depth 1", pids, BFM_IOENGINE_THREADS, 1, FALSE);
+        if (e >= eNOERROR) e = bench_FlushRun("threads, no limit", pids, BFM_IOENGINE_THREADS, 0, FALSE);
+        if (e >= eNOERROR) e = bench_FlushRun("io_uring, depth 1", pids, BFM_IOENGINE_URING, 1, FALSE);
+        if (e >= eNOERROR) e = bench_FlushRun("io_uring, depth 8", pids, BFM_IOENGINE_URING, 8, FALSE);
+        if (e >= eNOERROR) e = bench_FlushRun("io_uring, no limit", pids, BFM_IOENGINE_URING, 0, FALSE);
+        EduBfM_DetachVolume(volId);
+    }
+
+    e = bench_RestorePool(&pool, e);
+    free(pids);
+
+    return(e);
+
+} /* bench_Flush() */
+
+
+
+/*@================================
+ * bench_Dirty()
+ *================================*/
+/*
+ * Function: Four bench_Dirty(Four)
+ *
+ * Description:
+ *  Read DIRTY_PAGES pages into a page pool of DIRTY_NUM_BUFS buffers and
+ *  time EduBfM_FlushAll() after dirtying 0, 1, 16, and 256 of them, each
+ *  DIRTY_FLUSHES times. The columns give the time of a flush and the
+ *  part of it spent on each dirty page.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_Dirty(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        i, k, r;
+    Four        nDirty[] = { 0, 1, 16, 256 };
+    char        *buf;
+    double      t0, elapsed;
+    PageID      *pids;
+    BenchPool   pool;
+
+    pids = (PageID *)malloc(sizeof(PageID) * DIRTY_PAGES);
+    if (pids == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    e = bench_NewPages(volId, DIRTY_PAGES, pids);
+    if (e >= eNOERROR) e = bench_BigPool(&pool, DIRTY_NUM_BUFS);
+    if (e < eNOERROR) {
+        free(pids);
+        ERR(e);
+    }
+
+    printf("\n[dirty] %d buffers holding %d pages, %d flushes each\n", DIRTY_NUM_BUFS, DIRTY_PAGES, DIRTY_FLUSHES);
+    printf("%-8s %12s %14s\n", "dirty", "usec/flush", "usec/dirty pg");
+
+    e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    for (i = 0; e >= eNOERROR && i < DIRTY_PAGES; i++) {
+        e = EduBfM_GetTrain(&pids[i], &buf, PAGE_BUF);
+        if (e >= eNOERROR) e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+    }
+
+    for (k = 0; e >= eNOERROR && k < sizeof(nDirty) / sizeof(nDirty[0]); k++) {
+        elapsed = 0;
+        for (r = 0; e >= eNOERROR && r < DIRTY_FLUSHES; r++) {
+            for (i = 0; e >= eNOERROR && i < nDirty[k]; i++) {
+                e = EduBfM_GetTrain(&pids[i * (DIRTY_PAGES / 256)], &buf, PAGE_BUF);
+                if (e < eNOERROR) break;
+                buf[0]++;
+                e = EduBfM_SetDirty(&pids[i * (DIRTY_PAGES / 256)], PAGE_BUF);
+                if (e >= eNOERROR) e = EduBfM_FreeTrain(&pids[i * (DIRTY_PAGES / 256)], PAGE_BUF);
+            }
+
+            t0 = bench_Now();
+            if (e >= eNOERROR) e = EduBfM_FlushAll();
+            elapsed += bench_Now() - t0;
+        }
+        if (e < eNOERROR) break;
+
+        printf("%-8d %12.1f %14.1f\n", nDirty[k], elapsed / DIRTY_FLUSHES / 1e3,
+               (nDirty[k] > 0) ? elapsed / DIRTY_FLUSHES / nDirty[k] / 1e3 : 0.0);
+    }
+
+    EduBfM_DetachVolume(volId);
+
+    e = bench_RestorePool(&pool, e);
+    free(pids);
+
+    return(e);
+
+} /* bench_Dirty() */
@@ -0,0 +1,249 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchLookUp.c
+ *
+ * Description:
+ *  Benchmark of the lookup of a buffer: the page table versus the hash
+ *  table chained through the buffer table.
+ *
+ * Exports:
+ *  Four bench_LookUp(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "EduBfM_BenchModule.h"
+
+
+/*
+ * Definition for the benchmarks of this module
+ */
+/* lookup benchmark */
+#define LOOKUP_VOLUMES          8       /* keys are spread over this many volumes */
+#define LOOKUP_COUNT            (1 << 20) /* # of lookups of each kind per pool size */
+
+
+
+/*@================================
+ * bench_ChainLookUp()
+ *================================*/
+/*
+ * Function: Four bench_ChainLookUp(BufferTable *, Two *, Four, BfMHashKey *)
+ *
+ * Description:
+ *  Look up the key the way edubfm_ChainLookUp() does, on a private
+ *  buffer table and hash table.
+ *
+ * Returns:
+ *  index of the key (NOTFOUND_IN_HTABLE if not found)
+ */
+static Four bench_ChainLookUp(
+    BufferTable *bufTable,      /* IN buffer table */
+    Two         *hashTable,     /* IN hash table */
+    Four        tableSize,      /* IN size of the hash table */
+    BfMHashKey  *key)           /* IN key to be found */
+{
+    Four        i;
+
+    for (i = hashTable[(key->volNo + key->pageNo) % tableSize]; i != NIL; i = bufTable[i].nextHashEntry)
+        if (EQUALKEY(&bufTable[i].key, key)) return(i);
+
+    return(NOTFOUND_IN_HTABLE);
+
+} /* bench_ChainLookUp() */
+
+
+
+/*@================================
+ * bench_LookUp()
+ *================================*/
+/*
+ * Function: Four bench_LookUp(Four)
+ *
+ * Description:
+ *  Measure the lookup time of the page table and of the chained hash
+ *  table for pools of several sizes. The pool holds the same number of
+ *  consecutive pages of each of LOOKUP_VOLUMES volumes, the pattern which
+ *  makes the chains long under (volNo + pageNo). Hits are looked up in
+ *  random order, misses are the same pages of other volumes.
+ *  The hash table can only link MAX_CHAINED_BUFINDEX+1 buffers, so the
+ *  larger pools are measured on the page table only.
+ *  The page table hashes a key by one multiplication and looks at its
+ *  home bucket in line, so built without optimization a hit costs less
+ *  than on the chains at every size; optimized, the two are even on the
+ *  smallest pool and the page table takes a third of the time from 8192
+ *  buffers on, where the chains grow long. A pool used by EduBfM alone
+ *  (BfMConfig.shared FALSE) has the page table as its only index; the
+ *  chains are kept only for a pool the storage system shares, whose
+ *  misses under the pool latch they tell alone (see edubfm_LookUp()).
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_LookUp(
+    Four        volId)          /* IN volume identifier (not used) */
+{
+    static Four sizes[] = { 1024, 8192, 32760, 1 << 20, 1 << 23, 0 };
+    Four        e;
+    Four        n, tableSize;
+    Four        i, j, r, h;
+    Four        nRounds;
+    Boolean     chained;
+    Four        found;
+    Four        *order;
+    BfMHashKey  key;
+    BufferTable *bufTable;
+    Two         *hashTable;
+    BfMPageTable pt;
+    double      t0, tChainHit, tChainMiss, tPtHit, tPtMiss;
+
+    printf("\n[lookup] ns per lookup, %d volumes of consecutive pages\n", LOOKUP_VOLUMES);
+    printf("%8s %12s %12s %12s %12s\n", "buffers", "chain hit", "chain miss", "table hit", "table miss");
+
+    for (r = 0; sizes[r] != 0; r++) {
+
+        n = sizes[r];
+        nRounds = (LOOKUP_COUNT + n - 1) / n;
+        chained = (n <= MAX_CHAINED_BUFINDEX + 1);
+        tableSize = HASHTABLESIZE_TO_NBUFS(chained ? n : 1);
+        bufTable = (BufferTable *)malloc(sizeof(BufferTable) * n);
+        hashTable = (Two *)malloc(sizeof(Two) * tableSize);
+        order = (Four *)malloc(sizeof(Four) * n);
+        if (bufTable == NULL || hashTable == NULL || order == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+        e = edubfm_PageTableInit(&pt, n);
+        if (e < eNOERROR) ERR(e);
+
+        /* build both indexes on the same keys */
+        for (h = 0; h < tableSize; h++) hashTable[h] = NIL;
+        for (i = 0; i < n; i++) {
+            bufTable[i].key.volNo = i % LOOKUP_VOLUMES;
+            bufTable[i].key.pageNo = i / LOOKUP_VOLUMES;
+            if (chained) {
+                h = (bufTable[i].key.volNo + bufTable[i].key.pageNo) % tableSize;
+                bufTable[i].nextHashEntry = hashTable[h];
+                hashTable[h] = i;
+            }
+
+            e = edubfm_PageTableInsert(&pt, &bufTable[i].key, i);
+            if (e < eNOERROR) ERR(e);
+
+            order[i] = i;
+        }
+
+        seed = 1;
+        for (i = n - 1; i > 0; i--) {
+            j = bench_Random(i + 1);
+            h = order[i]; order[i] = order[j]; order[j] = h;
+        }
+
+        found = 0;
+
+        tChainHit = tChainMiss = 0;
+
+        t0 = bench_Now();
+        for (j = 0; chained && j < nRounds; j++)
+            for (i = 0; i < n; i++)
+                found += (bench_ChainLookUp(bufTable, hashTable, tableSize, &bufTable[order[i]].key) == order[i]);
+        if (chained) tChainHit = bench_Now() - t0;
+
+        t0 = bench_Now();
+        for (j = 0; j < nRounds; j++)
+            for (i = 0; i < n; i++)
+                found += (edubfm_PageTableLookUp(&pt, &bufTable[order[i]].key) == order[i]);
+        tPtHit = bench_Now() - t0;
+
+        t0 = bench_Now();
+        for (j = 0; chained && j < nRounds; j++)
+            for (i = 0; i < n; i++) {
+                key.volNo = LOOKUP_VOLUMES + i % LOOKUP_VOLUMES;
+                key.pageNo = i / LOOKUP_VOLUMES;
+                found += (bench_ChainLookUp(bufTable, hashTable, tableSize, &key) == NOTFOUND_IN_HTABLE);
+            }
+        if (chained) tChainMiss = bench_Now() - t0;
+
+        t0 = bench_Now();
+        for (j = 0; j < nRounds; j++)
+            for (i = 0; i < n; i++) {
+                key.volNo = LOOKUP_VOLUMES + i % LOOKUP_VOLUMES;
+                key.pageNo = i / LOOKUP_VOLUMES;
+                found += (edubfm_PageTableLookUp(&pt, &key) == NOTFOUND_IN_HTABLE);
+            }
+        tPtMiss = bench_Now() - t0;
+
+        if (found != (chained ? 4 : 2) * nRounds * n) {
+            printf("lookup results differ!!!\n");
+            benchWrong++;
+        }
+
+        if (chained)
+            printf("%8d %12.1f %12.1f %12.1f %12.1f\n", n,
+                   tChainHit / ((double)nRounds * n), tChainMiss / ((double)nRounds * n),
+                   tPtHit / ((double)nRounds * n), tPtMiss / ((double)nRounds * n));
+        else
+            printf("%8d %12s %12s %12.1f %12.1f\n", n, "-", "-",
+                   tPtHit / ((double)nRounds * n), tPtMiss / ((double)nRounds * n));
+
+        edubfm_PageTableFinal(&pt);
+        free(bufTable);
+        free(hashTable);
+        free(order);
+    }
+
+    return(eNOERROR);
+
+} /* bench_LookUp() */
@@ -0,0 +1,694 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchMemory.c
+ *
+ * Description:
+ *  Benchmarks of the memory of the pools: a memory budget split between
+ *  the pools, the kinds of pages backing the frames, and the page size
+ *  of the volume.
+ *
+ * Exports:
+ *  Four bench_Balance(Four)
+ *  Four bench_Frames(Four)
+ *  Four bench_PageSize(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "RDsM.h"
+#include "EduBfM_BenchModule.h"
+
+
+/*
+ * Definition for the benchmarks of this module
+ */
+/* balance benchmark */
+#define BALANCE_BUDGET          1024    /* pages shared by the pools */
+#define BALANCE_ACCESSES        40000   /* accesses per phase */
+
+/* frames benchmark */
+#define FRAMES_NUM_BUFS         8192    /* buffers of the page pool */
+#define FRAMES_HITS             (1 << 21) /* hits per run */
+#define FRAMES_PROBES           8       /* words read per hit, as in a search of a node */
+
+/* pagesize benchmark */
+#define PGSZ_POOL_BYTES         (4 << 20) /* bytes of the frames of the page pool */
+#define PGSZ_TABLE_BYTES        (8 << 20) /* bytes of the table scanned */
+#define PGSZ_INDEX_KEYS         (1 << 20) /* keys of the index */
+#define PGSZ_SCANS              3       /* scans of the table per page size */
+#define PGSZ_LOOKUPS            100000  /* lookups of the index per page size */
+#define PGSZ_MAX_LEVELS         8       /* levels of the index */
+#define PGSZ_NO_KEY             0x7fffffff /* key of the unused entries of an index node */
+
+
+
+/*@================================
+ * bench_BalanceRun()
+ *================================*/
+/*
+ * Function: Four bench_BalanceRun(char *, Boolean)
+ *
+ * Description:
+ *  Split BALANCE_BUDGET pages evenly between the page pool and the large
+ *  object train pool, and run the phases of the balance benchmark with
+ *  the split kept or adapted by EduBfM_SetMemoryBudget(). Print the hit
+ *  ratio of each phase and the sizes of the pools at its end.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_BalanceRun(
+    char        *name,          /* IN name of the run */
+    Boolean     adaptive)       /* IN TRUE if the split follows the workload */
+{
+    static struct {
+        char    *name;
+        Four    pagePercent;    /* percentage of the accesses to pages */
+        Four    nPages;         /* pages accessed at random */
+        Four    nTrains;        /* trains accessed at random */
+    } phases[] = {
+        { "pages", 80, 700, 40 },
+        { "trains", 20, 100, 200 },
+        { "pages", 80, 700, 40 },
+        { NULL, 0, 0, 0 }
+    };
+    Four        e;
+    Four        i, p, type;
+    UEight      nLookups, nHits;
+    PageID      *pid;
+    char        *buf;
+    BfMStats    before[NUM_BUF_TYPES], after[NUM_BUF_TYPES];
+
+    e = EduBfM_SetMemoryBudget(0);
+    if (e >= eNOERROR) e = bench_EmptyPool();
+    if (e >= eNOERROR) e = EduBfM_ResizePool(PAGE_BUF, BALANCE_BUDGET / 2);
+    if (e >= eNOERROR) e = EduBfM_ResizePool(LOT_LEAF_BUF, BALANCE_BUDGET / 2 / BI_BUFSIZE(LOT_LEAF_BUF));
+    if (e >= eNOERROR && adaptive) e = EduBfM_SetMemoryBudget(BALANCE_BUDGET);
+    if (e < eNOERROR) ERR(e);
+
+    seed = 1;
+    for (p = 0; phases[p].name != NULL; p++) {
+
+        for (type = 0; type < NUM_BUF_TYPES; type++) {
+            e = EduBfM_GetStats(type, &before[type]);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        for (i = 0; i < BALANCE_ACCESSES; i++) {
+            if (bench_Random(100) < phases[p].pagePercent) {
+                type = PAGE_BUF;
+                pid = &pageIds[bench_Random(phases[p].nPages)];
+            } else {
+                type = LOT_LEAF_BUF;
+                pid = &pageIds[bench_Random(phases[p].nTrains) * BI_BUFSIZE(LOT_LEAF_BUF)];
+            }
+
+            e = EduBfM_GetTrain(pid, &buf, type);
+            if (e < eNOERROR) ERR(e);
+            e = EduBfM_FreeTrain(pid, type);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        for (nLookups = 0, nHits = 0, type = 0; type < NUM_BUF_TYPES; type++) {
+            e = EduBfM_GetStats(type, &after[type]);
+            if (e < eNOERROR) ERR(e);
+            nLookups += after[type].nLookups - before[type].nLookups;
+            nHits += after[type].nHits - before[type].nHits;
+        }
+
+        printf("%-10s %-8s %8.1f%% %10d %10d %12llu\n", name, phases[p].name, 100.0 * nHits / nLookups,
+               BE_NBUFS(PAGE_BUF), BE_NBUFS(LOT_LEAF_BUF) * BI_BUFSIZE(LOT_LEAF_BUF),
+               (after[PAGE_BUF].nGhostHits - before[PAGE_BUF].nGhostHits)
+               + (after[LOT_LEAF_BUF].nGhostHits - before[LOT_LEAF_BUF].nGhostHits));
+    }
+
+    return(eNOERROR);
+
+} /* bench_BalanceRun() */
+
+
+
+/*@================================
+ * bench_Balance()
+ *================================*/
+/*
+ * Function: Four bench_Balance(Four)
+ *
+ * Description:
+ *  Compare a fixed even split of BALANCE_BUDGET pages between the page
+ *  pool and the large object train pool with a split adapted by
+ *  EduBfM_SetMemoryBudget(), under a workload switching from random
+ *  accesses mostly to pages, to accesses mostly to trains, and back.
+ *  In each phase the working set of the favored pool is larger than half
+ *  the budget, while the working sets of both fit in the budget.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Balance(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        type;
+
+    printf("\n[balance] %d pages shared by the pools, %d accesses per phase, %d pages per train\n",
+           BALANCE_BUDGET, BALANCE_ACCESSES, BI_BUFSIZE(LOT_LEAF_BUF));
+    printf("%-10s %-8s %9s %10s %10s %12s\n", "split", "phase", "hit", "page mem", "train mem", "ghost hits");
+
+    e = bench_BalanceRun("fixed", FALSE);
+    if (e >= eNOERROR) e = bench_BalanceRun("adaptive", TRUE);
+
+    /* give the pools their sizes back */
+    if (e >= eNOERROR) e = EduBfM_SetMemoryBudget(0);
+    if (e >= eNOERROR) e = bench_EmptyPool();
+    for (type = 0; e >= eNOERROR && type < NUM_BUF_TYPES; type++)
+        e = EduBfM_ResizePool(type, BI_NBUFS(type));
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* bench_Balance() */
+
+
+
+/*@================================
+ * bench_HugeKB()
+ *================================*/
+/*
+ * Function: long bench_HugeKB(void)
+ *
+ * Description:
+ *  Return the kilobytes of the process's memory on huge pages, transparent
+ *  or reserved, as told by /proc/self/smaps_rollup.
+ *
+ * Returns:
+ *  kilobytes (0 if unknown)
+ */
+static long bench_HugeKB(void)
+{
+    FILE        *fp;
+    char        line[128];
+    long        kb, total = 0;
+
+    fp = fopen("/proc/self/smaps_rollup", "r");
+    if (fp == NULL) return(0);
+
+    while (fgets(line, sizeof(line), fp) != NULL)
+        if (sscanf(line, "AnonHugePages: %ld", &kb) == 1 || sscanf(line, "Private_Hugetlb: %ld", &kb) == 1)
+            total += kb;
+    fclose(fp);
+
+    return(total);
+
+} /* bench_HugeKB() */
+
+
+
+/*@================================
+ * bench_FramesRun()
+ *================================*/
+/*
+ * Function: Four bench_FramesRun(char *, PageID *, Four, Four)
+ *
+ * Description:
+ *  Move the frames of the page pool onto the given pages and nodes, check
+ *  the stamps of the pages in the pool, and time FRAMES_HITS hits on
+ *  random pages, each reading FRAMES_PROBES words of the page.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_FramesRun(
+    char        *name,          /* IN name of the run */
+    PageID      *pids,          /* IN pages in the pool */
+    Four        pages,          /* IN BFM_PAGES_xxx */
+    Four        numaNodes)      /* IN # of NUMA nodes */
+{
+    static char *pageNames[NUM_BFM_PAGES] = { "4 KB", "THP", "2 MB", "1 GB" };
+    Four        e;
+    Four        i, k, n;
+    Four        nWrong;
+    volatile Four sum;          /* keeps the reads of the words */
+    char        *buf;
+    double      t0, elapsed;
+    BfMConfig   cfg;
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+    cfg.hugePages = pages;
+    cfg.numaNodes = numaNodes;
+    t0 = bench_Now();
+    e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+    elapsed = bench_Now() - t0;
+
+    for (nWrong = 0, i = 0; i < FRAMES_NUM_BUFS; i++) {
+        e = EduBfM_GetTrain(&pids[i], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        for (k = 0; k < FRAMES_PROBES; k++)
+            if (((Four *)buf)[k * (PAGESIZE / sizeof(Four) / FRAMES_PROBES)] != i * FRAMES_PROBES + k) nWrong++;
+        e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    seed = 1;
+    sum = 0;
+    t0 = bench_Now();
+    for (i = 0; i < FRAMES_HITS; i++) {
+        n = bench_Random(FRAMES_NUM_BUFS);
+        e = EduBfM_GetTrain(&pids[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        for (k = 0; k < FRAMES_PROBES; k++)
+            sum += ((Four *)buf)[bench_Random(PAGESIZE / sizeof(Four))];
+        e = EduBfM_FreeTrain(&pids[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    t0 = bench_Now() - t0;
+
+    benchWrong += nWrong;
+    printf("%-24s %6s %6d %10.2f %9ld %10.1f %7d\n", name, pageNames[BE_PAGES(PAGE_BUF)],
+           BE_NUMANODES(PAGE_BUF), elapsed / 1e6, bench_HugeKB() / 1024, t0 / FRAMES_HITS, nWrong);
+
+    return(eNOERROR);
+
+} /* bench_FramesRun() */
+
+
+
+/*@================================
+ * bench_Frames()
+ *================================*/
+/*
+ * Function: Four bench_Frames(Four)
+ *
+ * Description:
+ *  Fill a page pool of FRAMES_NUM_BUFS buffers with stamped pages and
+ *  compare the time of hits on random pages as its frames are backed by
+ *  pages of each kind, first on no node in particular and then spread
+ *  over all the NUMA nodes. The frames are moved in place for each run,
+ *  and the stamps are checked afterwards. Reserved huge pages fall back
+ *  to transparent ones if the system has none, which shows in the kind
+ *  of pages obtained.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_Frames(
+    Four        volId)          /* IN volume identifier */
+{
+    static struct {
+        char    *name;
+        Four    pages;
+        Four    numaNodes;
+    } runs[] = {
+        { "4 KB pages", BFM_PAGES_DEFAULT, 0 },
+        { "transparent huge pages", BFM_PAGES_THP, 0 },
+        { "2 MB huge pages", BFM_PAGES_2MB, 0 },
+        { "1 GB huge pages", BFM_PAGES_1GB, 0 },
+        { "4 KB pages, all nodes", BFM_PAGES_DEFAULT, BFM_MAX_NUMA_NODES },
+        { "2 MB pages, all nodes", BFM_PAGES_2MB, BFM_MAX_NUMA_NODES },
+        { NULL, 0, 0 }
+    };
+    Four        e;
+    Four        i, k, r;
+    char        *buf;
+    PageID      *pids;
+    BenchPool   pool;
+
+    pids = (PageID *)malloc(sizeof(PageID) * FRAMES_NUM_BUFS);
+    if (pids == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    e = bench_NewPages(volId, FRAMES_NUM_BUFS, pids);
+    if (e >= eNOERROR) e = bench_BigPool(&pool, FRAMES_NUM_BUFS);
+    if (e < eNOERROR) {
+        free(pids);
+        ERR(e);
+    }
+
+    for (i = 0; e >= eNOERROR && i < FRAMES_NUM_BUFS; i++) {
+        e = EduBfM_GetTrain(&pids[i], &buf, PAGE_BUF);
+        if (e < eNOERROR) break;
+        for (k = 0; k < FRAMES_PROBES; k++)
+            ((Four *)buf)[k * (PAGESIZE / sizeof(Four) / FRAMES_PROBES)] = i * FRAMES_PROBES + k;
+        e = EduBfM_SetDirty(&pids[i], PAGE_BUF);
+        if (e >= eNOERROR) e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+    }
+
+    printf("\n[frames] %d buffers of %d bytes, %d NUMA node(s) online, %d hits on random pages reading %d words each\n",
+           FRAMES_NUM_BUFS, PAGESIZE, edubfm_NumaNodes(), FRAMES_HITS, FRAMES_PROBES);
+    printf("%-24s %6s %6s %10s %9s %10s %7s\n", "frames", "pages", "nodes", "move msec", "huge MB", "ns/hit", "wrong");
+
+    for (r = 0; e >= eNOERROR && runs[r].name != NULL; r++)
+        e = bench_FramesRun(runs[r].name, pids, runs[r].pages, runs[r].numaNodes);
+
+    if (e >= eNOERROR) e = bench_FramesRun("4 KB pages again", pids, BFM_PAGES_DEFAULT, 0);
+
+    e = bench_RestorePool(&pool, e);
+    free(pids);
+
+    return(e);
+
+} /* bench_Frames() */
+
+
+
+/*@================================
+ * bench_AllocRuns()
+ *================================*/
+/*
+ * Function: Four bench_AllocRuns(Four, Four, Four, PageID *)
+ *
+ * Description:
+ *  Allocate 'n' runs of 'nPages' consecutive pages on a new segment, the
+ *  pages of a volume of pages nPages times PAGESIZE, each run starting at
+ *  a page number that is a multiple of nPages (see EduBfM_SetPageSize()).
+ *  The storage system allocates trains of one page or of TRAINSIZE pages
+ *  only, so the pages are allocated one by one, extent after extent, and
+ *  the runs are taken from the consecutive ones; the pages left over stay
+ *  allocated.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - the pages are not consecutive enough
+ *    some errors caused by function calls
+ */
+static Four bench_AllocRuns(
+    Four        volId,          /* IN volume identifier */
+    Four        nPages,         /* IN pages of a run */
+    Four        n,              /* IN # of runs */
+    PageID      *runs)          /* OUT first page of each run */
+{
+    Four        e;
+    Four        i, k;
+    Four        firstExtNo;
+    Four        length = 0;     /* length of the run being gathered */
+    PageID      nearPid;
+    PageID      pid;
+
+    e = RDsM_CreateSegment(volId, &firstExtNo);
+    if (e < eNOERROR) ERR(e);
+    e = RDsM_ExtNoToPageId(volId, firstExtNo, &nearPid);
+    if (e < eNOERROR) ERR(e);
+
+    for (i = 0, k = 0; i < n && k < 2 * n * nPages + BENCH_EXTENT_SIZE; k++) {
+        e = RDsM_AllocTrains(volId, firstExtNo, &nearPid, 100, 1, PAGESIZE2, &pid);
+        if (e < eNOERROR) ERR(e);
+
+        if (length > 0 && pid.volNo == runs[i].volNo && pid.pageNo == runs[i].pageNo + length)
+            length++;
+        else if (pid.pageNo % nPages == 0) {
+            runs[i] = pid;
+            length = 1;
+        }
+        else
+            length = 0;
+        if (length == nPages) {
+            i++;
+            length = 0;
+        }
+        nearPid = pid;
+    }
+    if (i < n) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    return(eNOERROR);
+
+} /* bench_AllocRuns() */
+
+
+
+/*@================================
+ * bench_PageSizeRun()
+ *================================*/
+/*
+ * Function: Four bench_PageSizeRun(Four, Four)
+ *
+ * Description:
+ *  Make the pages of the volume 'pageSize' bytes large, lay out a table
+ *  of PGSZ_TABLE_BYTES and an index of PGSZ_INDEX_KEYS keys on new pages,
+ *  and print the throughput of PGSZ_SCANS scans of the table and of
+ *  PGSZ_LOOKUPS lookups of random keys of the index, with the misses of
+ *  a lookup, through a page pool of PGSZ_POOL_BYTES of frames reading
+ *  with the direct I/O. Word k of page i of the table is i + k, which
+ *  every scan checks, and a page of PAGESIZE inside a page of the volume
+ *  must be refused.
+ *  An index node is an array of (key, child) pairs sorted by key, where
+ *  the child of a leaf is the value of the key, 3 * key; the root is
+ *  the last node allocated.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four bench_PageSizeRun(
+    Four        volId,          /* IN volume identifier */
+    Four        pageSize)       /* IN page size in bytes */
+{
+    Four        e;
+    Four        i, j, k, m, n, level;
+    Eight       span;           /* keys under a node of a level */
+    Four        fanout = pageSize / (2 * sizeof(Four));
+    Four        nTable = PGSZ_TABLE_BYTES / pageSize;
+    Four        nNodes, nLevels;
+    Four        levelStart[PGSZ_MAX_LEVELS + 1];        /* first node of each level, leaves first */
+    Four        nWrong = 0;
+    Four        *entries;
+    Four        key, low, high, mid;
+    Four        inside;         /* result of getting a page inside a page of the volume */
+    UFour       sum;            /* sum of the words of a page of the table */
+    char        *buf;
+    double      t0, scanTime, lookupTime;
+    PageID      *pids;
+    PageID      pid;
+    BfMConfig   cfg;
+    BfMStats    before, after;
+    BenchPool   pool;
+
+    /* the nodes of each level, from the leaves up to the root */
+    levelStart[0] = 0;
+    for (nLevels = 0, n = PGSZ_INDEX_KEYS; nLevels < PGSZ_MAX_LEVELS; ) {
+        n = (n + fanout - 1) / fanout;
+        levelStart[nLevels + 1] = levelStart[nLevels] + n;
+        nLevels++;
+        if (n == 1) break;
+    }
+    nNodes = levelStart[nLevels];
+
+    pids = (PageID *)malloc(sizeof(PageID) * (nTable + nNodes));
+    if (pids == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    /* no page of the volume may be buffered while its page size is changed */
+    e = bench_EmptyPool();
+    if (e >= eNOERROR) e = EduBfM_SetPageSize(volId, pageSize);
+    if (e >= eNOERROR) e = bench_AllocRuns(volId, pageSize / PAGESIZE, nTable + nNodes, pids);
+    if (e < eNOERROR) {
+        free(pids);
+        ERR(e);
+    }
+
+    e = bench_BigPool(&pool, PGSZ_POOL_BYTES / pageSize);
+    if (e < eNOERROR) {
+        free(pids);
+        ERR(e);
+    }
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e >= eNOERROR) {
+        cfg.pageSize = pageSize;
+        cfg.directIO = TRUE;
+        e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    }
+    if (e >= eNOERROR) e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+
+    /* the table, then the index level by level */
+    for (i = 0; e >= eNOERROR && i < nTable + nNodes; i++) {
+        e = EduBfM_GetTrain(&pids[i], &buf, PAGE_BUF);
+        if (e < eNOERROR) break;
+        entries = (Four *)buf;
+        if (i < nTable)
+            for (k = 0; k < pageSize / sizeof(Four); k++) entries[k] = i + k;
+        else {
+            n = i - nTable;
+            for (level = 0; n >= levelStart[level + 1]; level++);
+            for (k = 0; k < fanout; k++) {
+                if (level == 0) {
+                    key = n * fanout + k;
+                    entries[2 * k] = (key < PGSZ_INDEX_KEYS) ? key : PGSZ_NO_KEY;
+                    entries[2 * k + 1] = 3 * key;
+                }
+                else {
+                    /* the first key under a child is its index on its level times the keys under a node there */
+                    j = levelStart[level - 1] + (n - levelStart[level]) * fanout + k;
+                    for (span = 1, m = 0; m < level; m++) span *= fanout;
+                    entries[2 * k] = (j < levelStart[level]) ? (Four)((j - levelStart[level - 1]) * span) : PGSZ_NO_KEY;
+                    entries[2 * k + 1] = j;
+                }
+            }
+        }
+        e = EduBfM_SetDirty(&pids[i], PAGE_BUF);
+        if (e >= eNOERROR) e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+    }
+    if (e >= eNOERROR) e = bench_EmptyPool();
+
+    if (e >= eNOERROR && pageSize > PAGESIZE) {
+        pid = pids[0];
+        pid.pageNo++;
+        inside = EduBfM_GetTrain(&pid, &buf, PAGE_BUF);
+        if (inside != eBADPAGESIZE_EDUBFM) nWrong++;
+        if (inside >= eNOERROR) e = EduBfM_FreeTrain(&pid, PAGE_BUF);
+    }
+
+    /* scans of the table */
+    t0 = bench_Now();
+    for (j = 0; e >= eNOERROR && j < PGSZ_SCANS; j++)
+        for (i = 0; i < nTable; i++) {
+            e = EduBfM_GetTrain(&pids[i], &buf, PAGE_BUF);
+            if (e < eNOERROR) break;
+            entries = (Four *)buf;
+            for (sum = 0, k = 0; k < pageSize / sizeof(Four); k++) sum += entries[k];
+            if (sum != (UFour)i * (pageSize / sizeof(Four)) + (UFour)(pageSize / sizeof(Four)) * (pageSize / sizeof(Four) - 1) / 2)
+                nWrong++;
+            e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+            if (e < eNOERROR) break;
+        }
+    scanTime = bench_Now() - t0;
+
+    /* lookups of the index */
+    if (e >= eNOERROR) e = bench_EmptyPool();
+    if (e >= eNOERROR) e = EduBfM_GetStats(PAGE_BUF, &before);
+    seed = 1;
+    t0 = bench_Now();
+    for (i = 0; e >= eNOERROR && i < PGSZ_LOOKUPS; i++) {
+        key = bench_Random(PGSZ_INDEX_KEYS);
+        for (n = nNodes - 1, level = nLevels - 1; level >= 0; level--) {
+            e = EduBfM_GetTrain(&pids[nTable + n], &buf, PAGE_BUF);
+            if (e < eNOERROR) break;
+            entries = (Four *)buf;
+
+            /* the last entry whose key is not greater */
+            for (low = 0, high = fanout - 1; low < high; ) {
+                mid = (low + high + 1) / 2;
+                if (entries[2 * mid] <= key) low = mid;
+                else high = mid - 1;
+            }
+            if (level == 0 && (entries[2 * low] != key || entries[2 * low + 1] != 3 * key)) nWrong++;
+
+            e = EduBfM_FreeTrain(&pids[nTable + n], PAGE_BUF);
+            if (e < eNOERROR) break;
+            n = entries[2 * low + 1];
+        }
+    }
+    lookupTime = bench_Now() - t0;
+    if (e >= eNOERROR) e = EduBfM_GetStats(PAGE_BUF, &after);
+
+    benchWrong += nWrong;
+    if (e >= eNOERROR)
+        printf("%-8d %8d %8d %7d %10.1f %12.0f %12.2f %6d\n", pageSize / 1024, PGSZ_POOL_BYTES / pageSize,
+               fanout, nLevels, (double)PGSZ_TABLE_BYTES * PGSZ_SCANS / (1 << 20) / (scanTime / 1e9),
+               PGSZ_LOOKUPS / (lookupTime / 1e9), (double)(after.nMisses - before.nMisses) / PGSZ_LOOKUPS,
+               nWrong);
+
+    EduBfM_DetachVolume(volId);
+    e = bench_RestorePool(&pool, e);
+    if (e >= eNOERROR) e = EduBfM_SetPageSize(volId, PAGESIZE);
+    free(pids);
+
+    return(e);
+
+} /* bench_PageSizeRun() */
+
+
+
+/*@================================
+ * bench_PageSize()
+ *================================*/
+/*
+ * Function: Four bench_PageSize(Four)
+ *
+ * Description:
+ *  Compare the scans of a table and the lookups of an index on the volume
+ *  with pages of 4, 8, 16, and 64 KB (see bench_PageSizeRun()). The
+ *  columns give the page size in KB, the buffers of the page pool, the
+ *  entries of an index node, the levels of the index, the throughput of
+ *  the scans in MB/s and of the lookups per second, the misses of a
+ *  lookup, and the pages scanned or the lookups which read a wrong value.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_PageSize(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e = eNOERROR;
+    Four        i;
+    Four        pageSizes[] = { 4096, 8192, 16384, 65536 };
+
+    printf("\n[pagesize] table of %d MB scanned %d times, %d lookups of an index of %d keys, %d MB of frames\n",
+           PGSZ_TABLE_BYTES >> 20, PGSZ_SCANS, PGSZ_LOOKUPS, PGSZ_INDEX_KEYS, PGSZ_POOL_BYTES >> 20);
+    printf("%-8s %8s %8s %7s %10s %12s %12s %6s\n", "KB", "buffers", "fanout", "levels", "scan MB/s",
+           "lookups/s", "misses/lkup", "wrong");
+
+    for (i = 0; e >= eNOERROR && i < sizeof(pageSizes) / sizeof(pageSizes[0]); i++)
+        e = bench_PageSizeRun(volId, pageSizes[i]);
+
+    return(e);
+
+} /* bench_PageSize() */
@@ -0,0 +1,371 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchModule.c
+ *
+ * Description:
+ *  Fixtures shared by the benchmarks of EduBfM: the pages allocated for
+ *  the benchmarks or on a new segment, pseudo random numbers, timing,
+ *  and the replacement of the page pool of the storage system by a pool
+ *  of the size a benchmark needs.
+ *
+ * Exports:
+ *  Four bench_Random(Four)
+ *  double bench_Now(void)
+ *  Four bench_Access(PageID *, Four, Boolean *)
+ *  Four bench_EmptyPool(void)
+ *  void bench_DropCache(void)
+ *  Four bench_BigPool(BenchPool *, Four)
+ *  Four bench_RestorePool(BenchPool *, Four)
+ *  Four bench_NewPages(Four, Four, PageID *)
+ *  Four bench_AllocPages(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "RDsM.h"
+#include "EduBfM_BenchModule.h"
+
+
+
+PageID pageIds[BENCH_NUM_PAGES];         /* pages allocated for the benchmarks */
+UFour seed = 1;                          /* seed of the pseudo random numbers */
+Four benchWrong;                         /* wrong reads found by the benchmarks run */
+
+
+
+/*@================================
+ * bench_Random()
+ *================================*/
+/*
+ * Function: Four bench_Random(Four)
+ *
+ * Description:
+ *  Return a pseudo random number in [0, n).
+ *  A fixed linear congruential generator keeps the runs reproducible.
+ */
+Four bench_Random(
+    Four        n)              /* IN upper bound */
+{
+    seed = seed * 1103515245 + 12345;
+    return((Four)((seed >> 8) % (UFour)n));
+
+} /* bench_Random() */
+
+
+
+/*@================================
+ * bench_Now()
+ *================================*/
+/*
+ * Function: double bench_Now(void)
+ *
+ * Description:
+ *  Return the current time in nanoseconds.
+ */
+double bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return(ts.tv_sec * 1e9 + ts.tv_nsec);
+
+} /* bench_Now() */
+
+
+
+/*@================================
+ * bench_Access()
+ *================================*/
+/*
+ * Function: Four bench_Access(PageID *, Four, Boolean *)
+ *
+ * Description:
+ *  Fix and unfix the page, reporting whether it was in the buffer pool.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Access(
+    PageID      *pid,           /* IN page to be accessed */
+    Four        type,           /* IN buffer type */
+    Boolean     *hit)           /* OUT TRUE if the page was in the pool */
+{
+    Four        e;
+    char        *buf;
+
+    *hit = (edubfm_LookUp((BfMHashKey *)pid, type) != NOTFOUND_IN_HTABLE);
+
+    e = EduBfM_GetTrain(pid, &buf, type);
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_FreeTrain(pid, type);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* bench_Access() */
+
+
+
+/*@================================
+ * bench_EmptyPool()
+ *================================*/
+/*
+ * Function: Four bench_EmptyPool(void)
+ *
+ * Description:
+ *  Write out the dirty pages and empty the buffer pools so that every
+ *  run starts cold.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_EmptyPool(void)
+{
+    Four        e;
+
+    e = EduBfM_FlushAll();
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_DiscardAll();
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* bench_EmptyPool() */
+
+
+
+/*@================================
+ * bench_DropCache()
+ *================================*/
+/*
+ * Function: void bench_DropCache(void)
+ *
+ * Description:
+ *  Drop the pages of the volume from the page cache so that they are
+ *  read from the disk.
+ */
+void bench_DropCache(void)
+{
+    Four        fd;
+
+    fd = open(BENCH_VOLUME_NAME, O_RDONLY);
+    if (fd >= 0) {
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+
+} /* bench_DropCache() */
+
+
+
+/*@================================
+ * bench_BigPool()
+ *================================*/
+/*
+ * Function: Four bench_BigPool(BenchPool *, Four)
+ *
+ * Description:
+ *  Replace the page pool of the storage system by an empty one of the
+ *  given number of buffers. The replaced pool is kept in 'pool' and put
+ *  back by bench_RestorePool().
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_BigPool(
+    BenchPool   *pool,          /* OUT replaced pool */
+    Four        nBufs)          /* IN # of buffers */
+{
+    Four        e;
+    Four        i;
+
+    pool->bufTable = (BufferTable *)malloc(sizeof(BufferTable) * nBufs);
+    pool->hashTable = (Two *)malloc(sizeof(Two) * HASHTABLESIZE_TO_NBUFS(nBufs));
+    pool->bufferPool = (char *)malloc((size_t)PAGESIZE * nBufs);
+    if (pool->bufTable == NULL || pool->hashTable == NULL || pool->bufferPool == NULL) {
+        free(pool->bufTable);
+        free(pool->hashTable);
+        free(pool->bufferPool);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+    edubfm_FinalPool(PAGE_BUF);
+
+    for (i = 0; i < nBufs; i++) {
+        SET_NILBFMHASHKEY(pool->bufTable[i].key);
+        pool->bufTable[i].fixed = 0;
+        pool->bufTable[i].bits = ALL_0;
+        pool->bufTable[i].nextHashEntry = NIL;
+    }
+    for (i = 0; i < HASHTABLESIZE_TO_NBUFS(nBufs); i++) pool->hashTable[i] = NIL;
+
+    pool->saved = bufInfo[PAGE_BUF];
+    bufInfo[PAGE_BUF].nBufs = nBufs;
+    bufInfo[PAGE_BUF].nextVictim = 0;
+    bufInfo[PAGE_BUF].bufTable = pool->bufTable;
+    bufInfo[PAGE_BUF].bufferPool = pool->bufferPool;
+    bufInfo[PAGE_BUF].hashTable = pool->hashTable;
+
+    return(eNOERROR);
+
+} /* bench_BigPool() */
+
+
+
+/*@================================
+ * bench_RestorePool()
+ *================================*/
+/*
+ * Function: Four bench_RestorePool(BenchPool *, Four)
+ *
+ * Description:
+ *  Write out and drop the pool installed by bench_BigPool() and put the
+ *  page pool of the storage system back. The pool is only dropped if
+ *  the benchmark failed with the error 'e'.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_RestorePool(
+    BenchPool   *pool,          /* IN replaced pool */
+    Four        e)              /* IN error of the benchmark */
+{
+    if (e >= eNOERROR) e = bench_EmptyPool();
+    edubfm_FinalPool(PAGE_BUF);
+
+    /* edubfm_FinalPool() has put back the frames the pool was built with */
+    free(BI_BUFFERPOOL(PAGE_BUF));
+    bufInfo[PAGE_BUF] = pool->saved;
+
+    free(pool->bufTable);
+    free(pool->hashTable);
+
+    return(e);
+
+} /* bench_RestorePool() */
+
+
+
+/*@================================
+ * bench_NewPages()
+ *================================*/
+/*
+ * Function: Four bench_NewPages(Four, Four, PageID *)
+ *
+ * Description:
+ *  Allocate 'n' pages of one page on a new segment of the volume.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_NewPages(
+    Four        volId,          /* IN volume identifier */
+    Four        n,              /* IN # of pages */
+    PageID      *pids)          /* OUT pages allocated */
+{
+    Four        e;
+    Four        i;
+    Four        firstExtNo;
+    PageID      nearPid;
+
+    e = RDsM_CreateSegment(volId, &firstExtNo);
+    if (e < eNOERROR) ERR(e);
+    e = RDsM_ExtNoToPageId(volId, firstExtNo, &nearPid);
+    if (e < eNOERROR) ERR(e);
+
+    for (i = 0; i < n; i++) {
+        e = RDsM_AllocTrains(volId, firstExtNo, &nearPid, 100, 1, PAGESIZE2, &pids[i]);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* bench_NewPages() */
+
+
+
+/*@================================
+ * bench_AllocPages()
+ *================================*/
+/*
+ * Function: Four bench_AllocPages(Four)
+ *
+ * Description:
+ *  Allocate the pages used by the benchmarks.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_AllocPages(
+    Four        volId)          /* IN volume identifier */
+{
+    return(bench_NewPages(volId, BENCH_NUM_PAGES, pageIds));
+
+} /* bench_AllocPages() */
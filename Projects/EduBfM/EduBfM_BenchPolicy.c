@@ -0,0 +1,478 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchPolicy.c
+ *
+ * Description:
+ *  Benchmarks of the buffer replacement policies: the hit ratios of the
+ *  policies under a mixed workload, how the buffers are allocated on
+ *  misses, and the hit ratio of a hot set under a scan with and without
+ *  an access strategy.
+ *
+ * Exports:
+ *  Four bench_Policy(Four)
+ *  Four bench_Alloc(Four)
+ *  Four bench_Ring(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "EduBfM_BenchModule.h"
+
+
+/*
+ * Definition for the benchmarks of this module
+ */
+/* mixed workload of the policy benchmark */
+#define POLICY_HOT_PAGES        4       /* hot set: B+-tree upper levels, catalog pages */
+#define POLICY_WARM_PAGES       300     /* pages accessed at random */
+#define POLICY_ROUNDS           40
+#define POLICY_POINTS           100     /* point accesses per round */
+#define POLICY_HOT_PERCENT      80      /* percentage of point accesses to the hot set */
+#define POLICY_SCAN_LENGTH      100     /* pages scanned per round */
+
+/* alloc benchmark */
+#define ALLOC_DIRTY_EVERY       4       /* one access in 4 dirties its page in the last phases */
+
+/* ring benchmark */
+#define RING_NUM_BUFS           128     /* buffers of the page pool */
+#define RING_HOT_PAGES          64      /* pages of the point accesses */
+#define RING_ROUNDS             400
+#define RING_POINTS             20      /* point accesses per round */
+#define RING_SCAN_STEP          10      /* pages scanned per round */
+
+
+
+/*@================================
+ * bench_Policy()
+ *================================*/
+/*
+ * Function: Four bench_Policy(Four)
+ *
+ * Description:
+ *  Run a mixed workload under each buffer replacement policy and print
+ *  the hit ratios. Every round does point accesses, mostly to a small
+ *  hot set, followed by a sequential scan of pages that are never
+ *  accessed again soon. A scan-resistant policy keeps the hot set
+ *  in the pool across the scans.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Policy(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        policy;
+    Four        round, i;
+    Four        scanPos;
+    Four        nAccess, nHit, nHotAccess, nHotHit;
+    Boolean     hit;
+    BfMConfig   cfg;
+    PageID      *hotPages = &pageIds[0];
+    PageID      *warmPages = &pageIds[POLICY_HOT_PAGES];
+    PageID      *scanPages = &pageIds[POLICY_HOT_PAGES + POLICY_WARM_PAGES];
+    Four        nScanPages = BENCH_NUM_PAGES - POLICY_HOT_PAGES - POLICY_WARM_PAGES;
+
+    printf("\n[policy] %d buffers, %d hot pages, %d warm pages, %d rounds of %d point accesses + %d-page scan\n",
+           BI_NBUFS(PAGE_BUF), POLICY_HOT_PAGES, POLICY_WARM_PAGES, POLICY_ROUNDS, POLICY_POINTS, POLICY_SCAN_LENGTH);
+    printf("%-10s %10s %10s %10s %12s\n", "policy", "accesses", "hits", "hit ratio", "hot hit ratio");
+
+    for (policy = 0; policy < NUM_BFM_POLICIES; policy++) {
+
+        e = bench_EmptyPool();
+        if (e < eNOERROR) ERR(e);
+
+        e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+        if (e < eNOERROR) ERR(e);
+        cfg.policy = policy;
+        e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+        if (e < eNOERROR) ERR(e);
+
+        seed = 1;
+        scanPos = 0;
+        nAccess = nHit = nHotAccess = nHotHit = 0;
+
+        for (round = 0; round < POLICY_ROUNDS; round++) {
+
+            for (i = 0; i < POLICY_POINTS; i++) {
+                if (bench_Random(100) < POLICY_HOT_PERCENT) {
+                    e = bench_Access(&hotPages[bench_Random(POLICY_HOT_PAGES)], PAGE_BUF, &hit);
+                    nHotAccess++;
+                    nHotHit += hit;
+                }
+                else
+                    e = bench_Access(&warmPages[bench_Random(POLICY_WARM_PAGES)], PAGE_BUF, &hit);
+                if (e < eNOERROR) ERR(e);
+                nAccess++;
+                nHit += hit;
+            }
+
+            for (i = 0; i < POLICY_SCAN_LENGTH; i++) {
+                e = bench_Access(&scanPages[scanPos], PAGE_BUF, &hit);
+                if (e < eNOERROR) ERR(e);
+                scanPos = (scanPos + 1) % nScanPages;
+                nAccess++;
+                nHit += hit;
+            }
+        }
+
+        printf("%-10s %10d %10d %9.2f%% %11.2f%%\n", edubfm_policies[policy]->name, nAccess, nHit,
+               100.0 * nHit / nAccess, 100.0 * nHotHit / nHotAccess);
+    }
+
+    /* restore the default policy */
+    cfg.policy = BFM_POLICY_CLOCK;
+    e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* bench_Policy() */
+
+
+
+/*@================================
+ * bench_PrintAlloc()
+ *================================*/
+/*
+ * Function: Four bench_PrintAlloc(char *, BfMStats *)
+ *
+ * Description:
+ *  Print the allocations done since the statistics 'before' were taken.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_PrintAlloc(
+    char        *phase,         /* IN name of the phase */
+    BfMStats    *before)        /* INOUT statistics at the start of the phase */
+{
+    Four        e;
+    BfMStats    after;
+    UEight      nAllocs;
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+
+    nAllocs = (after.nFreeAllocs - before->nFreeAllocs) + (after.nCleanAllocs - before->nCleanAllocs)
+            + (after.nSweepAllocs - before->nSweepAllocs);
+
+    printf("%-10s %8llu %8llu %8llu %8llu %8llu %12.2f\n", phase, nAllocs,
+           after.nFreeAllocs - before->nFreeAllocs, after.nCleanAllocs - before->nCleanAllocs,
+           after.nSweepAllocs - before->nSweepAllocs, after.nVictimFlushes - before->nVictimFlushes,
+           nAllocs ? (double)(after.nSweepSteps - before->nSweepSteps) / nAllocs : 0.0);
+
+    *before = after;
+
+    return(eNOERROR);
+
+} /* bench_PrintAlloc() */
+
+
+
+/*@================================
+ * bench_Alloc()
+ *================================*/
+/*
+ * Function: Four bench_Alloc(Four)
+ *
+ * Description:
+ *  Count how the buffers are allocated under the default policy in three
+ *  phases: filling the empty pool, scanning pages sequentially, and the
+ *  mixed workload of bench_Policy(). The mixed workload is then run under
+ *  each policy dirtying every ALLOC_DIRTY_EVERY-th page it accesses, which
+ *  shows how often each policy finds a clean victim on the clean list.
+ *  The 'flushes' column is the number of dirty victims written by the
+ *  misses, and the last one the number of buffers visited by the clock
+ *  sweeps per allocation.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Alloc(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        i;
+    Four        policy;
+    Boolean     hit;
+    char        *buf;
+    PageID      *pid;
+    BfMConfig   cfg;
+    BfMStats    stats;
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_GetStats(PAGE_BUF, &stats);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[alloc] %d buffers\n", BE_NBUFS(PAGE_BUF));
+    printf("%-10s %8s %8s %8s %8s %8s %12s\n", "phase", "allocs", "free", "clean", "sweep", "flushes", "steps/alloc");
+
+    for (i = 0; i < BE_NBUFS(PAGE_BUF); i++) {
+        e = bench_Access(&pageIds[i], PAGE_BUF, &hit);
+        if (e < eNOERROR) ERR(e);
+    }
+    e = bench_PrintAlloc("cold", &stats);
+    if (e < eNOERROR) ERR(e);
+
+    for (i = 0; i < BENCH_NUM_PAGES; i++) {
+        e = bench_Access(&pageIds[i], PAGE_BUF, &hit);
+        if (e < eNOERROR) ERR(e);
+    }
+    e = bench_PrintAlloc("scan", &stats);
+    if (e < eNOERROR) ERR(e);
+
+    seed = 1;
+    for (i = 0; i < POLICY_ROUNDS * POLICY_POINTS; i++) {
+        if (bench_Random(100) < POLICY_HOT_PERCENT)
+            e = bench_Access(&pageIds[bench_Random(POLICY_HOT_PAGES)], PAGE_BUF, &hit);
+        else
+            e = bench_Access(&pageIds[POLICY_HOT_PAGES + bench_Random(POLICY_WARM_PAGES)], PAGE_BUF, &hit);
+        if (e < eNOERROR) ERR(e);
+    }
+    e = bench_PrintAlloc("mixed", &stats);
+    if (e < eNOERROR) ERR(e);
+
+    printf("mixed, 1 in %d accesses dirtying:\n", ALLOC_DIRTY_EVERY);
+
+    for (policy = 0; policy < NUM_BFM_POLICIES; policy++) {
+
+        e = bench_EmptyPool();
+        if (e < eNOERROR) ERR(e);
+
+        e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+        if (e < eNOERROR) ERR(e);
+        cfg.policy = policy;
+        e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+        if (e < eNOERROR) ERR(e);
+
+        e = EduBfM_GetStats(PAGE_BUF, &stats);
+        if (e < eNOERROR) ERR(e);
+
+        seed = 1;
+        for (i = 0; i < POLICY_ROUNDS * POLICY_POINTS; i++) {
+            if (bench_Random(100) < POLICY_HOT_PERCENT)
+                pid = &pageIds[bench_Random(POLICY_HOT_PAGES)];
+            else
+                pid = &pageIds[POLICY_HOT_PAGES + bench_Random(POLICY_WARM_PAGES)];
+
+            e = EduBfM_GetTrain(pid, &buf, PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+            if (i % ALLOC_DIRTY_EVERY == 0) {
+                e = EduBfM_SetDirty(pid, PAGE_BUF);
+                if (e < eNOERROR) ERR(e);
+            }
+            e = EduBfM_FreeTrain(pid, PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+        }
+        e = bench_PrintAlloc(edubfm_policies[policy]->name, &stats);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    /* restore the default policy */
+    cfg.policy = BFM_POLICY_CLOCK;
+    e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* bench_Alloc() */
+
+
+
+/*@================================
+ * bench_RingRun()
+ *================================*/
+/*
+ * Function: Four bench_RingRun(Four, Boolean)
+ *
+ * Description:
+ *  Interleave point accesses to a hot set with a sequential scan of the
+ *  other benchmark pages under the given policy, and print the hit ratio
+ *  of the point accesses and the hit ratio of the scan. The scan reads
+ *  through an access strategy if 'ring' is TRUE.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_RingRun(
+    Four        policy,         /* IN BFM_POLICY_xxx */
+    Boolean     ring)           /* IN TRUE to scan with an access strategy */
+{
+    Four        e;
+    Four        round, i;
+    Four        scanPos = 0;
+    Four        nHotHit = 0, nScanHit = 0;
+    Boolean     hit;
+    char        *buf;
+    BfMConfig   cfg;
+    BfMStats    before, after;
+    BfMAccessStrategy *strategy = NULL;
+    PageID      *hotPages = &pageIds[0];
+    PageID      *scanPages = &pageIds[RING_HOT_PAGES];
+    Four        nScanPages = BENCH_NUM_PAGES - RING_HOT_PAGES;
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+    cfg.policy = policy;
+    e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+
+    if (ring) {
+        e = EduBfM_GetAccessStrategy(PAGE_BUF, BFM_MAX_RING_SIZE, &strategy);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    /* warm the hot set up */
+    for (i = 0; i < RING_HOT_PAGES; i++) {
+        e = bench_Access(&hotPages[i], PAGE_BUF, &hit);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    seed = 1;
+    for (round = 0; round < RING_ROUNDS; round++) {
+
+        for (i = 0; i < RING_POINTS; i++) {
+            e = bench_Access(&hotPages[bench_Random(RING_HOT_PAGES)], PAGE_BUF, &hit);
+            if (e < eNOERROR) ERR(e);
+            nHotHit += hit;
+        }
+
+        for (i = 0; i < RING_SCAN_STEP; i++) {
+            nScanHit += (edubfm_LookUp((BfMHashKey *)&scanPages[scanPos], PAGE_BUF) != NOTFOUND_IN_HTABLE);
+            e = EduBfM_GetTrainWithStrategy(&scanPages[scanPos], &buf, PAGE_BUF, strategy);
+            if (e < eNOERROR) ERR(e);
+            e = EduBfM_FreeTrain(&scanPages[scanPos], PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+            scanPos = (scanPos + 1) % nScanPages;
+        }
+    }
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+
+    printf("%-10s %-6s %11.2f%% %11.2f%% %12llu\n", edubfm_policies[policy]->name, ring ? "ring" : "shared",
+           100.0 * nHotHit / (RING_ROUNDS * RING_POINTS), 100.0 * nScanHit / (RING_ROUNDS * RING_SCAN_STEP),
+           after.nRingReuses - before.nRingReuses);
+
+    if (strategy != NULL) {
+        e = EduBfM_FreeAccessStrategy(strategy);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* bench_RingRun() */
+
+
+
+/*@================================
+ * bench_Ring()
+ *================================*/
+/*
+ * Function: Four bench_Ring(Four)
+ *
+ * Description:
+ *  Measure how much of a hot set survives a concurrent full scan on a
+ *  page pool of RING_NUM_BUFS buffers, the hot set taking half of the
+ *  pool. The scan reads the pages through the shared pool or through an
+ *  access strategy recycling a ring of buffers.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Ring(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e = eNOERROR;
+    Four        policy;
+    BenchPool   pool;
+    BfMConfig   cfg;
+
+    e = bench_BigPool(&pool, RING_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[ring] %d buffers, %d hot pages, %d rounds of %d point accesses + %d scanned pages\n",
+           RING_NUM_BUFS, RING_HOT_PAGES, RING_ROUNDS, RING_POINTS, RING_SCAN_STEP);
+    printf("%-10s %-6s %12s %12s %12s\n", "policy", "scan", "hot hit", "scan hit", "ring reuses");
+
+    for (policy = 0; e >= eNOERROR && policy < NUM_BFM_POLICIES; policy++) {
+        e = bench_RingRun(policy, FALSE);
+        if (e >= eNOERROR) e = bench_RingRun(policy, TRUE);
+    }
+
+    /* restore the default policy */
+    if (e >= eNOERROR) e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e >= eNOERROR) {
+        cfg.policy = BFM_POLICY_CLOCK;
+        e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    }
+
+    return(bench_RestorePool(&pool, e));
+
+} /* bench_Ring() */
@@ -0,0 +1,416 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchRead.c
+ *
+ * Description:
+ *  Benchmarks of the reads of the pages: sequential scans with and
+ *  without EduBfM_PrefetchTrains(), and random accesses with buffered
+ *  and with direct I/O.
+ *
+ * Exports:
+ *  Four bench_Prefetch(Four)
+ *  Four bench_Direct(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "EduBfM_BenchModule.h"
+
+
+/*
+ * Definition for the benchmarks of this module
+ */
+/* prefetch benchmark */
+#define PREFETCH_WORK_USEC      20      /* work done on each page while it is fixed */
+
+/* direct benchmark */
+#define DIRECT_NUM_BUFS         1024    /* buffers of the page pool */
+#define DIRECT_PAGES            6144    /* pages accessed at random */
+#define DIRECT_ACCESSES         20000   /* accesses per run */
+#define DIRECT_DIRTY_EVERY      4       /* one in this many accesses updates the page */
+
+
+
+/*@================================
+ * bench_PrefetchRun()
+ *================================*/
+/*
+ * Function: Four bench_PrefetchRun(char *, Four, Four, UFour *)
+ *
+ * Description:
+ *  Scan the pages from a cold buffer pool, prefetching the next 'depth'
+ *  pages every 'depth' pages with the given I/O engine, and print the
+ *  elapsed time. The checksums of the
+ *  pages are stored in 'sums' if 'depth' is 0, and compared with them
+ *  otherwise.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_PrefetchRun(
+    char        *name,          /* IN name of the run */
+    Four        engine,         /* IN BFM_IOENGINE_xxx */
+    Four        depth,          /* IN # of pages read ahead */
+    UFour       *sums)          /* INOUT checksums of the pages */
+{
+    Four        e;
+    Four        i, j, n;
+    Four        nWrong = 0;
+    UFour       sum;
+    char        *buf;
+    double      start, t0, elapsed;
+    BfMStats    before, after;
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+    e = EduBfM_SetIOEngine(engine);
+    if (e < eNOERROR) ERR(e);
+
+    /* read the pages from the disk, not from the page cache */
+    bench_DropCache();
+
+    e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    start = bench_Now();
+    for (i = 0; i < BENCH_NUM_PAGES; i++) {
+        n = (BENCH_NUM_PAGES - i - 1 < depth) ? BENCH_NUM_PAGES - i - 1 : depth;
+        if (n > 0 && i % depth == 0) {
+            e = EduBfM_PrefetchTrains(&pageIds[i + 1], n, PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        e = EduBfM_GetTrain(&pageIds[i], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+
+        for (sum = 0, j = 0; j < PAGESIZE; j++) sum = sum * 31 + (unsigned char)buf[j];
+        if (depth == 0) sums[i] = sum;
+        else if (sums[i] != sum) nWrong++;
+        for (t0 = bench_Now(); bench_Now() - t0 < PREFETCH_WORK_USEC * 1e3; );
+
+        e = EduBfM_FreeTrain(&pageIds[i], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    elapsed = bench_Now() - start;
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+
+    benchWrong += nWrong;
+    printf("%-18s %9.2f %10llu %10llu %10llu %7d\n", name, elapsed / 1e6,
+           after.nPrefetches - before.nPrefetches, after.nPrefetchHits - before.nPrefetchHits,
+           after.nPrefetchWaits - before.nPrefetchWaits, nWrong);
+
+    return(eNOERROR);
+
+} /* bench_PrefetchRun() */
+
+
+
+/*@================================
+ * bench_Prefetch()
+ *================================*/
+/*
+ * Function: Four bench_Prefetch(Four)
+ *
+ * Description:
+ *  Compare a sequential scan reading each page when it is fixed with
+ *  scans reading ahead by EduBfM_PrefetchTrains(). The last column is
+ *  the number of pages whose contents differ from the first scan.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Prefetch(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    static UFour sums[BENCH_NUM_PAGES];
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[prefetch] scan of %d pages with %d buffers, %d usec of work per page\n",
+           BENCH_NUM_PAGES, BE_NBUFS(PAGE_BUF), PREFETCH_WORK_USEC);
+    printf("%-18s %9s %10s %10s %10s %7s\n", "read-ahead", "msec", "prefetches", "hits", "waits", "wrong");
+
+    e = bench_PrefetchRun("none", BFM_IOENGINE_URING, 0, sums);
+    if (e >= eNOERROR) e = bench_PrefetchRun("1 page, io_uring", BFM_IOENGINE_URING, 1, sums);
+    if (e >= eNOERROR) e = bench_PrefetchRun("4 pages, io_uring", BFM_IOENGINE_URING, 4, sums);
+    if (e >= eNOERROR) e = bench_PrefetchRun("1 page, threads", BFM_IOENGINE_THREADS, 1, sums);
+    if (e >= eNOERROR) e = bench_PrefetchRun("4 pages, threads", BFM_IOENGINE_THREADS, 4, sums);
+
+    EduBfM_DetachVolume(volId);
+
+    return(e);
+
+} /* bench_Prefetch() */
+
+
+
+/*@================================
+ * bench_CachedMB()
+ *================================*/
+/*
+ * Function: double bench_CachedMB(void)
+ *
+ * Description:
+ *  Return the MB of the volume held in the page cache (-1 if unknown).
+ */
+static double bench_CachedMB(void)
+{
+    Four        fd;
+    struct stat st;
+    size_t      i, nPages, nCached;
+    long        pageSize = sysconf(_SC_PAGESIZE);
+    void        *map;
+    unsigned char *vec;
+
+    fd = open(BENCH_VOLUME_NAME, O_RDONLY);
+    if (fd < 0) return(-1);
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return(-1);
+    }
+
+    nPages = (st.st_size + pageSize - 1) / pageSize;
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return(-1);
+
+    vec = (unsigned char *)malloc(nPages);
+    if (vec == NULL || mincore(map, st.st_size, vec) != 0) {
+        free(vec);
+        munmap(map, st.st_size);
+        return(-1);
+    }
+
+    for (nCached = 0, i = 0; i < nPages; i++)
+        if (vec[i] & 1) nCached++;
+
+    free(vec);
+    munmap(map, st.st_size);
+
+    return((double)nCached * pageSize / (1 << 20));
+
+} /* bench_CachedMB() */
+
+
+
+/*@================================
+ * bench_DirectRun()
+ *================================*/
+/*
+ * Function: Four bench_DirectRun(char *, PageID *, Four *, Boolean, Boolean)
+ *
+ * Description:
+ *  Do DIRECT_ACCESSES random accesses to the pages with the page pool
+ *  reading and writing by the direct I/O or through the page cache,
+ *  starting from an empty pool and, if asked, an empty page cache. One
+ *  in DIRECT_DIRTY_EVERY accesses stamps the page anew, and every access
+ *  checks the stamp the page was last given. The time includes writing
+ *  out the dirty pages at the end.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_DirectRun(
+    char        *name,          /* IN name of the run */
+    PageID      *pids,          /* IN pages accessed */
+    Four        *stamps,        /* INOUT stamps of the pages */
+    Boolean     directIO,       /* IN TRUE for the direct I/O */
+    Boolean     cold)           /* IN TRUE to empty the page cache first */
+{
+    Four        e;
+    Four        i, n;
+    Four        nMisses, nWrong;
+    char        *buf;
+    double      t0, elapsed, cachedMB, poolMB;
+    BfMConfig   cfg;
+
+    e = bench_EmptyPool();
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+    cfg.directIO = directIO;
+    e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) ERR(e);
+
+    if (cold) bench_DropCache();
+
+    nMisses = nWrong = 0;
+    t0 = bench_Now();
+    for (i = 0; i < DIRECT_ACCESSES; i++) {
+        n = bench_Random(DIRECT_PAGES);
+        if (edubfm_LookUp((BfMHashKey *)&pids[n], PAGE_BUF) == NOTFOUND_IN_HTABLE) nMisses++;
+
+        e = EduBfM_GetTrain(&pids[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+
+        if (memcmp(buf + PAGESIZE - sizeof(Four), &stamps[n], sizeof(Four)) != 0) nWrong++;
+        if (i % DIRECT_DIRTY_EVERY == 0) {
+            stamps[n]++;
+            memcpy(buf + PAGESIZE - sizeof(Four), &stamps[n], sizeof(Four));
+            e = EduBfM_SetDirty(&pids[n], PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+        }
+
+        e = EduBfM_FreeTrain(&pids[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+    e = EduBfM_FlushAll();
+    if (e < eNOERROR) ERR(e);
+    elapsed = bench_Now() - t0;
+
+    cachedMB = bench_CachedMB();
+    poolMB = (double)PAGESIZE * DIRECT_NUM_BUFS / (1 << 20);
+
+    benchWrong += nWrong;
+    printf("%-16s %8d %10.1f %12.1f %8.1f %10.1f %10.1f %7d\n", name, nMisses, elapsed / 1e6,
+           DIRECT_ACCESSES / (elapsed / 1e9) / 1e3, poolMB, cachedMB, poolMB + cachedMB, nWrong);
+
+    return(eNOERROR);
+
+} /* bench_DirectRun() */
+
+
+
+/*@================================
+ * bench_Direct()
+ *================================*/
+/*
+ * Function: Four bench_Direct(Four)
+ *
+ * Description:
+ *  Stamp DIRECT_PAGES pages and access them at random with a page pool
+ *  of DIRECT_NUM_BUFS buffers, through the page cache from a cold and
+ *  then a warm cache, and by the direct I/O. The MB columns are the
+ *  memory held by the pool, by the page cache for the volume after the
+ *  run, and both; the last column is the number of accesses which found
+ *  a wrong stamp.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_Direct(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        i;
+    char        *buf;
+    PageID      *pids;
+    Four        *stamps;
+    BenchPool   pool;
+
+    pids = (PageID *)malloc(sizeof(PageID) * DIRECT_PAGES);
+    stamps = (Four *)malloc(sizeof(Four) * DIRECT_PAGES);
+    if (pids == NULL || stamps == NULL) {
+        free(pids);
+        free(stamps);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    e = bench_NewPages(volId, DIRECT_PAGES, pids);
+    if (e >= eNOERROR) e = bench_BigPool(&pool, DIRECT_NUM_BUFS);
+    if (e < eNOERROR) {
+        free(pids);
+        free(stamps);
+        ERR(e);
+    }
+
+    printf("\n[direct] %d buffers, %d random accesses to %d pages, 1 in %d updating\n",
+           DIRECT_NUM_BUFS, DIRECT_ACCESSES, DIRECT_PAGES, DIRECT_DIRTY_EVERY);
+    printf("%-16s %8s %10s %12s %8s %10s %10s %7s\n", "I/O", "misses", "msec", "k accesses/s",
+           "pool MB", "cache MB", "total MB", "wrong");
+
+    e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    if (e >= eNOERROR) {
+        for (i = 0; e >= eNOERROR && i < DIRECT_PAGES; i++) {
+            stamps[i] = i;
+            e = EduBfM_GetTrain(&pids[i], &buf, PAGE_BUF);
+            if (e < eNOERROR) break;
+            memcpy(buf + PAGESIZE - sizeof(Four), &stamps[i], sizeof(Four));
+            e = EduBfM_SetDirty(&pids[i], PAGE_BUF);
+            if (e >= eNOERROR) e = EduBfM_FreeTrain(&pids[i], PAGE_BUF);
+        }
+
+        seed = 1;
+        if (e >= eNOERROR) e = bench_DirectRun("buffered, cold", pids, stamps, FALSE, TRUE);
+        if (e >= eNOERROR) e = bench_DirectRun("buffered, warm", pids, stamps, FALSE, FALSE);
+        if (e >= eNOERROR) e = bench_DirectRun("direct", pids, stamps, TRUE, TRUE);
+        if (e >= eNOERROR) e = bench_DirectRun("direct, again", pids, stamps, TRUE, FALSE);
+        EduBfM_DetachVolume(volId);
+    }
+
+    e = bench_RestorePool(&pool, e);
+    free(pids);
+    free(stamps);
+
+    return(e);
+
+} /* bench_Direct() */
@@ -0,0 +1,1074 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchThreads.c
+ *
+ * Description:
+ *  Benchmarks of the page pool shared by threads: the throughput of
+ *  fixes from 1 to 64 threads, the statistics after them, resizes of
+ *  the pool under the threads, optimistic reads, and the checks of what
+ *  the threads read while the pool is resized or discarded.
+ *
+ * Exports:
+ *  Four bench_Scale(Four)
+ *  Four bench_Stats(Four)
+ *  Four bench_Resize(Four)
+ *  Four bench_Optimistic(Four)
+ *  Four bench_Check(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "EduBfM_BenchModule.h"
+
+
+/*
+ * Definition for the benchmarks of this module
+ */
+/* scale benchmark */
+#define SCALE_NUM_BUFS          256     /* buffers of the page pool */
+#define SCALE_MAX_THREADS       64
+#define SCALE_HIT_OPS           (1 << 20) /* # of accesses per run, shared by the threads */
+#define SCALE_MISS_OPS          (1 << 16)
+
+/* stats benchmark */
+#define STATS_THREADS           4
+
+/* resize benchmark */
+#define RESIZE_NUM_BUFS         128     /* buffers of the page pool given by the storage system */
+#define RESIZE_PAGES            512     /* pages accessed at random */
+#define RESIZE_ACCESSES         20000   /* accesses per size */
+#define RESIZE_THREADS          4
+#define RESIZE_THREAD_ACCESSES  200000  /* accesses per thread while the pool is resized */
+#define RESIZE_PAUSE_USEC       500     /* pause between the resizes while the threads run */
+#define RESIZE_MAX_BUFS         1024    /* BfMConfig.maxBufs the pool is resized up to first */
+#define RESIZE_BIG_BUFS         200000  /* buffers the pool is grown to beyond BfMConfig.maxBufs */
+
+/* optimistic benchmark */
+#define OPT_PAGES               16      /* pages searched: the inner nodes of a B+-tree */
+#define OPT_KEYS                256     /* keys per page */
+#define OPT_MAX_THREADS         8       /* searching threads */
+#define OPT_SEARCHES            (1 << 20) /* searches per run, shared by the threads */
+
+/* check benchmark */
+#define CHECK_NUM_BUFS          64      /* buffers of the page pool */
+#define CHECK_MAX_BUFS          1024    /* buffers of the pool grown while the pages are read */
+#define CHECK_PAGES             512     /* pages read at random */
+#define CHECK_THREADS           4
+#define CHECK_ROUNDS            200     /* resizes or discards under the readers */
+#define CHECK_ACCESSES          100000  /* fixes per thread of the victim check */
+
+
+/* type definition for a thread of the scale benchmark */
+typedef struct {
+    pthread_t   thread;
+    PageID      *pids;          /* pages accessed at random */
+    Four        nPages;
+    Four        nOps;           /* # of accesses */
+    UFour       seed;           /* seed of the thread's pseudo random numbers */
+    Four        nWrong;         /* # of pages read with a wrong stamp (resize benchmark) */
+    Four        e;              /* error code */
+} ScaleThread;
+
+static Four resizeRunning;               /* # of threads of the resize benchmark running */
+
+
+
+/*@================================
+ * bench_ScaleMain()
+ *================================*/
+/*
+ * Function: void *bench_ScaleMain(void *)
+ *
+ * Description:
+ *  Body of a thread of the scale benchmark: fix, read, and unfix pages
+ *  chosen at random by a private xorshift generator.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *bench_ScaleMain(
+    void        *arg)           /* INOUT ScaleThread */
+{
+    ScaleThread *t = (ScaleThread *)arg;
+    Four        i;
+    PageID      *pid;
+    char        *buf;
+
+    for (i = 0; i < t->nOps; i++) {
+        t->seed ^= t->seed << 13;
+        t->seed ^= t->seed >> 17;
+        t->seed ^= t->seed << 5;
+        pid = &t->pids[t->seed % (UFour)t->nPages];
+
+        t->e = EduBfM_GetTrain(pid, &buf, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+        t->e = EduBfM_FreeTrain(pid, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+    }
+
+    return(NULL);
+
+} /* bench_ScaleMain() */
+
+
+
+/*@================================
+ * bench_ScaleRun()
+ *================================*/
+/*
+ * Function: Four bench_ScaleRun(char *, Four, Four)
+ *
+ * Description:
+ *  Run 'nOps' accesses to the first 'nPages' benchmark pages, shared by
+ *  1, 2, 4, ... SCALE_MAX_THREADS threads, and print the throughput and
+ *  the number of misses of each run. The pages are loaded first so
+ *  that a hot set fitting the pool is never missed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_ScaleRun(
+    char        *name,          /* IN name of the workload */
+    Four        nPages,         /* IN # of pages accessed */
+    Four        nOps)           /* IN # of accesses per run */
+{
+    Four        e;
+    Four        i, nThreads;
+    char        *buf;
+    double      t0, elapsed;
+    BfMStats    before, after;
+    ScaleThread threads[SCALE_MAX_THREADS];
+
+    for (i = 0; i < nPages; i++) {
+        e = EduBfM_GetTrain(&pageIds[i], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        e = EduBfM_FreeTrain(&pageIds[i], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    for (nThreads = 1; nThreads <= SCALE_MAX_THREADS; nThreads *= 2) {
+
+        e = EduBfM_GetStats(PAGE_BUF, &before);
+        if (e < eNOERROR) ERR(e);
+
+        t0 = bench_Now();
+        for (i = 0; i < nThreads; i++) {
+            threads[i].pids = pageIds;
+            threads[i].nPages = nPages;
+            threads[i].nOps = nOps / nThreads;
+            threads[i].seed = 2463534242U + i * 7919;
+            threads[i].e = eNOERROR;
+            if (pthread_create(&threads[i].thread, NULL, bench_ScaleMain, &threads[i]) != 0) break;
+        }
+        nThreads = i < nThreads ? i : nThreads;
+        for (i = 0; i < nThreads; i++) pthread_join(threads[i].thread, NULL);
+        elapsed = bench_Now() - t0;
+
+        for (i = 0; i < nThreads; i++)
+            if (threads[i].e < eNOERROR) ERR(threads[i].e);
+
+        e = EduBfM_GetStats(PAGE_BUF, &after);
+        if (e < eNOERROR) ERR(e);
+
+        printf("%-10s %8d %10.2f %12.0f %10llu\n", name, nThreads, elapsed / 1e6,
+               (double)(nOps / nThreads) * nThreads / (elapsed / 1e9),
+               (after.nFreeAllocs + after.nCleanAllocs + after.nSweepAllocs)
+               - (before.nFreeAllocs + before.nCleanAllocs + before.nSweepAllocs));
+    }
+
+    return(eNOERROR);
+
+} /* bench_ScaleRun() */
+
+
+
+/*@================================
+ * bench_Scale()
+ *================================*/
+/*
+ * Function: Four bench_Scale(Four)
+ *
+ * Description:
+ *  Measure the throughput of EduBfM_GetTrain()/EduBfM_FreeTrain() pairs
+ *  from 1 to SCALE_MAX_THREADS threads on a page pool of SCALE_NUM_BUFS
+ *  buffers: on a hot set of half the pool, where every access is a hit
+ *  pinning the buffer without the pool latch, and on twice as many pages
+ *  as the pool, where the misses are serialized by the pool latch.
+ *  The pool is used by EduBfM alone, so the page table is its only index.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Scale(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    BenchPool   pool;
+    BfMConfig   cfg;
+
+    e = bench_BigPool(&pool, SCALE_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    cfg.shared = FALSE;
+    if (e >= eNOERROR) e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    if (e < eNOERROR) return(bench_RestorePool(&pool, e));
+
+    printf("\n[scale] %d buffers, %ld online CPUs\n", SCALE_NUM_BUFS, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-10s %8s %10s %12s %10s\n", "workload", "threads", "msec", "accesses/s", "misses");
+
+    e = bench_ScaleRun("hit", SCALE_NUM_BUFS / 2, SCALE_HIT_OPS);
+    if (e >= eNOERROR) e = bench_ScaleRun("miss mix", SCALE_NUM_BUFS * 2, SCALE_MISS_OPS);
+
+    return(bench_RestorePool(&pool, e));
+
+} /* bench_Scale() */
+
+
+
+/*@================================
+ * bench_Stats()
+ *================================*/
+/*
+ * Function: Four bench_Stats(Four)
+ *
+ * Description:
+ *  Run the miss mix of the scale benchmark on STATS_THREADS threads and
+ *  print the statistics of the page pool, which the threads counted in
+ *  their own blocks, as text and as JSON.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Stats(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e = eNOERROR;
+    Four        i, nThreads;
+    BenchPool   pool;
+    ScaleThread threads[STATS_THREADS];
+
+    e = bench_BigPool(&pool, SCALE_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[stats] %d buffers, %d threads, %d accesses to %d pages\n",
+           SCALE_NUM_BUFS, STATS_THREADS, SCALE_MISS_OPS, SCALE_NUM_BUFS * 2);
+
+    for (nThreads = 0; nThreads < STATS_THREADS; nThreads++) {
+        threads[nThreads].pids = pageIds;
+        threads[nThreads].nPages = SCALE_NUM_BUFS * 2;
+        threads[nThreads].nOps = SCALE_MISS_OPS / STATS_THREADS;
+        threads[nThreads].seed = 2463534242U + nThreads * 7919;
+        threads[nThreads].e = eNOERROR;
+        if (pthread_create(&threads[nThreads].thread, NULL, bench_ScaleMain, &threads[nThreads]) != 0) break;
+    }
+    for (i = 0; i < nThreads; i++) pthread_join(threads[i].thread, NULL);
+    for (i = 0; e >= eNOERROR && i < nThreads; i++) e = threads[i].e;
+
+    if (e >= eNOERROR) e = EduBfM_PrintStats(PAGE_BUF, BFM_STATS_TEXT, stdout);
+    if (e >= eNOERROR) e = EduBfM_PrintStats(PAGE_BUF, BFM_STATS_JSON, stdout);
+
+    return(bench_RestorePool(&pool, e));
+
+} /* bench_Stats() */
+
+
+
+/*@================================
+ * bench_ResizeMain()
+ *================================*/
+/*
+ * Function: void *bench_ResizeMain(void *)
+ *
+ * Description:
+ *  Body of a thread of the resize benchmark: fix pages chosen at random,
+ *  check their stamps, and unfix them while the pool is resized.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *bench_ResizeMain(
+    void        *arg)           /* INOUT ScaleThread */
+{
+    ScaleThread *t = (ScaleThread *)arg;
+    Four        i, n;
+    char        *buf;
+
+    for (i = 0; i < t->nOps; i++) {
+        t->seed ^= t->seed << 13;
+        t->seed ^= t->seed >> 17;
+        t->seed ^= t->seed << 5;
+        n = t->seed % (UFour)t->nPages;
+
+        t->e = EduBfM_GetTrain(&t->pids[n], &buf, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+        if (memcmp(buf + PAGESIZE - sizeof(Four), &n, sizeof(Four)) != 0) t->nWrong++;
+        t->e = EduBfM_FreeTrain(&t->pids[n], PAGE_BUF);
+        if (t->e < eNOERROR) break;
+    }
+
+    BFM_ATOMIC_ADD(resizeRunning, -1);
+
+    return(NULL);
+
+} /* bench_ResizeMain() */
+
+
+
+/*@================================
+ * bench_ResizeRun()
+ *================================*/
+/*
+ * Function: Four bench_ResizeRun(Four, char *)
+ *
+ * Description:
+ *  Resize the page pool to 'nBufs' buffers, run RESIZE_ACCESSES accesses
+ *  to the pages stamped by bench_Resize(), and print the time of the
+ *  resize, the hit ratio, and the number of pages with wrong stamps.
+ *  The page fixed by bench_Resize() must keep its buffer and contents.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_ResizeRun(
+    Four        nBufs,          /* IN # of buffers */
+    char        *pinned)        /* IN buffer of the page fixed during the benchmark */
+{
+    Four        e;
+    Four        i, n;
+    Four        nWrong;
+    char        *buf;
+    double      t0, elapsed;
+    BfMStats    before, after;
+
+    t0 = bench_Now();
+    e = EduBfM_ResizePool(PAGE_BUF, nBufs);
+    if (e < eNOERROR) ERR(e);
+    elapsed = bench_Now() - t0;
+
+    e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    for (nWrong = 0, i = 0; i < RESIZE_ACCESSES; i++) {
+        n = bench_Random(RESIZE_PAGES);
+
+        e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+        if (memcmp(buf + PAGESIZE - sizeof(Four), &n, sizeof(Four)) != 0) nWrong++;
+        if (n == 0 && buf != pinned) nWrong++;
+        e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+
+    n = 0;
+    if (memcmp(pinned + PAGESIZE - sizeof(Four), &n, sizeof(Four)) != 0) nWrong++;
+
+    benchWrong += nWrong;
+    printf("%8d %12.1f %10.1f%% %7d\n", nBufs, elapsed / 1e3,
+           100.0 * (after.nHits - before.nHits) / (after.nLookups - before.nLookups), nWrong);
+
+    return(eNOERROR);
+
+} /* bench_ResizeRun() */
+
+
+
+/*@================================
+ * bench_Resize()
+ *================================*/
+/*
+ * Function: Four bench_Resize(Four)
+ *
+ * Description:
+ *  Grow and shrink the page pool around the buffers given by the storage
+ *  system while the first page stays fixed, printing the hit ratio of
+ *  random accesses at each size. BfMConfig.maxBufs is RESIZE_MAX_BUFS
+ *  at first, so growing the pool to RESIZE_BIG_BUFS buffers raises it and
+ *  moves the trains beyond the buffer table onto a larger reservation of
+ *  frames. Then resize the pool back and forth while RESIZE_THREADS
+ *  threads access the pages, counting the shrinks refused because a
+ *  buffer to be removed stayed fixed.
+ *  Every page is stamped with its number first, and every access checks
+ *  the stamp.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Resize(
+    Four        volId)          /* IN volume identifier */
+{
+    static Four sizes[] = { RESIZE_NUM_BUFS, 1024, 256, 64, 1024, RESIZE_BIG_BUFS, RESIZE_NUM_BUFS, 0 };
+    Four        e;
+    Four        i, n, nThreads;
+    Four        nResizes, nRefused, nWrong;
+    char        *buf, *pinned;
+    BenchPool   pool;
+    BfMConfig   cfg;
+    ScaleThread threads[RESIZE_THREADS];
+
+    e = bench_BigPool(&pool, RESIZE_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e >= eNOERROR) {
+        cfg.maxBufs = RESIZE_MAX_BUFS;
+        e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    }
+    if (e < eNOERROR) return(bench_RestorePool(&pool, e));
+
+    for (n = 0; e >= eNOERROR && n < RESIZE_PAGES; n++) {
+        e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) break;
+        memcpy(buf + PAGESIZE - sizeof(Four), &n, sizeof(Four));
+        e = EduBfM_SetDirty(&pageIds[n], PAGE_BUF);
+        if (e >= eNOERROR) e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+    }
+    if (e >= eNOERROR) e = bench_EmptyPool();
+    if (e >= eNOERROR) e = EduBfM_GetTrain(&pageIds[0], &pinned, PAGE_BUF);
+    if (e < eNOERROR) return(bench_RestorePool(&pool, e));
+
+    printf("\n[resize] %d buffers given by the storage system, %d accesses to %d pages per size\n",
+           RESIZE_NUM_BUFS, RESIZE_ACCESSES, RESIZE_PAGES);
+    printf("%8s %12s %11s %7s\n", "buffers", "resize usec", "hit", "wrong");
+
+    seed = 1;
+    for (i = 0; e >= eNOERROR && sizes[i] != 0; i++) {
+        e = bench_ResizeRun(sizes[i], pinned);
+    }
+
+    /* resize while the threads access the pages */
+    resizeRunning = 0;
+    for (nThreads = 0; e >= eNOERROR && nThreads < RESIZE_THREADS; nThreads++) {
+        threads[nThreads].pids = pageIds;
+        threads[nThreads].nPages = RESIZE_PAGES;
+        threads[nThreads].nOps = RESIZE_THREAD_ACCESSES;
+        threads[nThreads].seed = 2463534242U + nThreads * 7919;
+        threads[nThreads].nWrong = 0;
+        threads[nThreads].e = eNOERROR;
+        BFM_ATOMIC_ADD(resizeRunning, 1);
+        if (pthread_create(&threads[nThreads].thread, NULL, bench_ResizeMain, &threads[nThreads]) != 0) {
+            BFM_ATOMIC_ADD(resizeRunning, -1);
+            break;
+        }
+    }
+
+    for (nResizes = 0, nRefused = 0; e >= eNOERROR && BFM_ATOMIC_LOAD(resizeRunning) > 0; nResizes++) {
+        e = EduBfM_ResizePool(PAGE_BUF, (nResizes % 2 == 0) ? 1024 : RESIZE_NUM_BUFS);
+        if (e == eRESIZEFIXEDBUF_EDUBFM) {
+            nRefused++;
+            e = eNOERROR;
+        }
+        usleep(RESIZE_PAUSE_USEC);
+    }
+
+    for (i = 0; i < nThreads; i++) pthread_join(threads[i].thread, NULL);
+    for (nWrong = 0, i = 0; i < nThreads; i++) {
+        if (e >= eNOERROR) e = threads[i].e;
+        nWrong += threads[i].nWrong;
+    }
+
+    n = 0;
+    if (memcmp(pinned + PAGESIZE - sizeof(Four), &n, sizeof(Four)) != 0) nWrong++;
+
+    benchWrong += nWrong;
+    if (e >= eNOERROR)
+        printf("%d threads: %d resizes (%d shrinks refused), %d accesses, %d wrong\n",
+               nThreads, nResizes, nRefused, nThreads * RESIZE_THREAD_ACCESSES, nWrong);
+
+    if (e >= eNOERROR) e = EduBfM_FreeTrain(&pageIds[0], PAGE_BUF);
+    if (e >= eNOERROR) e = EduBfM_ResizePool(PAGE_BUF, RESIZE_NUM_BUFS);
+
+    return(bench_RestorePool(&pool, e));
+
+} /* bench_Resize() */
+
+
+
+/* state shared by the threads of the optimistic benchmark */
+static Boolean optOptimistic;   /* TRUE if the pages are read by EduBfM_OptimisticRead() */
+static volatile Boolean optStop; /* TRUE when the updating thread is to stop */
+
+
+
+/*@================================
+ * bench_SearchNode()
+ *================================*/
+/*
+ * Function: Four bench_SearchNode(char *, Four, Boolean *)
+ *
+ * Description:
+ *  Search the OPT_KEYS sorted keys of the page for the last key not
+ *  greater than 'key', as a B+-tree descent does in an inner node, and
+ *  check the keys are consecutive even numbers, which the updates of the
+ *  optimistic benchmark keep.
+ *
+ * Returns:
+ *  position of the key found
+ */
+static Four bench_SearchNode(
+    char        *buf,           /* IN page */
+    Four        key,            /* IN key searched */
+    Boolean     *torn)          /* OUT TRUE if the page is not consistent */
+{
+    volatile Four *keys = (volatile Four *)buf;
+    Four        low = 0, high = OPT_KEYS - 1, mid;
+
+    while (low < high) {
+        mid = (low + high + 1) / 2;
+        if (keys[mid] <= key) low = mid;
+        else high = mid - 1;
+    }
+    *torn = (keys[OPT_KEYS - 1] - keys[0] != 2 * (OPT_KEYS - 1));
+
+    return(low);
+
+} /* bench_SearchNode() */
+
+
+
+/*@================================
+ * bench_OptimisticMain()
+ *================================*/
+/*
+ * Function: void *bench_OptimisticMain(void *)
+ *
+ * Description:
+ *  Body of a searching thread of the optimistic benchmark: search pages
+ *  chosen at random, fixing and latching them in shared mode, or reading
+ *  them optimistically and falling back on the latch if the page is being
+ *  updated. A search finding a torn page is counted in 'nWrong'.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *bench_OptimisticMain(
+    void        *arg)           /* INOUT ScaleThread */
+{
+    ScaleThread *t = (ScaleThread *)arg;
+    Four        i;
+    PageID      *pid;
+    char        *buf;
+    Boolean     torn;
+    BfMReadToken token;
+
+    for (i = 0; i < t->nOps; i++) {
+        t->seed ^= t->seed << 13;
+        t->seed ^= t->seed >> 17;
+        t->seed ^= t->seed << 5;
+        pid = &t->pids[t->seed % (UFour)t->nPages];
+
+        if (optOptimistic) {
+            while ((t->e = EduBfM_OptimisticRead(pid, &buf, &token, PAGE_BUF)) == eNOERROR) {
+                (void) bench_SearchNode(buf, t->seed % (2 * OPT_KEYS), &torn);
+                if (EduBfM_ValidateRead(&token) == eNOERROR) break;
+            }
+            if (t->e == eNOERROR) {
+                if (torn) t->nWrong++;
+                continue;
+            }
+            if (t->e != eNOTFOUND_BFM) break;
+        }
+
+        t->e = EduBfM_GetTrain(pid, &buf, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+        t->e = EduBfM_LatchTrain(pid, BFM_SHARED, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+        (void) bench_SearchNode(buf, t->seed % (2 * OPT_KEYS), &torn);
+        if (torn) t->nWrong++;
+        t->e = EduBfM_UnlatchTrain(pid, PAGE_BUF);
+        if (t->e >= eNOERROR) t->e = EduBfM_FreeTrain(pid, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+    }
+
+    return(NULL);
+
+} /* bench_OptimisticMain() */
+
+
+
+/*@================================
+ * bench_OptimisticUpdate()
+ *================================*/
+/*
+ * Function: void *bench_OptimisticUpdate(void *)
+ *
+ * Description:
+ *  Body of the updating thread of the optimistic benchmark: rewrite all
+ *  the keys of pages chosen at random, latched in exclusive mode, until
+ *  'optStop' is set. The number of updates is left in 'nOps'.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *bench_OptimisticUpdate(
+    void        *arg)           /* INOUT ScaleThread */
+{
+    ScaleThread *t = (ScaleThread *)arg;
+    Four        k;
+    PageID      *pid;
+    Four        *keys;
+
+    for (t->nOps = 0; !optStop; t->nOps++) {
+        t->seed ^= t->seed << 13;
+        t->seed ^= t->seed >> 17;
+        t->seed ^= t->seed << 5;
+        pid = &t->pids[t->seed % (UFour)t->nPages];
+
+        t->e = EduBfM_GetTrain(pid, (char **)&keys, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+        t->e = EduBfM_LatchTrain(pid, BFM_EXCLUSIVE, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+        for (k = 0; k < OPT_KEYS; k++) ((volatile Four *)keys)[k] = (t->nOps % 2) + 2 * k;
+        t->e = EduBfM_UnlatchTrain(pid, PAGE_BUF);
+        if (t->e >= eNOERROR) t->e = EduBfM_FreeTrain(pid, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+        sched_yield();
+    }
+
+    return(NULL);
+
+} /* bench_OptimisticUpdate() */
+
+
+
+/*@================================
+ * bench_OptimisticRun()
+ *================================*/
+/*
+ * Function: Four bench_OptimisticRun(char *, Boolean, Boolean)
+ *
+ * Description:
+ *  Run OPT_SEARCHES searches shared by 1, 2, 4, ... OPT_MAX_THREADS
+ *  threads, with a thread updating the pages if 'update' is TRUE, and
+ *  print the throughput, the optimistic reads which failed validation,
+ *  the updates, and the searches which saw a torn page.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_OptimisticRun(
+    char        *name,          /* IN name of the run */
+    Boolean     optimistic,     /* IN TRUE to read the pages optimistically */
+    Boolean     update)         /* IN TRUE to update the pages meanwhile */
+{
+    Four        i, nThreads, nWrong;
+    double      t0, elapsed;
+    BfMStats    before, after;
+    ScaleThread threads[OPT_MAX_THREADS];
+    ScaleThread updater;
+
+    optOptimistic = optimistic;
+
+    for (nThreads = 1; nThreads <= OPT_MAX_THREADS; nThreads *= 2) {
+
+        (void) EduBfM_GetStats(PAGE_BUF, &before);
+
+        optStop = FALSE;
+        updater.pids = pageIds;
+        updater.nPages = OPT_PAGES;
+        updater.seed = 88172645U;
+        updater.e = eNOERROR;
+        if (update && pthread_create(&updater.thread, NULL, bench_OptimisticUpdate, &updater) != 0) update = FALSE;
+
+        t0 = bench_Now();
+        for (i = 0; i < nThreads; i++) {
+            threads[i].pids = pageIds;
+            threads[i].nPages = OPT_PAGES;
+            threads[i].nOps = OPT_SEARCHES / nThreads;
+            threads[i].seed = 2463534242U + i * 7919;
+            threads[i].nWrong = 0;
+            threads[i].e = eNOERROR;
+            if (pthread_create(&threads[i].thread, NULL, bench_OptimisticMain, &threads[i]) != 0) break;
+        }
+        nThreads = i < nThreads ? i : nThreads;
+        for (i = 0; i < nThreads; i++) pthread_join(threads[i].thread, NULL);
+        elapsed = bench_Now() - t0;
+
+        optStop = TRUE;
+        if (update) pthread_join(updater.thread, NULL);
+
+        for (nWrong = 0, i = 0; i < nThreads; i++) {
+            if (threads[i].e < eNOERROR) ERR(threads[i].e);
+            nWrong += threads[i].nWrong;
+        }
+        if (update && updater.e < eNOERROR) ERR(updater.e);
+
+        (void) EduBfM_GetStats(PAGE_BUF, &after);
+
+        benchWrong += nWrong;
+        printf("%-22s %8d %10.2f %12.0f %10llu %8d %6d\n", name, nThreads, elapsed / 1e6,
+               (double)(OPT_SEARCHES / nThreads) * nThreads / (elapsed / 1e9),
+               after.nOptimisticConflicts - before.nOptimisticConflicts,
+               (update) ? updater.nOps : 0, nWrong);
+    }
+
+    return(eNOERROR);
+
+} /* bench_OptimisticRun() */
+
+
+
+/*@================================
+ * bench_Optimistic()
+ *================================*/
+/*
+ * Function: Four bench_Optimistic(Four)
+ *
+ * Description:
+ *  Lay out OPT_PAGES pages like inner nodes of OPT_KEYS sorted keys and
+ *  search them by threads fixing and latching each page, then by threads
+ *  reading them optimistically, first alone and then against a thread
+ *  updating the pages under the exclusive latch.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Optimistic(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        i, k;
+    Four        *keys;
+    BenchPool   pool;
+
+    e = bench_BigPool(&pool, SCALE_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[optimistic] %d pages of %d keys, %ld online CPUs\n", OPT_PAGES, OPT_KEYS,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-22s %8s %10s %12s %10s %8s %6s\n", "read", "threads", "msec", "searches/s",
+           "conflicts", "updates", "torn");
+
+    for (i = 0; e >= eNOERROR && i < OPT_PAGES; i++) {
+        e = EduBfM_GetTrain(&pageIds[i], (char **)&keys, PAGE_BUF);
+        if (e < eNOERROR) break;
+        for (k = 0; k < OPT_KEYS; k++) keys[k] = 2 * k;
+        e = EduBfM_SetDirty(&pageIds[i], PAGE_BUF);
+        if (e >= eNOERROR) e = EduBfM_FreeTrain(&pageIds[i], PAGE_BUF);
+    }
+
+    if (e >= eNOERROR) e = bench_OptimisticRun("fix and latch", FALSE, FALSE);
+    if (e >= eNOERROR) e = bench_OptimisticRun("optimistic", TRUE, FALSE);
+    if (e >= eNOERROR) e = bench_OptimisticRun("fix and latch, update", FALSE, TRUE);
+    if (e >= eNOERROR) e = bench_OptimisticRun("optimistic, update", TRUE, TRUE);
+
+    return(bench_RestorePool(&pool, e));
+
+} /* bench_Optimistic() */
+
+
+
+/* state shared by the threads of the check benchmark */
+static Boolean checkFix;        /* TRUE if the readers fix the pages not in the pool */
+static volatile Boolean checkStop; /* TRUE when the readers are to stop */
+
+
+
+/*@================================
+ * bench_CheckMain()
+ *================================*/
+/*
+ * Function: void *bench_CheckMain(void *)
+ *
+ * Description:
+ *  Body of a reading thread of the check benchmark: read the stamps of
+ *  pages chosen at random by EduBfM_OptimisticRead() until 'checkStop'
+ *  is set, fixing the page instead if it is not in the pool and
+ *  'checkFix' is TRUE. A validated read or a fix finding a wrong stamp
+ *  is counted in 'nWrong', and the validated reads in 'nOps'.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *bench_CheckMain(
+    void        *arg)           /* INOUT ScaleThread */
+{
+    ScaleThread *t = (ScaleThread *)arg;
+    Four        n, stamp;
+    char        *buf;
+    BfMReadToken token;
+
+    for (t->nOps = 0; !checkStop; ) {
+        t->seed ^= t->seed << 13;
+        t->seed ^= t->seed >> 17;
+        t->seed ^= t->seed << 5;
+        n = t->seed % (UFour)t->nPages;
+
+        t->e = EduBfM_OptimisticRead(&t->pids[n], &buf, &token, PAGE_BUF);
+        if (t->e == eNOERROR) {
+            stamp = *(volatile Four *)(buf + PAGESIZE - sizeof(Four));
+            if (EduBfM_ValidateRead(&token) != eNOERROR) continue;
+            t->nOps++;
+            if (stamp != n) t->nWrong++;
+            continue;
+        }
+        if (t->e != eNOTFOUND_BFM) break;
+        t->e = eNOERROR;
+        if (!checkFix) continue;
+
+        t->e = EduBfM_GetTrain(&t->pids[n], &buf, PAGE_BUF);
+        if (t->e < eNOERROR) break;
+        if (memcmp(buf + PAGESIZE - sizeof(Four), &n, sizeof(Four)) != 0) t->nWrong++;
+        t->e = EduBfM_FreeTrain(&t->pids[n], PAGE_BUF);
+        if (t->e < eNOERROR) break;
+    }
+
+    return(NULL);
+
+} /* bench_CheckMain() */
+
+
+
+/*@================================
+ * bench_CheckOptimistic()
+ *================================*/
+/*
+ * Function: Four bench_CheckOptimistic(char *, Boolean)
+ *
+ * Description:
+ *  Run CHECK_THREADS reading threads while the pool is resized back and
+ *  forth CHECK_ROUNDS times, or emptied by EduBfM_DiscardAll() and
+ *  refilled with pages chosen at random if 'discard' is TRUE. Every read
+ *  which passed EduBfM_ValidateRead() must have seen the stamp of its
+ *  page; print the reads, the wrong ones, and whether the check passed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_CheckOptimistic(
+    char        *name,          /* IN name of the check */
+    Boolean     discard)        /* IN TRUE to discard the pool instead of resizing it */
+{
+    Four        e = eNOERROR;
+    Four        i, k, n, nThreads;
+    Four        nReads, nWrong = 0;
+    char        *buf;
+    ScaleThread threads[CHECK_THREADS];
+
+    /* the pool is emptied under the readers, so only the main thread fixes pages then */
+    checkFix = !discard;
+    checkStop = FALSE;
+    for (nThreads = 0; nThreads < CHECK_THREADS; nThreads++) {
+        threads[nThreads].pids = pageIds;
+        threads[nThreads].nPages = CHECK_PAGES;
+        threads[nThreads].seed = 2463534242U + nThreads * 7919;
+        threads[nThreads].nWrong = 0;
+        threads[nThreads].e = eNOERROR;
+        if (pthread_create(&threads[nThreads].thread, NULL, bench_CheckMain, &threads[nThreads]) != 0) break;
+    }
+
+    for (i = 0; e >= eNOERROR && i < CHECK_ROUNDS; i++) {
+        if (!discard) {
+            e = EduBfM_ResizePool(PAGE_BUF, (i % 2 == 0) ? CHECK_MAX_BUFS : CHECK_NUM_BUFS);
+            if (e == eRESIZEFIXEDBUF_EDUBFM) e = eNOERROR;
+            usleep(RESIZE_PAUSE_USEC);
+            continue;
+        }
+
+        e = EduBfM_DiscardAll();
+        for (k = 0; e >= eNOERROR && k < CHECK_NUM_BUFS; k++) {
+            n = bench_Random(CHECK_PAGES);
+            e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+            if (e < eNOERROR) break;
+            if (memcmp(buf + PAGESIZE - sizeof(Four), &n, sizeof(Four)) != 0) nWrong++;
+            e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+        }
+    }
+
+    checkStop = TRUE;
+    for (i = 0; i < nThreads; i++) pthread_join(threads[i].thread, NULL);
+    for (nReads = 0, i = 0; i < nThreads; i++) {
+        if (e >= eNOERROR) e = threads[i].e;
+        nReads += threads[i].nOps;
+        nWrong += threads[i].nWrong;
+    }
+    if (e >= eNOERROR && !discard) e = EduBfM_ResizePool(PAGE_BUF, CHECK_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    benchWrong += nWrong;
+    printf("%-28s %10d %7d %7s\n", name, nReads, nWrong, (nWrong == 0) ? "PASS" : "FAIL");
+
+    return(eNOERROR);
+
+} /* bench_CheckOptimistic() */
+
+
+
+/*@================================
+ * bench_CheckVictims()
+ *================================*/
+/*
+ * Function: Four bench_CheckVictims(void)
+ *
+ * Description:
+ *  Run CHECK_THREADS threads fixing and unfixing CHECK_ACCESSES pages
+ *  each, chosen at random among more pages than the pool holds, so the
+ *  threads keep claiming victims and unmapping their pages from each
+ *  other. Every fix must see the stamp of its page, and afterwards no
+ *  buffer may be left fixed and every page in the pool must be found by
+ *  the lookup at its own buffer. Print the fixes, the wrong ones, and
+ *  whether the check passed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_CheckVictims(void)
+{
+    Four        e = eNOERROR;
+    Four        i, nThreads;
+    Four        nWrong = 0;
+    ScaleThread threads[CHECK_THREADS];
+
+    resizeRunning = 0;
+    for (nThreads = 0; nThreads < CHECK_THREADS; nThreads++) {
+        threads[nThreads].pids = pageIds;
+        threads[nThreads].nPages = CHECK_PAGES;
+        threads[nThreads].nOps = CHECK_ACCESSES;
+        threads[nThreads].seed = 88172645U + nThreads * 7919;
+        threads[nThreads].nWrong = 0;
+        threads[nThreads].e = eNOERROR;
+        BFM_ATOMIC_ADD(resizeRunning, 1);
+        if (pthread_create(&threads[nThreads].thread, NULL, bench_ResizeMain, &threads[nThreads]) != 0) {
+            BFM_ATOMIC_ADD(resizeRunning, -1);
+            break;
+        }
+    }
+
+    for (i = 0; i < nThreads; i++) pthread_join(threads[i].thread, NULL);
+    for (i = 0; i < nThreads; i++) {
+        if (e >= eNOERROR) e = threads[i].e;
+        nWrong += threads[i].nWrong;
+    }
+    if (e < eNOERROR) ERR(e);
+
+    for (i = 0; i < BI_NBUFS(PAGE_BUF); i++) {
+        if (BI_FIXED(PAGE_BUF, i) != 0) nWrong++;
+        if (!IS_NILBFMHASHKEY(BI_KEY(PAGE_BUF, i)) && edubfm_LookUp(&BI_KEY(PAGE_BUF, i), PAGE_BUF) != i)
+            nWrong++;
+    }
+
+    benchWrong += nWrong;
+    printf("%-28s %10d %7d %7s\n", "victims, fix and unfix", nThreads * CHECK_ACCESSES, nWrong,
+           (nWrong == 0) ? "PASS" : "FAIL");
+
+    return(eNOERROR);
+
+} /* bench_CheckVictims() */
+
+
+
+/*@================================
+ * bench_Check()
+ *================================*/
+/*
+ * Function: Four bench_Check(Four)
+ *
+ * Description:
+ *  Stamp CHECK_PAGES pages with their numbers and check that threads
+ *  reading them see the right stamps while the pool is resized, while it
+ *  is discarded, and while the threads evict each other's pages. A
+ *  wrong stamp makes EduBfM_Bench exit with a nonzero status.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Check(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        n;
+    char        *buf;
+    BenchPool   pool;
+
+    e = bench_BigPool(&pool, CHECK_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[check] %d threads reading %d stamped pages through a pool of %d buffers\n",
+           CHECK_THREADS, CHECK_PAGES, CHECK_NUM_BUFS);
+    printf("%-28s %10s %7s %7s\n", "check", "reads", "wrong", "result");
+
+    for (n = 0; e >= eNOERROR && n < CHECK_PAGES; n++) {
+        e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+        if (e < eNOERROR) break;
+        memcpy(buf + PAGESIZE - sizeof(Four), &n, sizeof(Four));
+        e = EduBfM_SetDirty(&pageIds[n], PAGE_BUF);
+        if (e >= eNOERROR) e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+    }
+    if (e >= eNOERROR) e = bench_EmptyPool();
+
+    seed = 1;
+    if (e >= eNOERROR) e = bench_CheckOptimistic("optimistic read, resize", FALSE);
+    if (e >= eNOERROR) e = bench_CheckOptimistic("optimistic read, discard", TRUE);
+    if (e >= eNOERROR) e = bench_CheckVictims();
+
+    return(bench_RestorePool(&pool, e));
+
+} /* bench_Check() */
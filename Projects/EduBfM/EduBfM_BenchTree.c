@@ -0,0 +1,454 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_BenchTree.c
+ *
+ * Description:
+ *  Benchmarks of descents of a three-level tree of pages: fixes through
+ *  swizzled references, and lookups kept in flight by
+ *  EduBfM_GetTrainAsync().
+ *
+ * Exports:
+ *  Four bench_Swizzle(Four)
+ *  Four bench_Async(Four)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+#include "EduBfM_TestModule.h"
+#include "EduBfM_BenchModule.h"
+
+
+/*
+ * Definition for the benchmarks of this module
+ */
+/* swizzle benchmark */
+#define SWIZ_FANOUT             16      /* children of the root */
+#define SWIZ_LEAVES             64      /* children of an inner node */
+#define SWIZ_PAGES              (1 + SWIZ_FANOUT + SWIZ_FANOUT * SWIZ_LEAVES)
+#define SWIZ_DESCENTS           (1 << 18) /* descents per run */
+
+/* async benchmark */
+#define ASYNC_NUM_BUFS          128     /* buffers of the page pool */
+#define ASYNC_LOOKUPS           20000   /* lookups per run */
+#define ASYNC_MAX_BATCH         32      /* lookups in flight */
+
+
+/* type definition for a lookup of the async benchmark
+ * It is resumed by done() of its request at each node read.
+ */
+typedef struct {
+    BfMAsyncGet get;            /* fix of the node visited */
+    Four        level;          /* level of the node (0: root) */
+    Four        node;           /* node visited, the index of its page in pageIds */
+} BenchLookUp;
+
+static BfMAsyncQueue asyncQueue;        /* requests of the async benchmark */
+static Four asyncLeft;                  /* lookups of the async benchmark not begun */
+static Four asyncWrong;                 /* nodes read with a wrong stamp */
+static Four asyncError;                 /* first error of the lookups */
+
+
+
+/*@================================
+ * bench_SwizzleRun()
+ *================================*/
+/*
+ * Function: Four bench_SwizzleRun(char *, BfMSwizzledRef *)
+ *
+ * Description:
+ *  Do SWIZ_DESCENTS descents from the root of the tree to a random leaf,
+ *  fixing each node through its reference if 'refs' is given and by its
+ *  page identifier otherwise, and print the time of a descent, the hit
+ *  ratio of the pool, and the part of the fixes done through swizzled
+ *  references.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_SwizzleRun(
+    char                *name,          /* IN name of the run */
+    BfMSwizzledRef      *refs)          /* INOUT references to the nodes (NULL if not used) */
+{
+    Four                e;
+    Four                i, level, n;
+    char                *buf;
+    double              t0, elapsed;
+    BfMStats            before, after;
+
+    e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    seed = 1;
+    t0 = bench_Now();
+    for (i = 0; i < SWIZ_DESCENTS; i++) {
+        for (level = 0, n = 0; level < 3; level++) {
+            if (refs != NULL) e = EduBfM_GetTrainSwizzled(&refs[n], &buf, PAGE_BUF);
+            else e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+
+            if (refs != NULL) e = EduBfM_FreeTrainSwizzled(&refs[n], PAGE_BUF);
+            else e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+            if (e < eNOERROR) ERR(e);
+
+            if (level == 0) n = 1 + bench_Random(SWIZ_FANOUT);
+            else if (level == 1) n = 1 + SWIZ_FANOUT + (n - 1) * SWIZ_LEAVES + bench_Random(SWIZ_LEAVES);
+        }
+    }
+    elapsed = bench_Now() - t0;
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+
+    printf("%-12s %10.1f %8.1f %10.1f\n", name, elapsed / SWIZ_DESCENTS,
+           100.0 * (after.nHits - before.nHits) / (after.nLookups - before.nLookups),
+           100.0 * (after.nSwizzledHits - before.nSwizzledHits) / (after.nLookups - before.nLookups));
+
+    return(eNOERROR);
+
+} /* bench_SwizzleRun() */
+
+
+
+/*@================================
+ * bench_Swizzle()
+ *================================*/
+/*
+ * Function: Four bench_Swizzle(Four)
+ *
+ * Description:
+ *  Lay out SWIZ_PAGES pages as a tree of a root, SWIZ_FANOUT inner nodes
+ *  and SWIZ_LEAVES leaves under each inner node, and descend it at random
+ *  fixing the nodes by their page identifiers and then through swizzled
+ *  references, first with a page pool holding the whole tree and then
+ *  with one holding a quarter of the leaves, where references to evicted
+ *  leaves are found stale and swizzled again. The columns give the time
+ *  of a descent in ns, the hit ratio, and the part of the fixes done
+ *  through swizzled references.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four bench_Swizzle(
+    Four                volId)          /* IN volume identifier */
+{
+    Four                e = eNOERROR;
+    Four                i, k;
+    Four                nBufs[] = { 2 * SWIZ_PAGES, SWIZ_FANOUT * SWIZ_LEAVES / 4 };
+    char                *buf;
+    BfMSwizzledRef      *refs;
+    BenchPool           pool;
+
+    refs = (BfMSwizzledRef *)malloc(sizeof(BfMSwizzledRef) * SWIZ_PAGES);
+    if (refs == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    printf("\n[swizzle] %d descents of a tree of %d pages (1 + %d + %d x %d)\n", SWIZ_DESCENTS, SWIZ_PAGES,
+           SWIZ_FANOUT, SWIZ_FANOUT, SWIZ_LEAVES);
+
+    for (k = 0; e >= eNOERROR && k < sizeof(nBufs) / sizeof(nBufs[0]); k++) {
+        e = bench_BigPool(&pool, nBufs[k]);
+        if (e < eNOERROR) break;
+
+        printf("%d buffers\n", nBufs[k]);
+        printf("%-12s %10s %8s %10s\n", "fix", "ns/descent", "hits %", "swizzled %");
+
+        for (i = 0; e >= eNOERROR && i < SWIZ_PAGES; i++) {
+            refs[i].trainId = pageIds[i];
+            refs[i].index = NIL;
+            e = EduBfM_GetTrain(&pageIds[i], &buf, PAGE_BUF);
+            if (e >= eNOERROR) e = EduBfM_FreeTrain(&pageIds[i], PAGE_BUF);
+        }
+
+        if (e >= eNOERROR) e = bench_SwizzleRun("page id", NULL);
+        if (e >= eNOERROR) e = bench_SwizzleRun("swizzled", refs);
+
+        e = bench_RestorePool(&pool, e);
+    }
+
+    free(refs);
+
+    return(e);
+
+} /* bench_Swizzle() */
+
+
+
+/*@================================
+ * bench_AsyncChild()
+ *================================*/
+/*
+ * Function: Four bench_AsyncChild(Four, Four)
+ *
+ * Description:
+ *  Return a random child of the node of the tree of bench_Swizzle() on
+ *  the level, or NIL to begin a new lookup at the root after a leaf.
+ */
+static Four bench_AsyncChild(
+    Four        level,          /* IN level of the node */
+    Four        node)           /* IN node */
+{
+    if (level == 0) return(1 + bench_Random(SWIZ_FANOUT));
+    if (level == 1) return(1 + SWIZ_FANOUT + (node - 1) * SWIZ_LEAVES + bench_Random(SWIZ_LEAVES));
+
+    return(NIL);
+
+} /* bench_AsyncChild() */
+
+
+
+/*@================================
+ * bench_AsyncStep()
+ *================================*/
+/*
+ * Function: void bench_AsyncStep(BfMAsyncGet *)
+ *
+ * Description:
+ *  Resume the lookup whose node has been fixed: check the stamp of the
+ *  node, free it, and go on with a child, or with the root of the next
+ *  lookup after a leaf, until a node has to be read. It is done() of the
+ *  requests, and is what the body of a coroutine suspended at each
+ *  EduBfM_GetTrainAsync() left pending would be.
+ */
+static void bench_AsyncStep(
+    BfMAsyncGet *get)           /* IN request of the lookup */
+{
+    Four        e;
+    BenchLookUp *l = (BenchLookUp *)get->arg;
+
+    for (;;) {
+        if (get->result < eNOERROR) {
+            if (asyncError == eNOERROR) asyncError = get->result;
+            return;
+        }
+
+        if (*(Four *)get->retBuf != l->node) asyncWrong++;
+
+        e = EduBfM_FreeTrain(&get->trainId, PAGE_BUF);
+        if (e < eNOERROR) {
+            asyncError = e;
+            return;
+        }
+
+        l->node = bench_AsyncChild(l->level, l->node);
+        l->level++;
+        if (l->node == NIL) {
+            if (asyncLeft == 0) return;
+            asyncLeft--;
+            l->node = 0;
+            l->level = 0;
+        }
+
+        get->trainId = pageIds[l->node];
+        e = EduBfM_GetTrainAsync(get, &asyncQueue);
+        if (e < eNOERROR) {
+            asyncError = e;
+            return;
+        }
+        if (e == FALSE) return;
+    }
+
+} /* bench_AsyncStep() */
+
+
+
+/*@================================
+ * bench_AsyncRun()
+ *================================*/
+/*
+ * Function: Four bench_AsyncRun(char *, Four, Four)
+ *
+ * Description:
+ *  Do ASYNC_LOOKUPS lookups from the root of the tree to a random leaf
+ *  from an empty page pool, 'batch' of them in flight by
+ *  EduBfM_GetTrainAsync() on the given I/O engine, or one at a time by
+ *  EduBfM_GetTrain() if 'batch' is 0, and print the lookups per second,
+ *  the reads per lookup, and the nodes read with a wrong stamp.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four bench_AsyncRun(
+    char        *name,          /* IN name of the run */
+    Four        engine,         /* IN BFM_IOENGINE_xxx */
+    Four        batch)          /* IN # of lookups in flight (0: one at a time, waiting for each read) */
+{
+    Four        e;
+    Four        i, level, n;
+    char        *buf;
+    double      t0, elapsed;
+    BfMStats    before, after;
+    BenchLookUp lookups[ASYNC_MAX_BATCH];
+
+    e = bench_EmptyPool();
+    if (e >= eNOERROR) e = EduBfM_SetIOEngine(engine);
+    if (e >= eNOERROR) e = EduBfM_GetStats(PAGE_BUF, &before);
+    if (e < eNOERROR) ERR(e);
+
+    seed = 1;
+    asyncWrong = 0;
+    t0 = bench_Now();
+    if (batch == 0) {
+        for (i = 0; i < ASYNC_LOOKUPS; i++)
+            for (level = 0, n = 0; n != NIL; n = bench_AsyncChild(level++, n)) {
+                e = EduBfM_GetTrain(&pageIds[n], &buf, PAGE_BUF);
+                if (e < eNOERROR) ERR(e);
+                if (*(Four *)buf != n) asyncWrong++;
+                e = EduBfM_FreeTrain(&pageIds[n], PAGE_BUF);
+                if (e < eNOERROR) ERR(e);
+            }
+    }
+    else {
+        asyncLeft = ASYNC_LOOKUPS;
+        asyncError = eNOERROR;
+        for (i = 0; i < batch && asyncLeft > 0 && asyncError == eNOERROR; i++) {
+            asyncLeft--;
+            lookups[i].level = 0;
+            lookups[i].node = 0;
+            lookups[i].get.trainId = pageIds[0];
+            lookups[i].get.type = PAGE_BUF;
+            lookups[i].get.done = bench_AsyncStep;
+            lookups[i].get.arg = &lookups[i];
+            e = EduBfM_GetTrainAsync(&lookups[i].get, &asyncQueue);
+            if (e < eNOERROR) ERR(e);
+            if (e == TRUE) bench_AsyncStep(&lookups[i].get);
+        }
+        while (asyncQueue.nPending > 0) {
+            e = EduBfM_PollTrains(&asyncQueue, TRUE);
+            if (e < eNOERROR) ERR(e);
+        }
+        if (asyncError < eNOERROR) ERR(asyncError);
+    }
+    elapsed = bench_Now() - t0;
+
+    e = EduBfM_GetStats(PAGE_BUF, &after);
+    if (e < eNOERROR) ERR(e);
+
+    benchWrong += asyncWrong;
+    printf("%-20s %12.0f %10.2f %10llu %7d\n", name, ASYNC_LOOKUPS / (elapsed / 1e9),
+           (double)(after.nMisses - before.nMisses) / ASYNC_LOOKUPS,
+           after.nAsyncReads - before.nAsyncReads, asyncWrong);
+
+    return(eNOERROR);
+
+} /* bench_AsyncRun() */
+
+
+
+/*@================================
+ * bench_Async()
+ *================================*/
+/*
+ * Function: Four bench_Async(Four)
+ *
+ * Description:
+ *  Stamp the pages of the tree of bench_Swizzle() with their indexes and
+ *  look up random leaves through a page pool of ASYNC_NUM_BUFS buffers,
+ *  which holds a small part of the leaves, reading with the direct I/O.
+ *  The lookups are done one at a time by EduBfM_GetTrain(), and then in
+ *  batches kept in flight by EduBfM_GetTrainAsync() from this thread
+ *  alone, each lookup resumed by EduBfM_PollTrains() when its node is
+ *  read. The columns give the lookups per second, the reads of a lookup,
+ *  the reads started by EduBfM_GetTrainAsync(), and the nodes read with
+ *  a wrong stamp.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four bench_Async(
+    Four        volId)          /* IN volume identifier */
+{
+    Four        e;
+    Four        i;
+    char        *buf;
+    BfMConfig   cfg;
+    BenchPool   pool;
+
+    e = bench_BigPool(&pool, ASYNC_NUM_BUFS);
+    if (e < eNOERROR) ERR(e);
+
+    printf("\n[async] %d lookups of a tree of %d pages (1 + %d + %d x %d), %d buffers, direct I/O\n",
+           ASYNC_LOOKUPS, SWIZ_PAGES, SWIZ_FANOUT, SWIZ_FANOUT, SWIZ_LEAVES, ASYNC_NUM_BUFS);
+    printf("%-20s %12s %10s %10s %7s\n", "lookups in flight", "lookups/s", "reads/lkup", "async rds", "wrong");
+
+    e = EduBfM_GetConfig(PAGE_BUF, &cfg);
+    if (e >= eNOERROR) {
+        cfg.directIO = TRUE;
+        e = EduBfM_SetConfig(PAGE_BUF, &cfg);
+    }
+    if (e >= eNOERROR) e = EduBfM_AttachVolume(volId, BENCH_VOLUME_NAME);
+    if (e >= eNOERROR) {
+        for (i = 0; e >= eNOERROR && i < SWIZ_PAGES; i++) {
+            e = EduBfM_GetTrain(&pageIds[i], &buf, PAGE_BUF);
+            if (e < eNOERROR) break;
+            *(Four *)buf = i;
+            e = EduBfM_SetDirty(&pageIds[i], PAGE_BUF);
+            if (e >= eNOERROR) e = EduBfM_FreeTrain(&pageIds[i], PAGE_BUF);
+        }
+
+        if (e >= eNOERROR) e = bench_AsyncRun("1, GetTrain", BFM_IOENGINE_URING, 0);
+        if (e >= eNOERROR) e = bench_AsyncRun("1, io_uring", BFM_IOENGINE_URING, 1);
+        if (e >= eNOERROR) e = bench_AsyncRun("8, io_uring", BFM_IOENGINE_URING, 8);
+        if (e >= eNOERROR) e = bench_AsyncRun("32, io_uring", BFM_IOENGINE_URING, 32);
+        if (e >= eNOERROR) e = bench_AsyncRun("8, threads", BFM_IOENGINE_THREADS, 8);
+        if (e >= eNOERROR) e = bench_AsyncRun("32, threads", BFM_IOENGINE_THREADS, 32);
+        EduBfM_DetachVolume(volId);
+    }
+
+    return(bench_RestorePool(&pool, e));
+
+} /* bench_Async() */
@@ -0,0 +1,106 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_DetachVolume.c
+ *
+ * Description :
+ *  Detach a volume attached by EduBfM_AttachVolume().
+ *
+ * Exports:
+ *  Four EduBfM_DetachVolume(VolNo)
+ */
+
+
+#include <unistd.h> /* for close */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_DetachVolume()
+ *================================*/
+/*
+ * Function: Four EduBfM_DetachVolume(VolNo)
+ *
+ * Description :
+ *  Close the device of the volume. The background writer is stopped
+ *  while the volume is detached, and the reads started by
+ *  EduBfM_PrefetchTrains() are completed.
+ *
+ * Returns:
+ *  error code
+ *    eNOTATTACHEDVOLUME_EDUBFM - the volume is not attached
+ *    some errors caused by function calls
+ */
+Four EduBfM_DetachVolume(
+    VolNo               volNo)          /* IN volume number */
+{
+    Four                e;              /* error code */
+    BfMDevice           *dev;
+
+
+    dev = edubfm_FindDevice(volNo);
+    if (volNo < 0 || dev == NULL) ERR(eNOTATTACHEDVOLUME_EDUBFM);
+
+    edubfm_StopWriter();
+    edubfm_StopPrefetcher();
+
+    close(dev->fd);
+    if (dev->directFd != NIL) close(dev->directFd);
+    dev->fd = NIL;
+    dev->directFd = NIL;
+    dev->volNo = NIL;
+
+    e = edubfm_StartWriter();
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* EduBfM_DetachVolume() */
@@ -73,6 +73,9 @@
  *  For ODYSSEUS/EduCOSMOS EduBfM, refer to the EduBfM project manual.)
  *
  *  Discard all buffers.
+ *  The cost is that of the trains in the buffer pools: the buffers are
+ *  found in the page tables, and in the hash tables of the pools shared
+ *  with the storage system (see edubfm_EmptyPool()).
  *
  * Returns:
  *  error code
@@ -81,28 +84,31 @@ Four EduBfM_DiscardAll(void)
 {
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four 	e;			/* error */
-    Two 	i;			/* index */
     Four 	type;			/* buffer type */
 
-    // Step 1. Flush all pages : PAGE_BUF
-    type = PAGE_BUF;
-    i = BI_NBUFS(type) - 1;
-    while(i>=0){
-        BI_KEY(type, i).pageNo = NIL;
-        BI_BITS(type, i) = ALL_0;
-        i--;
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
     }
 
-    // Step 2. Flush all trains : LOT_LEAF_BUF
-    type = LOT_LEAF_BUF;
-    i = BI_NBUFS(type) - 1;
-    while(i>=0){
-        BI_KEY(type, i).pageNo = NIL;
-        BI_BITS(type, i) = ALL_0;
-        i--;
+    /* the trains being written by the background writer or read ahead are discarded too */
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        BFM_LATCH(type);
+        edubfm_WaitWriter(type, NIL);
+        edubfm_ReapPrefetches(type, TRUE);
     }
 
-    edubfm_DeleteAll();
+    /* only the buffers holding a train are visited (see edubfm_EmptyPool()) */
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        e = edubfm_EmptyPool(type);
+        if (e < eNOERROR) break;
+    }
+
+    edubfm_ZCacheClear();
+    for (type = 0; type < NUM_BUF_TYPES; type++) edubfm_ExtensionClear(type);
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) BFM_UNLATCH(type);
+    if (e < eNOERROR) ERR(e);
 
     return(eNOERROR);
 
@@ -74,6 +74,10 @@
  *
  *  Flush dirty buffers holding trains.
  *  A dirty buffer is one with the dirty bit set.
+ *  The trains are written in disk order, and those on consecutive pages
+ *  of an attached volume by one vectored write (see edubfm_FlushPool()).
+ *  Then the resident trains are saved to the warm-up file, if one was set
+ *  by EduBfM_SetWarmUpFile().
  *
  * Returns:
  *  error code
@@ -82,29 +86,24 @@ Four EduBfM_FlushAll(void)
 {
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four        e;                      /* error */
-    Two         i;                      /* index */
     Four        type;                   /* buffer type */
 
-    // Step 1. Flush all pages : PAGE_BUF
-    type = PAGE_BUF;
-    i = BI_NBUFS(type) - 1;
-    //printf("MY LETTER PAGE : BI_NBUFS - 1 : %d\n", i);
-    while(i>=0){
-        e = edubfm_FlushTrain( &(BI_KEY(type, i)) , type);
-        if(e<0) ERR(e);
-        i--;
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
     }
 
-    // Step 2. Flush all Trains : LOT_LEAF_BUF
-    type = LOT_LEAF_BUF;
-    i = BI_NBUFS(type) - 1;
-    //printf("MY LETTER TRAIN : BI_NBUFS - 1 : %d\n", i);
-    while(i>=0){
-        edubfm_FlushTrain( &(BI_KEY(type, i)) , type);
-        if(e<0) ERR(e);
-        i--;
+    /* write the dirty trains of each pool in disk order */
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        BFM_LATCH(type);
+        e = edubfm_FlushPool(type);
+        BFM_UNLATCH(type);
+        if (e < eNOERROR) ERR(e);
     }
-    
+
+    e = edubfm_SaveWarmUp();
+    if (e < eNOERROR) ERR(e);
+
     return( eNOERROR );
     
 }  /* EduBfM_FlushAll() */
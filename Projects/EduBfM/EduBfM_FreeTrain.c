@@ -74,6 +74,7 @@
  *
  *  Free(or unfix) a buffer.
  *  This function simply frees a buffer by decrementing the fix count by 1.
+ *  The count is decremented atomically without the pool latch.
  *
  * Returns :
  *  error code
@@ -87,19 +88,31 @@ Four EduBfM_FreeTrain(
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four                index;          /* index on buffer holding the train */
     Four 		e;		/* error code */
+    Two                 fixed;          /* fix count before unfixing */
 
     /*@ check if the parameter is valid. */
     if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);	
 
-    index = edubfm_LookUp(trainId, type);
-    if(index < 0) return(eNOTFOUND_BFM);
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    BFM_TRACE(BFM_TRACE_FREE, trainId, type);
+
+    index = edubfm_Unfix(trainId, type, &fixed);
+    if(index < 0) {
+        /* the train may be in the hash table only */
+        BFM_LATCH(type);
+        if (edubfm_LookUp(trainId, type) >= 0)
+            index = edubfm_Unfix(trainId, type, &fixed);
+        BFM_UNLATCH(type);
+        if (index < 0) return(eNOTFOUND_BFM);
+    }
 
-    if(BI_FIXED(type, index) <= 0){
+    if(fixed <= 0){
         printf("Warning: Fixed counter is less than 0!!!\n");
         PRINT_TRAINID("trainId", trainId);
-        BI_FIXED(type, index) = 0;
-    } else {
-        BI_FIXED(type, index) -= 1;
     }
 
     
@@ -0,0 +1,111 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_FreeTrainSwizzled.c
+ *
+ * Description :
+ *  Free a train fixed through a swizzled reference.
+ *
+ * Exports:
+ *  Four EduBfM_FreeTrainSwizzled(BfMSwizzledRef *, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_FreeTrainSwizzled()
+ *================================*/
+/*
+ * Function: Four EduBfM_FreeTrainSwizzled(BfMSwizzledRef *, Four)
+ *
+ * Description :
+ *  Free the train fixed by EduBfM_GetTrainSwizzled() through the
+ *  reference. Since the train is fixed, its buffer is still the one the
+ *  reference remembers, and the fix count of the buffer is decremented
+ *  without looking the train up.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER_EDUBFM - bad parameter
+ *    eNOTFOUND_BFM - the reference is not swizzled to the train
+ */
+Four EduBfM_FreeTrainSwizzled(
+    BfMSwizzledRef      *ref,           /* IN reference to the train */
+    Four                type)           /* IN buffer type */
+{
+    Two                 fixed;          /* fix count before unfixing */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (ref == NULL) ERR(eBADPARAMETER_EDUBFM);
+
+    if (!IS_POOL_INITIALIZED(type) || ref->index < 0 || ref->index >= BFM_ATOMIC_LOAD(BE_NBUFS(type)) ||
+        !EQUALKEY(&BI_KEY(type, ref->index), (BfMHashKey *)&ref->trainId))
+        return(eNOTFOUND_BFM);
+
+    BFM_TRACE(BFM_TRACE_FREE, &ref->trainId, type);
+
+    fixed = BFM_ATOMIC_LOAD(BI_FIXED(type, ref->index));
+    while (fixed > 0 && !BFM_ATOMIC_CAS(BI_FIXED(type, ref->index), fixed, fixed - 1));
+    if (fixed == 1) edubfm_Unpinned(type);
+
+    if (fixed <= 0) {
+        printf("Warning: Fixed counter is less than 0!!!\n");
+        PRINT_TRAINID("trainId", &ref->trainId);
+    }
+
+    return(eNOERROR);
+
+} /* EduBfM_FreeTrainSwizzled() */
@@ -0,0 +1,135 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_GetAccessStrategy.c
+ *
+ * Description :
+ *  Create an access strategy for a bulk scan.
+ *
+ * Exports:
+ *  Four EduBfM_GetAccessStrategy(Four, Four, BfMAccessStrategy **)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_GetAccessStrategy()
+ *================================*/
+/*
+ * Function: Four EduBfM_GetAccessStrategy(Four, Four, BfMAccessStrategy **)
+ *
+ * Description :
+ *  Create an access strategy recycling a ring of 'ringSize' buffers of
+ *  the buffer pool, to be given to EduBfM_GetTrainWithStrategy() by a
+ *  scan reading many trains once, e.g. a sequential scan of a file or
+ *  the traversal of a B+ tree being dropped. The ring is limited to an
+ *  eighth of the pool (at least one buffer) and BFM_MAX_RING_SIZE, so
+ *  that the scan leaves the rest of the pool to the other accesses.
+ *  The strategy is freed by EduBfM_FreeAccessStrategy().
+ *  The scans of EduOM_NextObject() and EduOM_PrevObject() and the drop
+ *  of a B+ tree by edubtm_FreePages() still fix their pages through the
+ *  buffer manager of the storage system, which has no access strategy,
+ *  so they run under the default replacement of the pool.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER_EDUBFM - bad parameter
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter strategy
+ *     the new access strategy
+ */
+Four EduBfM_GetAccessStrategy(
+    Four                type,           /* IN buffer type */
+    Four                ringSize,       /* IN # of buffers recycled */
+    BfMAccessStrategy   **strategy)     /* OUT access strategy */
+{
+    Four                e;              /* error code */
+    Four                i;
+    BfMAccessStrategy   *s;
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (ringSize <= 0 || strategy == NULL) ERR(eBADPARAMETER_EDUBFM);
+
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    if (ringSize > BE_NBUFS(type) / 8) ringSize = BE_NBUFS(type) / 8;
+    if (ringSize > BFM_MAX_RING_SIZE) ringSize = BFM_MAX_RING_SIZE;
+    if (ringSize < 1) ringSize = 1;
+
+    s = (BfMAccessStrategy *)malloc(sizeof(BfMAccessStrategy) + sizeof(BfMRingSlot) * ringSize);
+    if (s == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    s->type = type;
+    s->size = ringSize;
+    s->current = 0;
+    s->ring = (BfMRingSlot *)(s + 1);
+    for (i = 0; i < ringSize; i++) {
+        s->ring[i].idx = NIL;
+        SET_NILBFMHASHKEY(s->ring[i].key);
+    }
+
+    *strategy = s;
+
+    return(eNOERROR);
+
+} /* EduBfM_GetAccessStrategy() */
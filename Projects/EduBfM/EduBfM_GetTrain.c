@@ -77,11 +77,18 @@
  *  pool, allocate a buffer (a buffer selected as victim may be forced out
  *  by the buffer replacement algorithm), read a disk train into the 
  *  selected buffer train, and return it.
+ *  A hit pins the buffer holding only the latch of its page table
+ *  partition (see edubfm_Fix()); the pool latch is taken for a miss, for
+ *  a train being prefetched, and for the 'access' hook of the buffer
+ *  replacement policy.
+ *  It is EduBfM_GetTrainWithStrategy() with no access strategy.
  *
  * Returns:
  *  error code
  *    eBADBUFFER_BFM - Invalid Buffer
  *    eBADBUFFERTYPE_BFM - Invalid Buffer type
+ *    eBADPAGESIZE_EDUBFM - the pages of the volume are larger than the frames,
+ *                          or the train is not the first page of one
  *    some errors caused by function calls
  *
  * Side effects:
@@ -93,44 +100,6 @@ Four EduBfM_GetTrain(
     char **retBuf,    /* OUT pointer to the returned buffer */
     Four type)        /* IN buffer type */
 {
-    /* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
-    Four e;     /* for error */
-    Four index; /* index of the buffer pool */
-
-    /*@ Check the validity of given parameters */
-    /* Some restrictions may be added         */
-    if (retBuf == NULL) ERR(eBADBUFFER_BFM);
-
-    /* Is the buffer type valid? */
-    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
-    
-    index = edubfm_LookUp(trainId, type);
-    //printf("$$$ LookUp PASS\n");
-    if(index<0){
-        //printf("$$$ CAME TO ALLOC\n");
-        index = edubfm_AllocTrain(type);
-        //printf("$$$ ALLOCTRAIN PASS index: %d\n", index);
-        if(index < 0) ERR(index);
-        e = edubfm_ReadTrain(trainId, BI_BUFFER(type, index), type);
-        //printf("$$$ READTRAIN PASS\n");
-        if(e <0) ERR(e);
-
-        BI_KEY(type, index).volNo = trainId->volNo;
-        BI_KEY(type, index).pageNo = trainId->pageNo;
-        BI_FIXED(type, index) = 1;
-
-        e = edubfm_Insert(trainId, index, type);
-        //printf("$$$ INSERT PASS\n");
-        if(e < 0) ERR(e);
-    } else {
-        BI_FIXED(type, index) += 1;
-    }
-    BI_BITS(type, index) |= REFER;
-    //printf("$$$ SET REFER BIT TO 1 PASS\n");
-    *retBuf = BI_BUFFER(type, index);
-    //printf("$$$ retBuf Setted: %p\n", *retBuf);
-    //printf("BUFFER POSITION : %p\n", BI_BUFFERPOOL(type));
-
-    return (eNOERROR); /* No error */
+    return (EduBfM_GetTrainWithStrategy(trainId, retBuf, type, NULL));
 
 } /* EduBfM_GetTrain() */
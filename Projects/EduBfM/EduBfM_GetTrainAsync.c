@@ -0,0 +1,138 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_GetTrainAsync.c
+ *
+ * Description :
+ *  Fix a train without waiting for its read.
+ *
+ * Exports:
+ *  Four EduBfM_GetTrainAsync(BfMAsyncGet *, BfMAsyncQueue *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_GetTrainAsync()
+ *================================*/
+/*
+ * Function: Four EduBfM_GetTrainAsync(BfMAsyncGet *, BfMAsyncQueue *)
+ *
+ * Description :
+ *  Fix the train of the request like EduBfM_GetTrain() if it is in the
+ *  buffer pool of the request's type. Otherwise start its read and leave
+ *  the request pending on the queue: EduBfM_PollTrains() of the queue
+ *  later sets the request's 'result' and 'retBuf' and calls its 'done'
+ *  (if not NULL). A thread thus keeps the reads of many independent
+ *  requests, such as the probes of a batch of B+-tree lookups, in flight
+ *  at once, up to BFM_MAX_PREFETCHES reads per pool; the requests beyond
+ *  them wait on the queue for a read of the pool to be over.
+ *  From a C++20 coroutine, an awaiter calls it in await_suspend() with the
+ *  coroutine handle as 'arg' and a 'done' resuming the handle, and returns
+ *  whether the request was left pending, so that a hit does not suspend
+ *  the coroutine; the scheduler of the thread calls EduBfM_PollTrains().
+ *  A train fixed by either function is freed by EduBfM_FreeTrain(). A
+ *  train of a volume not attached by EduBfM_AttachVolume() is fixed by
+ *  EduBfM_GetTrain(), waiting for its read.
+ *
+ * Returns:
+ *  TRUE if the train has been fixed, FALSE if the request is pending
+ *  error code
+ *    eBADBUFFERTYPE_BFM - Invalid Buffer type
+ *    eBADPARAMETER_EDUBFM - bad parameter
+ *    eBADPAGESIZE_EDUBFM - the pages of the volume are larger than the frames,
+ *                          or the train is not the first page of one
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter req
+ *     retBuf is the buffer holding the train if it has been fixed
+ *  2) parameter queue
+ *     a pending request is put on the queue
+ */
+Four EduBfM_GetTrainAsync(
+    BfMAsyncGet         *req,           /* INOUT request */
+    BfMAsyncQueue       *queue)         /* INOUT queue of the requests of the calling thread */
+{
+    Four                e;              /* error code */
+
+
+    /*@ check if the parameters are valid. */
+    if (req == NULL || queue == NULL) ERR(eBADPARAMETER_EDUBFM);
+    if (IS_BAD_BUFFERTYPE(req->type)) ERR(eBADBUFFERTYPE_BFM);
+
+    if (!IS_POOL_INITIALIZED(req->type)) {
+        e = edubfm_InitPool(req->type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    req->queue = queue;
+    req->result = eNOERROR;
+    req->next = NULL;
+
+    e = edubfm_StartAsync(req);
+    if (e < eNOERROR) ERR(e);
+
+    if (e == ASYNC_FIXED) return(TRUE);
+
+    queue->nPending++;
+
+    if (e == ASYNC_DEFERRED) {
+        if (queue->deferred == NULL) queue->deferred = req;
+        else queue->lastDeferred->next = req;
+        queue->lastDeferred = req;
+    }
+
+    return(FALSE);
+
+} /* EduBfM_GetTrainAsync() */
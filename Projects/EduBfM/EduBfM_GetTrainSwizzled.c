@@ -0,0 +1,149 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_GetTrainSwizzled.c
+ *
+ * Description :
+ *  Fix a train through a swizzled reference to its buffer.
+ *
+ * Exports:
+ *  Four EduBfM_GetTrainSwizzled(BfMSwizzledRef *, char **, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_GetTrainSwizzled()
+ *================================*/
+/*
+ * Function: Four EduBfM_GetTrainSwizzled(BfMSwizzledRef *, char **, Four)
+ *
+ * Description :
+ *  Fix the train of the reference like EduBfM_GetTrain(), going straight
+ *  to the buffer the reference remembers instead of looking the train up
+ *  in the page table. A caller following the same references over and
+ *  over, such as the child pointers of the upper levels of a B+-tree it
+ *  keeps in memory, thus saves the hashing and the probing of a bucket
+ *  per step.
+ *  A reference is swizzled by the first call: its buffer and the version
+ *  of the buffer are stored in it. The reference is not unswizzled when
+ *  the buffer is given to another train; rather, the next call finds that
+ *  the buffer no longer holds the train at that version, fixes the train
+ *  by EduBfM_GetTrain(), and swizzles the reference again. An exclusive
+ *  latch advances the version of the buffer (see EduBfM_LatchTrain()), so
+ *  a reference to a train updated in the meantime is swizzled again too.
+ *  A reference is initialized with its train and index NIL, and the train
+ *  fixed through it is freed by EduBfM_FreeTrainSwizzled().
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFER_BFM - Invalid Buffer
+ *    eBADBUFFERTYPE_BFM - Invalid Buffer type
+ *    eBADPARAMETER_EDUBFM - bad parameter
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter ref
+ *     swizzled to the buffer holding the train
+ *  2) parameter retBuf
+ *     pointer to the buffer holding the train
+ */
+Four EduBfM_GetTrainSwizzled(
+    BfMSwizzledRef      *ref,           /* INOUT reference to the train */
+    char                **retBuf,       /* OUT pointer to the returned buffer */
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                index;          /* index on buffer holding the train */
+
+
+    /*@ check if the parameters are valid. */
+    if (retBuf == NULL) ERR(eBADBUFFER_BFM);
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (ref == NULL) ERR(eBADPARAMETER_EDUBFM);
+
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    if (ref->index != NIL) {
+        index = edubfm_FixAt((BfMHashKey *)&ref->trainId, ref->index, ref->version, type);
+        if (index >= 0) {
+            BFM_TRACE(BFM_TRACE_GET, &ref->trainId, type);
+            BFM_COUNT(type, nLookups);
+            BFM_COUNT(type, nHits);
+            BFM_COUNT(type, nSwizzledHits);
+            if (BE_POLICY(type)->access != NULL) {
+                BFM_LATCH(type);
+                BE_POLICY(type)->access(type, index);
+                BFM_UNLATCH(type);
+            }
+            edubfm_Referred(type, index);
+            *retBuf = BI_BUFFER(type, index);
+
+            return(eNOERROR);
+        }
+    }
+
+    /*@ the reference is not swizzled or is stale */
+    e = EduBfM_GetTrain(&ref->trainId, retBuf, type);
+    if (e < eNOERROR) ERR(e);
+
+    /* the train is fixed, so its buffer and version cannot change but by an exclusive latch */
+    ref->index = edubfm_FastLookUp((BfMHashKey *)&ref->trainId, type);
+    ref->version = BFM_ATOMIC_LOAD(BE_VERSION(type, ref->index));
+
+    return(eNOERROR);
+
+} /* EduBfM_GetTrainSwizzled() */
@@ -0,0 +1,273 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_GetTrainWithStrategy.c
+ *
+ * Description : 
+ *  Return a buffer which has the disk content indicated by `trainId',
+ *  following the access strategy of a bulk scan if one is given.
+ *
+ * Exports:
+ *  Four EduBfM_GetTrainWithStrategy(TrainID *, char **, Four, BfMAccessStrategy *)
+ */
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_GetTrainWithStrategy()
+ *================================*/
+/*
+ * Function: EduBfM_GetTrainWithStrategy(TrainID*, char**, Four, BfMAccessStrategy*)
+ *
+ * Description : 
+ *  Return a buffer which has the disk content indicated by `trainId'.
+ *  Before the allocation of a buffer, look up the train in the buffer
+ *  pool using hashing mechanism.   If the train already  exist in the pool
+ *  then simply return it and set the reference bit of the correponding
+ *  buffer table entry.   Otherwise, i.e. the train does not exist in the
+ *  pool, allocate a buffer (a buffer selected as victim may be forced out
+ *  by the buffer replacement algorithm), read a disk train into the 
+ *  selected buffer train, and return it.
+ *  A hit pins the buffer holding only the latch of its page table
+ *  partition (see edubfm_Fix()); the pool latch is taken for a miss, for
+ *  a train being read, and for the 'access' hook of the buffer
+ *  replacement policy.
+ *  A miss publishes the buffer, fixed and IO_READING, in the page table
+ *  and reads the train from the volume after releasing the pool latch,
+ *  so that the hits and the other misses do not wait for the read; a
+ *  fix of the same train waits for it (see edubfm_WaitPrefetch()). The
+ *  latch is also released over the write-back of a dirty victim (see
+ *  edubfm_AllocTrain()), after which the train is looked up again.
+ *  If an access strategy is given (see EduBfM_GetAccessStrategy()), a miss
+ *  recycles the buffer on the current slot of its ring, and the trains
+ *  on the ring are not marked referenced (see edubfm_Strategy.c).
+ *  Under a memory budget (see EduBfM_SetMemoryBudget()), a miss without
+ *  a strategy is reported to edubfm_BalanceMiss(), and every so many such
+ *  misses the pools are balanced after the pool latch is released.
+ *  A train of a volume of larger pages (see EduBfM_SetPageSize()) is read
+ *  only into a pool whose frames are large enough (BfMConfig.pageSize).
+ *  EduBfM_GetTrain() is EduBfM_GetTrainWithStrategy() with no strategy.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFER_BFM - Invalid Buffer
+ *    eBADBUFFERTYPE_BFM - Invalid Buffer type
+ *    eBADPARAMETER_EDUBFM - the strategy is for another buffer type
+ *    eBADPAGESIZE_EDUBFM - the pages of the volume are larger than the frames,
+ *                          or the train is not the first page of one
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter retBuf
+ *     pointer to buffer holding the disk train indicated by `trainId'
+ */
+Four EduBfM_GetTrainWithStrategy(
+    TrainID *trainId, /* IN train to be used */
+    char **retBuf,    /* OUT pointer to the returned buffer */
+    Four type,        /* IN buffer type */
+    BfMAccessStrategy *strategy) /* INOUT access strategy (NULL if none) */
+{
+    Four e;     /* for error */
+    Four index; /* index of the buffer pool */
+    Four victim = NIL; /* buffer allocated to the train */
+    Boolean reading; /* TRUE if the train is read from the volume */
+    UEight start; /* time of the call (0 if its latency is not measured) */
+    Boolean balance = FALSE; /* TRUE if the memory budget is to be balanced */
+
+    /*@ Check the validity of given parameters */
+    /* Some restrictions may be added         */
+    if (retBuf == NULL) ERR(eBADBUFFER_BFM);
+
+    /* Is the buffer type valid? */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (strategy != NULL && strategy->type != type) ERR(eBADPARAMETER_EDUBFM);
+
+    /* Build the EduBfM-private information at the first use of the pool */
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    BFM_TRACE(BFM_TRACE_GET, trainId, type);
+
+    start = edubfm_SampleStart();
+    BFM_COUNT(type, nLookups);
+
+    if (BFM_ATOMIC_LOAD(BE_NPREFETCHES(type)) > 0) {
+        BFM_LATCH(type);
+        edubfm_ReapPrefetches(type, FALSE);
+        BFM_UNLATCH(type);
+    }
+
+    index = edubfm_Fix(trainId, type);
+    if (index >= 0) {
+        if (!edubfm_RingHit(strategy, index)) {
+            if (BE_POLICY(type)->access != NULL) {
+                BFM_LATCH(type);
+                BE_POLICY(type)->access(type, index);
+                BFM_UNLATCH(type);
+            }
+            edubfm_Referred(type, index);
+        }
+        *retBuf = BI_BUFFER(type, index);
+
+        BFM_COUNT(type, nHits);
+        if (start != 0) BFM_COUNT_VALUE(type, getTrainNs, edubfm_Now() - start);
+
+        return (eNOERROR);
+    }
+
+    BFM_LATCH(type);
+
+    edubfm_ReapPrefetches(type, FALSE);
+
+    for (;;) {
+        index = edubfm_LookUp(trainId, type);
+        if (index >= 0 && BE_IOSTATE(type, index) == IO_READING) {
+            /* wait for the read started by EduBfM_PrefetchTrains() or by a miss, which may fail */
+            edubfm_WaitPrefetch(type, index);
+            continue;
+        }
+        if (victim != NIL) {
+            if (index < 0) break;
+            /* the train was read in while the latch was released over the write-back of the victim */
+            BE_POLICY(type)->release(type, victim);
+            edubfm_PushFreeBuf(type, victim);
+            victim = NIL;
+        }
+        if (index >= 0) break;
+
+        e = edubfm_CheckTrain(type, trainId);
+        if (e < eNOERROR) ERR_UNLATCH(e, type);
+        BFM_COUNT(type, nMisses);
+        if (strategy == NULL) balance = edubfm_BalanceMiss(type, (BfMHashKey *)trainId);
+        BE_POLICY(type)->miss(type, (BfMHashKey *)trainId);
+        victim = edubfm_RingAlloc(strategy);
+        if(victim == NIL) victim = edubfm_AllocTrain(type);
+        if(victim < 0) ERR_UNLATCH(victim, type);
+    }
+
+    if(index<0){
+        index = victim;
+
+        /* an optimistic read finding the key before the train is written fails */
+        BFM_ATOMIC_ADD(BE_VERSION(type, index), 2);
+        BI_KEY(type, index).volNo = trainId->volNo;
+        BI_KEY(type, index).pageNo = trainId->pageNo;
+        BFM_ATOMIC_STORE(BI_FIXED(type, index), 1);
+
+        /* a train taken out of the compressed cache or the extension file is there already */
+        reading = !edubfm_ReadCached(trainId, BI_BUFFER(type, index), type);
+        if (reading) {
+            BFM_ATOMIC_STORE(BE_IOSTATE(type, index), IO_READING);
+            BE_NIOS(type)++;
+        }
+
+        e = edubfm_Insert(trainId, index, type);
+        if(e < 0) {
+            /* give the frame back as if the read had failed */
+            if (reading) {
+                BFM_ATOMIC_STORE(BE_IOSTATE(type, index), IO_NONE);
+                BE_NIOS(type)--;
+            }
+            SET_NILBFMHASHKEY(BI_KEY(type, index));
+            BFM_ATOMIC_STORE(BI_FIXED(type, index), 0);
+            BE_POLICY(type)->release(type, index);
+            edubfm_PushFreeBuf(type, index);
+            ERR_UNLATCH(e, type);
+        }
+
+        if (strategy != NULL) edubfm_RingAdd(strategy, index);
+        else edubfm_Referred(type, index);
+
+        /* after the REFER bit is set, which CLOCK-Pro does not count for a load */
+        BE_POLICY(type)->admit(type, index);
+
+        if (reading) {
+            /* only the fix of the buffer keeps it while the train is read */
+            BFM_UNLATCH(type);
+            e = edubfm_ReadVolume(trainId, BI_BUFFER(type, index), type);
+            if (e >= eNOERROR) BFM_ATOMIC_STORE(BE_IOSTATE(type, index), IO_NONE);
+            BFM_LATCH(type);
+
+            if (e < eNOERROR) {
+                /* delete the mapping while edubfm_Fix() still ignores the buffer */
+                BE_POLICY(type)->release(type, index);
+                edubfm_Delete(&BI_KEY(type, index), type);
+                SET_NILBFMHASHKEY(BI_KEY(type, index));
+                BI_BITS(type, index) = ALL_0;
+                BFM_ATOMIC_STORE(BE_IOSTATE(type, index), IO_NONE);
+                BFM_ATOMIC_STORE(BI_FIXED(type, index), 0);
+                edubfm_PushFreeBuf(type, index);
+            }
+            BE_NIOS(type)--;
+            pthread_cond_broadcast(&BE_WRITEDONE(type));
+            if (e < eNOERROR) ERR_UNLATCH(e, type);
+        }
+    } else {
+        BFM_COUNT(type, nHits);
+        BFM_ATOMIC_ADD(BI_FIXED(type, index), 1);
+        if (!edubfm_RingHit(strategy, index)) {
+            if (BE_POLICY(type)->access != NULL) BE_POLICY(type)->access(type, index);
+            edubfm_Referred(type, index);
+        }
+    }
+    *retBuf = BI_BUFFER(type, index);
+
+    BFM_UNLATCH(type);
+    if (balance) edubfm_Balance();
+
+    if (start != 0) BFM_COUNT_VALUE(type, getTrainNs, edubfm_Now() - start);
+
+    return (eNOERROR); /* No error */
+
+} /* EduBfM_GetTrainWithStrategy() */
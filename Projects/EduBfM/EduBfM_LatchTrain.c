@@ -0,0 +1,129 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_LatchTrain.c
+ *
+ * Description :
+ *  Latch the contents of a buffer in shared or exclusive mode.
+ *
+ * Exports:
+ *  Four EduBfM_LatchTrain(TrainID *, Four, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_LatchTrain()
+ *================================*/
+/*
+ * Function: Four EduBfM_LatchTrain(TrainID *, Four, Four)
+ *
+ * Description :
+ *  Acquire the content latch of the buffer holding the train in the given
+ *  mode (BFM_SHARED or BFM_EXCLUSIVE). The train must have been fixed by
+ *  EduBfM_GetTrain(), and the latch is released by EduBfM_UnlatchTrain()
+ *  before the train is freed. The fix only keeps the train in the buffer;
+ *  the threads reading the buffer hold the latch in shared mode, and the
+ *  thread updating it holds the latch in exclusive mode. The waits for a
+ *  latch held by another thread are counted in the statistics.
+ *  The version of the buffer is odd while the latch is held in exclusive
+ *  mode, so the readers not latching the buffer see the update (see
+ *  EduBfM_OptimisticRead()).
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER_EDUBFM - bad mode
+ *    eNOTFOUND_BFM - the train is not in the buffer pool
+ */
+Four EduBfM_LatchTrain(
+    TrainID             *trainId,       /* IN train to be latched */
+    Four                mode,           /* IN BFM_SHARED or BFM_EXCLUSIVE */
+    Four                type)           /* IN buffer type */
+{
+    Four                index;          /* index on buffer holding the train */
+
+
+    /*@ check if the parameter is valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (mode != BFM_SHARED && mode != BFM_EXCLUSIVE) ERR(eBADPARAMETER_EDUBFM);
+
+    if (!IS_POOL_INITIALIZED(type)) return(eNOTFOUND_BFM);
+
+    index = edubfm_FastLookUp(trainId, type);
+    if (index < 0) {
+        BFM_LATCH(type);
+        index = edubfm_LookUp(trainId, type);
+        BFM_UNLATCH(type);
+        if (index < 0) return(eNOTFOUND_BFM);
+    }
+
+    if (mode == BFM_SHARED) {
+        if (pthread_rwlock_tryrdlock(&BE_CONTENTLATCH(type, index)) != 0) {
+            BFM_COUNT(type, nContentWaits);
+            pthread_rwlock_rdlock(&BE_CONTENTLATCH(type, index));
+        }
+    }
+    else {
+        if (pthread_rwlock_trywrlock(&BE_CONTENTLATCH(type, index)) != 0) {
+            BFM_COUNT(type, nContentWaits);
+            pthread_rwlock_wrlock(&BE_CONTENTLATCH(type, index));
+        }
+
+        /* the optimistic reads fail until the latch is released */
+        BFM_ATOMIC_ADD(BE_VERSION(type, index), 1);
+    }
+
+    return(eNOERROR);
+
+} /* EduBfM_LatchTrain() */
@@ -0,0 +1,145 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_OptimisticRead.c
+ *
+ * Description :
+ *  Begin to read a train in the buffer pool without fixing or latching it.
+ *
+ * Exports:
+ *  Four EduBfM_OptimisticRead(TrainID *, char **, BfMReadToken *, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_OptimisticRead()
+ *================================*/
+/*
+ * Function: Four EduBfM_OptimisticRead(TrainID *, char **, BfMReadToken *, Four)
+ *
+ * Description :
+ *  Give the buffer holding the train to read it optimistically: the train
+ *  is neither fixed nor latched, so that the readers of a popular train,
+ *  such as an inner node of a B+-tree, never write a cache line shared
+ *  with each other. The caller reads or copies what it needs from the
+ *  buffer and then calls EduBfM_ValidateRead() with the token; if the
+ *  buffer got another train or was updated in the meantime, whatever was
+ *  read is thrown away and the read is begun again.
+ *  The lookup in the page table takes no latch either, and what it finds
+ *  is checked against the buffer table and the version of the buffer,
+ *  which EduBfM advances whenever the buffer gets another train and keeps
+ *  odd while the train is latched in exclusive mode. Thus the threads
+ *  updating a train read optimistically must latch it in exclusive mode
+ *  (see EduBfM_LatchTrain()). The reader must not follow a pointer read
+ *  from the buffer, nor trust any value read, before the read is
+ *  validated.
+ *  If the train is not in the buffer pool, is still being read, or is
+ *  being updated, eNOTFOUND_BFM is returned and the caller fixes the
+ *  train by EduBfM_GetTrain() instead.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER_EDUBFM - bad parameter
+ *    eNOTFOUND_BFM - the train cannot be read optimistically
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter retBuf
+ *     pointer to the buffer holding the train
+ *  2) parameter token
+ *     what EduBfM_ValidateRead() checks
+ */
+Four EduBfM_OptimisticRead(
+    TrainID             *trainId,       /* IN train to be read */
+    char                **retBuf,       /* OUT pointer to the buffer holding the train */
+    BfMReadToken        *token,         /* OUT token of the read */
+    Four                type)           /* IN buffer type */
+{
+    Four                index;          /* index on buffer holding the train */
+    UFour               version;        /* version of the buffer */
+    One                 state;          /* I/O state of the buffer */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (retBuf == NULL || token == NULL) ERR(eBADPARAMETER_EDUBFM);
+    CHECKKEY((BfMHashKey *)trainId);
+
+    if (!IS_POOL_INITIALIZED(type)) return(eNOTFOUND_BFM);
+
+    index = edubfm_PageTableProbe(&BE_PAGETABLE(type), (BfMHashKey *)trainId);
+    if (index < 0 || index >= BFM_ATOMIC_LOAD(BE_NBUFS(type))) return(eNOTFOUND_BFM);
+
+    version = BFM_ATOMIC_LOAD(BE_VERSION(type, index));
+    if (version & 1) return(eNOTFOUND_BFM);
+
+    state = BFM_ATOMIC_LOAD(BE_IOSTATE(type, index));
+    if (state == IO_READING || state == IO_MOVING) return(eNOTFOUND_BFM);
+    if (!EQUALKEY(&BI_KEY(type, index), (BfMHashKey *)trainId)) return(eNOTFOUND_BFM);
+
+    /* the key read belongs to the version */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (BFM_ATOMIC_LOAD(BE_VERSION(type, index)) != version) return(eNOTFOUND_BFM);
+
+    token->type = type;
+    token->index = index;
+    token->version = version;
+    *retBuf = BI_BUFFER(type, index);
+
+    BFM_COUNT(type, nOptimisticReads);
+
+    return(eNOERROR);
+
+} /* EduBfM_OptimisticRead() */
@@ -0,0 +1,151 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_PollTrains.c
+ *
+ * Description :
+ *  Complete the pending requests of EduBfM_GetTrainAsync().
+ *
+ * Exports:
+ *  Four EduBfM_PollTrains(BfMAsyncQueue *, Boolean)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_PollTrains()
+ *================================*/
+/*
+ * Function: Four EduBfM_PollTrains(BfMAsyncQueue *, Boolean)
+ *
+ * Description :
+ *  Complete the reads of the buffer pools which are over, start the
+ *  reads of the requests of the queue waiting for a read to be over, and
+ *  call 'done' of every request of the queue which has been completed:
+ *  its 'result' is eNOERROR and its train fixed in 'retBuf', or 'result'
+ *  is the error of its read. If 'wait' is TRUE and no request has been
+ *  completed, wait for one unless none is pending.
+ *  'done' is called with no latch held, so it may issue further requests
+ *  on the queue; those are completed by a later call.
+ *
+ * Returns:
+ *  the number of requests completed
+ *  error code
+ *    eBADPARAMETER_EDUBFM - bad parameter
+ */
+Four EduBfM_PollTrains(
+    BfMAsyncQueue       *queue,         /* INOUT queue of the requests of the calling thread */
+    Boolean             wait)           /* IN TRUE to wait for a request if none is completed */
+{
+    Four                e;              /* error code */
+    Four                type;
+    Four                n;              /* # of requests completed */
+    UEight              epoch;          /* # of reads over before the pools were reaped */
+    BfMAsyncGet         *req;
+    BfMAsyncGet         *next;
+    BfMAsyncGet         *ready = NULL;  /* requests completed */
+
+
+    /*@ check if the parameters are valid. */
+    if (queue == NULL) ERR(eBADPARAMETER_EDUBFM);
+
+    for (;;) {
+        epoch = edubfm_PrefetchEpoch();
+
+        for (type = 0; type < NUM_BUF_TYPES; type++)
+            if (IS_POOL_INITIALIZED(type) && BFM_ATOMIC_LOAD(BE_NPREFETCHES(type)) > 0) {
+                BFM_LATCH(type);
+                edubfm_ReapPrefetches(type, FALSE);
+                BFM_UNLATCH(type);
+            }
+
+        /* start the deferred requests again, in order */
+        req = queue->deferred;
+        queue->deferred = queue->lastDeferred = NULL;
+        for ( ; req != NULL; req = next) {
+            next = req->next;
+            req->next = NULL;
+
+            e = edubfm_StartAsync(req);
+            if (e == ASYNC_DEFERRED) {
+                if (queue->deferred == NULL) queue->deferred = req;
+                else queue->lastDeferred->next = req;
+                queue->lastDeferred = req;
+            }
+            else if (e != ASYNC_PENDING) {
+                req->result = (e < eNOERROR) ? e : eNOERROR;
+                req->next = ready;
+                ready = req;
+            }
+        }
+
+        req = edubfm_TakeCompleted(queue, epoch, wait && ready == NULL && queue->nPending > 0);
+        for ( ; req != NULL; req = next) {
+            next = req->next;
+            req->next = ready;
+            ready = req;
+        }
+
+        if (ready != NULL || !wait || queue->nPending == 0) break;
+    }
+
+    for (n = 0; ready != NULL; n++) {
+        req = ready;
+        ready = req->next;
+        queue->nPending--;
+        if (req->done != NULL) req->done(req);
+    }
+
+    return(n);
+
+} /* EduBfM_PollTrains() */
@@ -0,0 +1,132 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_PrefetchTrains.c
+ *
+ * Description :
+ *  Start reading trains into the buffer pool ahead of their use.
+ *
+ * Exports:
+ *  Four EduBfM_PrefetchTrains(TrainID *, Four, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_PrefetchTrains()
+ *================================*/
+/*
+ * Function: Four EduBfM_PrefetchTrains(TrainID *, Four, Four)
+ *
+ * Description :
+ *  Start the reads of the trains which are not in the buffer pool
+ *  specified by 'type', without waiting for them. A later
+ *  EduBfM_GetTrain() of such a train waits only for its own read if it
+ *  is still in flight.
+ *  Prefetching is a hint: the trains on volumes not attached by
+ *  EduBfM_AttachVolume() and those of pages larger than the frames of the
+ *  pool or not aligned to them (see EduBfM_SetPageSize()) are skipped, and
+ *  the trains are not prefetched beyond BFM_MAX_PREFETCHES reads in
+ *  flight or half of the pool.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER_EDUBFM - bad parameter
+ *    some errors caused by function calls
+ */
+Four EduBfM_PrefetchTrains(
+    TrainID             *trainIds,      /* IN trains to be read */
+    Four                nTrains,        /* IN # of trains */
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                i;
+    Four                index;          /* index of the buffer pool */
+    Four                maxPrefetches;
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (trainIds == NULL || nTrains < 0) ERR(eBADPARAMETER_EDUBFM);
+
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    maxPrefetches = BE_MAXPREFETCHES(type);
+
+    BFM_LATCH(type);
+
+    edubfm_ReapPrefetches(type, FALSE);
+
+    for (i = 0; i < nTrains && BE_NPREFETCHES(type) < maxPrefetches; i++) {
+
+        if (edubfm_FindDevice(trainIds[i].volNo) == NULL) continue;
+        if (edubfm_CheckTrain(type, &trainIds[i]) < eNOERROR) continue;
+        if (edubfm_LookUp((BfMHashKey *)&trainIds[i], type) != NOTFOUND_IN_HTABLE) continue;
+
+        index = edubfm_StartRead(&trainIds[i], type);
+        if (index == eNOUNFIXEDBUF_BFM) break;
+        if (index == NIL) continue;
+        if (index < 0) ERR_UNLATCH(index, type);
+
+        BFM_COUNT(type, nPrefetches);
+    }
+
+    BFM_UNLATCH(type);
+
+    return(eNOERROR);
+
+} /* EduBfM_PrefetchTrains() */
@@ -0,0 +1,170 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_PrintStats.c
+ *
+ * Description :
+ *  Print the statistics of a buffer pool as text or JSON.
+ *
+ * Exports:
+ *  Four EduBfM_PrintStats(Four, Four, FILE *)
+ */
+
+
+#include <stddef.h> /* for offsetof */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* names of the buffer types */
+static char *buffertypes[NUM_BUF_TYPES] = { "PAGE_BUF", "LOT_LEAF_BUF" };
+
+/* name and offset of a field of BfMStats */
+#define MEMBER(field)   { #field, offsetof(BfMStats, field) }
+
+/* counters of BfMStats */
+static struct {
+    char        *name;
+    size_t      offset;
+} counters[] = {
+    MEMBER(nLookups), MEMBER(nHits), MEMBER(nMisses), MEMBER(nEvictions),
+    MEMBER(nFreeAllocs), MEMBER(nCleanAllocs), MEMBER(nSweepAllocs), MEMBER(nSweepSteps),
+    MEMBER(nVictimFlushes), MEMBER(nWriterFlushes), MEMBER(nAvoidedFlushes),
+    MEMBER(nPrefetches), MEMBER(nPrefetchHits), MEMBER(nPrefetchWaits),
+    MEMBER(nRingReuses), MEMBER(nLatchWaits), MEMBER(nContentWaits), MEMBER(nGhostHits),
+    MEMBER(nCompressedStores), MEMBER(nCompressedHits), MEMBER(nExtensionWrites), MEMBER(nExtensionHits),
+    MEMBER(nOptimisticReads), MEMBER(nOptimisticConflicts), MEMBER(nSwizzledHits),
+    MEMBER(nAsyncReads)
+};
+#define NUM_COUNTERS    (sizeof(counters) / sizeof(counters[0]))
+
+/* histograms of BfMStats */
+static struct {
+    char        *name;
+    size_t      offset;
+} hists[] = {
+    MEMBER(sweepLengths), MEMBER(getTrainNs), MEMBER(readNs), MEMBER(writeNs)
+};
+#define NUM_HISTS       (sizeof(hists) / sizeof(hists[0]))
+
+#define FIELD(stats, offset)    ((UEight *)((char *)(stats) + (offset)))
+
+
+
+/*@================================
+ * EduBfM_PrintStats()
+ *================================*/
+/*
+ * Function: Four EduBfM_PrintStats(Four, Four, FILE *)
+ *
+ * Description :
+ *  Print the statistics of the buffer pool specified by 'type' (see
+ *  EduBfM_GetStats()) to 'fp' in the given format. BFM_STATS_TEXT prints a
+ *  line per counter and a line per nonempty bucket of the histograms.
+ *  BFM_STATS_JSON prints a JSON object on a line, with a member per
+ *  counter and an array of BFM_NUM_HIST_BUCKETS counts per histogram.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER_EDUBFM - bad format or file
+ *    some errors caused by function calls
+ */
+Four EduBfM_PrintStats(
+    Four                type,           /* IN buffer type */
+    Four                format,         /* IN BFM_STATS_TEXT or BFM_STATS_JSON */
+    FILE                *fp)            /* IN file printed to */
+{
+    Four                e;              /* error code */
+    BfMStats            stats;
+    UEight              *hist;
+    Four                i, b;
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (format != BFM_STATS_TEXT && format != BFM_STATS_JSON) ERR(eBADPARAMETER_EDUBFM);
+    if (fp == NULL) ERR(eBADPARAMETER_EDUBFM);
+
+    e = EduBfM_GetStats(type, &stats);
+    if (e < eNOERROR) ERR(e);
+
+    if (format == BFM_STATS_TEXT) {
+        fprintf(fp, "%s\n", buffertypes[type]);
+        for (i = 0; i < NUM_COUNTERS; i++)
+            fprintf(fp, "  %-20s %llu\n", counters[i].name, *FIELD(&stats, counters[i].offset));
+        for (i = 0; i < NUM_HISTS; i++) {
+            hist = FIELD(&stats, hists[i].offset);
+            fprintf(fp, "  %s\n", hists[i].name);
+            for (b = 0; b < BFM_NUM_HIST_BUCKETS; b++) {
+                if (hist[b] == 0) continue;
+                if (b == BFM_NUM_HIST_BUCKETS - 1)
+                    fprintf(fp, "    [%llu, inf) %llu\n", 1ULL << b, hist[b]);
+                else
+                    fprintf(fp, "    [%llu, %llu) %llu\n", (b == 0) ? 0ULL : 1ULL << b, 1ULL << (b + 1), hist[b]);
+            }
+        }
+    }
+    else {
+        fprintf(fp, "{\"type\": \"%s\"", buffertypes[type]);
+        for (i = 0; i < NUM_COUNTERS; i++)
+            fprintf(fp, ", \"%s\": %llu", counters[i].name, *FIELD(&stats, counters[i].offset));
+        for (i = 0; i < NUM_HISTS; i++) {
+            hist = FIELD(&stats, hists[i].offset);
+            fprintf(fp, ", \"%s\": [", hists[i].name);
+            for (b = 0; b < BFM_NUM_HIST_BUCKETS; b++)
+                fprintf(fp, "%s%llu", (b == 0) ? "" : ", ", hist[b]);
+            fprintf(fp, "]");
+        }
+        fprintf(fp, "}\n");
+    }
+
+    return(eNOERROR);
+
+} /* EduBfM_PrintStats() */
@@ -0,0 +1,154 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_ResizePool.c
+ *
+ * Description :
+ *  Change the number of buffers of a buffer pool while it is used.
+ *
+ * Exports:
+ *  Four EduBfM_ResizePool(Four, Four)
+ */
+
+
+#include <time.h> /* for clock_gettime */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* milliseconds a resize waits in all for the buffers to be removed to be unpinned */
+#define RESIZE_WAIT_MSEC        1000
+
+
+/*@================================
+ * EduBfM_ResizePool()
+ *================================*/
+/*
+ * Function: Four EduBfM_ResizePool(Four, Four)
+ *
+ * Description :
+ *  Make the buffer pool specified by 'type' have 'nBufs' buffers, e.g. to
+ *  move memory between PAGE_BUF and LOT_LEAF_BUF without restarting.
+ *  A pool grows by adding empty buffers, and shrinks by evicting the
+ *  trains in the buffers removed from its end, writing the dirty ones.
+ *  The buffers keep their addresses, so the trains fixed by other threads
+ *  stay valid during the resize. Since other threads fix buffers only for
+ *  a while, a shrink over a fixed buffer waits until a buffer of the pool
+ *  is unpinned and is tried again, keeping the buffers emptied so far;
+ *  it is given up if the buffers are not all unpinned within
+ *  RESIZE_WAIT_MSEC milliseconds.
+ *  The buffer replacement policy starts over from the trains in the pool,
+ *  as it does when the configuration is changed.
+ *  A pool may have up to BFM_MAX_POOL_BUFS buffers. If it is grown beyond
+ *  BfMConfig.maxBufs, maxBufs is raised to 'nBufs' (see
+ *  EduBfM_SetConfig()), which may move the frames beyond the buffer table
+ *  of the storage system; the growth then waits for them to be unpinned
+ *  as a shrink does. The information of the added buffers is allocated
+ *  as they are needed.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER_EDUBFM - bad number of buffers
+ *    eRESIZEFIXEDBUF_EDUBFM - a buffer to be removed or moved stays fixed
+ *    some errors caused by function calls
+ */
+Four EduBfM_ResizePool(
+    Four                type,           /* IN buffer type */
+    Four                nBufs)          /* IN new # of buffers */
+{
+    Four                e = eNOERROR;   /* error code */
+    UFour               seen;           /* BE_NUNPINS(type) before a try */
+    struct timespec     deadline;       /* time the resize is given up at */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (nBufs < 1 || nBufs > BFM_MAX_POOL_BUFS) ERR(eBADPARAMETER_EDUBFM);
+
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += RESIZE_WAIT_MSEC / 1000;
+    deadline.tv_nsec += (long)(RESIZE_WAIT_MSEC % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+    /* counted before the buffers are looked at, so that no unpin is missed */
+    BFM_ATOMIC_ADD(BE_NUNPINWAITS(type), 1);
+
+    for (;;) {
+        seen = BFM_ATOMIC_LOAD(BE_NUNPINS(type));
+        e = eNOERROR;
+
+        BFM_LATCH(type);
+        if (nBufs > BE_MAXBUFS(type))
+            e = edubfm_ReserveFrames(type, nBufs);
+        if (e >= eNOERROR && nBufs > BE_NBUFS(type))
+            e = edubfm_GrowPool(type, nBufs);
+        else if (e >= eNOERROR && nBufs < BE_NBUFS(type))
+            e = edubfm_ShrinkPool(type, nBufs);
+        BFM_UNLATCH(type);
+
+        if (e == eREMAPFIXEDBUF_EDUBFM) e = eRESIZEFIXEDBUF_EDUBFM;
+        if (e != eRESIZEFIXEDBUF_EDUBFM || !edubfm_WaitUnpinned(type, seen, &deadline)) break;
+    }
+
+    BFM_ATOMIC_ADD(BE_NUNPINWAITS(type), -1);
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* EduBfM_ResizePool() */
@@ -0,0 +1,100 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetCompressedCache.c
+ *
+ * Description :
+ *  Keep the trains evicted from the buffer pools compressed in memory.
+ *
+ * Exports:
+ *  Four EduBfM_SetCompressedCache(Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetCompressedCache()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetCompressedCache(Four)
+ *
+ * Description :
+ *  Give 'nPages' pages of memory to a cache of the trains evicted from
+ *  the buffer pools, kept compressed so that the memory holds several
+ *  times as many trains; a miss finds the train there before reading the
+ *  disk. The cache takes less of its memory while few misses find their
+ *  trains in it (see edubfm_ZCache.c). The trains kept are dropped. If
+ *  'nPages' is 0, the cache is removed.
+ *  The trains must be changed through EduBfM only, as the cache keeps the
+ *  images the buffer pools evicted.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_EDUBFM - bad size
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetCompressedCache(
+    Four                nPages)         /* IN # of pages of memory of the cache (0: none) */
+{
+    Four                e;              /* error code */
+
+
+    /*@ check if the parameter is valid. */
+    if (nPages < 0) ERR(eBADPARAMETER_EDUBFM);
+
+    e = edubfm_SetZCache(nPages);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* EduBfM_SetCompressedCache() */
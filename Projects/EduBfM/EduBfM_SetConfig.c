@@ -0,0 +1,215 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetConfig.c
+ *
+ * Description :
+ *  Set the configuration parameters of a buffer pool.
+ *
+ * Exports:
+ *  Four EduBfM_SetConfig(Four, BfMConfig *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetConfig()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetConfig(Four, BfMConfig *)
+ *
+ * Description :
+ *  Set the configuration parameters of the buffer pool specified by 'type'.
+ *  If the buffer replacement policy is changed, the state of the old
+ *  policy is discarded and the new policy starts from the trains
+ *  currently in the buffer pool.
+ *  The current configuration can be obtained by EduBfM_GetConfig() and
+ *  modified before calling this function.
+ *  If dirtyHigh is not 0, the background writer writes the dirty buffers
+ *  of the pool on the attached volumes (see EduBfM_AttachVolume()) while
+ *  more than dirtyHigh percent of the buffers are dirty, until dirtyLow
+ *  percent are.
+ *  If hugePages or numaNodes is changed, the frames of the pool are moved
+ *  onto the pages asked for, spread over that many NUMA nodes at most
+ *  (see edubfm_Frames.c); no buffer of the pool may be fixed then.
+ *  If directIO is TRUE, the pool reads and writes the trains of the
+ *  attached volumes with the direct I/O, bypassing the page cache of the
+ *  OS (see edubfm_Device.c); the frames of the pool are moved onto aligned
+ *  memory the first time, and no buffer of the pool may be fixed then.
+ *  If pageSize is changed, the frames of the pool are made large enough
+ *  for the trains of the volumes of pages up to that size (see
+ *  EduBfM_SetPageSize()); the trains in the pool are written and evicted,
+ *  and no buffer of the pool may be fixed then.
+ *  If shared is TRUE (the default), the buffer manager of the storage
+ *  system may fix the buffers of the pool in the buffer table of
+ *  bufInfo[] too, chaining the trains it loads on the hash table and
+ *  setting their dirty bits without EduBfM, so EduBfM_FlushAll() and
+ *  EduBfM_DiscardAll() look at those buffers themselves. A pool used by
+ *  EduBfM alone may set it to FALSE, so that the page table is its only
+ *  index (see edubfm_SetShared()) and those functions only visit the
+ *  trains in the page table and the dirty buffers on the dirty map.
+ *  maxBufs is the number of buffers the pool is made ready to be resized
+ *  to, at least the buffers it has and at most BFM_MAX_POOL_BUFS; it is
+ *  raised by EduBfM_ResizePool() when the pool grows beyond it. The
+ *  information of the buffers is allocated as the pool grows, but the
+ *  frames beyond the buffer table of the storage system are reserved for
+ *  maxBufs buffers, so if it is raised after the pool has grown beyond the
+ *  buffer table, the frames there are moved onto a larger reservation and
+ *  none of them may be fixed then.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eBADPARAMETER_EDUBFM - bad configuration parameter
+ *    eBADPAGESIZE_EDUBFM - bad page size
+ *    eREMAPFIXEDBUF_EDUBFM - a buffer is fixed while the frames are moved
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetConfig(
+    Four                type,           /* IN buffer type */
+    BfMConfig           *cfg)           /* IN configuration parameters */
+{
+    Four                e;              /* error code */
+
+
+    /*@ check if the parameters are valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+    if (cfg == NULL) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->policy < 0 || cfg->policy >= NUM_BFM_POLICIES) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->lruK < 1 || cfg->lruK > BFM_MAX_LRUK) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->dirtyHigh < 0 || cfg->dirtyHigh > 100) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->dirtyLow < 0 || cfg->dirtyLow > cfg->dirtyHigh) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->flushDepth < 0) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->hugePages < 0 || cfg->hugePages >= NUM_BFM_PAGES) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->numaNodes < 0 || cfg->numaNodes > BFM_MAX_NUMA_NODES) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->directIO != FALSE && cfg->directIO != TRUE) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->shared != FALSE && cfg->shared != TRUE) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->maxBufs < 1 || cfg->maxBufs > BFM_MAX_POOL_BUFS) ERR(eBADPARAMETER_EDUBFM);
+    if (cfg->pageSize < PAGESIZE || cfg->pageSize > BFM_MAX_PAGESIZE || (cfg->pageSize & (cfg->pageSize - 1)) != 0)
+        ERR(eBADPAGESIZE_EDUBFM);
+
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    /* the background writer is restarted with the new watermarks */
+    edubfm_StopWriter();
+
+    if (cfg->maxBufs != BE_MAXBUFS(type)) {
+        BFM_LATCH(type);
+        e = edubfm_ReserveFrames(type, cfg->maxBufs);
+        BFM_UNLATCH(type);
+        if (e < eNOERROR) {
+            (void) edubfm_StartWriter();
+            ERR(e);
+        }
+    }
+
+    if (cfg->hugePages != BE_CFG(type).hugePages || cfg->numaNodes != BE_CFG(type).numaNodes) {
+        BFM_LATCH(type);
+        e = edubfm_RemapFrames(type, cfg->hugePages, cfg->numaNodes);
+        BFM_UNLATCH(type);
+        if (e < eNOERROR) {
+            (void) edubfm_StartWriter();
+            ERR(e);
+        }
+    }
+
+    if (cfg->pageSize != BE_CFG(type).pageSize) {
+        BFM_LATCH(type);
+        e = edubfm_ResizeFrames(type, BE_BASEBUFSIZE(type) * (cfg->pageSize / PAGESIZE));
+        BFM_UNLATCH(type);
+        if (e < eNOERROR) {
+            (void) edubfm_StartWriter();
+            ERR(e);
+        }
+    }
+
+    if (cfg->directIO && !BE_CFG(type).directIO) {
+        BFM_LATCH(type);
+        e = edubfm_AlignFrames(type);
+        BFM_UNLATCH(type);
+        if (e < eNOERROR) {
+            (void) edubfm_StartWriter();
+            ERR(e);
+        }
+    }
+
+    if (cfg->shared != BE_CFG(type).shared) {
+        BFM_LATCH(type);
+        e = edubfm_SetShared(type, cfg->shared);
+        BFM_UNLATCH(type);
+        if (e < eNOERROR) {
+            (void) edubfm_StartWriter();
+            ERR(e);
+        }
+    }
+
+    /* rebuild the policy state with the new parameters */
+    BE_POLICY(type)->final(type);
+    BE_POLICY(type) = NULL;
+
+    BE_CFG(type) = *cfg;
+    BE_CFG(type).numaNodes = BE_NUMANODES(type);
+
+    e = edubfm_policies[BE_CFG(type).policy]->init(type);
+    if (e < eNOERROR) ERR(e);
+    BE_POLICY(type) = edubfm_policies[BE_CFG(type).policy];
+
+    e = edubfm_StartWriter();
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* EduBfM_SetConfig() */
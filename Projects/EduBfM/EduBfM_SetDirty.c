@@ -87,12 +87,29 @@ Four EduBfM_SetDirty(
 {
     /* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four index; /* an index of the buffer table & pool */
+    Four e;     /* for error */
 
     /*@ Is the paramter valid? */
     if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
-    index = edubfm_LookUp(trainId, type);
-    if (index < 0) return (eNOTFOUND_BFM);
-    BI_BITS(type, index) = BI_BITS(type, index)|DIRTY;
+
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    BFM_TRACE(BFM_TRACE_DIRTY, trainId, type);
+
+    /* the train is fixed by the caller, so that its buffer stays mapped */
+    index = edubfm_FastLookUp(trainId, type);
+    if (index < 0) {
+        BFM_LATCH(type);
+        index = edubfm_LookUp(trainId, type);
+        BFM_UNLATCH(type);
+        if (index < 0) return (eNOTFOUND_BFM);
+    }
+
+    if (edubfm_MarkDirty(type, index)) edubfm_KickWriter(type);
+
     return (eNOERROR);
 
 } /* EduBfM_SetDirty */
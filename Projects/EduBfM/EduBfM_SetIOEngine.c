@@ -0,0 +1,107 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetIOEngine.c
+ *
+ * Description :
+ *  Select the I/O engine used on the attached volumes.
+ *
+ * Exports:
+ *  Four EduBfM_SetIOEngine(Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetIOEngine()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetIOEngine(Four)
+ *
+ * Description :
+ *  Select the I/O engine (BFM_IOENGINE_xxx) reading and writing the trains
+ *  on the volumes attached by EduBfM_AttachVolume(): the reads of
+ *  EduBfM_PrefetchTrains(), the writes of the background writer, and the
+ *  writes of EduBfM_FlushAll(). By default io_uring is used, or the thread
+ *  pool where io_uring is not available. The background writer is
+ *  stopped and the reads in flight are completed while the engine is
+ *  replaced.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_EDUBFM - bad engine
+ *    eNOTSUPPORTED_EDUBFM - the engine is not available
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetIOEngine(
+    Four                engine)         /* IN BFM_IOENGINE_xxx */
+{
+    Four                e;              /* error code */
+    Four                eStart;
+
+
+    /*@ check if the parameter is valid. */
+    if (engine < 0 || engine >= NUM_BFM_IOENGINES) ERR(eBADPARAMETER_EDUBFM);
+
+    edubfm_StopWriter();
+    edubfm_StopPrefetcher();
+
+    e = edubfm_SelectIOEngine(engine);
+
+    eStart = edubfm_StartWriter();
+    if (e < eNOERROR) ERR(e);
+    if (eStart < eNOERROR) ERR(eStart);
+
+    return(eNOERROR);
+
+} /* EduBfM_SetIOEngine() */
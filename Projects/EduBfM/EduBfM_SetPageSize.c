@@ -0,0 +1,138 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_SetPageSize.c
+ *
+ * Description :
+ *  Set the page size of a volume.
+ *
+ * Exports:
+ *  Four EduBfM_SetPageSize(VolNo, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_SetPageSize()
+ *================================*/
+/*
+ * Function: Four EduBfM_SetPageSize(VolNo, Four)
+ *
+ * Description :
+ *  Make the pages of the volume 'pageSize' bytes large, a power of 2
+ *  from PAGESIZE up to BFM_MAX_PAGESIZE, e.g. larger pages for a volume
+ *  of tables scanned as a whole or of indexes on wide keys. A page of the
+ *  volume is a train of pageSize / PAGESIZE consecutive pages of the
+ *  storage system, identified by the first of them (see edubfm_PageSize.c).
+ *  The storage system allocates trains of one page or of TRAINSIZE pages
+ *  only, so the caller allocates the pages of such a volume itself, as
+ *  runs of pageSize / PAGESIZE consecutive pages each starting at a page
+ *  number that is a multiple of pageSize / PAGESIZE; a train not aligned
+ *  so is refused by EduBfM_GetTrain() with eBADPAGESIZE_EDUBFM.
+ *  The trains of the volume are read into the buffer pools whose frames
+ *  are that large (BfMConfig.pageSize), so that a pool of large frames
+ *  may hold the pages of volumes of different page sizes.
+ *  No train of the volume may be in the buffer pools then. The compressed
+ *  cache and the extension files are emptied, since they may hold images
+ *  of trains of the former size.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_EDUBFM - bad parameter, too many volumes of larger
+ *                           pages, or a train of the volume is buffered
+ *    eBADPAGESIZE_EDUBFM - bad page size
+ *    some errors caused by function calls
+ */
+Four EduBfM_SetPageSize(
+    VolNo               volNo,          /* IN volume number */
+    Four                pageSize)       /* IN page size in bytes */
+{
+    Four                e = eNOERROR;   /* error code */
+    Four                type;           /* buffer type */
+    Four                i;
+
+
+    /*@ check if the parameters are valid. */
+    if (volNo < 0) ERR(eBADPARAMETER_EDUBFM);
+    if (pageSize < PAGESIZE || pageSize > BFM_MAX_PAGESIZE || (pageSize & (pageSize - 1)) != 0)
+        ERR(eBADPAGESIZE_EDUBFM);
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) BFM_LATCH(type);
+
+    /* the trains being read ahead are in the pools too */
+    for (type = 0; e >= eNOERROR && type < NUM_BUF_TYPES; type++) {
+        edubfm_ReapPrefetches(type, TRUE);
+        for (i = 0; i < BE_NBUFS(type); i++)
+            if (!IS_NILBFMHASHKEY(BI_KEY(type, i)) && BI_KEY(type, i).volNo == volNo) {
+                e = eBADPARAMETER_EDUBFM;
+                break;
+            }
+    }
+
+    if (e >= eNOERROR) e = edubfm_SetPageSize(volNo, pageSize / PAGESIZE);
+    if (e >= eNOERROR) {
+        edubfm_ZCacheClear();
+        for (type = 0; type < NUM_BUF_TYPES; type++) edubfm_ExtensionClear(type);
+    }
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) BFM_UNLATCH(type);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* EduBfM_SetPageSize() */
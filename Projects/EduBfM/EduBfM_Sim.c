@@ -0,0 +1,573 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_Sim.c
+ *
+ * Description :
+ *  Offline simulator of the buffer pools.
+ *  Replay a trace captured by EduBfM_SetTrace() against buffer pools of
+ *  several sizes under each buffer replacement policy, and print the
+ *  miss-ratio curve and the volume of the write-backs of each pool.
+ *  The real policies of EduBfM run on a buffer table built by the
+ *  simulator instead of the one of the storage system; a miss allocates
+ *  a buffer as edubfm_AllocTrain() does, but no train is read or
+ *  written: a dirty victim is only counted as a write-back, as are the
+ *  buffers left dirty at the end of the trace, which EduBfM_FlushAll()
+ *  would write.
+ *
+ *  Usage: EduBfM_Sim trace [policy ...] [# of buffers ...]
+ *
+ *  The policies are given by name (CLOCK, LRU-K, 2Q, ARC, CLOCK-Pro; all
+ *  if none). Without sizes, each pool is simulated from SIM_MIN_BUFS
+ *  buffers, doubling up to the first size holding all trains of the
+ *  trace.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "EduBfM_common.h"
+#include "EduBfM.h"
+#include "EduBfM_Internal.h"
+
+
+/*
+ * Definition for EduBfM Simulator
+ */
+#define SIM_MIN_BUFS            16      /* smallest default pool size */
+#define SIM_MAX_SIZES           32      /* maximum # of pool sizes */
+#define SIM_MAX_BASE_BUFS       16384   /* larger pools are grown by EduBfM_ResizePool() */
+
+/* type definition for the result of a replay */
+typedef struct {
+    UEight      nFixes;         /* replayed calls of EduBfM_GetTrain() */
+    UEight      nMisses;
+    UEight      nEvictWrites;   /* dirty victims written back */
+    UEight      nFlushWrites;   /* buffers dirty at the end of the trace */
+    UEight      nNoBufs;        /* misses finding every buffer fixed */
+} SimResult;
+
+/* type definition for a buffer table replacing the one of the storage system */
+typedef struct {
+    BufferTable *bufTable;
+    Two         *hashTable;
+    char        *bufferPool;
+} SimPool;
+
+static BfMTraceHeader header;           /* header of the trace */
+static BfMTraceRecord *records;         /* records of the trace */
+static Four nRecords;
+
+
+
+/*@================================
+ * sim_Load()
+ *================================*/
+/*
+ * Function: Four sim_Load(char *)
+ *
+ * Description:
+ *  Read the trace file into memory.
+ *
+ * Returns:
+ *  error code
+ *    eDEVICEIOERR_EDUBFM - the file cannot be read or is not a trace
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+static Four sim_Load(
+    char        *fileName)      /* IN name of the trace file */
+{
+    FILE        *fp;
+    long        size;
+
+    fp = fopen(fileName, "rb");
+    if (fp == NULL) ERR(eDEVICEIOERR_EDUBFM);
+
+    if (fread(&header, sizeof(BfMTraceHeader), 1, fp) != 1 || header.magic != BFM_TRACE_MAGIC ||
+        fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0) {
+        fclose(fp);
+        ERR(eDEVICEIOERR_EDUBFM);
+    }
+
+    nRecords = (Four)((size - sizeof(BfMTraceHeader)) / sizeof(BfMTraceRecord));
+    records = (BfMTraceRecord *)malloc(sizeof(BfMTraceRecord) * (nRecords > 0 ? nRecords : 1));
+    if (records == NULL) {
+        fclose(fp);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    if (fseek(fp, sizeof(BfMTraceHeader), SEEK_SET) != 0 ||
+        fread(records, sizeof(BfMTraceRecord), nRecords, fp) != (size_t)nRecords) {
+        free(records);
+        fclose(fp);
+        ERR(eDEVICEIOERR_EDUBFM);
+    }
+    fclose(fp);
+
+    return(eNOERROR);
+
+} /* sim_Load() */
+
+
+
+/*@================================
+ * sim_CompareKey()
+ *================================*/
+/*
+ * Function: int sim_CompareKey(const void *, const void *)
+ *
+ * Description:
+ *  qsort() comparison of two keys.
+ */
+static int sim_CompareKey(
+    const void  *a,             /* IN key */
+    const void  *b)             /* IN key */
+{
+    const BfMHashKey *x = (const BfMHashKey *)a;
+    const BfMHashKey *y = (const BfMHashKey *)b;
+
+    if (x->volNo != y->volNo) return(x->volNo - y->volNo);
+    if (x->pageNo != y->pageNo) return((x->pageNo < y->pageNo) ? -1 : 1);
+
+    return(0);
+
+} /* sim_CompareKey() */
+
+
+
+/*@================================
+ * sim_CountTrains()
+ *================================*/
+/*
+ * Function: Four sim_CountTrains(Four, Four *, Four *)
+ *
+ * Description:
+ *  Count the calls of EduBfM_GetTrain() on the pool in the trace and the
+ *  distinct trains they fix.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+static Four sim_CountTrains(
+    Four        type,           /* IN buffer type */
+    Four        *nFixes,        /* OUT # of calls of EduBfM_GetTrain() */
+    Four        *nTrains)       /* OUT # of distinct trains */
+{
+    Four        i, n;
+    BfMHashKey  *keys;
+
+    keys = (BfMHashKey *)malloc(sizeof(BfMHashKey) * (nRecords > 0 ? nRecords : 1));
+    if (keys == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    for (n = 0, i = 0; i < nRecords; i++)
+        if (records[i].type == type && records[i].op == BFM_TRACE_GET) {
+            keys[n].volNo = records[i].volNo;
+            keys[n].pageNo = records[i].pageNo;
+            n++;
+        }
+    *nFixes = n;
+
+    qsort(keys, n, sizeof(BfMHashKey), sim_CompareKey);
+    for (*nTrains = 0, i = 0; i < n; i++)
+        if (i == 0 || sim_CompareKey(&keys[i - 1], &keys[i]) != 0) (*nTrains)++;
+
+    free(keys);
+
+    return(eNOERROR);
+
+} /* sim_CountTrains() */
+
+
+
+/*@================================
+ * sim_NewPool()
+ *================================*/
+/*
+ * Function: Four sim_NewPool(SimPool *, Four, Four, Four)
+ *
+ * Description:
+ *  Build an empty pool of the given number of buffers under the policy.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four sim_NewPool(
+    SimPool     *pool,          /* OUT buffer table of the pool */
+    Four        type,           /* IN buffer type */
+    Four        policy,         /* IN BFM_POLICY_xxx */
+    Four        nBufs)          /* IN # of buffers */
+{
+    Four        e;
+    Four        i;
+    Four        nBaseBufs;
+    BfMConfig   cfg;
+
+    nBaseBufs = (nBufs < SIM_MAX_BASE_BUFS) ? nBufs : SIM_MAX_BASE_BUFS;
+
+    /* the frames are never touched */
+    pool->bufTable = (BufferTable *)malloc(sizeof(BufferTable) * nBaseBufs);
+    pool->hashTable = (Two *)malloc(sizeof(Two) * HASHTABLESIZE_TO_NBUFS(nBaseBufs));
+    pool->bufferPool = (char *)malloc((size_t)PAGESIZE * header.bufSize[type] * nBaseBufs);
+    if (pool->bufTable == NULL || pool->hashTable == NULL || pool->bufferPool == NULL) {
+        free(pool->bufTable);
+        free(pool->hashTable);
+        free(pool->bufferPool);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (i = 0; i < nBaseBufs; i++) {
+        SET_NILBFMHASHKEY(pool->bufTable[i].key);
+        pool->bufTable[i].fixed = 0;
+        pool->bufTable[i].bits = ALL_0;
+        pool->bufTable[i].nextHashEntry = NIL;
+    }
+    for (i = 0; i < HASHTABLESIZE_TO_NBUFS(nBaseBufs); i++) pool->hashTable[i] = NIL;
+
+    bufInfo[type].bufSize = header.bufSize[type];
+    bufInfo[type].nBufs = nBaseBufs;
+    bufInfo[type].nextVictim = 0;
+    bufInfo[type].bufTable = pool->bufTable;
+    bufInfo[type].bufferPool = pool->bufferPool;
+    bufInfo[type].hashTable = pool->hashTable;
+
+    e = edubfm_InitPool(type);
+    if (e >= eNOERROR) e = EduBfM_GetConfig(type, &cfg);
+    if (e >= eNOERROR) {
+        cfg.policy = policy;
+        if (cfg.maxBufs < nBufs) cfg.maxBufs = nBufs;
+        e = EduBfM_SetConfig(type, &cfg);
+    }
+    if (e >= eNOERROR && nBufs > nBaseBufs) e = EduBfM_ResizePool(type, nBufs);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* sim_NewPool() */
+
+
+
+/*@================================
+ * sim_FreePool()
+ *================================*/
+/*
+ * Function: void sim_FreePool(SimPool *, Four)
+ *
+ * Description:
+ *  Drop a pool built by sim_NewPool().
+ */
+static void sim_FreePool(
+    SimPool     *pool,          /* IN buffer table of the pool */
+    Four        type)           /* IN buffer type */
+{
+    edubfm_FinalPool(type);
+    memset(&bufInfo[type], 0, sizeof(BufferInfo));
+
+    free(pool->bufTable);
+    free(pool->hashTable);
+    free(pool->bufferPool);
+
+} /* sim_FreePool() */
+
+
+
+/*@================================
+ * sim_AllocTrain()
+ *================================*/
+/*
+ * Function: Four sim_AllocTrain(Four, SimResult *)
+ *
+ * Description:
+ *  Allocate a buffer as edubfm_AllocTrain() does, counting a dirty victim
+ *  as a write-back instead of writing it.
+ *
+ * Returns:
+ *  index of the buffer
+ *    eNOUNFIXEDBUF_BFM - every buffer is fixed
+ */
+static Four sim_AllocTrain(
+    Four        type,           /* IN buffer type */
+    SimResult   *r)             /* INOUT result of the replay */
+{
+    Four        victim;
+
+    victim = edubfm_PopFreeBuf(type);
+    if (victim == NIL) for (;;) {
+        victim = BE_POLICY(type)->victim(type);
+        if (victim < 0) return(victim);
+
+        if (!edubfm_ClaimVictim(type, victim)) continue;
+        if (edubfm_MarkClean(type, victim)) r->nEvictWrites++;
+        if (edubfm_UnmapVictim(type, victim)) break;
+    }
+
+    BE_POLICY(type)->evict(type, victim);
+    BI_BITS(type, victim) = ALL_0;
+    SET_NILBFMHASHKEY(BI_KEY(type, victim));
+
+    return(victim);
+
+} /* sim_AllocTrain() */
+
+
+
+/*@================================
+ * sim_Replay()
+ *================================*/
+/*
+ * Function: Four sim_Replay(Four, Four, Four, SimResult *)
+ *
+ * Description:
+ *  Replay the calls of the trace on the pool against an empty pool of
+ *  the given size under the policy.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four sim_Replay(
+    Four        type,           /* IN buffer type */
+    Four        policy,         /* IN BFM_POLICY_xxx */
+    Four        nBufs,          /* IN # of buffers */
+    SimResult   *r)             /* OUT result of the replay */
+{
+    Four        e;
+    Four        i, index;
+    Two         fixed;
+    BfMHashKey  key;
+    SimPool     pool;
+
+    memset(r, 0, sizeof(SimResult));
+
+    e = sim_NewPool(&pool, type, policy, nBufs);
+    if (e < eNOERROR) ERR(e);
+
+    BFM_LATCH(type);
+
+    for (i = 0; i < nRecords; i++) {
+        if (records[i].type != type) continue;
+        key.volNo = records[i].volNo;
+        key.pageNo = records[i].pageNo;
+
+        switch (records[i].op) {
+          case BFM_TRACE_GET:
+            r->nFixes++;
+            index = edubfm_Fix(&key, type);
+            if (index < 0) {
+                r->nMisses++;
+                BE_POLICY(type)->miss(type, &key);
+                index = sim_AllocTrain(type, r);
+                if (index < 0) {
+                    r->nNoBufs++;
+                    break;
+                }
+                BI_KEY(type, index) = key;
+                BI_FIXED(type, index) = 1;
+                BI_SETBITS(type, index, REFER);
+                e = edubfm_Insert(&key, index, type);
+                if (e < eNOERROR) {
+                    SET_NILBFMHASHKEY(BI_KEY(type, index));
+                    BI_FIXED(type, index) = 0;
+                    BE_POLICY(type)->release(type, index);
+                    edubfm_PushFreeBuf(type, index);
+                    ERR_UNLATCH(e, type);
+                }
+                BE_POLICY(type)->admit(type, index);
+                break;
+            }
+            if (BE_POLICY(type)->access != NULL)
+                BE_POLICY(type)->access(type, index);
+            BI_SETBITS(type, index, REFER);
+            break;
+
+          case BFM_TRACE_FREE:
+            (void) edubfm_Unfix(&key, type, &fixed);
+            break;
+
+          case BFM_TRACE_DIRTY:
+            index = edubfm_LookUp(&key, type);
+            if (index >= 0) (void) edubfm_MarkDirty(type, index);
+            break;
+        }
+    }
+
+    for (i = 0; i < BE_NBUFS(type); i++)
+        if (BI_BITS(type, i) & DIRTY) r->nFlushWrites++;
+
+    BFM_UNLATCH(type);
+
+    sim_FreePool(&pool, type);
+
+    return(eNOERROR);
+
+} /* sim_Replay() */
+
+
+
+/*@================================
+ * sim_Pool()
+ *================================*/
+/*
+ * Function: Four sim_Pool(Four, Boolean *, Four *, Four)
+ *
+ * Description:
+ *  Simulate the pool under the selected policies at the given sizes, or
+ *  at the default sizes if 'nSizes' is 0, and print a line per policy
+ *  and size.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four sim_Pool(
+    Four        type,           /* IN buffer type */
+    Boolean     *policies,      /* IN TRUE for the selected policies */
+    Four        *sizes,         /* IN # of buffers of each run */
+    Four        nSizes)         /* IN # of sizes (0: default sizes) */
+{
+    static char *poolNames[NUM_BUF_TYPES] = { "page pool", "large object train pool" };
+    Four        e;
+    Four        p, s, n;
+    Four        nFixes, nTrains;
+    Four        defaults[SIM_MAX_SIZES];
+    SimResult   r;
+
+    e = sim_CountTrains(type, &nFixes, &nTrains);
+    if (e < eNOERROR) ERR(e);
+    if (nFixes == 0) return(eNOERROR);
+
+    if (nSizes == 0) {
+        for (n = SIM_MIN_BUFS; nSizes < SIM_MAX_SIZES; n *= 2) {
+            defaults[nSizes++] = (n < BFM_MAX_POOL_BUFS) ? n : BFM_MAX_POOL_BUFS;
+            if (n >= nTrains || n >= BFM_MAX_POOL_BUFS) break;
+        }
+        sizes = defaults;
+    }
+
+    printf("\n[%s] %d fixes of %d trains of %d page(s)\n", poolNames[type], nFixes, nTrains, header.bufSize[type]);
+    printf("%-10s %8s %10s %10s %12s %12s %10s %8s\n", "policy", "buffers", "misses", "miss ratio",
+           "evict writes", "flush writes", "write MB", "no buf");
+
+    for (p = 0; p < NUM_BFM_POLICIES; p++) {
+        if (!policies[p]) continue;
+
+        for (s = 0; s < nSizes; s++) {
+            e = sim_Replay(type, p, sizes[s], &r);
+            if (e < eNOERROR) ERR(e);
+
+            printf("%-10s %8d %10llu %9.2f%% %12llu %12llu %10.1f %8llu\n", edubfm_policies[p]->name, sizes[s],
+                   r.nMisses, 100.0 * r.nMisses / r.nFixes, r.nEvictWrites, r.nFlushWrites,
+                   (double)(r.nEvictWrites + r.nFlushWrites) * header.bufSize[type] * PAGESIZE / (1 << 20),
+                   r.nNoBufs);
+        }
+    }
+
+    return(eNOERROR);
+
+} /* sim_Pool() */
+
+
+
+Four main(
+    int         argc,
+    char        **argv)
+{
+    Four        e;
+    Four        i, p, type;
+    Four        nSizes = 0;
+    Four        sizes[SIM_MAX_SIZES];
+    Boolean     policies[NUM_BFM_POLICIES];
+    Boolean     anyPolicy = FALSE;
+
+    if (argc < 2) {
+        printf("Usage: EduBfM_Sim trace [policy ...] [# of buffers ...]\n");
+        exit(1);
+    }
+
+    for (p = 0; p < NUM_BFM_POLICIES; p++) policies[p] = FALSE;
+
+    for (i = 2; i < argc; i++) {
+        for (p = 0; p < NUM_BFM_POLICIES; p++)
+            if (strcasecmp(argv[i], edubfm_policies[p]->name) == 0) break;
+
+        if (p < NUM_BFM_POLICIES) {
+            policies[p] = anyPolicy = TRUE;
+        }
+        else if (atoi(argv[i]) > 0 && atoi(argv[i]) <= BFM_MAX_POOL_BUFS && nSizes < SIM_MAX_SIZES) {
+            sizes[nSizes++] = atoi(argv[i]);
+        }
+        else {
+            printf("EduBfM_Sim: bad policy or # of buffers '%s'\n", argv[i]);
+            exit(1);
+        }
+    }
+    if (!anyPolicy)
+        for (p = 0; p < NUM_BFM_POLICIES; p++) policies[p] = TRUE;
+
+    e = sim_Load(argv[1]);
+    if (e < eNOERROR) {
+        printf("EduBfM_Sim: cannot read the trace '%s'\n", argv[1]);
+        exit(1);
+    }
+
+    for (type = 0; e >= eNOERROR && type < NUM_BUF_TYPES; type++)
+        e = sim_Pool(type, policies, sizes, nSizes);
+
+    if (e < eNOERROR) {
+        printf("EduBfM_Sim failed!!! (%d: %s)\n", e, Err_GetErrName(e));
+        exit(1);
+    }
+
+    free(records);
+
+    return 0;
+}
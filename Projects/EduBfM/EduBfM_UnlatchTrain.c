@@ -0,0 +1,108 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBfM_UnlatchTrain.c
+ *
+ * Description :
+ *  Release the content latch of a buffer.
+ *
+ * Exports:
+ *  Four EduBfM_UnlatchTrain(TrainID *, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * EduBfM_UnlatchTrain()
+ *================================*/
+/*
+ * Function: Four EduBfM_UnlatchTrain(TrainID *, Four)
+ *
+ * Description :
+ *  Release the content latch of the buffer holding the train, acquired
+ *  by EduBfM_LatchTrain(). The train is still fixed. Releasing the latch
+ *  held in exclusive mode makes the version of the buffer even again.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    eNOTFOUND_BFM - the train is not in the buffer pool
+ */
+Four EduBfM_UnlatchTrain(
+    TrainID             *trainId,       /* IN train to be unlatched */
+    Four                type)           /* IN buffer type */
+{
+    Four                index;          /* index on buffer holding the train */
+
+
+    /*@ check if the parameter is valid. */
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+
+    if (!IS_POOL_INITIALIZED(type)) return(eNOTFOUND_BFM);
+
+    index = edubfm_FastLookUp(trainId, type);
+    if (index < 0) {
+        BFM_LATCH(type);
+        index = edubfm_LookUp(trainId, type);
+        BFM_UNLATCH(type);
+        if (index < 0) return(eNOTFOUND_BFM);
+    }
+
+    /* the version is odd only under the exclusive latch, which this thread holds */
+    if (BFM_ATOMIC_LOAD(BE_VERSION(type, index)) & 1) BFM_ATOMIC_ADD(BE_VERSION(type, index), 1);
+
+    pthread_rwlock_unlock(&BE_CONTENTLATCH(type, index));
+
+    return(eNOERROR);
+
+} /* EduBfM_UnlatchTrain() */
@@ -50,6 +50,169 @@
 #define _EDUBFM_H_
 
 
+/*@
+ * Constant Definitions
+ */
+/* Buffer Replacement Policies */
+#define BFM_POLICY_CLOCK        0       /* second chance (default) */
+#define BFM_POLICY_LRUK         1       /* LRU-K */
+#define BFM_POLICY_2Q           2       /* 2Q (A1in/A1out/Am) */
+#define BFM_POLICY_ARC          3       /* Adaptive Replacement Cache */
+#define BFM_POLICY_CLOCKPRO     4       /* CLOCK-Pro */
+#define NUM_BFM_POLICIES        5
+
+/* maximum K of the LRU-K policy */
+#define BFM_MAX_LRUK            4
+
+/* maximum # of volumes attached by EduBfM_AttachVolume() */
+#define BFM_MAX_ATTACHED_VOLUMES 16
+
+/* maximum page size of a volume (see EduBfM_SetPageSize()) and of the frames of a buffer pool */
+#define BFM_MAX_PAGESIZE        65536
+
+/* I/O engines reading and writing the trains on the attached volumes */
+#define BFM_IOENGINE_URING      0       /* Linux io_uring */
+#define BFM_IOENGINE_THREADS    1       /* pool of threads doing synchronous I/O */
+#define NUM_BFM_IOENGINES       2
+
+/* # of buffers a buffer pool is made ready to be resized to unless it is
+ * configured otherwise (BfMConfig.maxBufs), and the most buffers a pool may
+ * have; a pool whose buffer table of the storage system is larger is made
+ * ready for that size
+ */
+#define BFM_DEFAULT_MAX_BUFS    (1 << 20)
+#define BFM_MAX_POOL_BUFS       (1 << 30)
+
+/* pages backing the frames of a buffer pool (BfMConfig.hugePages)
+ * A kind of huge pages which cannot be had, e.g. because none is reserved,
+ * falls back to the next smaller kind.
+ */
+#define BFM_PAGES_DEFAULT       0       /* pages of the system (default) */
+#define BFM_PAGES_THP           1       /* transparent huge pages */
+#define BFM_PAGES_2MB           2       /* reserved 2 MB huge pages */
+#define BFM_PAGES_1GB           3       /* reserved 1 GB huge pages */
+#define NUM_BFM_PAGES           4
+
+/* maximum # of NUMA nodes the frames of a buffer pool are spread over */
+#define BFM_MAX_NUMA_NODES      64
+
+/* maximum # of buffers recycled by an access strategy */
+#define BFM_MAX_RING_SIZE       64
+
+/* # of buckets of the histograms of BfMStats
+ * Bucket i counts the values v such that 2^i <= v < 2^(i+1); bucket 0 also
+ * counts 0, and the last bucket also counts the larger values.
+ */
+#define BFM_NUM_HIST_BUCKETS    32
+
+/* the latency of one in BFM_GETTRAIN_SAMPLE calls of EduBfM_GetTrain() by a thread is measured */
+#define BFM_GETTRAIN_SAMPLE     16
+
+/* formats of EduBfM_PrintStats() */
+#define BFM_STATS_TEXT          0
+#define BFM_STATS_JSON          1
+
+/* modes of the content latch of a buffer (see EduBfM_LatchTrain()) */
+#define BFM_SHARED              0
+#define BFM_EXCLUSIVE           1
+
+/* type definition for configuration parameters of a buffer pool */
+typedef struct {
+    Four        policy;         /* buffer replacement policy (BFM_POLICY_xxx) */
+    Four        lruK;           /* K of the LRU-K policy (1 ~ BFM_MAX_LRUK) */
+    Four        dirtyLow;       /* the background writer stops at this % of dirty buffers */
+    Four        dirtyHigh;      /* the background writer starts at this % of dirty buffers (0: off) */
+    Four        flushDepth;     /* # of vectored writes in flight in EduBfM_FlushAll() (0: no limit) */
+    Four        hugePages;      /* pages backing the frames (BFM_PAGES_xxx) */
+    Four        numaNodes;      /* # of NUMA nodes the frames are spread over (0: not bound) */
+    Four        directIO;       /* TRUE: the trains of the attached volumes bypass the page cache of the OS */
+    Four        pageSize;       /* largest page size of the volumes the pool holds trains of, in bytes */
+    Four        shared;         /* TRUE: the buffer manager of the storage system also fixes and dirties the buffers */
+    Four        maxBufs;        /* # of buffers the pool is made ready to be resized to (raised by EduBfM_ResizePool()) */
+} BfMConfig;
+
+/* type definition for statistics of a buffer pool
+ * BfMStats holds only UEight counters (see edubfm_Stats.c).
+ */
+typedef struct {
+    UEight      nLookups;               /* calls of EduBfM_GetTrain() */
+    UEight      nHits;                  /* lookups finding the train in the pool */
+    UEight      nMisses;                /* lookups reading the train */
+    UEight      nEvictions;             /* trains replaced to allocate a buffer */
+    UEight      nFreeAllocs;            /* buffers allocated from the free buffer list */
+    UEight      nCleanAllocs;           /* clean buffers allocated from the clean list */
+    UEight      nSweepAllocs;           /* buffers allocated by a search of the replacement policy */
+    UEight      nSweepSteps;            /* buffers visited by the clock sweeps */
+    UEight      nVictimFlushes;         /* dirty victims written by the foreground */
+    UEight      nWriterFlushes;         /* buffers written by the background writer */
+    UEight      nAvoidedFlushes;        /* clean victims cleaned by the background writer */
+    UEight      nPrefetches;            /* reads started by EduBfM_PrefetchTrains() */
+    UEight      nPrefetchHits;          /* fixes of trains read by EduBfM_PrefetchTrains() */
+    UEight      nPrefetchWaits;         /* fixes waiting for a read still in flight */
+    UEight      nRingReuses;            /* buffers recycled by the rings of access strategies */
+    UEight      nLatchWaits;            /* waits for the pool latch held by another thread */
+    UEight      nContentWaits;          /* waits for a content latch in EduBfM_LatchTrain() */
+    UEight      nGhostHits;             /* misses on trains evicted recently, under a memory budget */
+    UEight      nCompressedStores;      /* evicted trains kept by the compressed cache */
+    UEight      nCompressedHits;        /* misses served by the compressed cache */
+    UEight      nExtensionWrites;       /* evicted trains written to the extension file */
+    UEight      nExtensionHits;         /* misses served by the extension file */
+    UEight      nOptimisticReads;       /* reads begun by EduBfM_OptimisticRead() */
+    UEight      nOptimisticConflicts;   /* optimistic reads failing EduBfM_ValidateRead() */
+    UEight      nSwizzledHits;          /* fixes through swizzled references */
+    UEight      nAsyncReads;            /* reads started by EduBfM_GetTrainAsync() */
+    UEight      sweepLengths[BFM_NUM_HIST_BUCKETS];     /* buffers visited per clock sweep */
+    UEight      getTrainNs[BFM_NUM_HIST_BUCKETS];       /* latency of the sampled EduBfM_GetTrain() in ns */
+    UEight      readNs[BFM_NUM_HIST_BUCKETS];           /* latency of the reads in ns */
+    UEight      writeNs[BFM_NUM_HIST_BUCKETS];          /* latency of the writes in ns */
+} BfMStats;
+
+/* type definition for an access strategy (see EduBfM_GetAccessStrategy()) */
+typedef struct BfMAccessStrategy BfMAccessStrategy;
+
+/* type definition for an optimistic read (see EduBfM_OptimisticRead()) */
+typedef struct {
+    Four        type;           /* buffer type */
+    Four        index;          /* buffer read */
+    UFour       version;        /* version of the buffer when the read began */
+} BfMReadToken;
+
+/* type definition for a swizzled reference (see EduBfM_GetTrainSwizzled()) */
+typedef struct {
+    TrainID     trainId;        /* train referred to */
+    Four        index;          /* buffer which held the train (NIL if not swizzled) */
+    UFour       version;        /* version of the buffer then */
+} BfMSwizzledRef;
+
+/* type definition for the requests of EduBfM_GetTrainAsync() of a thread */
+typedef struct BfMAsyncQueue BfMAsyncQueue;
+
+/* type definition for a fix of a train which does not wait for its read
+ * (see EduBfM_GetTrainAsync())
+ */
+typedef struct BfMAsyncGet BfMAsyncGet;
+struct BfMAsyncGet {
+    TrainID     trainId;                /* IN train to be fixed */
+    Four        type;                   /* IN buffer type */
+    void        (*done)(BfMAsyncGet *); /* IN continuation of a request left pending */
+    void        *arg;                   /* IN argument of done(), e.g. the coroutine to resume */
+    char        *retBuf;                /* OUT buffer holding the train */
+    Four        result;                 /* OUT error code of a request left pending */
+    BfMAsyncQueue *queue;               /* queue of the request (used by EduBfM) */
+    BfMAsyncGet *next;                  /* link used by EduBfM */
+};
+
+/* A queue is set to all zeros before its first use, and used by one
+ * thread at a time (see EduBfM_PollTrains()).
+ */
+struct BfMAsyncQueue {
+    BfMAsyncGet *deferred;      /* requests waiting for a read to be started */
+    BfMAsyncGet *lastDeferred;
+    BfMAsyncGet *completed;     /* requests over whose done() has not been called */
+    Four        nPending;       /* # of requests left pending whose done() has not been called */
+};
+
+
 /*@
  * Function Prototypes
  */
@@ -59,6 +222,33 @@ Four EduBfM_GetTrain(TrainID *, char **, Four);
 Four EduBfM_SetDirty(TrainID *, Four);
 Four EduBfM_DiscardAll(void);
 Four EduBfM_FlushAll(void);
+Four EduBfM_SetConfig(Four, BfMConfig *);
+Four EduBfM_GetConfig(Four, BfMConfig *);
+Four EduBfM_GetStats(Four, BfMStats *);
+Four EduBfM_PrintStats(Four, Four, FILE *);
+Four EduBfM_ResizePool(Four, Four);
+Four EduBfM_SetMemoryBudget(Four);
+Four EduBfM_SetCompressedCache(Four);
+Four EduBfM_SetExtensionFile(Four, char *, Four);
+Four EduBfM_SetWarmUpFile(char *);
+Four EduBfM_SetTrace(char *);
+Four EduBfM_AttachVolume(VolNo, char *);
+Four EduBfM_DetachVolume(VolNo);
+Four EduBfM_PrefetchTrains(TrainID *, Four, Four);
+Four EduBfM_SetIOEngine(Four);
+Four EduBfM_LatchTrain(TrainID *, Four, Four);
+Four EduBfM_UnlatchTrain(TrainID *, Four);
+Four EduBfM_GetAccessStrategy(Four, Four, BfMAccessStrategy **);
+Four EduBfM_FreeAccessStrategy(BfMAccessStrategy *);
+Four EduBfM_GetTrainWithStrategy(TrainID *, char **, Four, BfMAccessStrategy *);
+Four EduBfM_OptimisticRead(TrainID *, char **, BfMReadToken *, Four);
+Four EduBfM_ValidateRead(BfMReadToken *);
+Four EduBfM_GetTrainSwizzled(BfMSwizzledRef *, char **, Four);
+Four EduBfM_FreeTrainSwizzled(BfMSwizzledRef *, Four);
+Four EduBfM_SetPageSize(VolNo, Four);
+Four EduBfM_GetTrainAsync(BfMAsyncGet *, BfMAsyncQueue *);
+Four EduBfM_PollTrains(BfMAsyncQueue *, Boolean);
+Four EduBfM_Final(void);
 
 
 #endif /* _EDUBFM_H_ */
@@ -0,0 +1,120 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+#ifndef _EDUBFM_BENCHMODULE_H_
+#define _EDUBFM_BENCHMODULE_H_
+
+
+/*
+ * Definition for EduBfM Benchmark
+ */
+#define BENCH_VOLUME_NAME       "bench.vol"
+#define BENCH_VOLUME_ID         2000
+#define BENCH_EXTENT_SIZE       16
+#define BENCH_VOLUME_PAGES      60000
+#define BENCH_NUM_PAGES         1200
+
+
+/* type definition for a buffer pool replacing the page pool */
+typedef struct {
+    BufferInfo  saved;          /* page pool of the storage system */
+    BufferTable *bufTable;
+    Two         *hashTable;
+    char        *bufferPool;
+} BenchPool;
+
+
+/*
+ * Variables shared by the benchmarks
+ */
+extern PageID pageIds[BENCH_NUM_PAGES];
+extern UFour seed;
+extern Four benchWrong;
+
+
+/*@
+ * Function Prototypes
+ */
+/* Fixtures */
+Four bench_Random(Four);
+double bench_Now(void);
+Four bench_Access(PageID *, Four, Boolean *);
+Four bench_EmptyPool(void);
+void bench_DropCache(void);
+Four bench_BigPool(BenchPool *, Four);
+Four bench_RestorePool(BenchPool *, Four);
+Four bench_NewPages(Four, Four, PageID *);
+Four bench_AllocPages(Four);
+
+/* Benchmarks */
+Four bench_Policy(Four);
+Four bench_LookUp(Four);
+Four bench_Alloc(Four);
+Four bench_Writer(Four);
+Four bench_Flush(Four);
+Four bench_Prefetch(Four);
+Four bench_Ring(Four);
+Four bench_Scale(Four);
+Four bench_Stats(Four);
+Four bench_Resize(Four);
+Four bench_Balance(Four);
+Four bench_Frames(Four);
+Four bench_WarmUp(Four);
+Four bench_Trace(Four);
+Four bench_Direct(Four);
+Four bench_ZCache(Four);
+Four bench_Extension(Four);
+Four bench_Dirty(Four);
+Four bench_Optimistic(Four);
+Four bench_Swizzle(Four);
+Four bench_PageSize(Four);
+Four bench_Async(Four);
+Four bench_Check(Four);
+
+
+#endif /* _EDUBFM_BENCHMODULE_H_ */
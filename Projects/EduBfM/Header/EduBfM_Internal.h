@@ -49,6 +49,10 @@
 #ifndef _EDUBFM_INTERNAL_H_
 #define _EDUBFM_INTERNAL_H_
 
+#include <pthread.h>
+#include <sys/uio.h>
+#include "EduBfM.h"
+
 
 /*@
  * Constant Definitions
@@ -157,6 +161,20 @@ typedef struct {
  */
 #define BI_NEXTVICTIM(type)	     (bufInfo[type].nextVictim)
 
+/* Macro: BI_ENTRY(type, idx)
+ * Description: return the element of the buffer table; the buffers added by
+ *              EduBfM_ResizePool() beyond the buffer table of the storage
+ *              system have their elements in their chunk (see BufferChunk)
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (BufferTable) element of the buffer table
+ */
+#define BI_ENTRY(type, idx) \
+    (*((idx) < BE_NBASEBUFS(type) || BE_CHUNKS(type) == NULL \
+       ? &((BufferTable*)bufInfo[type].bufTable)[idx] \
+       : &BE_CHUNK(type, idx)->table[CHUNK_SLOT(idx)]))
+
 /* Macro: BI_KEY(type, idx)
  * Description: return the hash key of the page/train residing in the buffer element
  * Parameters:
@@ -164,7 +182,7 @@ typedef struct {
  *  Four idx        : array index of the buffer element
  * Returns: (BfMHashKey) hash key
  */
-#define BI_KEY(type, idx)	     (((BufferTable*)bufInfo[type].bufTable)[idx].key)
+#define BI_KEY(type, idx)	     (BI_ENTRY(type, idx).key)
 
 /* Macro: BI_FIXED(type, idx)
  * Description: return the number of transactions fixing (accessing) the page/train residing in the buffer element
@@ -173,7 +191,7 @@ typedef struct {
  *  Four idx        : array index of the buffer element
  * Returns: (Two) number of transactions
  */
-#define BI_FIXED(type, idx)	     (((BufferTable*)bufInfo[type].bufTable)[idx].fixed)
+#define BI_FIXED(type, idx)	     (BI_ENTRY(type, idx).fixed)
 
 /* Macro: BI_BITS(type, idx)
  * Description: return a set of bits indicating the state of the buffer element
@@ -182,7 +200,38 @@ typedef struct {
  *  Four idx        : array index of the buffer element
  * Returns: (One) set of bits
  */
-#define BI_BITS(type, idx)	     (((BufferTable*)bufInfo[type].bufTable)[idx].bits)
+#define BI_BITS(type, idx)	     (BI_ENTRY(type, idx).bits)
+
+/* Macro: BFM_ATOMIC_LOAD(x), BFM_ATOMIC_STORE(x, v), BFM_ATOMIC_ADD(x, n),
+ *        BFM_ATOMIC_OR(x, v), BFM_ATOMIC_AND(x, v), BFM_ATOMIC_CAS(x, old, v)
+ * Description: atomic operations on the fields which threads change
+ *              without holding the pool latch: the fix counts, the bits,
+ *              the I/O states, and the counters of dirty buffers.
+ *              BFM_ATOMIC_ADD returns the new value, BFM_ATOMIC_OR and
+ *              BFM_ATOMIC_AND return the old value, and BFM_ATOMIC_CAS
+ *              returns TRUE if x was 'old' and has been set to 'v'
+ *              ('old' is set to the value of x otherwise).
+ * Parameters:
+ *  x               : lvalue operated on
+ */
+#define BFM_ATOMIC_LOAD(x)          __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define BFM_ATOMIC_STORE(x, v)      __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+#define BFM_ATOMIC_ADD(x, n)        __atomic_add_fetch(&(x), (n), __ATOMIC_SEQ_CST)
+#define BFM_ATOMIC_OR(x, v)         __atomic_fetch_or(&(x), (v), __ATOMIC_SEQ_CST)
+#define BFM_ATOMIC_AND(x, v)        __atomic_fetch_and(&(x), (v), __ATOMIC_SEQ_CST)
+#define BFM_ATOMIC_CAS(x, old, v) \
+    __atomic_compare_exchange_n(&(x), &(old), (v), FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)
+
+/* Macro: BI_SETBITS(type, idx, b), BI_CLEARBITS(type, idx, b)
+ * Description: set/clear bits of a buffer element atomically
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ *  One b           : bits
+ * Returns: (One) the bits before
+ */
+#define BI_SETBITS(type, idx, b)     BFM_ATOMIC_OR(BI_BITS(type, idx), (One)(b))
+#define BI_CLEARBITS(type, idx, b)   BFM_ATOMIC_AND(BI_BITS(type, idx), (One)~(b))
 
 /* Macro: BI_NEXTHASHENTRY(type, idx)
  * Description: return the array index of the buffer element containing the next page/train having the identical hash key value
@@ -191,7 +240,7 @@ typedef struct {
  *  Four idx        : array index of the buffer element containing the current page/train
  * Returns: (Two) array index of the buffer element containing the next page/train
  */
-#define BI_NEXTHASHENTRY(type, idx)  (((BufferTable*)bufInfo[type].bufTable)[idx].nextHashEntry)
+#define BI_NEXTHASHENTRY(type, idx)  (BI_ENTRY(type, idx).nextHashEntry)
 
 /* Macro: BI_BUFFERPOOL(type)
  * Description: return the buffer pool
@@ -203,12 +252,17 @@ typedef struct {
 
 /* Macro: BI_BUFFER(type, idx)
  * Description: return the idx-th element of the buffer pool
+ *              (the offset is computed in size_t so that a pool may exceed 2GB;
+ *              the buffers added by EduBfM_ResizePool() are in BE_EXTFRAMES(type))
  * Parameters:
  *  Four type       : buffer type
  *  Four idx        : array index of the buffer element
  * Returns: (char *) pointer to the idx-th element
  */
-#define BI_BUFFER(type, idx)	     ((char*)BI_BUFFERPOOL(type)+PAGESIZE*BI_BUFSIZE(type)*idx)
+#define BI_BUFFER(type, idx) \
+    ((idx) < BE_NBASEBUFS(type) || BE_EXTFRAMES(type) == NULL \
+     ? (char*)BI_BUFFERPOOL(type)+(size_t)PAGESIZE*BI_BUFSIZE(type)*(idx) \
+     : BE_EXTFRAMES(type)+(size_t)PAGESIZE*BI_BUFSIZE(type)*((idx)-BE_NBASEBUFS(type)))
 
 /* Macro: BI_HASHTABLE(type)
  * Description: return the hash table
@@ -252,8 +306,784 @@ typedef struct {
 /* constant definition: The BfMHashKey don't exist in the hash table. */
 #define NOTFOUND_IN_HTABLE  -1
 
+/* The layout of BufferInfo and BufferTable is shared with the rest of the
+ * storage system, so their indices stay 16-bit. EduBfM itself uses Four
+ * for buffer indices everywhere (see BE_NBUFS(type)); the hash chains can
+ * only link buffers up to this index, the page table holds all of them.
+ * The buffers added by EduBfM_ResizePool() are never chained since the
+ * rest of the storage system only knows the buffer table of bufInfo[].
+ */
+#define MAX_CHAINED_BUFINDEX    0x7fff
+
+/* Macro: IS_CHAINED_BUFINDEX(type, idx)
+ * Description: return TRUE if the buffer may be linked on the hash chains
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (Boolean) TRUE if the buffer is in the buffer table of bufInfo[]
+ */
+#define IS_CHAINED_BUFINDEX(type, idx) ((idx) <= MAX_CHAINED_BUFINDEX && (idx) < BI_NBUFS(type))
+
+/* Macro: IS_POOL_CHAINED(type)
+ * Description: return TRUE if every buffer of the pool may be linked on the
+ *              hash chains, so that a key the chains miss is not in the pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Boolean) TRUE if the pool has not grown past the buffer table of bufInfo[]
+ */
+#define IS_POOL_CHAINED(type)   (IS_POOL_SHARED(type) && BE_NBUFS(type) <= BI_NBUFS(type) && BE_NBUFS(type) <= MAX_CHAINED_BUFINDEX + 1)
+
+/* Macro: IS_POOL_SHARED(type)
+ * Description: return TRUE if the buffer manager of the storage system may
+ *              use the buffer pool (BfMConfig.shared), so that the trains
+ *              are chained on its hash table besides the page table
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Boolean) TRUE if the hash table is maintained
+ */
+#define IS_POOL_SHARED(type)    (!IS_POOL_INITIALIZED(type) || BE_CFG(type).shared)
+
 extern BufferInfo bufInfo[];
 
+
+/*@
+ * Type Definitions for the Buffer Replacement Policies
+ */
+/* type definition for a doubly linked list of array indices
+ * (buffer indices or node indices of a ghost directory)
+ */
+typedef struct {
+    Four        head;           /* most recently inserted element */
+    Four        tail;           /* least recently inserted element */
+    Four        len;            /* # of elements in the list */
+} BfMList;
+
+/* type definition for the link arrays shared by the lists over one index space */
+typedef struct {
+    Four        *prev;
+    Four        *next;
+} BfMLinks;
+
+/* type definition for a chained hash map from BfMHashKey to a node index */
+typedef struct {
+    Four        nBuckets;       /* # of hash chains */
+    Four        *bucket;        /* first node of each hash chain */
+    Four        *next;          /* next node in the same hash chain */
+    BfMHashKey  *key;           /* key of each node */
+} BfMKeyMap;
+
+/* maximum number of lists in a ghost directory */
+#define BFM_MAX_GHOSTLISTS      2
+
+/* type definition for a ghost directory, i.e. LRU lists of the keys of
+ * recently replaced trains which are no longer in the buffer pool
+ */
+typedef struct {
+    Four        nNodes;         /* capacity of the directory */
+    Four        freeNode;       /* head of the free node chain */
+    BfMKeyMap   map;            /* key -> node */
+    BfMLinks    links;
+    One         *listNo;        /* list which each node belongs to */
+    BfMList     list[BFM_MAX_GHOSTLISTS];
+    Four        auxLen;         /* # of Eight words of auxiliary data per node */
+    Eight       *aux;           /* auxiliary data of the nodes */
+} BfMGhostDir;
+
+/* Macro: GHOST_AUX(g, node)
+ * Description: return the auxiliary data of the node of a ghost directory
+ * Parameters:
+ *  BfMGhostDir *g  : pointer to the ghost directory
+ *  Four node       : node index
+ * Returns: (Eight *) pointer to the auxiliary data
+ */
+#define GHOST_AUX(g, node)      ((g)->aux + (node) * (g)->auxLen)
+
+/* # of slots in a bucket of the page table */
+#define BFM_PT_SLOTS            5
+
+/* type definition for a bucket of the page table
+ * A bucket fills one 64-byte cache line. The keys are kept inline so that
+ * looking up a key usually reads only its home bucket. Each used slot has
+ * a non-zero 8-bit tag taken from the hash value of its key; a lookup
+ * compares the tags of all slots at once and reads the keys only on a tag
+ * match.
+ */
+typedef struct {
+    UOne        tag[8];                 /* tags of the slots (0: empty), tag[BFM_PT_SLOTS..7] are always 0 */
+    PageNo      pageNo[BFM_PT_SLOTS];
+    Four        index[BFM_PT_SLOTS];    /* buffer index of each slot */
+    VolNo       volNo[BFM_PT_SLOTS];
+    UTwo        overflow;               /* # of keys which were placed after this bucket since it was full */
+    Four        reserved;
+} BfMPageTableBucket;
+
+/* maximum # of partitions of the page table */
+#define BFM_PT_PARTITIONS       16
+
+/* type definition for a partition of the page table, an open addressing
+ * hash table from BfMHashKey to a buffer index probing bucket by bucket.
+ * Each partition has its own latch and fills whole cache lines.
+ */
+typedef struct {
+    pthread_mutex_t     latch;          /* partition latch */
+    Four                mask;           /* # of buckets - 1, # of buckets is a power of 2 */
+    Four                nKeys;          /* # of keys in the partition */
+    BfMPageTableBucket  *bucket;        /* 64-byte aligned array of buckets */
+    void                *retired;       /* bucket arrays outgrown, kept for the probes without the latch */
+} __attribute__((aligned(64))) BfMPageTablePart;
+
+/* type definition for the page table
+ * A key belongs to the partition chosen by bits of its hash value which
+ * are not used to choose its bucket.
+ */
+typedef struct {
+    Four                partMask;       /* # of partitions - 1, # of partitions is a power of 2 */
+    BfMPageTablePart    part[BFM_PT_PARTITIONS];
+} BfMPageTable;
+
+/* type definition for a buffer replacement policy
+ * Every hook receives the buffer type as its first parameter and is
+ * called with the pool latch held.
+ * 'victim' only selects a buffer; the replacement becomes effective
+ * when 'evict' is called after the selected buffer has been flushed.
+ * 'access' is NULL if the policy only looks at the reference bits, so
+ * that a hit does not take the pool latch.
+ */
+typedef struct {
+    char        *name;
+    Four        (*init)(Four);                  /* build the policy state of a buffer pool */
+    void        (*final)(Four);                 /* release the policy state */
+    void        (*access)(Four, Four);          /* a train in the buffer is referenced again */
+    void        (*miss)(Four, BfMHashKey *);    /* a train not in the pool is requested */
+    Four        (*victim)(Four);                /* select a buffer to be replaced */
+    void        (*evict)(Four, Four);           /* the selected buffer is being replaced */
+    void        (*admit)(Four, Four);           /* a train has been loaded into the buffer */
+    void        (*release)(Four, Four);         /* the buffer holds no train any more */
+} BfMPolicy;
+
+/* maximum # of unfixed buffers at the cold end of a list of a replacement
+ * policy among which a clean one is preferred to a dirty one
+ */
+#define BFM_CLEAN_WINDOW        8
+
+/* maximum # of reads in flight started by EduBfM_PrefetchTrains() per buffer pool */
+#define BFM_MAX_PREFETCHES      32
+
+/* I/O state of a buffer (BE_IOSTATE) */
+#define IO_NONE         0       /* no I/O of EduBfM in flight */
+#define IO_READING      1       /* being read by EduBfM_PrefetchTrains() or by a miss */
+#define IO_PREFETCHED   2       /* read by EduBfM_PrefetchTrains(); the train has not been fixed yet */
+#define IO_WRITING      3       /* a copy is being written by the background writer, or the victim itself */
+#define IO_MOVING       4       /* the frame is moved onto other pages (see edubfm_Frames.c) */
+
+/* operations of an I/O request */
+#define BFM_IO_READ     0
+#define BFM_IO_WRITE    1
+
+/* # of threads of the thread pool I/O engine */
+#define BFM_IO_THREADS  4
+
+/* type definition for a request to an I/O engine
+ * The engine calls done() from one of its threads when the request is over
+ * (see edubfm_IODone()).
+ */
+typedef struct BfMIORequest BfMIORequest;
+struct BfMIORequest {
+    Four        op;             /* BFM_IO_xxx */
+    Four        fd;             /* file descriptor of the device */
+    off_t       offset;         /* offset on the device */
+    struct iovec *iov;          /* buffers (kept until the request is over) */
+    Four        nIov;           /* # of buffers */
+    Four        result;         /* error code of the request */
+    void        (*done)(BfMIORequest *);
+    Four        type;           /* buffer type whose statistics count the request */
+    UEight      start;          /* time the request was started (edubfm_Now()) */
+    void        *arg;           /* argument of done() */
+    BfMIORequest *next;         /* link used by the engine */
+};
+
+/* type definition for an I/O engine */
+typedef struct {
+    char        *name;
+    Four        (*init)(void);                          /* start the engine */
+    void        (*final)(void);                         /* stop the engine; no request is in flight */
+    void        (*submit)(BfMIORequest **, Four);       /* start requests */
+    void        (*setBuffers)(struct iovec *, Four);    /* memory the buffers are read into and written from */
+} BfMIOEngine;
+
+/* type definition for requests whose completion is waited for together */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t done;
+    Four        nPending;       /* # of requests not over */
+    Four        result;         /* first error of the requests */
+} BfMIOBatch;
+
+/* states of a prefetch request */
+#define PREFETCH_FREE   0       /* the request is not used */
+#define PREFETCH_BUSY   1       /* being read */
+#define PREFETCH_DONE   2       /* read */
+#define PREFETCH_FAILED 3       /* the read failed */
+
+/* type definition for a read started by EduBfM_PrefetchTrains() or
+ * EduBfM_GetTrainAsync()
+ * The buffer stays fixed until the foreground completes the request.
+ */
+typedef struct {
+    Four        type;           /* buffer type */
+    Four        idx;            /* index of the buffer being read */
+    BfMHashKey  key;            /* train being read */
+    Four        state;          /* PREFETCH_xxx (protected by the prefetcher mutex) */
+    BfMIORequest req;           /* read of the train */
+    struct iovec iov;
+    BfMAsyncGet *waiters;       /* requests of EduBfM_GetTrainAsync() fixing the train when it is read */
+} BfMPrefetch;
+
+/* results of edubfm_StartAsync() */
+#define ASYNC_FIXED     0       /* the train has been fixed */
+#define ASYNC_PENDING   1       /* the request waits for the read of the train */
+#define ASYNC_DEFERRED  2       /* no read can be started before one of the pool is over */
+
+/* type definition for a buffer on the ring of an access strategy */
+typedef struct {
+    Four        idx;            /* buffer index (NIL if the slot is empty) */
+    BfMHashKey  key;            /* train the strategy loaded into the buffer */
+} BfMRingSlot;
+
+/* access strategy of a bulk scan
+ * The scan recycles the buffers on its ring instead of taking buffers
+ * from the buffer replacement policy. A strategy is used by one thread
+ * at a time.
+ */
+struct BfMAccessStrategy {
+    Four        type;           /* buffer type */
+    Four        size;           /* # of slots on the ring */
+    Four        current;        /* slot the next miss is loaded into */
+    BfMRingSlot *ring;
+};
+
+/* type definition for the counters of the buffer pools kept by a thread
+ * (see edubfm_Stats.c)
+ */
+typedef struct BfMThreadStats BfMThreadStats;
+struct BfMThreadStats {
+    BfMStats    pool[NUM_BUF_TYPES];    /* counters of each buffer pool */
+    Four        nUntilSample;           /* calls of EduBfM_GetTrain() until the next sampled one */
+    BfMThreadStats *prev;               /* links of the blocks of the running threads */
+    BfMThreadStats *next;
+};
+
+/* # of buffers whose EduBfM-private information is allocated together
+ * (see BufferChunk), and the most chunks a buffer pool may have
+ */
+#define BFM_CHUNK_SHIFT 12
+#define BFM_CHUNK_BUFS  (1 << BFM_CHUNK_SHIFT)
+#define BFM_MAX_CHUNKS  (BFM_MAX_POOL_BUFS / BFM_CHUNK_BUFS)
+
+/* type definition for the EduBfM-private information of BFM_CHUNK_BUFS
+ * buffers of a buffer pool. The chunks are allocated as the pool grows and
+ * never move, since the hits read them without the pool latch; the
+ * elements of the buffer table of the buffers in the buffer table of
+ * bufInfo[] are not used.
+ */
+typedef struct {
+    BufferTable table[BFM_CHUNK_BUFS];          /* buffer table of the buffers beyond nBaseBufs */
+    UEight      dirtyMap[BFM_CHUNK_BUFS / 64];  /* bit of each buffer set while it is dirty */
+    UFour       versions[BFM_CHUNK_BUFS];       /* version of each buffer, odd while the train is updated */
+    One         cleaned[BFM_CHUNK_BUFS];        /* TRUE if the buffer was cleaned by the background writer */
+    One         ioState[BFM_CHUNK_BUFS];        /* IO_xxx of each buffer */
+    pthread_rwlock_t contentLatches[BFM_CHUNK_BUFS];    /* content latch of each buffer */
+} BufferChunk;
+
+/* type definition for the EduBfM-private information of a buffer pool
+ * which is kept apart from BufferInfo since BufferInfo is shared with
+ * the rest of the storage system.
+ */
+typedef struct {
+    BfMConfig   cfg;            /* configuration parameters */
+    BfMPolicy   *policy;        /* buffer replacement policy (NULL if not initialized) */
+    void        *policyState;   /* state private to the policy */
+    BfMPageTable pageTable;     /* page table, i.e. the primary index of the buffer pool */
+    Four        nBufs;          /* # of buffers in this buffer pool */
+    Four        nBaseBufs;      /* # of buffers in the buffer table of bufInfo[] */
+    BufferChunk **chunks;       /* directory of BFM_MAX_CHUNKS chunks, NULL after the last one */
+    Four        nChunks;        /* # of chunks allocated */
+    char        *extFrames;     /* frames of the buffers beyond nBaseBufs */
+    size_t      extSize;        /* bytes mapped at extFrames */
+    char        *sysFrames;     /* frames of the buffer table allocated by the storage system if replaced */
+    size_t      framesSize;     /* bytes mapped at the frames of the buffer table if sysFrames is not NULL */
+    Four        pages;          /* BFM_PAGES_xxx backing the frames as far as it could be had */
+    Four        numaNodes;      /* # of NUMA nodes the frames are spread over (0: not bound) */
+    size_t      numaStride;     /* bytes of the frames bound to one node before the next */
+    Four        nextVictim;     /* clock hand of the second chance buffer replacement */
+    Four        *freeBufs;      /* stack of the buffers holding no train, room for the buffers of the chunks */
+    Four        nFreeBufs;      /* # of buffers in freeBufs */
+    Four        nDirty;         /* # of dirty buffers */
+    BfMLinks    cleanLinks;     /* links of the clean list */
+    BfMList     cleanList;      /* buffers holding a clean train, most recently cleaned first */
+    pthread_mutex_t cleanLatch; /* latch of the clean list */
+    void        *retiredFrames; /* frames replaced, kept for the optimistic reads until edubfm_FinalPool() */
+    Four        baseBufSize;    /* size of a buffer in pages given by the storage system */
+    Boolean     writerOn;       /* TRUE while the background writer serves this pool */
+    pthread_mutex_t latch;      /* pool latch */
+    pthread_cond_t writeDone;   /* signaled when an I/O done without the pool latch is over */
+    Four        nIOs;           /* # of reads of misses and write-backs of victims in flight */
+    pthread_mutex_t unpinLatch; /* latch of nUnpins */
+    pthread_cond_t unpinned;    /* signaled when a buffer is unpinned while a resize waits */
+    Four        nUnpinWaits;    /* # of resizes waiting for a buffer to be unpinned */
+    UFour       nUnpins;        /* # of times unpinned has been signaled */
+    BfMPrefetch prefetches[BFM_MAX_PREFETCHES];  /* reads started by EduBfM_PrefetchTrains() */
+    Four        nPrefetches;    /* # of prefetches not PREFETCH_FREE */
+} BufferExtInfo;
+
+/* Macro: BE_CFG(type)
+ * Description: return the configuration parameters of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (BfMConfig) configuration parameters
+ */
+#define BE_CFG(type)             (bufExt[type].cfg)
+
+/* Macro: BE_POLICY(type)
+ * Description: return the buffer replacement policy of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (BfMPolicy *) buffer replacement policy
+ */
+#define BE_POLICY(type)          (bufExt[type].policy)
+
+/* Macro: BE_POLICYSTATE(type)
+ * Description: return the state of the buffer replacement policy of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (void *) policy state
+ */
+#define BE_POLICYSTATE(type)     (bufExt[type].policyState)
+
+/* Macro: BE_PAGETABLE(type)
+ * Description: return the page table of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (BfMPageTable) page table
+ */
+#define BE_PAGETABLE(type)       (bufExt[type].pageTable)
+
+/* Macro: BE_NBUFS(type)
+ * Description: return the number of buffer elements of a buffer pool
+ *              (valid after the EduBfM-private information is built)
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) the number of buffer elements
+ */
+#define BE_NBUFS(type)           (bufExt[type].nBufs)
+
+/* Macro: BE_NBASEBUFS(type), BE_MAXBUFS(type)
+ * Description: return the number of buffer elements in the buffer table
+ *              of bufInfo[], and the number of buffer elements the buffer
+ *              pool may be resized to (BfMConfig.maxBufs)
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) the number of buffer elements
+ */
+#define BE_NBASEBUFS(type)       (bufExt[type].nBaseBufs)
+#define BE_MAXBUFS(type)         (bufExt[type].cfg.maxBufs)
+
+/* Macro: BE_CHUNKS(type), BE_NCHUNKS(type)
+ * Description: return the directory of the chunks of a buffer pool (NULL
+ *              while the EduBfM-private information is not built), and
+ *              the number of chunks allocated
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (BufferChunk **) directory, (Four) the number of chunks
+ */
+#define BE_CHUNKS(type)          (bufExt[type].chunks)
+#define BE_NCHUNKS(type)         (bufExt[type].nChunks)
+
+/* Macro: BE_CHUNK(type, idx), CHUNK_SLOT(idx)
+ * Description: return the chunk holding the EduBfM-private information of
+ *              a buffer, and the index of the buffer in its chunk
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (BufferChunk *) chunk, (Four) index in the chunk
+ */
+#define BE_CHUNK(type, idx)      (bufExt[type].chunks[(idx) >> BFM_CHUNK_SHIFT])
+#define CHUNK_SLOT(idx)          ((idx) & (BFM_CHUNK_BUFS - 1))
+
+/* Macro: BE_EXTFRAMES(type), BE_EXTSIZE(type)
+ * Description: return the frames of the buffers beyond BE_NBASEBUFS(type)
+ *              (NULL until the pool first grows), and the bytes mapped at
+ *              the frames
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (char *) frames, (size_t) bytes
+ */
+#define BE_EXTFRAMES(type)       (bufExt[type].extFrames)
+#define BE_EXTSIZE(type)         (bufExt[type].extSize)
+
+/* Macro: BE_SYSFRAMES(type), BE_FRAMESSIZE(type)
+ * Description: return the frames of the buffer table allocated by the
+ *              storage system, set aside while BI_BUFFERPOOL(type) points
+ *              to frames mapped by edubfm_Frames.c (NULL otherwise), and
+ *              the bytes mapped at BI_BUFFERPOOL(type) meanwhile
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (char *) frames, (size_t) bytes
+ */
+#define BE_SYSFRAMES(type)       (bufExt[type].sysFrames)
+#define BE_FRAMESSIZE(type)      (bufExt[type].framesSize)
+
+/* Macro: BE_PAGES(type), BE_NUMANODES(type), BE_NUMASTRIDE(type)
+ * Description: return the pages backing the frames of a buffer pool
+ *              (BFM_PAGES_xxx), the number of NUMA nodes the frames are
+ *              spread over, and the bytes of the frames bound to a node
+ *              before the next (see edubfm_Frames.c)
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) kind of pages, (Four) the number of nodes,
+ *          (size_t) bytes
+ */
+#define BE_PAGES(type)           (bufExt[type].pages)
+#define BE_NUMANODES(type)       (bufExt[type].numaNodes)
+#define BE_NUMASTRIDE(type)      (bufExt[type].numaStride)
+
+/* Macro: BE_NEXTVICTIM(type)
+ * Description: return the array index of the next buffer element to be
+ *              visited by the second chance buffer replacement
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) an array index of the next victim
+ */
+#define BE_NEXTVICTIM(type)      (bufExt[type].nextVictim)
+
+/* Macro: BE_FREEBUFS(type)
+ * Description: return the stack of the free buffers of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four *) array of buffer indices
+ */
+#define BE_FREEBUFS(type)        (bufExt[type].freeBufs)
+
+/* Macro: BE_NFREEBUFS(type)
+ * Description: return the number of free buffers of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) the number of free buffers
+ */
+#define BE_NFREEBUFS(type)       (bufExt[type].nFreeBufs)
+
+/* Macro: BE_NDIRTY(type)
+ * Description: return the number of dirty buffers of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) the number of dirty buffers
+ */
+#define BE_NDIRTY(type)          (bufExt[type].nDirty)
+
+/* Macro: BE_DIRTYMAP(type, w)
+ * Description: return a word of the dirty map of a buffer pool, a bitmap of
+ *              64 buffers per word whose bit is set while the buffer is
+ *              dirty; the words are kept in the chunks of the buffers
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four w          : index of the word, i.e. the buffer index / 64
+ * Returns: (UEight) word of the dirty map
+ */
+#define BE_DIRTYMAP(type, w) \
+    (bufExt[type].chunks[(w) >> (BFM_CHUNK_SHIFT - 6)]->dirtyMap[(w) & (BFM_CHUNK_BUFS / 64 - 1)])
+#define DIRTYMAP_BIT(idx)        ((UEight)1 << ((idx) % 64))
+
+/* Macro: BE_CLEANLIST(type), BE_CLEANLINKS(type), BE_CLEANLATCH(type)
+ * Description: return the clean list of a buffer pool, which holds the
+ *              buffers whose train has not been dirtied since it was read
+ *              or written, its link arrays, and the latch protecting both
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (BfMList) list, (BfMLinks) link arrays, (pthread_mutex_t) latch
+ */
+#define BE_CLEANLIST(type)       (bufExt[type].cleanList)
+#define BE_CLEANLINKS(type)      (bufExt[type].cleanLinks)
+#define BE_CLEANLATCH(type)      (bufExt[type].cleanLatch)
+
+/* Macro: IS_ON_CLEANLIST(type, idx)
+ * Description: return whether the buffer is on the clean list; read
+ *              without the latch of the list, it is only a hint
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (Boolean) TRUE or FALSE
+ */
+#define IS_ON_CLEANLIST(type, idx) \
+    (BE_CLEANLINKS(type).prev[idx] != NIL || BE_CLEANLIST(type).head == (idx))
+
+/* Macro: BE_CLEANED(type, idx)
+ * Description: return whether the buffer has been cleaned by the background
+ *              writer and not dirtied or replaced since
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (One) TRUE or FALSE
+ */
+#define BE_CLEANED(type, idx)    (BE_CHUNK(type, idx)->cleaned[CHUNK_SLOT(idx)])
+
+/* Macro: BE_VERSION(type, idx)
+ * Description: return the version of the buffer, which is advanced when
+ *              the buffer gets another train and is odd while the train
+ *              is latched in exclusive mode (see EduBfM_OptimisticRead())
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (UFour) version
+ */
+#define BE_VERSION(type, idx)    (BE_CHUNK(type, idx)->versions[CHUNK_SLOT(idx)])
+
+/* Macro: BE_RETIREDFRAMES(type)
+ * Description: return the list of the frames replaced by edubfm_Frames.c,
+ *              every one of which is kept until
+ *              edubfm_FinalPool() since an optimistic read may still be on it
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (void *) list of the frames (NULL if none)
+ */
+#define BE_RETIREDFRAMES(type)   (bufExt[type].retiredFrames)
+
+/* Macro: BE_BASEBUFSIZE(type)
+ * Description: return the size of a buffer in pages the storage system
+ *              gave the buffer pool, i.e. the size of a train of a volume
+ *              of pages of PAGESIZE (BI_BUFSIZE(type) is the size of the
+ *              frames, which BfMConfig.pageSize may make larger)
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) size in pages
+ */
+#define BE_BASEBUFSIZE(type)     (bufExt[type].baseBufSize)
+
+/* Macro: BE_WRITERON(type)
+ * Description: return whether the background writer serves a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Boolean) TRUE or FALSE
+ */
+#define BE_WRITERON(type)        (bufExt[type].writerOn)
+
+/* Macro: BE_LATCH(type)
+ * Description: return the latch of a buffer pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (pthread_mutex_t) latch
+ */
+#define BE_LATCH(type)           (bufExt[type].latch)
+
+/* Macro: BE_WRITEDONE(type)
+ * Description: return the condition signaled at the end of each write of
+ *              the background writer, and of each read of a miss and
+ *              write-back of a victim done without the pool latch
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (pthread_cond_t) condition variable
+ */
+#define BE_WRITEDONE(type)       (bufExt[type].writeDone)
+
+/* Macro: BE_NIOS(type)
+ * Description: return the number of reads of misses and write-backs of
+ *              victims in flight without the pool latch
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) the number of I/Os (protected by the pool latch)
+ */
+#define BE_NIOS(type)            (bufExt[type].nIOs)
+
+/* Macro: BE_UNPINLATCH(type), BE_UNPINNED(type), BE_NUNPINWAITS(type), BE_NUNPINS(type)
+ * Description: return the latch and the condition by which a resize of a
+ *              buffer pool waits for the buffers to be removed to be
+ *              unpinned, the number of resizes waiting, and the number of
+ *              times the condition has been signaled (see
+ *              edubfm_Unpinned())
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (pthread_mutex_t) latch, (pthread_cond_t) condition variable,
+ *          (Four) the number of resizes, (UFour) the number of signals
+ */
+#define BE_UNPINLATCH(type)      (bufExt[type].unpinLatch)
+#define BE_UNPINNED(type)        (bufExt[type].unpinned)
+#define BE_NUNPINWAITS(type)     (bufExt[type].nUnpinWaits)
+#define BE_NUNPINS(type)         (bufExt[type].nUnpins)
+
+/* Macro: BE_IOSTATE(type, idx)
+ * Description: return the I/O state of a buffer (IO_xxx)
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (One) I/O state
+ */
+#define BE_IOSTATE(type, idx)    (BE_CHUNK(type, idx)->ioState[CHUNK_SLOT(idx)])
+
+/* Macro: BE_CONTENTLATCH(type, idx)
+ * Description: return the content latch of a buffer
+ *              (see EduBfM_LatchTrain())
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four idx        : array index of the buffer element
+ * Returns: (pthread_rwlock_t) content latch
+ */
+#define BE_CONTENTLATCH(type, idx)  (BE_CHUNK(type, idx)->contentLatches[CHUNK_SLOT(idx)])
+
+/* Macro: BE_PREFETCH(type, i)
+ * Description: return a prefetch request of a buffer pool
+ * Parameters:
+ *  Four type       : buffer type
+ *  Four i          : index of the request (0 ~ BFM_MAX_PREFETCHES-1)
+ * Returns: (BfMPrefetch) prefetch request
+ */
+#define BE_PREFETCH(type, i)     (bufExt[type].prefetches[i])
+
+/* Macro: BE_NPREFETCHES(type)
+ * Description: return the number of prefetch requests in use
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) the number of requests
+ */
+#define BE_NPREFETCHES(type)     (bufExt[type].nPrefetches)
+
+/* Macro: BE_MAXPREFETCHES(type)
+ * Description: return the maximum number of reads in flight started by
+ *              EduBfM_PrefetchTrains() and EduBfM_GetTrainAsync(), which
+ *              fix at most half of the pool
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (Four) the number of requests
+ */
+#define BE_MAXPREFETCHES(type)   ((BE_NBUFS(type) / 2 < BFM_MAX_PREFETCHES) ? BE_NBUFS(type) / 2 : BFM_MAX_PREFETCHES)
+
+/* Macro: BFM_LATCH(type), BFM_UNLATCH(type)
+ * Description: acquire/release the latch of a buffer pool. It serializes
+ *              the misses, the replacement policy, the free buffer list,
+ *              and the changes of the page table and the hash chains. A
+ *              hit only takes the latch of its page table partition
+ *              unless the policy has an 'access' hook.
+ * Parameter:
+ *  Four type       : buffer type
+ * BFM_LATCH counts the waits for the latch held by another thread.
+ */
+#define BFM_LATCH(type) \
+BEGIN_MACRO \
+    if (pthread_mutex_trylock(&BE_LATCH(type)) != 0) { \
+        BFM_COUNT(type, nLatchWaits); \
+        pthread_mutex_lock(&BE_LATCH(type)); \
+    } \
+END_MACRO
+#define BFM_UNLATCH(type)        pthread_mutex_unlock(&BE_LATCH(type))
+
+/* Macro: ERR_UNLATCH(e, type)
+ * Description: release the latch of a buffer pool and return the error
+ * Parameters:
+ *  Four e          : error code
+ *  Four type       : buffer type
+ */
+#define ERR_UNLATCH(e, type) \
+BEGIN_MACRO \
+    BFM_UNLATCH(type); ERR(e); \
+END_MACRO
+
+/* Macro: RDSM_LATCH(), RDSM_UNLATCH()
+ * Description: acquire/release the latch serializing the reads and the
+ *              writes of EduBfM by RDsM, which seeks the descriptor of
+ *              the volume before it reads or writes, since they are made
+ *              without the pool latch too
+ */
+#define RDSM_LATCH()             pthread_mutex_lock(&edubfm_rdsmLatch)
+#define RDSM_UNLATCH()           pthread_mutex_unlock(&edubfm_rdsmLatch)
+
+/* Macro: BE_MYSTATS(type)
+ * Description: return the counters of a buffer pool kept by the calling
+ *              thread (see edubfm_Stats.c)
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: (BfMStats) counters of the thread
+ */
+#define BE_MYSTATS(type) \
+    ((edubfm_myStats != NULL ? edubfm_myStats : edubfm_NewThreadStats())->pool[type])
+
+/* Macro: BFM_COUNT(type, counter), BFM_COUNT_N(type, counter, n),
+ *        BFM_COUNT_VALUE(type, hist, v)
+ * Description: add 1 or n to a counter of the calling thread, or count
+ *              the value v in a histogram of the calling thread. Only the
+ *              thread writes its counters, so no atomic read-modify-write
+ *              is needed; the stores are atomic for EduBfM_GetStats()
+ *              reading them at the same time.
+ * Parameters:
+ *  Four type       : buffer type
+ *  counter, hist   : field of BfMStats
+ */
+#define BFM_COUNT_N(type, counter, n) \
+BEGIN_MACRO \
+    UEight *_c = &BE_MYSTATS(type).counter; \
+    __atomic_store_n(_c, __atomic_load_n(_c, __ATOMIC_RELAXED) + (n), __ATOMIC_RELAXED); \
+END_MACRO
+#define BFM_COUNT(type, counter)        BFM_COUNT_N(type, counter, 1)
+#define BFM_COUNT_VALUE(type, hist, v)  edubfm_CountValue(BE_MYSTATS(type).hist, (v))
+
+/* Macro: IS_POOL_INITIALIZED(type)
+ * Description: check whether the EduBfM-private information of a buffer pool is built
+ * Parameter:
+ *  Four type       : buffer type
+ * Returns: TRUE(1) if it is built, otherwise FALSE(0)
+ */
+#define IS_POOL_INITIALIZED(type) (BE_POLICY(type) != NULL)
+
+/* type definition for a volume attached by EduBfM_AttachVolume()
+ * EduBfM opens the device of the volume by itself so that it can read and
+ * write trains at their offsets (pageNo * PAGESIZE) without going through
+ * the storage system, e.g. from the background writer.
+ */
+typedef struct {
+    VolNo       volNo;          /* volume number (NIL if the entry is not used) */
+    Four        fd;             /* file descriptor of the device */
+    Four        directFd;       /* file descriptor opened for the direct I/O (NIL if not supported) */
+} BfMDevice;
+
+/* calls recorded in the trace of the buffer accesses (see edubfm_Trace.c) */
+#define BFM_TRACE_GET           0       /* EduBfM_GetTrain() */
+#define BFM_TRACE_FREE          1       /* EduBfM_FreeTrain() */
+#define BFM_TRACE_DIRTY         2       /* EduBfM_SetDirty() */
+
+/* first word of a trace file */
+#define BFM_TRACE_MAGIC         0x42664d54
+
+/* type definition for the header of a trace file, followed by the records */
+typedef struct {
+    Four        magic;                  /* BFM_TRACE_MAGIC */
+    Four        bufSize[NUM_BUF_TYPES]; /* size of a buffer of each pool in pages */
+} BfMTraceHeader;
+
+/* type definition for a call recorded in the trace */
+typedef struct {
+    PageNo      pageNo;         /* train */
+    VolNo       volNo;
+    One         type;           /* buffer type */
+    One         op;             /* BFM_TRACE_xxx */
+} BfMTraceRecord;
+
+/* Macro: BFM_TRACE(op, key, type)
+ * Description: record a call in the trace of the buffer accesses if one
+ *              is captured (see EduBfM_SetTrace())
+ * Parameters:
+ *  Four op         : BFM_TRACE_xxx
+ *  BfMHashKey *key : train
+ *  Four type       : buffer type
+ */
+#define BFM_TRACE(op, key, type) \
+BEGIN_MACRO \
+    if (__atomic_load_n(&edubfm_tracing, __ATOMIC_RELAXED)) edubfm_Trace((op), (BfMHashKey *)(key), (type)); \
+END_MACRO
+
+extern BufferExtInfo bufExt[];
+extern BfMPolicy *edubfm_policies[];
+extern BfMDevice edubfm_devices[];
+extern pthread_mutex_t edubfm_rdsmLatch;
+extern __thread BfMThreadStats *edubfm_myStats;
+extern Four edubfm_tracing;
+
 /*@
  * Function Prototypes
  */
@@ -261,10 +1091,172 @@ extern BufferInfo bufInfo[];
 Four edubfm_AllocTrain(Four);
 Four edubfm_Delete(BfMHashKey *, Four);
 Four edubfm_DeleteAll(void);
+Four edubfm_DeletePool(Four, Four **, Four *);
+Four edubfm_SetShared(Four, Four);
 Four edubfm_FlushTrain(TrainID *, Four);
-Four edubfm_Insert(BfMHashKey *, Two, Four); 
+Four edubfm_FlushVictim(Four, Four);
+Four edubfm_FlushPool(Four);
+Four edubfm_Insert(BfMHashKey *, Four, Four); 
 Four edubfm_LookUp(BfMHashKey *, Four);
+Four edubfm_FastLookUp(BfMHashKey *, Four);
+Four edubfm_Fix(BfMHashKey *, Four);
+Four edubfm_FixAt(BfMHashKey *, Four, UFour, Four);
+void edubfm_Referred(Four, Four);
+Four edubfm_Unfix(BfMHashKey *, Four, Two *);
+Boolean edubfm_ClaimVictim(Four, Four);
+Boolean edubfm_UnmapVictim(Four, Four);
+Boolean edubfm_HoldFrame(Four, Four, One *);
 Four edubfm_ReadTrain(TrainID *, char *, Four);
+Boolean edubfm_ReadCached(TrainID *, char *, Four);
+Four edubfm_ReadVolume(TrainID *, char *, Four);
+Four edubfm_InitPool(Four);
+Four edubfm_ResetPool(Four);
+Four edubfm_EmptyPool(Four);
+void edubfm_FinalPool(Four);
+Four edubfm_GrowPool(Four, Four);
+Four edubfm_ShrinkPool(Four, Four);
+Four edubfm_ChainLookUp(BfMHashKey *, Four);
+void edubfm_PushFreeBuf(Four, Four);
+Four edubfm_PopFreeBuf(Four);
+void edubfm_CountDirty(Four);
+Boolean edubfm_MarkDirty(Four, Four);
+Boolean edubfm_MarkClean(Four, Four);
+Four edubfm_NextDirty(Four, Four, Four);
+void edubfm_CleanInsert(Four, Four);
+void edubfm_CleanRemove(Four, Four);
+Four edubfm_CleanVictim(Four);
+void edubfm_Unpinned(Four);
+Boolean edubfm_WaitUnpinned(Four, UFour, struct timespec *);
+
+/* background writer */
+Four edubfm_StartWriter(void);
+void edubfm_StopWriter(void);
+void edubfm_KickWriter(Four);
+void edubfm_WaitWriter(Four, Four);
+
+/* read-ahead */
+Four edubfm_StartRead(TrainID *, Four);
+Four edubfm_StartPrefetch(Four, Four);
+void edubfm_ReapPrefetches(Four, Boolean);
+void edubfm_WaitPrefetch(Four, Four);
+void edubfm_StopPrefetcher(void);
+void edubfm_AddPrefetchWaiter(Four, Four, BfMAsyncGet *);
+Boolean edubfm_IsPrefetching(Four, Four);
+UEight edubfm_PrefetchEpoch(void);
+BfMAsyncGet *edubfm_TakeCompleted(BfMAsyncQueue *, UEight, Boolean);
+
+/* fixes of EduBfM_GetTrainAsync() */
+Four edubfm_StartAsync(BfMAsyncGet *);
+
+/* rings of the access strategies */
+Four edubfm_RingAlloc(BfMAccessStrategy *);
+void edubfm_RingAdd(BfMAccessStrategy *, Four);
+Boolean edubfm_RingHit(BfMAccessStrategy *, Four);
+
+/* pages and NUMA nodes backing the frames */
+Four edubfm_RemapFrames(Four, Four, Four);
+Four edubfm_AlignFrames(Four);
+Four edubfm_ResizeFrames(Four, Four);
+Four edubfm_ReserveFrames(Four, Four);
+Four edubfm_MapFrames(Four, size_t, char **, size_t *);
+void edubfm_GiveBackFrames(Four);
+void edubfm_FreeRetiredFrames(Four);
+Four edubfm_NumaNodes(void);
+void edubfm_LocalFreeBufFirst(Four);
+
+/* memory budget shared by the buffer pools */
+Four edubfm_SetBudget(Four);
+Boolean edubfm_BalanceMiss(Four, BfMHashKey *);
+void edubfm_BalanceEvict(Four, Four);
+void edubfm_Balance(void);
+
+/* warm-up of the buffer pools across restarts */
+Four edubfm_SetWarmUpFile(char *);
+Four edubfm_SaveWarmUp(void);
+Four edubfm_LoadWarmUp(VolNo);
+
+/* trace of the buffer accesses */
+Four edubfm_StartTrace(char *);
+Four edubfm_StopTrace(void);
+void edubfm_Trace(Four, BfMHashKey *, Four);
+
+/* compressed cache of the evicted trains */
+Four edubfm_SetZCache(Four);
+void edubfm_ZCacheInsert(Four, BfMHashKey *, char *);
+Boolean edubfm_ZCacheLookUp(Four, BfMHashKey *, char *);
+void edubfm_ZCacheDelete(BfMHashKey *);
+void edubfm_ZCacheClear(void);
+void edubfm_ZCacheUsage(Four *, Eight *, Eight *);
+Four edubfm_Compress(char *, Four, char *, Four);
+Boolean edubfm_Decompress(char *, Four, char *, Four);
+
+/* extension files of the buffer pools */
+Four edubfm_SetExtension(Four, char *, Four);
+void edubfm_ExtensionInsert(Four, BfMHashKey *, char *);
+Boolean edubfm_ExtensionLookUp(Four, BfMHashKey *, char *);
+void edubfm_ExtensionDelete(Four, BfMHashKey *);
+void edubfm_ExtensionClear(Four);
+Four edubfm_ExtensionUsage(Four);
+
+/* statistics */
+BfMThreadStats *edubfm_NewThreadStats(void);
+void edubfm_SumStats(Four, BfMStats *);
+UEight edubfm_Now(void);
+UEight edubfm_SampleStart(void);
+void edubfm_CountValue(UEight *, UEight);
+
+/* devices of the attached volumes */
+BfMDevice *edubfm_FindDevice(VolNo);
+Four edubfm_DeviceFd(BfMDevice *, Four);
+Four edubfm_DeviceIO(BfMDevice *, Four, Four, PageNo, Four, char *);
+
+/* page sizes of the volumes */
+Four edubfm_SetPageSize(VolNo, Four);
+Four edubfm_TrainPages(Four, VolNo);
+Four edubfm_CheckTrain(Four, TrainID *);
+
+/* I/O engines */
+Four edubfm_SelectIOEngine(Four);
+void edubfm_StopIOEngine(void);
+void edubfm_IOSubmit(BfMIORequest **, Four);
+void edubfm_IOSetBuffers(void);
+void edubfm_IODo(BfMIORequest *, size_t);
+void edubfm_IODone(BfMIORequest *);
+void edubfm_IOBatchInit(BfMIOBatch *);
+void edubfm_IOBatchAdd(BfMIOBatch *, BfMIORequest *);
+Four edubfm_IOBatchWait(BfMIOBatch *);
+
+/* page table */
+Four edubfm_PageTableInit(BfMPageTable *, Four);
+void edubfm_PageTableFinal(BfMPageTable *);
+void edubfm_PageTableClear(BfMPageTable *);
+Four edubfm_PageTableTake(BfMPageTable *, Four *);
+Four edubfm_PageTableLookUp(BfMPageTable *, BfMHashKey *);
+Four edubfm_PageTableInsert(BfMPageTable *, BfMHashKey *, Four);
+Four edubfm_PageTableDelete(BfMPageTable *, BfMHashKey *);
+pthread_mutex_t *edubfm_PageTableLatch(BfMPageTable *, BfMHashKey *);
+Four edubfm_PageTableProbe(BfMPageTable *, BfMHashKey *);
+
+/* list, key map, and ghost directory used by the replacement policies */
+void edubfm_ListInit(BfMList *);
+void edubfm_ListInsertHead(BfMLinks *, BfMList *, Four);
+void edubfm_ListRemove(BfMLinks *, BfMList *, Four);
+Four edubfm_ListUnfixedTail(Four, BfMLinks *, BfMList *);
+Four edubfm_ListVictim(Four, BfMLinks *, BfMList *);
+Four edubfm_LinksInit(BfMLinks *, Four);
+Four edubfm_LinksGrow(BfMLinks *, Four, Four);
+void edubfm_LinksFinal(BfMLinks *);
+Four edubfm_MapInit(BfMKeyMap *, Four);
+void edubfm_MapFinal(BfMKeyMap *);
+Four edubfm_MapLookUp(BfMKeyMap *, BfMHashKey *);
+void edubfm_MapInsert(BfMKeyMap *, BfMHashKey *, Four);
+void edubfm_MapDelete(BfMKeyMap *, Four);
+Four edubfm_GhostInit(BfMGhostDir *, Four, Four);
+void edubfm_GhostFinal(BfMGhostDir *);
+Four edubfm_GhostLookUp(BfMGhostDir *, BfMHashKey *);
+Four edubfm_GhostInsert(BfMGhostDir *, Four, BfMHashKey *);
+void edubfm_GhostDelete(BfMGhostDir *, Four);
+void edubfm_GhostTrim(BfMGhostDir *, Four, Four);
 
 
 #endif /* _EDUBFM_INTERNAL_H_ */
@@ -121,3 +121,13 @@
 #define eNOMORELOCKCONTROLBLOCKS_BFM             ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,59)
 #define NUM_ERRORS_BFM_ERR_BASE                  60
 #define eNOTSUPPORTED_EDUBFM		             ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,61)
+#define eBADPARAMETER_EDUBFM                     ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,62)
+#define eMEMORYALLOCERR_EDUBFM                   ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,63)
+#define eNOTATTACHEDVOLUME_EDUBFM                ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,64)
+#define eDEVICEIOERR_EDUBFM                      ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,65)
+#define eTHREADCREATEERR_EDUBFM                  ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,66)
+#define eRESIZEFIXEDBUF_EDUBFM                   ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,67)
+#define eREMAPFIXEDBUF_EDUBFM                    ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,68)
+#define eBADWARMUPFILE_EDUBFM                    ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,69)
+#define eREADCONFLICT_EDUBFM                     ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,70)
+#define eBADPAGESIZE_EDUBFM                      ERR_ENCODE_ERROR_CODE(BFM_ERR_BASE,71)
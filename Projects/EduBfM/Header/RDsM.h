@@ -52,6 +52,9 @@
 
 Four	RDsM_ReadTrain(PageID *, char *, Two);
 Four	RDsM_WriteTrain(char *, PageID *, Two);
+Four	RDsM_CreateSegment(Four, Four *);
+Four	RDsM_ExtNoToPageId(Four, Four, PageID *);
+Four	RDsM_AllocTrains(Four, Four, PageID *, Two, Four, Two, PageID *);
 
 
 #endif /* _RDsM_H_ */
@@ -0,0 +1,429 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_2Q.c
+ *
+ * Description:
+ *  2Q buffer replacement policy (Johnson and Shasha, VLDB 1994).
+ *  A train read for the first time enters A1in, a FIFO queue of about a
+ *  quarter of the buffers. When it is replaced from A1in, its key is
+ *  remembered in A1out. Only a train requested again while its key is in
+ *  A1out is admitted into Am, an LRU list holding the rest of the pool.
+ *  A sequential scan therefore cycles through A1in and cannot push the
+ *  frequently used trains out of Am.
+ *
+ * Exports:
+ *  BfMPolicy edubfm_2QPolicy
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* where a buffer is */
+#define Q_NONE          0       /* being replaced */
+#define Q_FREE          1       /* in the free list */
+#define Q_A1IN          2       /* in A1in */
+#define Q_AM            3       /* in Am */
+
+/* size of A1in and A1out in percentage of the number of buffers */
+#define Q_KIN_PERCENT   25
+#define Q_KOUT_PERCENT  50
+
+/* type definition for the state of the 2Q policy */
+typedef struct {
+    Four        nBufs;          /* # of buffers */
+    Four        kIn;            /* target size of A1in */
+    Four        kOut;           /* maximum size of A1out */
+    One         *where;         /* Q_xxx */
+    BfMLinks    links;
+    BfMList     freeList;       /* buffers holding no train */
+    BfMList     a1in;           /* FIFO of trains read once */
+    BfMList     am;             /* LRU of trains read again */
+    BfMGhostDir a1out;          /* keys of trains replaced from A1in */
+    One         pending;        /* queue which the train being loaded enters */
+} TwoQState;
+
+#define STATE(type)     ((TwoQState *)BE_POLICYSTATE(type))
+
+
+static void twoq_Final(Four);
+
+
+
+/*@================================
+ * twoq_Init()
+ *================================*/
+/*
+ * Function: Four twoq_Init(Four)
+ *
+ * Description:
+ *  Build the 2Q state. Trains already in the buffer pool enter A1in.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four twoq_Init(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                i;
+    TwoQState           *s;
+
+
+    s = (TwoQState *)calloc(1, sizeof(TwoQState));
+    if (s == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    BE_POLICYSTATE(type) = s;
+
+    s->nBufs = BE_NBUFS(type);
+    s->kIn = s->nBufs * Q_KIN_PERCENT / 100;
+    s->kOut = s->nBufs * Q_KOUT_PERCENT / 100;
+    if (s->kIn < 1) s->kIn = 1;
+    if (s->kOut < 1) s->kOut = 1;
+
+    s->where = (One *)malloc(sizeof(One) * s->nBufs);
+    if (s->where == NULL) {
+        twoq_Final(type);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    e = edubfm_LinksInit(&s->links, s->nBufs);
+    if (e < eNOERROR) {
+        twoq_Final(type);
+        ERR(e);
+    }
+
+    e = edubfm_GhostInit(&s->a1out, s->kOut, 0);
+    if (e < eNOERROR) {
+        twoq_Final(type);
+        ERR(e);
+    }
+
+    edubfm_ListInit(&s->freeList);
+    edubfm_ListInit(&s->a1in);
+    edubfm_ListInit(&s->am);
+    for (i = 0; i < s->nBufs; i++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i))) {
+            s->where[i] = Q_FREE;
+            edubfm_ListInsertHead(&s->links, &s->freeList, i);
+        }
+        else {
+            s->where[i] = Q_A1IN;
+            edubfm_ListInsertHead(&s->links, &s->a1in, i);
+        }
+    }
+
+    return(eNOERROR);
+
+} /* twoq_Init() */
+
+
+
+/*@================================
+ * twoq_Final()
+ *================================*/
+/*
+ * Function: void twoq_Final(Four)
+ *
+ * Description:
+ *  Release the 2Q state.
+ *
+ * Returns:
+ *  None
+ */
+static void twoq_Final(
+    Four                type)           /* IN buffer type */
+{
+    TwoQState           *s = STATE(type);
+
+
+    if (s == NULL) return;
+
+    if (s->links.prev != NULL) edubfm_LinksFinal(&s->links);
+    if (s->a1out.listNo != NULL) edubfm_GhostFinal(&s->a1out);
+    free(s->where);
+    free(s);
+
+    BE_POLICYSTATE(type) = NULL;
+
+} /* twoq_Final() */
+
+
+
+/*@================================
+ * twoq_Access()
+ *================================*/
+/*
+ * Function: void twoq_Access(Four, Four)
+ *
+ * Description:
+ *  A train in Am moves to the head of Am.
+ *  A train in A1in stays where it is; re-references within A1in are
+ *  regarded as correlated references.
+ *
+ * Returns:
+ *  None
+ */
+static void twoq_Access(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    TwoQState           *s = STATE(type);
+
+
+    switch (s->where[idx]) {
+      case Q_AM:
+        edubfm_ListRemove(&s->links, &s->am, idx);
+        edubfm_ListInsertHead(&s->links, &s->am, idx);
+        break;
+
+      case Q_FREE:
+        /* a train loaded behind the policy's back; adopt it */
+        edubfm_ListRemove(&s->links, &s->freeList, idx);
+        edubfm_ListInsertHead(&s->links, &s->a1in, idx);
+        s->where[idx] = Q_A1IN;
+        break;
+    }
+
+} /* twoq_Access() */
+
+
+
+/*@================================
+ * twoq_Miss()
+ *================================*/
+/*
+ * Function: void twoq_Miss(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Decide the queue of the train to be loaded: Am if its key is in A1out,
+ *  otherwise A1in.
+ *
+ * Returns:
+ *  None
+ */
+static void twoq_Miss(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key)           /* IN train to be loaded */
+{
+    TwoQState           *s = STATE(type);
+    Four                node;
+
+
+    node = edubfm_GhostLookUp(&s->a1out, key);
+    if (node != NIL) {
+        edubfm_GhostDelete(&s->a1out, node);
+        s->pending = Q_AM;
+    }
+    else
+        s->pending = Q_A1IN;
+
+} /* twoq_Miss() */
+
+
+
+/*@================================
+ * twoq_Victim()
+ *================================*/
+/*
+ * Function: Four twoq_Victim(Four)
+ *
+ * Description:
+ *  Select an unfixed free buffer if any. Otherwise select the tail of
+ *  A1in if A1in is larger than its target size, or the tail of Am,
+ *  a clean buffer near the tail being preferred to a dirty one (see
+ *  edubfm_ListVictim()). If the chosen queue has no unfixed buffer, the
+ *  other one is used.
+ *
+ * Returns:
+ *  1) index of the selected buffer
+ *  2) eNOUNFIXEDBUF_BFM - There is no unfixed buffer.
+ */
+static Four twoq_Victim(
+    Four                type)           /* IN buffer type */
+{
+    TwoQState           *s = STATE(type);
+    Four                victim;
+
+
+    victim = edubfm_ListUnfixedTail(type, &s->links, &s->freeList);
+    if (victim != NIL) return(victim);
+
+    if (s->a1in.len > s->kIn) {
+        victim = edubfm_ListVictim(type, &s->links, &s->a1in);
+        if (victim == NIL) victim = edubfm_ListVictim(type, &s->links, &s->am);
+    }
+    else {
+        victim = edubfm_ListVictim(type, &s->links, &s->am);
+        if (victim == NIL) victim = edubfm_ListVictim(type, &s->links, &s->a1in);
+    }
+
+    return((victim != NIL) ? victim : eNOUNFIXEDBUF_BFM);
+
+} /* twoq_Victim() */
+
+
+
+/*@================================
+ * twoq_Evict()
+ *================================*/
+/*
+ * Function: void twoq_Evict(Four, Four)
+ *
+ * Description:
+ *  Unlink the buffer being replaced. The key of a train replaced from
+ *  A1in is remembered in A1out.
+ *
+ * Returns:
+ *  None
+ */
+static void twoq_Evict(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    TwoQState           *s = STATE(type);
+
+
+    switch (s->where[idx]) {
+      case Q_FREE:
+        edubfm_ListRemove(&s->links, &s->freeList, idx);
+        break;
+
+      case Q_A1IN:
+        edubfm_ListRemove(&s->links, &s->a1in, idx);
+        if (!IS_NILBFMHASHKEY(BI_KEY(type, idx)))
+            edubfm_GhostInsert(&s->a1out, 0, &BI_KEY(type, idx));
+        break;
+
+      case Q_AM:
+        edubfm_ListRemove(&s->links, &s->am, idx);
+        break;
+    }
+
+    s->where[idx] = Q_NONE;
+
+} /* twoq_Evict() */
+
+
+
+/*@================================
+ * twoq_Admit()
+ *================================*/
+/*
+ * Function: void twoq_Admit(Four, Four)
+ *
+ * Description:
+ *  Insert the buffer holding the loaded train into the decided queue.
+ *
+ * Returns:
+ *  None
+ */
+static void twoq_Admit(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    TwoQState           *s = STATE(type);
+
+
+    s->where[idx] = s->pending;
+    edubfm_ListInsertHead(&s->links, (s->pending == Q_AM) ? &s->am : &s->a1in, idx);
+
+} /* twoq_Admit() */
+
+
+
+/*@================================
+ * twoq_Release()
+ *================================*/
+/*
+ * Function: void twoq_Release(Four, Four)
+ *
+ * Description:
+ *  Return the buffer to the free list. A buffer still holding a train,
+ *  e.g. one emptied by EduBfM_DiscardAll(), leaves its list without
+ *  leaving a ghost.
+ *
+ * Returns:
+ *  None
+ */
+static void twoq_Release(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    TwoQState           *s = STATE(type);
+
+
+    switch (s->where[idx]) {
+      case Q_FREE:
+        return;
+
+      case Q_A1IN:
+        edubfm_ListRemove(&s->links, &s->a1in, idx);
+        break;
+
+      case Q_AM:
+        edubfm_ListRemove(&s->links, &s->am, idx);
+        break;
+    }
+
+    s->where[idx] = Q_FREE;
+    edubfm_ListInsertHead(&s->links, &s->freeList, idx);
+
+} /* twoq_Release() */
+
+
+BfMPolicy edubfm_2QPolicy = {
+    "2Q",
+    twoq_Init, twoq_Final, twoq_Access, twoq_Miss,
+    twoq_Victim, twoq_Evict, twoq_Admit, twoq_Release
+};
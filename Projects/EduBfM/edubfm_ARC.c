@@ -0,0 +1,455 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_ARC.c
+ *
+ * Description:
+ *  Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *  T1 holds trains referenced once recently and T2 trains referenced at
+ *  least twice; B1 and B2 remember the keys of trains replaced from T1
+ *  and T2. A miss on a key in B1 (B2) enlarges (shrinks) the target size
+ *  'p' of T1, so the split between recency and frequency follows the
+ *  workload. A sequential scan only fills T1 and cannot flush T2.
+ *
+ * Exports:
+ *  BfMPolicy edubfm_arcPolicy
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* where a buffer is */
+#define ARC_NONE        0       /* being replaced */
+#define ARC_FREE        1       /* in the free list */
+#define ARC_T1          2       /* in T1 */
+#define ARC_T2          3       /* in T2 */
+
+/* ghost lists */
+#define ARC_B1          0
+#define ARC_B2          1
+
+/* type definition for the state of the ARC policy */
+typedef struct {
+    Four        nBufs;          /* # of buffers, 'c' in the paper */
+    Four        p;              /* target size of T1 */
+    One         *where;         /* ARC_xxx */
+    BfMLinks    links;
+    BfMList     freeList;       /* buffers holding no train */
+    BfMList     t1;             /* LRU of trains referenced once */
+    BfMList     t2;             /* LRU of trains referenced more than once */
+    BfMGhostDir ghost;          /* B1 and B2 */
+    One         pending;        /* list which the train being loaded enters */
+    Boolean     pendingInB2;    /* TRUE if the train being loaded was found in B2 */
+} ARCState;
+
+#define STATE(type)     ((ARCState *)BE_POLICYSTATE(type))
+#define B1(s)           ((s)->ghost.list[ARC_B1])
+#define B2(s)           ((s)->ghost.list[ARC_B2])
+
+
+static void arc_Final(Four);
+
+
+
+/*@================================
+ * arc_Init()
+ *================================*/
+/*
+ * Function: Four arc_Init(Four)
+ *
+ * Description:
+ *  Build the ARC state. Trains already in the buffer pool enter T1.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four arc_Init(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                i;
+    ARCState            *s;
+
+
+    s = (ARCState *)calloc(1, sizeof(ARCState));
+    if (s == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    BE_POLICYSTATE(type) = s;
+
+    s->nBufs = BE_NBUFS(type);
+    s->p = 0;
+
+    s->where = (One *)malloc(sizeof(One) * s->nBufs);
+    if (s->where == NULL) {
+        arc_Final(type);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    e = edubfm_LinksInit(&s->links, s->nBufs);
+    if (e < eNOERROR) {
+        arc_Final(type);
+        ERR(e);
+    }
+
+    /* |B1| + |B2| never exceeds c */
+    e = edubfm_GhostInit(&s->ghost, s->nBufs, 0);
+    if (e < eNOERROR) {
+        arc_Final(type);
+        ERR(e);
+    }
+
+    edubfm_ListInit(&s->freeList);
+    edubfm_ListInit(&s->t1);
+    edubfm_ListInit(&s->t2);
+    for (i = 0; i < s->nBufs; i++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i))) {
+            s->where[i] = ARC_FREE;
+            edubfm_ListInsertHead(&s->links, &s->freeList, i);
+        }
+        else {
+            s->where[i] = ARC_T1;
+            edubfm_ListInsertHead(&s->links, &s->t1, i);
+        }
+    }
+
+    return(eNOERROR);
+
+} /* arc_Init() */
+
+
+
+/*@================================
+ * arc_Final()
+ *================================*/
+/*
+ * Function: void arc_Final(Four)
+ *
+ * Description:
+ *  Release the ARC state.
+ *
+ * Returns:
+ *  None
+ */
+static void arc_Final(
+    Four                type)           /* IN buffer type */
+{
+    ARCState            *s = STATE(type);
+
+
+    if (s == NULL) return;
+
+    if (s->links.prev != NULL) edubfm_LinksFinal(&s->links);
+    if (s->ghost.listNo != NULL) edubfm_GhostFinal(&s->ghost);
+    free(s->where);
+    free(s);
+
+    BE_POLICYSTATE(type) = NULL;
+
+} /* arc_Final() */
+
+
+
+/*@================================
+ * arc_Access()
+ *================================*/
+/*
+ * Function: void arc_Access(Four, Four)
+ *
+ * Description:
+ *  A referenced train moves to the head of T2 (case I of the paper).
+ *
+ * Returns:
+ *  None
+ */
+static void arc_Access(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    ARCState            *s = STATE(type);
+
+
+    switch (s->where[idx]) {
+      case ARC_T1:
+        edubfm_ListRemove(&s->links, &s->t1, idx);
+        break;
+
+      case ARC_T2:
+        edubfm_ListRemove(&s->links, &s->t2, idx);
+        break;
+
+      case ARC_FREE:
+        /* a train loaded behind the policy's back; adopt it */
+        edubfm_ListRemove(&s->links, &s->freeList, idx);
+        break;
+
+      default:
+        return;
+    }
+
+    s->where[idx] = ARC_T2;
+    edubfm_ListInsertHead(&s->links, &s->t2, idx);
+
+} /* arc_Access() */
+
+
+
+/*@================================
+ * arc_Miss()
+ *================================*/
+/*
+ * Function: void arc_Miss(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Adapt the target size of T1 when the key of the train to be loaded
+ *  is in B1 or B2 (case II and III of the paper), and decide the list
+ *  which the train enters.
+ *
+ * Returns:
+ *  None
+ */
+static void arc_Miss(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key)           /* IN train to be loaded */
+{
+    ARCState            *s = STATE(type);
+    Four                node;
+    Four                delta;
+
+
+    s->pending = ARC_T1;
+    s->pendingInB2 = FALSE;
+
+    node = edubfm_GhostLookUp(&s->ghost, key);
+    if (node == NIL) return;
+
+    if (s->ghost.listNo[node] == ARC_B1) {
+        delta = (B2(s).len >= B1(s).len) ? B2(s).len / B1(s).len : 1;
+        s->p = (s->p + delta < s->nBufs) ? s->p + delta : s->nBufs;
+    }
+    else {
+        delta = (B1(s).len >= B2(s).len) ? B1(s).len / B2(s).len : 1;
+        s->p = (s->p - delta > 0) ? s->p - delta : 0;
+        s->pendingInB2 = TRUE;
+    }
+
+    edubfm_GhostDelete(&s->ghost, node);
+    s->pending = ARC_T2;
+
+} /* arc_Miss() */
+
+
+
+/*@================================
+ * arc_Victim()
+ *================================*/
+/*
+ * Function: Four arc_Victim(Four)
+ *
+ * Description:
+ *  Select an unfixed free buffer if any. Otherwise select the LRU
+ *  unfixed buffer of T1 if T1 exceeds its target size, or of T2
+ *  (REPLACE of the paper), a clean buffer near the LRU end being
+ *  preferred to a dirty one (see edubfm_ListVictim()). If the chosen
+ *  list has no unfixed buffer, the other one is used.
+ *
+ * Returns:
+ *  1) index of the selected buffer
+ *  2) eNOUNFIXEDBUF_BFM - There is no unfixed buffer.
+ */
+static Four arc_Victim(
+    Four                type)           /* IN buffer type */
+{
+    ARCState            *s = STATE(type);
+    Four                victim;
+
+
+    victim = edubfm_ListUnfixedTail(type, &s->links, &s->freeList);
+    if (victim != NIL) return(victim);
+
+    if (s->t1.len > 0 && (s->t1.len > s->p || (s->pendingInB2 && s->t1.len == s->p))) {
+        victim = edubfm_ListVictim(type, &s->links, &s->t1);
+        if (victim == NIL) victim = edubfm_ListVictim(type, &s->links, &s->t2);
+    }
+    else {
+        victim = edubfm_ListVictim(type, &s->links, &s->t2);
+        if (victim == NIL) victim = edubfm_ListVictim(type, &s->links, &s->t1);
+    }
+
+    return((victim != NIL) ? victim : eNOUNFIXEDBUF_BFM);
+
+} /* arc_Victim() */
+
+
+
+/*@================================
+ * arc_Evict()
+ *================================*/
+/*
+ * Function: void arc_Evict(Four, Four)
+ *
+ * Description:
+ *  Move the key of the train being replaced into B1 or B2, keeping
+ *  |T1| + |B1| <= c and |B1| + |B2| <= c.
+ *
+ * Returns:
+ *  None
+ */
+static void arc_Evict(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    ARCState            *s = STATE(type);
+    Four                ghostList = NIL;
+
+
+    switch (s->where[idx]) {
+      case ARC_FREE:
+        edubfm_ListRemove(&s->links, &s->freeList, idx);
+        break;
+
+      case ARC_T1:
+        edubfm_ListRemove(&s->links, &s->t1, idx);
+        ghostList = ARC_B1;
+        break;
+
+      case ARC_T2:
+        edubfm_ListRemove(&s->links, &s->t2, idx);
+        ghostList = ARC_B2;
+        break;
+    }
+
+    s->where[idx] = ARC_NONE;
+
+    if (ghostList == NIL || IS_NILBFMHASHKEY(BI_KEY(type, idx))) return;
+
+    edubfm_GhostInsert(&s->ghost, ghostList, &BI_KEY(type, idx));
+
+    /* the train to be loaded enters T1: keep room for it in L1 */
+    edubfm_GhostTrim(&s->ghost, ARC_B1, s->nBufs - s->t1.len - 1);
+
+} /* arc_Evict() */
+
+
+
+/*@================================
+ * arc_Admit()
+ *================================*/
+/*
+ * Function: void arc_Admit(Four, Four)
+ *
+ * Description:
+ *  Insert the buffer holding the loaded train at the head of the
+ *  decided list.
+ *
+ * Returns:
+ *  None
+ */
+static void arc_Admit(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    ARCState            *s = STATE(type);
+
+
+    s->where[idx] = s->pending;
+    edubfm_ListInsertHead(&s->links, (s->pending == ARC_T2) ? &s->t2 : &s->t1, idx);
+
+} /* arc_Admit() */
+
+
+
+/*@================================
+ * arc_Release()
+ *================================*/
+/*
+ * Function: void arc_Release(Four, Four)
+ *
+ * Description:
+ *  Return the buffer to the free list. A buffer still holding a train,
+ *  e.g. one emptied by EduBfM_DiscardAll(), leaves its list without
+ *  leaving a ghost.
+ *
+ * Returns:
+ *  None
+ */
+static void arc_Release(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    ARCState            *s = STATE(type);
+
+
+    switch (s->where[idx]) {
+      case ARC_FREE:
+        return;
+
+      case ARC_T1:
+        edubfm_ListRemove(&s->links, &s->t1, idx);
+        break;
+
+      case ARC_T2:
+        edubfm_ListRemove(&s->links, &s->t2, idx);
+        break;
+    }
+
+    s->where[idx] = ARC_FREE;
+    edubfm_ListInsertHead(&s->links, &s->freeList, idx);
+
+} /* arc_Release() */
+
+
+BfMPolicy edubfm_arcPolicy = {
+    "ARC",
+    arc_Init, arc_Final, arc_Access, arc_Miss,
+    arc_Victim, arc_Evict, arc_Admit, arc_Release
+};
@@ -76,15 +76,27 @@ extern CfgParams_T sm_cfgParams;
  *
  *  Allocate a new buffer from the buffer pool.
  *  The used buffer pool is specified by the parameter 'type'.
- *  This routine uses the second chance buffer replacement algorithm
- *  to select a victim.  That is, if the reference bit of current checking
- *  entry (indicated by BI_NEXTVICTIM(type), macro for
- *  bufInfo[type].nextVictim) is set, then simply clear
+ *  A buffer on the free buffer list, i.e. one holding no train, is taken
+ *  first. Otherwise the victim is selected by the buffer replacement
+ *  policy configured for the buffer pool (BE_POLICY(type)). By default it
+ *  is the second chance buffer replacement algorithm. That is, if the
+ *  reference bit of current checking entry (indicated by
+ *  BE_NEXTVICTIM(type)) is set, then simply clear
  *  the bit for the second chance and proceed to the next entry, otherwise
- *  the current buffer indicated by BI_NEXTVICTIM(type) is selected to be
- *  returned.
+ *  the current buffer indicated by BE_NEXTVICTIM(type) is selected to be
+ *  returned. Every policy prefers a victim on the clean list of the pool
+ *  (see edubfm_CleanVictim() and edubfm_ListVictim()), so that the miss
+ *  need not write it.
  *  Before return the buffer, if the dirty bit of the victim is set, it 
  *  must be force out to the disk.
+ *  The caller holds the pool latch. Since a hit pins a buffer without
+ *  the pool latch, the victim is claimed before it is flushed, and it is
+ *  given up for another one if it has been pinned or dirtied again
+ *  before its mapping is deleted. The clean image of the victim is then
+ *  given to the compressed cache, if there is one (see edubfm_ZCache.c).
+ *  The pool latch is released over the write-back of a dirty victim (see
+ *  edubfm_FlushVictim()), so the caller looks the train up again before
+ *  it maps the buffer to the train.
  *
  * Returns;
  *  1) An index of a new buffer from the buffer pool
@@ -92,8 +104,6 @@ extern CfgParams_T sm_cfgParams;
  *     eNOUNFIXEDBUF_BFM - There is no unfixed buffer.
  *     some errors caused by fuction calls
  */
-#define GET_INDEX(type, idx) (BI_NEXTVICTIM(type)+idx) % BI_NBUFS(type)
-#define IS_REFERED(type, idx) (BI_BITS(type, idx) & REFER)
 #define IS_DIRTY(type, idx) (BI_BITS(type, idx) & DIRTY)
 
 Four edubfm_AllocTrain(
@@ -102,46 +112,64 @@ Four edubfm_AllocTrain(
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four 	e;			/* for error */
     Four 	victim;			/* return value */
-    Four 	i = 0;
+    UEight      nCleanAllocs;
     
 
 	/* Error check whether using not supported functionality by EduBfM */
 	if(sm_cfgParams.useBulkFlush) ERR(eNOTSUPPORTED_EDUBFM);
 
-    while(i < 2*BI_NBUFS(type)){
-        victim = GET_INDEX(type, i);
-        //printf("i=%d, victim=%d\n",i, victim);
-        if(BI_FIXED(type, victim) == 0 && !IS_REFERED(type, victim)){
-            //printf("Found a block to alloc\n");         
-
-            // Flush DIRTY data
-            if(IS_DIRTY(type, victim)){
-                //printf("Flushing... {pageNo: %d}\n", BI_KEY(type, victim).pageNo);
-                e = edubfm_FlushTrain(&(BI_KEY(type, victim)), type);
-                if (e < 0) ERR(e);
-            }
-            
-            // Initialize bufTable elements
-            BI_BITS(type, victim) = ALL_0;
-            BI_NEXTVICTIM(type) = (victim + 1) % BI_NBUFS(type);
-            if(BI_KEY(type, victim).pageNo != NIL){
-                //printf("There was data on hashTable. Deleting...\n");
-                e = edubfm_Delete(&(BI_KEY(type, victim)), type);
-                if (e < 0) ERR(e);
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    victim = edubfm_PopFreeBuf(type);
+    if (victim != NIL) {
+        BFM_COUNT(type, nFreeAllocs);
+    }
+    else for (;;) {
+        nCleanAllocs = BE_MYSTATS(type).nCleanAllocs;
+
+        victim = BE_POLICY(type)->victim(type);
+        if (victim < 0) return( victim );
+
+        if (BE_MYSTATS(type).nCleanAllocs == nCleanAllocs)
+            BFM_COUNT(type, nSweepAllocs);
+
+        /* a hit may have pinned the victim after it was selected */
+        if (!edubfm_ClaimVictim(type, victim)) continue;
+
+        // Flush DIRTY data
+        edubfm_WaitWriter(type, victim);
+        if(IS_DIRTY(type, victim)){
+            e = edubfm_FlushVictim(type, victim);
+            if (e < 0) {
+                BFM_ATOMIC_ADD(BI_FIXED(type, victim), -1);
+                ERR(e);
             }
-            
-            return ( victim );
-        };
-
-        if(BI_FIXED(type, victim) == 0 && IS_REFERED(type, victim)){
-            //printf("making REFER bit to 0 : result = ");
-            BI_BITS(type, victim) &= ~REFER;
-            //printf("%x\n", victim);
+            BFM_COUNT(type, nVictimFlushes);
+        }
+        else if (BE_CLEANED(type, victim)) {
+            BFM_COUNT(type, nAvoidedFlushes);
+        }
+
+        if (edubfm_UnmapVictim(type, victim)) {
+            BFM_COUNT(type, nEvictions);
+            edubfm_BalanceEvict(type, victim);
+            edubfm_ZCacheInsert(type, &BI_KEY(type, victim), BI_BUFFER(type, victim));
+            edubfm_ExtensionInsert(type, &BI_KEY(type, victim), BI_BUFFER(type, victim));
+            break;
         }
-        
-        i++;
     }
-    //printf("NO UNFIXED BUF\n");
-    return( eNOUNFIXEDBUF_BFM );
+    BE_CLEANED(type, victim) = FALSE;
+    BE_IOSTATE(type, victim) = IO_NONE;
+
+    BE_POLICY(type)->evict(type, victim);
+
+    // Initialize bufTable elements
+    BI_BITS(type, victim) = ALL_0;
+    SET_NILBFMHASHKEY(BI_KEY(type, victim));
+    
+    return ( victim );
     
 }  /* edubfm_AllocTrain */
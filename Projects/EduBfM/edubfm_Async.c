@@ -0,0 +1,212 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Async.c
+ *
+ * Description:
+ *  Fixes of trains which do not wait for the reads of the trains (see
+ *  EduBfM_GetTrainAsync()). A miss starts the read of the train like
+ *  EduBfM_PrefetchTrains() and makes the request wait for it; the request
+ *  is completed with the read (see edubfm_Prefetch.c).
+ *
+ * Exports:
+ *  Four edubfm_StartAsync(BfMAsyncGet *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * async_Fix()
+ *================================*/
+/*
+ * Function: static Four async_Fix(BfMAsyncGet *)
+ *
+ * Description:
+ *  Fix the train of the request by EduBfM_GetTrain(), which waits for
+ *  its read. The caller has released the pool latch.
+ *
+ * Returns:
+ *  ASYNC_FIXED
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four async_Fix(
+    BfMAsyncGet         *req)           /* INOUT request */
+{
+    Four                e;              /* error code */
+
+
+    e = EduBfM_GetTrain(&req->trainId, &req->retBuf, req->type);
+    if (e < eNOERROR) ERR(e);
+
+    return(ASYNC_FIXED);
+
+} /* async_Fix() */
+
+
+
+/*@================================
+ * edubfm_StartAsync()
+ *================================*/
+/*
+ * Function: Four edubfm_StartAsync(BfMAsyncGet *)
+ *
+ * Description:
+ *  Fix the train of the request if it is in the pool. Otherwise make the
+ *  request wait for the read of the train, starting the read unless it
+ *  is in flight already. If the pool has as many reads in flight as it
+ *  may have (see BE_MAXPREFETCHES()), the request is deferred, and the
+ *  caller is to start it again after a read of the pool is over.
+ *  A train of a volume not attached by EduBfM_AttachVolume(), or of a
+ *  pool too small to read ahead, is fixed by EduBfM_GetTrain(), which
+ *  waits for its read. So is a train being read by a miss, which has no
+ *  request to wait on, or one read in while the pool latch was released
+ *  over the write-back of a victim (see edubfm_StartRead()).
+ *  The pool must have been initialized.
+ *
+ * Returns:
+ *  ASYNC_xxx
+ *  error code
+ *    eBADPAGESIZE_EDUBFM - the pages of the volume are larger than the frames,
+ *                          or the train is not the first page of one
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter req
+ *     retBuf is the buffer holding the train if it has been fixed
+ */
+Four edubfm_StartAsync(
+    BfMAsyncGet         *req)           /* INOUT request */
+{
+    Four                e;              /* error code */
+    Four                type = req->type;
+    Four                index;          /* index of the buffer pool */
+
+
+    index = edubfm_Fix(&req->trainId, type);
+    if (index >= 0) {
+        BFM_TRACE(BFM_TRACE_GET, &req->trainId, type);
+        BFM_COUNT(type, nLookups);
+        BFM_COUNT(type, nHits);
+        if (BE_POLICY(type)->access != NULL) {
+            BFM_LATCH(type);
+            BE_POLICY(type)->access(type, index);
+            BFM_UNLATCH(type);
+        }
+        edubfm_Referred(type, index);
+        req->retBuf = BI_BUFFER(type, index);
+
+        return(ASYNC_FIXED);
+    }
+
+    BFM_LATCH(type);
+
+    if (BE_MAXPREFETCHES(type) == 0 || edubfm_FindDevice(req->trainId.volNo) == NULL) {
+        BFM_UNLATCH(type);
+        return(async_Fix(req));
+    }
+
+    edubfm_ReapPrefetches(type, FALSE);
+
+    index = edubfm_LookUp(&req->trainId, type);
+    if (index >= 0 && BE_IOSTATE(type, index) == IO_READING && !edubfm_IsPrefetching(type, index)) {
+        BFM_UNLATCH(type);
+        return(async_Fix(req));
+    }
+    if (index < 0 && BE_NPREFETCHES(type) >= BE_MAXPREFETCHES(type)) {
+        BFM_UNLATCH(type);
+        return(ASYNC_DEFERRED);
+    }
+
+    BFM_TRACE(BFM_TRACE_GET, &req->trainId, type);
+    BFM_COUNT(type, nLookups);
+
+    if (index >= 0 && BE_IOSTATE(type, index) == IO_READING) {
+        /* the train is being read ahead or for another request */
+        BFM_COUNT(type, nPrefetchWaits);
+        edubfm_AddPrefetchWaiter(type, index, req);
+        BFM_UNLATCH(type);
+
+        return(ASYNC_PENDING);
+    }
+
+    if (index >= 0) {
+        BFM_COUNT(type, nHits);
+        BFM_ATOMIC_ADD(BI_FIXED(type, index), 1);
+        if (BE_POLICY(type)->access != NULL) BE_POLICY(type)->access(type, index);
+        edubfm_Referred(type, index);
+        req->retBuf = BI_BUFFER(type, index);
+        BFM_UNLATCH(type);
+
+        return(ASYNC_FIXED);
+    }
+
+    e = edubfm_CheckTrain(type, &req->trainId);
+    if (e < eNOERROR) ERR_UNLATCH(e, type);
+
+    BFM_COUNT(type, nMisses);
+    index = edubfm_StartRead(&req->trainId, type);
+    if (index == NIL) {
+        BFM_UNLATCH(type);
+        return(async_Fix(req));
+    }
+    if (index < 0) ERR_UNLATCH(index, type);
+    BFM_COUNT(type, nAsyncReads);
+
+    edubfm_AddPrefetchWaiter(type, index, req);
+
+    BFM_UNLATCH(type);
+
+    return(ASYNC_PENDING);
+
+} /* edubfm_StartAsync() */
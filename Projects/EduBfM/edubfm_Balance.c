@@ -0,0 +1,373 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Balance.c
+ *
+ * Description:
+ *  Move memory between the page pool and the large object train pool
+ *  under a memory budget shared by them (see EduBfM_SetMemoryBudget()).
+ *  Each pool remembers the keys of the trains it evicted last in a ghost
+ *  directory holding as many trains as fill BALANCE_GHOST_SHARE-th of the
+ *  budget. A miss on a remembered train, i.e. a ghost hit, would have been
+ *  a hit if the pool had that much more memory, so the ghost hits of the
+ *  two pools estimate the marginal hit rates of the same amount of memory.
+ *  Every BALANCE_INTERVAL misses, a step of the budget is moved from the
+ *  pool with few ghost hits to the pool with many, and the ghost hits are
+ *  halved so that the split follows the workload as it changes.
+ *  The ghost directory of a pool is protected by the pool latch.
+ *
+ * Exports:
+ *  Four edubfm_SetBudget(Four)
+ *  Boolean edubfm_BalanceMiss(Four, BfMHashKey *)
+ *  void edubfm_BalanceEvict(Four, Four)
+ *  void edubfm_Balance(void)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* # of misses of the pools between two balancings */
+#define BALANCE_INTERVAL        256
+
+/* the ghost directory of a pool holds the trains of 1/BALANCE_GHOST_SHARE of the budget */
+#define BALANCE_GHOST_SHARE     4
+
+/* 1/BALANCE_STEPS of the budget is moved at a time */
+#define BALANCE_STEPS           32
+
+/* each pool keeps at least 1/BALANCE_MIN_SHARE of the budget */
+#define BALANCE_MIN_SHARE       16
+
+/* memory is moved if a pool has at least BALANCE_MIN_HITS ghost hits and
+ * BALANCE_RATIO times as many as the other
+ */
+#define BALANCE_MIN_HITS        8
+#define BALANCE_RATIO           2
+
+/* memory budget shared by the buffer pools */
+static struct {
+    pthread_mutex_t     mutex;          /* serializes the changes of the split */
+    Four                budget;         /* # of pages shared by the pools (0: no budget) */
+    Four                nMisses;        /* misses of the pools under the budget */
+    BfMGhostDir         ghosts[NUM_BUF_TYPES];          /* trains evicted last from each pool */
+    UEight              ghostHits[NUM_BUF_TYPES];       /* recent ghost hits of each pool */
+} balance = { PTHREAD_MUTEX_INITIALIZER, 0 };
+
+
+
+/*@================================
+ * balance_MinBufs()
+ *================================*/
+/*
+ * Function: static Four balance_MinBufs(Four, Four)
+ *
+ * Description:
+ *  Return the least number of buffers the pool keeps under the budget.
+ *
+ * Returns:
+ *  # of buffers
+ */
+static Four balance_MinBufs(
+    Four                type,           /* IN buffer type */
+    Four                budget)         /* IN # of pages shared by the pools */
+{
+    Four                n;
+
+
+    n = budget / BALANCE_MIN_SHARE / BI_BUFSIZE(type);
+
+    return((n > 0) ? n : 1);
+
+} /* balance_MinBufs() */
+
+
+
+/*@================================
+ * balance_Stop()
+ *================================*/
+/*
+ * Function: static void balance_Stop(void)
+ *
+ * Description:
+ *  Stop moving memory and forget the ghost directories.
+ *  The caller holds the mutex of the budget.
+ *
+ * Returns:
+ *  None
+ */
+static void balance_Stop(void)
+{
+    Four                type;
+
+
+    if (balance.budget == 0) return;
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) BFM_LATCH(type);
+    balance.budget = 0;
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        edubfm_GhostFinal(&balance.ghosts[type]);
+        balance.ghostHits[type] = 0;
+    }
+    for (type = 0; type < NUM_BUF_TYPES; type++) BFM_UNLATCH(type);
+
+} /* balance_Stop() */
+
+
+
+/*@================================
+ * edubfm_SetBudget()
+ *================================*/
+/*
+ * Function: Four edubfm_SetBudget(Four)
+ *
+ * Description:
+ *  Make the pools share 'nPages' pages of memory, splitting them in
+ *  proportion to the memory the pools have now, or let the pools keep
+ *  their sizes if 'nPages' is 0.
+ *  The pools are initialized.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_EDUBFM - the budget cannot hold the least sizes of the pools
+ *    some errors caused by function calls
+ */
+Four edubfm_SetBudget(
+    Four                nPages)         /* IN # of pages shared by the pools (0: none) */
+{
+    Four                e = eNOERROR;   /* error code */
+    Four                type;
+    Four                total;          /* # of pages the pools have now */
+    Four                rest;           /* # of pages beyond the least sizes of the pools */
+    Four                nBufs[NUM_BUF_TYPES];
+
+
+    pthread_mutex_lock(&balance.mutex);
+
+    balance_Stop();
+
+    for (total = 0, type = 0; e >= eNOERROR && type < NUM_BUF_TYPES; type++) {
+        e = edubfm_InitPool(type);
+        if (e >= eNOERROR) total += BE_NBUFS(type) * BI_BUFSIZE(type);
+    }
+    if (e < eNOERROR || nPages == 0) {
+        pthread_mutex_unlock(&balance.mutex);
+        if (e < eNOERROR) ERR(e);
+        return(eNOERROR);
+    }
+
+    /* each pool gets its least size and a share of the rest in proportion to its memory */
+    for (rest = nPages, type = 0; type < NUM_BUF_TYPES; type++)
+        rest -= balance_MinBufs(type, nPages) * BI_BUFSIZE(type);
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        nBufs[type] = balance_MinBufs(type, nPages)
+                      + (Four)((double)rest * BE_NBUFS(type) * BI_BUFSIZE(type) / total) / BI_BUFSIZE(type);
+        if (nBufs[type] > BE_MAXBUFS(type)) nBufs[type] = BE_MAXBUFS(type);
+    }
+    if (rest < 0) e = eBADPARAMETER_EDUBFM;
+
+    /* shrink first so that the pools never hold more than the budget together */
+    for (type = 0; e >= eNOERROR && type < NUM_BUF_TYPES; type++)
+        if (nBufs[type] < BE_NBUFS(type)) e = EduBfM_ResizePool(type, nBufs[type]);
+    for (type = 0; e >= eNOERROR && type < NUM_BUF_TYPES; type++)
+        if (nBufs[type] > BE_NBUFS(type)) e = EduBfM_ResizePool(type, nBufs[type]);
+
+    for (type = 0; e >= eNOERROR && type < NUM_BUF_TYPES; type++) {
+        e = edubfm_GhostInit(&balance.ghosts[type], nPages / BALANCE_GHOST_SHARE / BI_BUFSIZE(type), 0);
+        if (e < eNOERROR)
+            while (--type >= 0) edubfm_GhostFinal(&balance.ghosts[type]);
+    }
+    if (e < eNOERROR) {
+        pthread_mutex_unlock(&balance.mutex);
+        ERR(e);
+    }
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) BFM_LATCH(type);
+    balance.budget = nPages;
+    balance.nMisses = 0;
+    for (type = 0; type < NUM_BUF_TYPES; type++) BFM_UNLATCH(type);
+
+    pthread_mutex_unlock(&balance.mutex);
+
+    return(eNOERROR);
+
+} /* edubfm_SetBudget() */
+
+
+
+/*@================================
+ * edubfm_BalanceMiss()
+ *================================*/
+/*
+ * Function: Boolean edubfm_BalanceMiss(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Count a miss of the pool, and a ghost hit if the train was evicted
+ *  recently. The caller holds the pool latch, and calls edubfm_Balance()
+ *  after releasing it if TRUE is returned.
+ *
+ * Returns:
+ *  TRUE if the pools are due to be balanced
+ */
+Boolean edubfm_BalanceMiss(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key)           /* IN key of the missed train */
+{
+    Four                node;
+
+
+    if (balance.budget == 0) return(FALSE);
+
+    node = edubfm_GhostLookUp(&balance.ghosts[type], key);
+    if (node != NIL) {
+        edubfm_GhostDelete(&balance.ghosts[type], node);
+        balance.ghostHits[type]++;
+        BFM_COUNT(type, nGhostHits);
+    }
+
+    return(BFM_ATOMIC_ADD(balance.nMisses, 1) % BALANCE_INTERVAL == 0);
+
+} /* edubfm_BalanceMiss() */
+
+
+
+/*@================================
+ * edubfm_BalanceEvict()
+ *================================*/
+/*
+ * Function: void edubfm_BalanceEvict(Four, Four)
+ *
+ * Description:
+ *  Remember the train evicted from the buffer, whose key is still set.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_BalanceEvict(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN index of the buffer */
+{
+    if (balance.budget == 0) return;
+
+    (void) edubfm_GhostInsert(&balance.ghosts[type], 0, &BI_KEY(type, idx));
+
+} /* edubfm_BalanceEvict() */
+
+
+
+/*@================================
+ * edubfm_Balance()
+ *================================*/
+/*
+ * Function: void edubfm_Balance(void)
+ *
+ * Description:
+ *  Move a step of the budget to the pool having had many more ghost hits
+ *  than the other, shrinking the other pool first. Nothing is moved if
+ *  the other pool cannot shrink now, e.g. because a buffer to be removed
+ *  is fixed; it is tried again at the next balancing.
+ *  The caller holds no pool latch. If another thread is balancing the
+ *  pools, nothing is done.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_Balance(void)
+{
+    Four                e;              /* error code */
+    Four                type;
+    Four                winner, loser;
+    Four                nBufs;
+    UEight              hits[NUM_BUF_TYPES];
+
+
+    if (pthread_mutex_trylock(&balance.mutex) != 0) return;
+
+    if (balance.budget == 0) {
+        pthread_mutex_unlock(&balance.mutex);
+        return;
+    }
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        BFM_LATCH(type);
+        hits[type] = balance.ghostHits[type];
+        balance.ghostHits[type] /= 2;
+        BFM_UNLATCH(type);
+    }
+
+    winner = (hits[PAGE_BUF] >= hits[LOT_LEAF_BUF]) ? PAGE_BUF : LOT_LEAF_BUF;
+    loser = (winner == PAGE_BUF) ? LOT_LEAF_BUF : PAGE_BUF;
+
+    if (hits[winner] >= BALANCE_MIN_HITS && hits[winner] > BALANCE_RATIO * hits[loser]) {
+
+        nBufs = BE_NBUFS(loser) - (balance.budget / BALANCE_STEPS + BI_BUFSIZE(loser) - 1) / BI_BUFSIZE(loser);
+        if (nBufs < balance_MinBufs(loser, balance.budget)) nBufs = balance_MinBufs(loser, balance.budget);
+
+        e = eNOERROR;
+        if (nBufs < BE_NBUFS(loser)) {
+            BFM_LATCH(loser);
+            e = edubfm_ShrinkPool(loser, nBufs);
+            BFM_UNLATCH(loser);
+        }
+
+        nBufs = (balance.budget - BE_NBUFS(loser) * BI_BUFSIZE(loser)) / BI_BUFSIZE(winner);
+        if (nBufs > BE_MAXBUFS(winner)) nBufs = BE_MAXBUFS(winner);
+
+        if (e >= eNOERROR && nBufs > BE_NBUFS(winner)) {
+            BFM_LATCH(winner);
+            (void) edubfm_GrowPool(winner, nBufs);
+            BFM_UNLATCH(winner);
+        }
+    }
+
+    pthread_mutex_unlock(&balance.mutex);
+
+} /* edubfm_Balance() */
@@ -0,0 +1,243 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Clock.c
+ *
+ * Description:
+ *  Second chance (CLOCK) buffer replacement policy.
+ *  It uses the REFER bit of the buffer table and BE_NEXTVICTIM(type) as
+ *  the clock hand, which is copied to BI_NEXTVICTIM(type) for the rest of
+ *  the storage system, wrapped to the buffer table it knows of.
+ *  A victim is first looked for on the clean list of the pool (see
+ *  edubfm_CleanVictim()), which gives the clean buffers the same second
+ *  chance in the order they became clean, so that a miss neither sweeps
+ *  the dirty buffers nor waits for the write-back of one. The hand only
+ *  sweeps when no clean buffer can be replaced.
+ *  A hit only sets the REFER bit atomically, so the policy has no
+ *  'access' hook and a hit never waits for the hand; the hand is moved
+ *  by the misses, which clear the bits atomically.
+ *
+ * Exports:
+ *  BfMPolicy edubfm_clockPolicy
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* type definition for the state of the CLOCK policy */
+typedef struct {
+    Four        swept;          /* buffer selected by the last sweep, NIL if none */
+} ClockState;
+
+#define STATE(type)     ((ClockState *)BE_POLICYSTATE(type))
+
+#define GET_INDEX(type, idx) (BE_NEXTVICTIM(type)+idx) % BE_NBUFS(type)
+#define IS_REFERED(type, idx) (BFM_ATOMIC_LOAD(BI_BITS(type, idx)) & REFER)
+
+
+static void clock_Miss(Four type, BfMHashKey *key) { }
+static void clock_Admit(Four type, Four idx) { }
+static void clock_Release(Four type, Four idx) { }
+
+
+
+/*@================================
+ * clock_Init()
+ *================================*/
+/*
+ * Function: Four clock_Init(Four)
+ *
+ * Description:
+ *  Build the CLOCK state.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+static Four clock_Init(
+    Four                type)           /* IN buffer type */
+{
+    ClockState          *s;
+
+
+    s = (ClockState *)malloc(sizeof(ClockState));
+    if (s == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    s->swept = NIL;
+    BE_POLICYSTATE(type) = s;
+
+    return(eNOERROR);
+
+} /* clock_Init() */
+
+
+
+/*@================================
+ * clock_Final()
+ *================================*/
+/*
+ * Function: void clock_Final(Four)
+ *
+ * Description:
+ *  Free the CLOCK state.
+ *
+ * Returns:
+ *  None
+ */
+static void clock_Final(
+    Four                type)           /* IN buffer type */
+{
+    free(BE_POLICYSTATE(type));
+    BE_POLICYSTATE(type) = NULL;
+
+} /* clock_Final() */
+
+
+
+/*@================================
+ * clock_Victim()
+ *================================*/
+/*
+ * Function: Four clock_Victim(Four)
+ *
+ * Description:
+ *  Select a victim by the second chance buffer replacement algorithm.
+ *  The clean list is tried first. If none of its buffers can be replaced,
+ *  the buffers are swept:
+ *  If the reference bit of the current checking entry (indicated by
+ *  BE_NEXTVICTIM(type)) is set, then simply clear the bit for the second
+ *  chance and proceed to the next entry, otherwise the current buffer is
+ *  selected. Fixed buffers are skipped.
+ *
+ * Returns:
+ *  1) index of the selected buffer
+ *  2) eNOUNFIXEDBUF_BFM - There is no unfixed buffer.
+ */
+static Four clock_Victim(
+    Four 	type)			/* IN buffer type */
+{
+    ClockState  *s = STATE(type);
+    Four 	victim;
+    Four 	i = 0;
+    Four        nSteps;         /* # of buffers visited by the sweep */
+
+
+    s->swept = NIL;
+
+    victim = edubfm_CleanVictim(type);
+    if (victim != NIL) {
+        BFM_COUNT(type, nCleanAllocs);
+        return(victim);
+    }
+
+    while(i < 2*BE_NBUFS(type)){
+        victim = GET_INDEX(type, i);
+        if(BI_FIXED(type, victim) == 0 && !IS_REFERED(type, victim)){
+            break;
+        };
+
+        if(BI_FIXED(type, victim) == 0 && IS_REFERED(type, victim)){
+            BI_CLEARBITS(type, victim, REFER);
+        }
+
+        i++;
+    }
+
+    nSteps = (i < 2*BE_NBUFS(type)) ? i + 1 : i;
+    BFM_COUNT_N(type, nSweepSteps, nSteps);
+    BFM_COUNT_VALUE(type, sweepLengths, nSteps);
+
+    if (i == 2*BE_NBUFS(type)) return( eNOUNFIXEDBUF_BFM );
+
+    s->swept = victim;
+
+    return( victim );
+
+}  /* clock_Victim() */
+
+
+
+/*@================================
+ * clock_Evict()
+ *================================*/
+/*
+ * Function: void clock_Evict(Four, Four)
+ *
+ * Description:
+ *  Advance the hand past the buffer being replaced if the sweep selected
+ *  it. A buffer taken from the free buffer list or the clean list leaves
+ *  the hand where it is.
+ *
+ * Returns:
+ *  None
+ */
+static void clock_Evict(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    ClockState          *s = STATE(type);
+
+
+    if (idx != s->swept) return;
+    s->swept = NIL;
+
+    BE_NEXTVICTIM(type) = (idx + 1) % BE_NBUFS(type);
+    BI_NEXTVICTIM(type) = BE_NEXTVICTIM(type) % BE_NBASEBUFS(type);
+
+} /* clock_Evict() */
+
+
+BfMPolicy edubfm_clockPolicy = {
+    "CLOCK",
+    clock_Init, clock_Final, NULL, clock_Miss,
+    clock_Victim, clock_Evict, clock_Admit, clock_Release
+};
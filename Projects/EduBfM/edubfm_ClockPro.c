@@ -0,0 +1,698 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_ClockPro.c
+ *
+ * Description:
+ *  CLOCK-Pro buffer replacement policy (Jiang, Chen, and Zhang, USENIX 2005).
+ *  Resident trains are either hot or cold. A cold train starts a test
+ *  period when it is loaded; if it is referenced again during the test
+ *  period it becomes hot. Cold trains replaced during their test period
+ *  stay on the clock as non-resident entries, and a miss on one of them
+ *  both makes it hot and enlarges the target number of cold buffers 'mc'.
+ *  All entries are on one circular list; HAND_cold looks for a victim
+ *  among the resident cold trains, HAND_hot turns unreferenced hot trains
+ *  cold, and HAND_test ends test periods and drops non-resident entries.
+ *  The reference bit of a resident train is the REFER bit of the buffer
+ *  table. A hit only sets it atomically, so the policy has no 'access'
+ *  hook and a hit never waits for the pool latch; the hands clear it
+ *  atomically. The bit set by the load of a train is cleared when the
+ *  train is admitted, since the load is not a re-reference.
+ *
+ * Exports:
+ *  BfMPolicy edubfm_clockProPolicy
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* status of an entry */
+#define CP_FREE         0       /* entry not in use */
+#define CP_HOT          1       /* resident hot train */
+#define CP_COLD         2       /* resident cold train */
+#define CP_NONRESIDENT  3       /* replaced cold train in its test period */
+
+/* type definition for an entry on the clock */
+typedef struct {
+    BfMHashKey  key;            /* train of the entry */
+    Four        idx;            /* buffer holding the train, NIL if non-resident */
+    One         status;         /* CP_xxx */
+    One         test;           /* TRUE if in the test period */
+} CPEntry;
+
+/* type definition for the state of the CLOCK-Pro policy */
+typedef struct {
+    Four        nBufs;          /* # of buffers, 'm' in the paper */
+    Four        mc;             /* target # of resident cold trains */
+    Four        nHot;           /* # of resident hot trains */
+    Four        nNonResident;   /* # of non-resident entries */
+    CPEntry     *entry;         /* 2m entries */
+    Four        freeEntry;      /* head of the free entry chain (uses links.next) */
+    BfMLinks    links;          /* circular list of the entries */
+    Four        handHot;
+    Four        handCold;
+    Four        handTest;
+    Four        *bufEntry;      /* entry of the train in each buffer */
+    BfMLinks    bufLinks;
+    BfMList     freeList;       /* buffers holding no train */
+    BfMKeyMap   map;            /* key -> non-resident entry */
+    Boolean     pendingHot;     /* TRUE if the train being loaded becomes hot */
+} ClockProState;
+
+#define STATE(type)     ((ClockProState *)BE_POLICYSTATE(type))
+#define IS_REFERED(type, idx) (BFM_ATOMIC_LOAD(BI_BITS(type, idx)) & REFER)
+#define NEXT(s, i)      ((s)->links.next[i])
+#define PREV(s, i)      ((s)->links.prev[i])
+
+
+static void cp_Final(Four);
+static void cp_RunHandHot(Four);
+static void cp_RunHandTest(Four);
+
+
+
+/*@================================
+ * cp_Link()
+ *================================*/
+/*
+ * Function: void cp_Link(ClockProState *, Four)
+ *
+ * Description:
+ *  Put the entry at the head of the clock, i.e. right behind HAND_hot,
+ *  which makes it the last one to be visited by the hands.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_Link(
+    ClockProState       *s,             /* INOUT policy state */
+    Four                ent)            /* IN entry */
+{
+    Four                tail;
+
+
+    if (s->handHot == NIL) {
+        NEXT(s, ent) = PREV(s, ent) = ent;
+        s->handHot = s->handCold = s->handTest = ent;
+        return;
+    }
+
+    tail = PREV(s, s->handHot);
+    NEXT(s, tail) = ent;
+    PREV(s, ent) = tail;
+    NEXT(s, ent) = s->handHot;
+    PREV(s, s->handHot) = ent;
+
+} /* cp_Link() */
+
+
+
+/*@================================
+ * cp_Unlink()
+ *================================*/
+/*
+ * Function: void cp_Unlink(ClockProState *, Four)
+ *
+ * Description:
+ *  Take the entry off the clock, moving any hand pointing to it forward.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_Unlink(
+    ClockProState       *s,             /* INOUT policy state */
+    Four                ent)            /* IN entry */
+{
+    Four                next = NEXT(s, ent);
+
+
+    if (next == ent) {
+        s->handHot = s->handCold = s->handTest = NIL;
+    }
+    else {
+        if (s->handHot == ent) s->handHot = next;
+        if (s->handCold == ent) s->handCold = next;
+        if (s->handTest == ent) s->handTest = next;
+
+        NEXT(s, PREV(s, ent)) = next;
+        PREV(s, next) = PREV(s, ent);
+    }
+
+    NEXT(s, ent) = PREV(s, ent) = NIL;
+
+} /* cp_Unlink() */
+
+
+
+/*@================================
+ * cp_NewEntry()
+ *================================*/
+/*
+ * Function: Four cp_NewEntry(ClockProState *, BfMHashKey *, Four, One)
+ *
+ * Description:
+ *  Allocate an entry for the train in the buffer and put it on the clock.
+ *
+ * Returns:
+ *  entry index
+ */
+static Four cp_NewEntry(
+    ClockProState       *s,             /* INOUT policy state */
+    BfMHashKey          *key,           /* IN train */
+    Four                idx,            /* IN buffer holding the train */
+    One                 status)         /* IN CP_HOT or CP_COLD */
+{
+    Four                ent;
+
+
+    ent = s->freeEntry;
+    s->freeEntry = NEXT(s, ent);
+
+    s->entry[ent].key = *key;
+    s->entry[ent].idx = idx;
+    s->entry[ent].status = status;
+    s->entry[ent].test = (status == CP_COLD);
+    s->bufEntry[idx] = ent;
+
+    if (status == CP_HOT) s->nHot++;
+
+    cp_Link(s, ent);
+
+    return(ent);
+
+} /* cp_NewEntry() */
+
+
+
+/*@================================
+ * cp_FreeEntry()
+ *================================*/
+/*
+ * Function: void cp_FreeEntry(ClockProState *, Four)
+ *
+ * Description:
+ *  Take the entry off the clock and return it to the free entry chain.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_FreeEntry(
+    ClockProState       *s,             /* INOUT policy state */
+    Four                ent)            /* IN entry */
+{
+    CPEntry             *p = &s->entry[ent];
+
+
+    if (p->status == CP_NONRESIDENT) {
+        edubfm_MapDelete(&s->map, ent);
+        s->nNonResident--;
+    }
+    else if (p->status == CP_HOT)
+        s->nHot--;
+
+    if (p->idx != NIL) s->bufEntry[p->idx] = NIL;
+
+    cp_Unlink(s, ent);
+    p->status = CP_FREE;
+    p->idx = NIL;
+
+    NEXT(s, ent) = s->freeEntry;
+    s->freeEntry = ent;
+
+} /* cp_FreeEntry() */
+
+
+
+/*@================================
+ * cp_Init()
+ *================================*/
+/*
+ * Function: Four cp_Init(Four)
+ *
+ * Description:
+ *  Build the CLOCK-Pro state. Trains already in the buffer pool become
+ *  cold trains which are not in their test period.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four cp_Init(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                i;
+    Four                nEntries;
+    ClockProState       *s;
+
+
+    s = (ClockProState *)calloc(1, sizeof(ClockProState));
+    if (s == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    BE_POLICYSTATE(type) = s;
+
+    s->nBufs = BE_NBUFS(type);
+    nEntries = 2 * s->nBufs;
+    s->mc = s->nBufs / 4;
+    if (s->mc < 1) s->mc = 1;
+    s->handHot = s->handCold = s->handTest = NIL;
+
+    s->entry = (CPEntry *)malloc(sizeof(CPEntry) * nEntries);
+    s->bufEntry = (Four *)malloc(sizeof(Four) * s->nBufs);
+    if (s->entry == NULL || s->bufEntry == NULL) {
+        cp_Final(type);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    e = edubfm_LinksInit(&s->links, nEntries);
+    if (e >= eNOERROR) e = edubfm_LinksInit(&s->bufLinks, s->nBufs);
+    if (e >= eNOERROR) e = edubfm_MapInit(&s->map, nEntries);
+    if (e < eNOERROR) {
+        cp_Final(type);
+        ERR(e);
+    }
+
+    for (i = 0; i < nEntries; i++) {
+        s->entry[i].status = CP_FREE;
+        s->entry[i].idx = NIL;
+        NEXT(s, i) = (i + 1 < nEntries) ? i + 1 : NIL;
+    }
+    s->freeEntry = 0;
+
+    edubfm_ListInit(&s->freeList);
+    for (i = 0; i < s->nBufs; i++) {
+        s->bufEntry[i] = NIL;
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i)))
+            edubfm_ListInsertHead(&s->bufLinks, &s->freeList, i);
+        else
+            s->entry[cp_NewEntry(s, &BI_KEY(type, i), i, CP_COLD)].test = FALSE;
+    }
+
+    return(eNOERROR);
+
+} /* cp_Init() */
+
+
+
+/*@================================
+ * cp_Final()
+ *================================*/
+/*
+ * Function: void cp_Final(Four)
+ *
+ * Description:
+ *  Release the CLOCK-Pro state.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_Final(
+    Four                type)           /* IN buffer type */
+{
+    ClockProState       *s = STATE(type);
+
+
+    if (s == NULL) return;
+
+    if (s->links.prev != NULL) edubfm_LinksFinal(&s->links);
+    if (s->bufLinks.prev != NULL) edubfm_LinksFinal(&s->bufLinks);
+    if (s->map.bucket != NULL) edubfm_MapFinal(&s->map);
+    free(s->entry);
+    free(s->bufEntry);
+    free(s);
+
+    BE_POLICYSTATE(type) = NULL;
+
+} /* cp_Final() */
+
+
+
+/*@================================
+ * cp_RunHandHot()
+ *================================*/
+/*
+ * Function: void cp_RunHandHot(Four)
+ *
+ * Description:
+ *  Move HAND_hot until an unreferenced hot train is found and turned
+ *  cold. On its way the hand clears the reference bits of hot trains,
+ *  ends the test periods of cold trains, and drops non-resident entries
+ *  (a test period ending without a re-reference shrinks 'mc').
+ *
+ * Returns:
+ *  None
+ */
+static void cp_RunHandHot(
+    Four                type)           /* IN buffer type */
+{
+    ClockProState       *s = STATE(type);
+    Four                ent;
+    Four                steps;
+    CPEntry             *p;
+
+
+    for (steps = 4 * s->nBufs; steps > 0 && s->handHot != NIL; steps--) {
+        ent = s->handHot;
+        s->handHot = NEXT(s, ent);
+        p = &s->entry[ent];
+
+        switch (p->status) {
+          case CP_HOT:
+            if (IS_REFERED(type, p->idx) || BI_FIXED(type, p->idx) != 0)
+                BI_CLEARBITS(type, p->idx, REFER);
+            else {
+                p->status = CP_COLD;
+                p->test = FALSE;
+                s->nHot--;
+                return;
+            }
+            break;
+
+          case CP_COLD:
+            if (p->test) {
+                p->test = FALSE;
+                if (s->mc > 1) s->mc--;
+            }
+            break;
+
+          case CP_NONRESIDENT:
+            cp_FreeEntry(s, ent);
+            if (s->mc > 1) s->mc--;
+            break;
+        }
+    }
+
+} /* cp_RunHandHot() */
+
+
+
+/*@================================
+ * cp_RunHandTest()
+ *================================*/
+/*
+ * Function: void cp_RunHandTest(Four)
+ *
+ * Description:
+ *  Move HAND_test until the number of non-resident entries is at most
+ *  the number of buffers, ending test periods on its way.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_RunHandTest(
+    Four                type)           /* IN buffer type */
+{
+    ClockProState       *s = STATE(type);
+    Four                ent;
+    Four                steps;
+    CPEntry             *p;
+
+
+    for (steps = 4 * s->nBufs; steps > 0 && s->nNonResident > s->nBufs; steps--) {
+        ent = s->handTest;
+        s->handTest = NEXT(s, ent);
+        p = &s->entry[ent];
+
+        if (p->status == CP_NONRESIDENT) {
+            cp_FreeEntry(s, ent);
+            if (s->mc > 1) s->mc--;
+        }
+        else if (p->status == CP_COLD && p->test) {
+            p->test = FALSE;
+            if (s->mc > 1) s->mc--;
+        }
+    }
+
+} /* cp_RunHandTest() */
+
+
+
+/*@================================
+ * cp_Miss()
+ *================================*/
+/*
+ * Function: void cp_Miss(Four, BfMHashKey *)
+ *
+ * Description:
+ *  If the train to be loaded has a non-resident entry, i.e. it is
+ *  re-referenced in its test period, it will be loaded as a hot train
+ *  and the target number of cold buffers grows.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_Miss(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key)           /* IN train to be loaded */
+{
+    ClockProState       *s = STATE(type);
+    Four                ent;
+
+
+    s->pendingHot = FALSE;
+
+    ent = edubfm_MapLookUp(&s->map, key);
+    if (ent == NIL) return;
+
+    if (s->mc < s->nBufs - 1) s->mc++;
+    cp_FreeEntry(s, ent);
+    s->pendingHot = TRUE;
+
+} /* cp_Miss() */
+
+
+
+/*@================================
+ * cp_Victim()
+ *================================*/
+/*
+ * Function: Four cp_Victim(Four)
+ *
+ * Description:
+ *  Select an unfixed free buffer if any. Otherwise move HAND_cold until
+ *  an unfixed, unreferenced resident cold train on the clean list is
+ *  found; the first dirty one met is taken instead once the hand has
+ *  passed BFM_CLEAN_WINDOW of them, so that a miss does not wait for a
+ *  write-back if it need not. A referenced cold train met by the hand
+ *  becomes hot if it is in its test period, otherwise it starts a new
+ *  test period; either way it moves to the head of the clock.
+ *
+ * Returns:
+ *  1) index of the selected buffer
+ *  2) eNOUNFIXEDBUF_BFM - There is no unfixed buffer.
+ */
+static Four cp_Victim(
+    Four                type)           /* IN buffer type */
+{
+    ClockProState       *s = STATE(type);
+    Four                victim;
+    Four                ent;
+    Four                steps;
+    Four                dirty = NIL;    /* first dirty cold train met */
+    Four                nDirty = 0;     /* # of dirty cold trains met */
+    CPEntry             *p;
+
+
+    victim = edubfm_ListUnfixedTail(type, &s->bufLinks, &s->freeList);
+    if (victim != NIL) return(victim);
+
+    for (steps = 4 * s->nBufs; steps > 0 && s->handCold != NIL; steps--) {
+
+        /* no cold train to replace; make one */
+        if (s->nHot == s->nBufs) cp_RunHandHot(type);
+
+        ent = s->handCold;
+        s->handCold = NEXT(s, ent);
+        p = &s->entry[ent];
+
+        if (p->status != CP_COLD || BI_FIXED(type, p->idx) != 0) continue;
+
+        if (!IS_REFERED(type, p->idx)) {
+            if (IS_ON_CLEANLIST(type, p->idx) && !(BFM_ATOMIC_LOAD(BI_BITS(type, p->idx)) & DIRTY)) {
+                BFM_COUNT(type, nCleanAllocs);
+                return(p->idx);
+            }
+            if (dirty == NIL) dirty = p->idx;
+            if (++nDirty >= BFM_CLEAN_WINDOW) return(dirty);
+            continue;
+        }
+
+        BI_CLEARBITS(type, p->idx, REFER);
+        cp_Unlink(s, ent);
+        cp_Link(s, ent);
+
+        if (p->test) {
+            p->status = CP_HOT;
+            p->test = FALSE;
+            s->nHot++;
+            if (s->nHot > s->nBufs - s->mc) cp_RunHandHot(type);
+        }
+        else
+            p->test = TRUE;
+    }
+
+    if (dirty != NIL && BI_FIXED(type, dirty) == 0) return(dirty);
+
+    /* every cold train is fixed; fall back to any unfixed train */
+    for (victim = 0; victim < s->nBufs; victim++)
+        if (BI_FIXED(type, victim) == 0 && s->bufEntry[victim] != NIL) return(victim);
+
+    return(eNOUNFIXEDBUF_BFM);
+
+} /* cp_Victim() */
+
+
+
+/*@================================
+ * cp_Evict()
+ *================================*/
+/*
+ * Function: void cp_Evict(Four, Four)
+ *
+ * Description:
+ *  A cold train replaced during its test period stays on the clock as a
+ *  non-resident entry; any other entry of the buffer is dropped.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_Evict(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    ClockProState       *s = STATE(type);
+    Four                ent = s->bufEntry[idx];
+    CPEntry             *p;
+
+
+    if (ent == NIL) {
+        if (s->bufLinks.prev[idx] != NIL || s->freeList.head == idx)
+            edubfm_ListRemove(&s->bufLinks, &s->freeList, idx);
+        return;
+    }
+
+    p = &s->entry[ent];
+    if (p->status == CP_COLD && p->test) {
+        p->status = CP_NONRESIDENT;
+        p->idx = NIL;
+        s->bufEntry[idx] = NIL;
+        edubfm_MapInsert(&s->map, &p->key, ent);
+        s->nNonResident++;
+        if (s->nNonResident > s->nBufs) cp_RunHandTest(type);
+    }
+    else
+        cp_FreeEntry(s, ent);
+
+} /* cp_Evict() */
+
+
+
+/*@================================
+ * cp_Admit()
+ *================================*/
+/*
+ * Function: void cp_Admit(Four, Four)
+ *
+ * Description:
+ *  Put the loaded train on the head of the clock, as a hot train if it
+ *  was re-referenced in its test period, otherwise as a cold train in
+ *  a new test period, and clear the REFER bit set by the load.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_Admit(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    ClockProState       *s = STATE(type);
+
+
+    cp_NewEntry(s, &BI_KEY(type, idx), idx, s->pendingHot ? CP_HOT : CP_COLD);
+    BI_CLEARBITS(type, idx, REFER);
+
+    if (s->nHot > s->nBufs - s->mc) cp_RunHandHot(type);
+
+} /* cp_Admit() */
+
+
+
+/*@================================
+ * cp_Release()
+ *================================*/
+/*
+ * Function: void cp_Release(Four, Four)
+ *
+ * Description:
+ *  Return the buffer to the free list.
+ *
+ * Returns:
+ *  None
+ */
+static void cp_Release(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    ClockProState       *s = STATE(type);
+
+
+    if (s->bufEntry[idx] != NIL) cp_FreeEntry(s, s->bufEntry[idx]);
+    edubfm_ListInsertHead(&s->bufLinks, &s->freeList, idx);
+
+} /* cp_Release() */
+
+
+BfMPolicy edubfm_clockProPolicy = {
+    "CLOCK-Pro",
+    cp_Init, cp_Final, NULL, cp_Miss,
+    cp_Victim, cp_Evict, cp_Admit, cp_Release
+};
@@ -0,0 +1,432 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Compress.c
+ *
+ * Description:
+ *  Compression of the trains kept by the compressed cache (see
+ *  edubfm_ZCache.c). A train is compressed by a fast LZ77 scheme into the
+ *  block format of LZ4: a sequence of a token, literals, the 2-byte
+ *  offset of a match of at least LZ_MIN_MATCH bytes, and the extra
+ *  lengths, with the last LZ_LAST_LITERALS bytes left as literals.
+ *  The matches are found through a hash table of the positions of the
+ *  last LZ_HASH_BITS-bit hashes of 4 bytes. Slotted and B+-tree pages,
+ *  with their free space and their repeated headers and keys, shrink to
+ *  a fraction of their size; a train which does not is not kept.
+ *
+ * Exports:
+ *  Four edubfm_Compress(char *, Four, char *, Four)
+ *  Boolean edubfm_Decompress(char *, Four, char *, Four)
+ */
+
+
+#include <string.h> /* for memcpy & memset */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/*@
+ * constant definitions
+ */
+#define LZ_HASH_BITS            12
+#define LZ_MIN_MATCH            4       /* shortest match */
+#define LZ_LAST_LITERALS        5       /* the last bytes are always literals */
+#define LZ_MATCH_LIMIT          12      /* no match starts in the last bytes */
+#define LZ_MAX_OFFSET           65535
+#define LZ_RUN_MASK             15      /* length held by the token */
+#define LZ_SKIP_SHIFT           6       /* the search speeds up after 2^LZ_SKIP_SHIFT bytes without a match */
+
+
+/*@
+ * macro definitions
+ */
+
+/* Macro: LZ_HASH(v)
+ * Description: return the hash of 4 bytes
+ * Parameters:
+ *  UFour v         : the 4 bytes
+ * Returns: (Four) index into the hash table
+ */
+#define LZ_HASH(v)      ((Four)(((v) * 2654435761U) >> (32 - LZ_HASH_BITS)))
+
+
+/*@
+ * internal function prototypes
+ */
+static UFour lz_Read32(const UOne *);
+static UEight lz_Read64(const UOne *);
+static void lz_Copy(UOne *, const UOne *, Four);
+static UOne *lz_Length(UOne *, Four);
+static UOne *lz_Sequence(UOne *, UOne *, const UOne *, Four, Four, Four);
+
+
+
+/*@================================
+ * lz_Read32()
+ *================================*/
+/*
+ * Function: static UFour lz_Read32(const UOne *)
+ *
+ * Description:
+ *  Read 4 bytes at any alignment.
+ *
+ * Returns:
+ *  the 4 bytes
+ */
+static UFour lz_Read32(
+    const UOne          *p)             /* IN bytes */
+{
+    UFour               v;
+
+
+    memcpy(&v, p, sizeof(v));
+
+    return(v);
+
+} /* lz_Read32() */
+
+
+
+/*@================================
+ * lz_Read64()
+ *================================*/
+/*
+ * Function: static UEight lz_Read64(const UOne *)
+ *
+ * Description:
+ *  Read 8 bytes at any alignment.
+ *
+ * Returns:
+ *  the 8 bytes
+ */
+static UEight lz_Read64(
+    const UOne          *p)             /* IN bytes */
+{
+    UEight              v;
+
+
+    memcpy(&v, p, sizeof(v));
+
+    return(v);
+
+} /* lz_Read64() */
+
+
+
+/*@================================
+ * lz_Copy()
+ *================================*/
+/*
+ * Function: static void lz_Copy(UOne *, const UOne *, Four)
+ *
+ * Description:
+ *  Copy 'len' bytes 8 at a time, writing up to 7 bytes more. The source
+ *  is at least 8 bytes before the destination if they overlap.
+ *
+ * Returns:
+ *  None
+ */
+static void lz_Copy(
+    UOne                *op,            /* OUT destination */
+    const UOne          *ip,            /* IN source */
+    Four                len)            /* IN # of bytes */
+{
+    UOne                *oend = op + len;
+
+
+    do {
+        memcpy(op, ip, 8);
+        op += 8;
+        ip += 8;
+    } while (op < oend);
+
+} /* lz_Copy() */
+
+
+
+/*@================================
+ * lz_Length()
+ *================================*/
+/*
+ * Function: static UOne *lz_Length(UOne *, Four)
+ *
+ * Description:
+ *  Write the part of a length beyond LZ_RUN_MASK as bytes of 255 and
+ *  a last byte below 255.
+ *
+ * Returns:
+ *  the byte after the length
+ */
+static UOne *lz_Length(
+    UOne                *op,            /* OUT where to write */
+    Four                len)            /* IN length beyond LZ_RUN_MASK */
+{
+    for ( ; len >= 255; len -= 255) *op++ = 255;
+    *op++ = (UOne)len;
+
+    return(op);
+
+} /* lz_Length() */
+
+
+
+/*@================================
+ * lz_Sequence()
+ *================================*/
+/*
+ * Function: static UOne *lz_Sequence(UOne *, UOne *, const UOne *, Four, Four, Four)
+ *
+ * Description:
+ *  Write a sequence of 'litLen' literals followed by a match of
+ *  'matchLen' bytes at 'offset' bytes back, or by no match if 'matchLen'
+ *  is 0.
+ *
+ * Returns:
+ *  1) the byte after the sequence
+ *  2) NULL if the sequence does not fit before 'oend'
+ */
+static UOne *lz_Sequence(
+    UOne                *op,            /* OUT where to write */
+    UOne                *oend,          /* IN end of the output */
+    const UOne          *lit,           /* IN literals */
+    Four                litLen,         /* IN # of literals */
+    Four                offset,         /* IN offset of the match */
+    Four                matchLen)       /* IN length of the match (0: none) */
+{
+    UOne                *token;
+
+
+    /* token, literals, their length, offset and match length, at most */
+    if (oend - op < 1 + litLen + litLen / 255 + 1 + 2 + matchLen / 255 + 1) return(NULL);
+
+    token = op++;
+    if (litLen >= LZ_RUN_MASK) {
+        *token = LZ_RUN_MASK << 4;
+        op = lz_Length(op, litLen - LZ_RUN_MASK);
+    }
+    else
+        *token = (UOne)(litLen << 4);
+
+    memcpy(op, lit, litLen);
+    op += litLen;
+
+    if (matchLen > 0) {
+        *op++ = (UOne)(offset & 0xff);
+        *op++ = (UOne)(offset >> 8);
+
+        matchLen -= LZ_MIN_MATCH;
+        if (matchLen >= LZ_RUN_MASK) {
+            *token |= LZ_RUN_MASK;
+            op = lz_Length(op, matchLen - LZ_RUN_MASK);
+        }
+        else
+            *token |= (UOne)matchLen;
+    }
+
+    return(op);
+
+} /* lz_Sequence() */
+
+
+
+/*@================================
+ * edubfm_Compress()
+ *================================*/
+/*
+ * Function: Four edubfm_Compress(char *, Four, char *, Four)
+ *
+ * Description:
+ *  Compress 'n' bytes into at most 'cap' bytes.
+ *
+ * Returns:
+ *  1) # of bytes of the compressed image
+ *  2) 0 if the image does not fit in 'cap' bytes
+ */
+Four edubfm_Compress(
+    char                *src,           /* IN bytes to be compressed */
+    Four                n,              /* IN # of bytes */
+    char                *dst,           /* OUT compressed image */
+    Four                cap)            /* IN size of 'dst' */
+{
+    const UOne          *base = (const UOne *)src;
+    const UOne          *ip = base;     /* current position */
+    const UOne          *anchor = base; /* first byte not yet written */
+    const UOne          *end = base + n;
+    const UOne          *ref, *mp, *mlimit;
+    UOne                *op = (UOne *)dst;
+    UOne                *oend = (UOne *)dst + cap;
+    UTwo                table[1 << LZ_HASH_BITS];       /* last position of each hash (mod 2^16; a match is checked) */
+    Four                h;
+    UFour               v;
+    UEight              diff;           /* bytes of a match and its reference that differ */
+
+
+    memset(table, 0, sizeof(table));
+
+    if (n > LZ_MATCH_LIMIT) {
+        mlimit = end - LZ_LAST_LITERALS;
+
+        for (ip++; ip < end - LZ_MATCH_LIMIT; ) {
+            v = lz_Read32(ip);
+            h = LZ_HASH(v);
+            ref = base + table[h];
+            table[h] = (UTwo)(ip - base);
+
+            if (ref >= ip || ip - ref > LZ_MAX_OFFSET || lz_Read32(ref) != v) {
+                ip += 1 + ((ip - anchor) >> LZ_SKIP_SHIFT);
+                continue;
+            }
+
+            /* extend the match forward and backward */
+            for (mp = ip + LZ_MIN_MATCH, ref += LZ_MIN_MATCH; mp + 8 <= mlimit; mp += 8, ref += 8)
+                if ((diff = lz_Read64(mp) ^ lz_Read64(ref)) != 0) break;
+            if (mp + 8 <= mlimit) {
+                mp += __builtin_ctzll(diff) >> 3;
+                ref += __builtin_ctzll(diff) >> 3;
+            }
+            else
+                for ( ; mp < mlimit && *mp == *ref; mp++, ref++);
+            ref -= mp - ip;
+            for ( ; ip > anchor && ref > base && ip[-1] == ref[-1]; ip--, ref--);
+
+            op = lz_Sequence(op, oend, anchor, (Four)(ip - anchor), (Four)(ip - ref), (Four)(mp - ip));
+            if (op == NULL) return(0);
+
+            ip = anchor = mp;
+
+            /* the positions skipped by the match are found again through this one */
+            if (ip < end - LZ_MATCH_LIMIT) table[LZ_HASH(lz_Read32(ip - 2))] = (UTwo)(ip - 2 - base);
+        }
+    }
+
+    op = lz_Sequence(op, oend, anchor, (Four)(end - anchor), 0, 0);
+    if (op == NULL) return(0);
+
+    return((Four)(op - (UOne *)dst));
+
+} /* edubfm_Compress() */
+
+
+
+/*@================================
+ * edubfm_Decompress()
+ *================================*/
+/*
+ * Function: Boolean edubfm_Decompress(char *, Four, char *, Four)
+ *
+ * Description:
+ *  Decompress an image made by edubfm_Compress() into exactly 'n' bytes.
+ *  A damaged image is detected before anything is read or written out of
+ *  bounds.
+ *
+ * Returns:
+ *  TRUE if the image decompresses into 'n' bytes
+ */
+Boolean edubfm_Decompress(
+    char                *src,           /* IN compressed image */
+    Four                srcLen,         /* IN # of bytes of the image */
+    char                *dst,           /* OUT decompressed bytes */
+    Four                n)              /* IN # of bytes to be decompressed */
+{
+    const UOne          *ip = (const UOne *)src;
+    const UOne          *iend = ip + srcLen;
+    UOne                *op = (UOne *)dst;
+    UOne                *oend = op + n;
+    const UOne          *ref;
+    Four                token, len, offset, b;
+
+
+    while (ip < iend) {
+        token = *ip++;
+
+        len = token >> 4;
+        if (len == LZ_RUN_MASK)
+            do {
+                if (ip >= iend) return(FALSE);
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+
+        if (len > iend - ip || len > oend - op) return(FALSE);
+        if (len <= iend - ip - 8 && len <= oend - op - 8) lz_Copy(op, ip, len);
+        else memcpy(op, ip, len);
+        ip += len;
+        op += len;
+
+        /* the last sequence has no match */
+        if (ip == iend) break;
+
+        if (iend - ip < 2) return(FALSE);
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op - (UOne *)dst) return(FALSE);
+
+        len = token & LZ_RUN_MASK;
+        if (len == LZ_RUN_MASK)
+            do {
+                if (ip >= iend) return(FALSE);
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        len += LZ_MIN_MATCH;
+        if (len > oend - op) return(FALSE);
+
+        /* a match may overlap the bytes it produces */
+        ref = op - offset;
+        if (offset >= 8 && len <= oend - op - 8) {
+            lz_Copy(op, ref, len);
+            op += len;
+        }
+        else
+            while (len-- > 0) *op++ = *ref++;
+    }
+
+    return(op == oend);
+
+} /* edubfm_Decompress() */
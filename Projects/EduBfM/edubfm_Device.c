@@ -0,0 +1,189 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Device.c
+ *
+ * Description:
+ *  Devices of the volumes attached by EduBfM_AttachVolume(). A volume
+ *  consists of one device and page 'pageNo' is stored at offset
+ *  pageNo * PAGESIZE of the device.
+ *  The trains are read and written by the I/O engines (edubfm_IOEngine.c).
+ *  A device is also opened for the direct I/O if its file system supports
+ *  it; the buffer pools configured for the direct I/O (BfMConfig.directIO)
+ *  read and write their trains by that descriptor, straight from and into
+ *  their frames, and the misses and the victims of those pools on the
+ *  attached volumes go to the device instead of the storage system.
+ *  The reads and the writes of the other volumes by RDsM are serialized
+ *  by edubfm_rdsmLatch, since they are made without the pool latch.
+ *
+ * Exports:
+ *  BfMDevice *edubfm_FindDevice(VolNo)
+ *  Four edubfm_DeviceFd(BfMDevice *, Four)
+ *  Four edubfm_DeviceIO(BfMDevice *, Four, Four, PageNo, Four, char *)
+ */
+
+
+#include <sys/uio.h>
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* attached volumes */
+BfMDevice edubfm_devices[BFM_MAX_ATTACHED_VOLUMES] = {
+    { NIL, NIL, NIL }, { NIL, NIL, NIL },
+    { NIL, NIL, NIL }, { NIL, NIL, NIL },
+    { NIL, NIL, NIL }, { NIL, NIL, NIL },
+    { NIL, NIL, NIL }, { NIL, NIL, NIL },
+    { NIL, NIL, NIL }, { NIL, NIL, NIL },
+    { NIL, NIL, NIL }, { NIL, NIL, NIL },
+    { NIL, NIL, NIL }, { NIL, NIL, NIL },
+    { NIL, NIL, NIL }, { NIL, NIL, NIL }
+};
+
+/* latch of the reads and the writes by RDsM (see RDSM_LATCH()) */
+pthread_mutex_t edubfm_rdsmLatch = PTHREAD_MUTEX_INITIALIZER;
+
+
+
+/*@================================
+ * edubfm_FindDevice()
+ *================================*/
+/*
+ * Function: BfMDevice *edubfm_FindDevice(VolNo)
+ *
+ * Description:
+ *  Find the attached volume.
+ *
+ * Returns:
+ *  pointer to the entry of the volume (NULL if not attached)
+ */
+BfMDevice *edubfm_FindDevice(
+    VolNo               volNo)          /* IN volume number */
+{
+    Four                i;
+
+
+    for (i = 0; i < BFM_MAX_ATTACHED_VOLUMES; i++)
+        if (edubfm_devices[i].volNo == volNo) return(&edubfm_devices[i]);
+
+    return(NULL);
+
+} /* edubfm_FindDevice() */
+
+
+
+/*@================================
+ * edubfm_DeviceFd()
+ *================================*/
+/*
+ * Function: Four edubfm_DeviceFd(BfMDevice *, Four)
+ *
+ * Description:
+ *  Return the file descriptor by which the buffer pool of the given type
+ *  reads and writes the trains of the device.
+ *
+ * Returns:
+ *  file descriptor
+ */
+Four edubfm_DeviceFd(
+    BfMDevice           *dev,           /* IN device */
+    Four                type)           /* IN buffer type */
+{
+
+    if (BE_CFG(type).directIO && dev->directFd != NIL) return(dev->directFd);
+
+    return(dev->fd);
+
+} /* edubfm_DeviceFd() */
+
+
+
+/*@================================
+ * edubfm_DeviceIO()
+ *================================*/
+/*
+ * Function: Four edubfm_DeviceIO(BfMDevice *, Four, Four, PageNo, Four, char *)
+ *
+ * Description:
+ *  Read or write one train of 'nPages' pages of the device synchronously,
+ *  straight from or into the given frame of the buffer pool of the given
+ *  type.
+ *
+ * Returns:
+ *  error code
+ *    eDEVICEIOERR_EDUBFM - the device failed
+ */
+Four edubfm_DeviceIO(
+    BfMDevice           *dev,           /* IN device */
+    Four                type,           /* IN buffer type */
+    Four                op,             /* IN BFM_IO_xxx */
+    PageNo              pageNo,         /* IN first page of the train */
+    Four                nPages,         /* IN size of the train in pages */
+    char                *frame)         /* INOUT frame of the train */
+{
+    BfMIORequest        req;
+    struct iovec        iov;
+
+
+    iov.iov_base = frame;
+    iov.iov_len = (size_t)PAGESIZE * nPages;
+
+    req.op = op;
+    req.fd = edubfm_DeviceFd(dev, type);
+    req.offset = (off_t)pageNo * PAGESIZE;
+    req.iov = &iov;
+    req.nIov = 1;
+    req.type = type;
+
+    edubfm_IODo(&req, 0);
+    if (req.result < eNOERROR) ERR(req.result);
+
+    return(eNOERROR);
+
+} /* edubfm_DeviceIO() */
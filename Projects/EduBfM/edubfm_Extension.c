@@ -0,0 +1,363 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Extension.c
+ *
+ * Description:
+ *  Extension files of the buffer pools (see EduBfM_SetExtensionFile()):
+ *  a second tier of a buffer pool in a file on local fast storage, which
+ *  holds a given number of trains in slots of the size of a train. A
+ *  train evicted clean, or after its dirty image is written (see
+ *  edubfm_AllocTrain()), is written to a slot, and a miss looks it up
+ *  before reading the volume (see edubfm_ReadTrain()), so that it costs
+ *  a single read of the file.
+ *  The directory of the slots is a ghost directory keyed by the trains,
+ *  whose node of a train is the index of its slot; the least recently
+ *  written train gives its slot up when the file is full.
+ *  The file is exclusive like the compressed cache (see edubfm_ZCache.c):
+ *  a train found is taken out of it, and a train read ahead by
+ *  EduBfM_PrefetchTrains() is dropped from it, so that the image in the
+ *  file is always the one on the volume.
+ *  A train is admitted only at its second eviction within the time the
+ *  file holds as many trains as it has slots: a second ghost directory
+ *  remembers the trains evicted once, so that the pages of a scan, which
+ *  are touched once, never churn the file. A train taken out of the file
+ *  is remembered too, to be written back when it is evicted again.
+ *  The file of a pool is read and written by its direct I/O descriptor
+ *  when the pool uses the direct I/O (BfMConfig.directIO), and is
+ *  protected by the pool latch.
+ *
+ * Exports:
+ *  Four edubfm_SetExtension(Four, char *, Four)
+ *  void edubfm_ExtensionInsert(Four, BfMHashKey *, char *)
+ *  Boolean edubfm_ExtensionLookUp(Four, BfMHashKey *, char *)
+ *  void edubfm_ExtensionDelete(Four, BfMHashKey *)
+ *  void edubfm_ExtensionClear(Four)
+ *  Four edubfm_ExtensionUsage(Four)
+ */
+
+
+#define _GNU_SOURCE /* for O_DIRECT */
+#include <fcntl.h>  /* for open */
+#include <unistd.h> /* for close & ftruncate */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* extension files of the buffer pools */
+static struct {
+    Four                nSlots;         /* # of slots of the file (0: no file) */
+    BfMDevice           dev;            /* the file */
+    BfMGhostDir         dir;            /* trains in the slots; the node of a train is its slot */
+    BfMGhostDir         seen;           /* trains to be admitted at their next eviction */
+} ext[NUM_BUF_TYPES];
+
+
+
+/*@================================
+ * extension_Close()
+ *================================*/
+/*
+ * Function: static void extension_Close(Four)
+ *
+ * Description:
+ *  Close the extension file of the buffer pool and free its directories.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+static void extension_Close(
+    Four                type)           /* IN buffer type */
+{
+    if (ext[type].nSlots == 0) return;
+
+    close(ext[type].dev.fd);
+    if (ext[type].dev.directFd != NIL) close(ext[type].dev.directFd);
+    edubfm_GhostFinal(&ext[type].dir);
+    edubfm_GhostFinal(&ext[type].seen);
+    ext[type].nSlots = 0;
+
+} /* extension_Close() */
+
+
+
+/*@================================
+ * edubfm_SetExtension()
+ *================================*/
+/*
+ * Function: Four edubfm_SetExtension(Four, char *, Four)
+ *
+ * Description:
+ *  Make the given file, created anew, the extension file of the buffer
+ *  pool with 'nTrains' slots, or remove the extension file of the pool
+ *  if 'fileName' is NULL.
+ *
+ * Returns:
+ *  error code
+ *    eDEVICEIOERR_EDUBFM - the file cannot be created
+ *    some errors caused by function calls
+ */
+Four edubfm_SetExtension(
+    Four                type,           /* IN buffer type */
+    char                *fileName,      /* IN extension file (NULL: none) */
+    Four                nTrains)        /* IN # of trains the file holds */
+{
+    Four                e;              /* error code */
+    Four                fd;
+    off_t               size;           /* size of the file */
+
+
+    BFM_LATCH(type);
+
+    extension_Close(type);
+    if (fileName == NULL) {
+        BFM_UNLATCH(type);
+        return(eNOERROR);
+    }
+
+    size = (off_t)nTrains * PAGESIZE * BI_BUFSIZE(type);
+    fd = open(fileName, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, size) != 0) {
+        if (fd >= 0) close(fd);
+        BFM_UNLATCH(type);
+        ERR(eDEVICEIOERR_EDUBFM);
+    }
+
+    e = edubfm_GhostInit(&ext[type].dir, nTrains, 0);
+    if (e >= eNOERROR) {
+        e = edubfm_GhostInit(&ext[type].seen, nTrains, 0);
+        if (e < eNOERROR) edubfm_GhostFinal(&ext[type].dir);
+    }
+    if (e < eNOERROR) {
+        close(fd);
+        BFM_UNLATCH(type);
+        ERR(e);
+    }
+
+    ext[type].dev.volNo = NIL;
+    ext[type].dev.fd = fd;
+    ext[type].dev.directFd = open(fileName, O_RDWR | O_DIRECT);
+    if (ext[type].dev.directFd < 0) ext[type].dev.directFd = NIL;
+    ext[type].nSlots = nTrains;
+
+    BFM_UNLATCH(type);
+
+    return(eNOERROR);
+
+} /* edubfm_SetExtension() */
+
+
+
+/*@================================
+ * edubfm_ExtensionInsert()
+ *================================*/
+/*
+ * Function: void edubfm_ExtensionInsert(Four, BfMHashKey *, char *)
+ *
+ * Description:
+ *  Write a clean train evicted from the buffer pool to the extension file
+ *  if it is admitted, i.e. if it is remembered from an earlier eviction
+ *  or from the file; otherwise remember it. Nothing is done if the pool
+ *  has no extension file, and the train is dropped if the write fails.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ExtensionInsert(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key,           /* IN train evicted */
+    char                *frame)         /* IN frame holding the train */
+{
+    Four                node;
+    Four                slot;
+
+
+    if (ext[type].nSlots == 0) return;
+
+    node = edubfm_GhostLookUp(&ext[type].dir, key);
+    if (node != NIL) edubfm_GhostDelete(&ext[type].dir, node);
+
+    node = edubfm_GhostLookUp(&ext[type].seen, key);
+    if (node == NIL) {
+        (void) edubfm_GhostInsert(&ext[type].seen, 0, key);
+        return;
+    }
+    edubfm_GhostDelete(&ext[type].seen, node);
+
+    slot = edubfm_GhostInsert(&ext[type].dir, 0, key);
+    if (edubfm_DeviceIO(&ext[type].dev, type, BFM_IO_WRITE, slot * BI_BUFSIZE(type), BI_BUFSIZE(type), frame) < eNOERROR) {
+        edubfm_GhostDelete(&ext[type].dir, slot);
+        return;
+    }
+
+    BFM_COUNT(type, nExtensionWrites);
+
+} /* edubfm_ExtensionInsert() */
+
+
+
+/*@================================
+ * edubfm_ExtensionLookUp()
+ *================================*/
+/*
+ * Function: Boolean edubfm_ExtensionLookUp(Four, BfMHashKey *, char *)
+ *
+ * Description:
+ *  Take the train out of the extension file into the frame, if the file
+ *  holds it. The train is read from the volume instead if the read of
+ *  the file fails.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  TRUE if the train has been put into the frame
+ */
+Boolean edubfm_ExtensionLookUp(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key,           /* IN train missed */
+    char                *frame)         /* OUT frame for the train */
+{
+    Four                slot;
+    Four                e;              /* error code */
+
+
+    if (ext[type].nSlots == 0) return(FALSE);
+
+    slot = edubfm_GhostLookUp(&ext[type].dir, key);
+    if (slot == NIL) return(FALSE);
+
+    e = edubfm_DeviceIO(&ext[type].dev, type, BFM_IO_READ, slot * BI_BUFSIZE(type), BI_BUFSIZE(type), frame);
+    edubfm_GhostDelete(&ext[type].dir, slot);
+    if (e < eNOERROR) return(FALSE);
+
+    /* the train goes back to the file when it is evicted again */
+    (void) edubfm_GhostInsert(&ext[type].seen, 0, key);
+    BFM_COUNT(type, nExtensionHits);
+
+    return(TRUE);
+
+} /* edubfm_ExtensionLookUp() */
+
+
+
+/*@================================
+ * edubfm_ExtensionDelete()
+ *================================*/
+/*
+ * Function: void edubfm_ExtensionDelete(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Drop the train from the extension file, if the file holds it, because
+ *  the train is being read into the buffer pool by another way.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ExtensionDelete(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key)           /* IN train */
+{
+    Four                slot;
+
+
+    if (ext[type].nSlots == 0) return;
+
+    slot = edubfm_GhostLookUp(&ext[type].dir, key);
+    if (slot != NIL) edubfm_GhostDelete(&ext[type].dir, slot);
+
+} /* edubfm_ExtensionDelete() */
+
+
+
+/*@================================
+ * edubfm_ExtensionClear()
+ *================================*/
+/*
+ * Function: void edubfm_ExtensionClear(Four)
+ *
+ * Description:
+ *  Drop every train from the extension file of the buffer pool and
+ *  forget the trains evicted, keeping the file.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ExtensionClear(
+    Four                type)           /* IN buffer type */
+{
+    if (ext[type].nSlots == 0) return;
+
+    edubfm_GhostTrim(&ext[type].dir, 0, 0);
+    edubfm_GhostTrim(&ext[type].seen, 0, 0);
+
+} /* edubfm_ExtensionClear() */
+
+
+
+/*@================================
+ * edubfm_ExtensionUsage()
+ *================================*/
+/*
+ * Function: Four edubfm_ExtensionUsage(Four)
+ *
+ * Description:
+ *  Return the number of trains held by the extension file of the pool.
+ *
+ * Returns:
+ *  # of trains
+ */
+Four edubfm_ExtensionUsage(
+    Four                type)           /* IN buffer type */
+{
+    return((ext[type].nSlots > 0) ? ext[type].dir.list[0].len : 0);
+
+} /* edubfm_ExtensionUsage() */
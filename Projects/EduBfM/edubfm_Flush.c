@@ -0,0 +1,363 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Flush.c
+ *
+ * Description:
+ *  Flush all dirty buffers of a buffer pool in disk order.
+ *  The dirty trains are sorted by (volNo, pageNo). On a volume attached by
+ *  EduBfM_AttachVolume(), the trains on consecutive pages are written by
+ *  one vectored write, and the writes are submitted together to the I/O
+ *  engine, at most flushDepth of the pool configuration at a time. On the
+ *  other volumes the trains are written one by one through
+ *  RDsM_WriteTrain().
+ *
+ * Exports:
+ *  Four edubfm_FlushPool(Four)
+ */
+
+
+#include <stdlib.h> /* for malloc, free & qsort */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+#include "RDsM.h"
+#include "RM.h"
+
+
+/* maximum # of trains written by one vectored write */
+#define FLUSH_MAX_RUN           256
+
+/* a dirty train */
+typedef struct {
+    VolNo               volNo;
+    PageNo              pageNo;
+    Four                idx;            /* index of the buffer */
+    Four                nPages;         /* size of the train in pages */
+} FlushEntry;
+
+/* trains on consecutive pages written by one vectored write */
+typedef struct {
+    Four                first;          /* index of the first entry */
+    Four                n;              /* # of entries */
+    BfMIORequest        req;            /* the write */
+} FlushRun;
+
+
+
+/*@================================
+ * flush_Compare()
+ *================================*/
+/*
+ * Function: static int flush_Compare(const void *, const void *)
+ *
+ * Description:
+ *  Order the dirty trains by (volNo, pageNo) for qsort().
+ *
+ * Returns:
+ *  negative, 0, or positive
+ */
+static int flush_Compare(
+    const void          *a,             /* IN FlushEntry */
+    const void          *b)             /* IN FlushEntry */
+{
+    const FlushEntry    *x = (const FlushEntry *)a;
+    const FlushEntry    *y = (const FlushEntry *)b;
+
+
+    if (x->volNo != y->volNo) return((x->volNo < y->volNo) ? -1 : 1);
+    if (x->pageNo != y->pageNo) return((x->pageNo < y->pageNo) ? -1 : 1);
+
+    return(0);
+
+} /* flush_Compare() */
+
+
+
+/*@================================
+ * flush_NextDirty()
+ *================================*/
+/*
+ * Function: static Four flush_NextDirty(Four, Four)
+ *
+ * Description:
+ *  Find the first buffer from 'from' on which may be dirty. In a pool
+ *  shared with the storage system (BfMConfig.shared), whose buffer
+ *  manager sets the dirty bits of the buffer table of bufInfo[] without
+ *  the dirty map, the dirty bits of those buffers are read instead of the
+ *  map; the buffers added by EduBfM_ResizePool() are only known to EduBfM.
+ *
+ * Returns:
+ *  buffer index, or NIL if there is none
+ */
+static Four flush_NextDirty(
+    Four                type,           /* IN buffer type */
+    Four                from)           /* IN first buffer to look at */
+{
+    if (BE_CFG(type).shared)
+        for ( ; from < BE_NBASEBUFS(type) && from < BE_NBUFS(type); from++)
+            if (BFM_ATOMIC_LOAD(BI_BITS(type, from)) & DIRTY) return(from);
+
+    return(edubfm_NextDirty(type, from, BE_NBUFS(type)));
+
+} /* flush_NextDirty() */
+
+
+
+/*@================================
+ * flush_TrainPages()
+ *================================*/
+/*
+ * Function: static Four flush_TrainPages(Four, Four)
+ *
+ * Description:
+ *  Return the size of the dirty train in the buffer. A train neither on
+ *  the dirty map nor in the page table was loaded and dirtied by the
+ *  buffer manager of the storage system, whose trains keep the size it
+ *  gave the pool, whatever page size EduBfM_SetPageSize() gave the volume.
+ *
+ * Returns:
+ *  size of the train in pages of PAGESIZE
+ */
+static Four flush_TrainPages(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    BfMHashKey          *key = &BI_KEY(type, idx);
+    pthread_mutex_t     *latch;
+    Four                i;
+
+
+    if (BFM_ATOMIC_LOAD(BE_DIRTYMAP(type, idx / 64)) & DIRTYMAP_BIT(idx))
+        return(edubfm_TrainPages(type, key->volNo));
+
+    latch = edubfm_PageTableLatch(&BE_PAGETABLE(type), key);
+    pthread_mutex_lock(latch);
+    i = edubfm_PageTableLookUp(&BE_PAGETABLE(type), key);
+    pthread_mutex_unlock(latch);
+
+    return((i == idx) ? edubfm_TrainPages(type, key->volNo) : BE_BASEBUFSIZE(type));
+
+} /* flush_TrainPages() */
+
+
+
+/*@================================
+ * flush_WriteRuns()
+ *================================*/
+/*
+ * Function: static void flush_WriteRuns(Four, FlushEntry *, FlushRun *, Four, struct iovec *)
+ *
+ * Description:
+ *  Write the runs, keeping at most flushDepth writes in flight, and
+ *  store the result of each write in its request.
+ *
+ * Returns:
+ *  None
+ */
+static void flush_WriteRuns(
+    Four                type,           /* IN buffer type */
+    FlushEntry          *entries,       /* IN dirty trains */
+    FlushRun            *runs,          /* INOUT runs */
+    Four                nRuns,          /* IN # of runs */
+    struct iovec        *iov)           /* OUT buffers; one element per entry */
+{
+    Four                r, i, k, depth;
+    BfMIORequest        *reqs[FLUSH_MAX_RUN];
+    BfMIOBatch          batch;
+
+
+    for (r = 0; r < nRuns; r++) {
+        for (i = runs[r].first; i < runs[r].first + runs[r].n; i++) {
+            iov[i].iov_base = BI_BUFFER(type, entries[i].idx);
+            iov[i].iov_len = (size_t)PAGESIZE * entries[i].nPages;
+        }
+        runs[r].req.op = BFM_IO_WRITE;
+        runs[r].req.type = type;
+        runs[r].req.fd = edubfm_DeviceFd(edubfm_FindDevice(entries[runs[r].first].volNo), type);
+        runs[r].req.offset = (off_t)entries[runs[r].first].pageNo * PAGESIZE;
+        runs[r].req.iov = &iov[runs[r].first];
+        runs[r].req.nIov = runs[r].n;
+    }
+
+    depth = BE_CFG(type).flushDepth;
+    if (depth <= 0) depth = nRuns;
+
+    for (r = 0; r < nRuns; r += depth) {
+        edubfm_IOBatchInit(&batch);
+        for (k = r; k < nRuns && k < r + depth; ) {
+            for (i = 0; k < nRuns && k < r + depth && i < FLUSH_MAX_RUN; i++, k++) {
+                edubfm_IOBatchAdd(&batch, &runs[k].req);
+                reqs[i] = &runs[k].req;
+            }
+            edubfm_IOSubmit(reqs, i);
+        }
+        (void) edubfm_IOBatchWait(&batch);
+    }
+
+} /* flush_WriteRuns() */
+
+
+
+/*@================================
+ * edubfm_FlushPool()
+ *================================*/
+/*
+ * Function: Four edubfm_FlushPool(Four)
+ *
+ * Description:
+ *  Flush the dirty buffers of the buffer pool in disk order. They are
+ *  found on the dirty map, so that a flush costs as much as the dirty
+ *  buffers, not the whole pool, except that the dirty bits of the buffer
+ *  table of bufInfo[] are read one by one in a pool shared with the
+ *  storage system (see flush_NextDirty()).
+ *  The caller holds the pool latch. The dirty bit of a buffer is cleared
+ *  before the buffer is written, so that an update made during the write
+ *  is not lost; a buffer whose write fails is dirtied again. A buffer
+ *  dirtied while the dirty buffers are gathered is left to the next flush.
+ *
+ * Returns:
+ *  error code
+ *    eNOTSUPPORTED_EDUBFM - rollback is required
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_FlushPool(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                eFirst = eNOERROR;
+    Four                i, k, n, nRuns;
+    Four                maxEntries;     /* # of dirty buffers counted */
+    FlushEntry          *entries;
+    FlushRun            *runs;
+    struct iovec        *iov;
+
+
+    /* the background writer may be writing an older image of a train */
+    edubfm_WaitWriter(type, NIL);
+
+    for (n = 0, i = 0; (i = flush_NextDirty(type, i)) != NIL; i++)
+        if ((BI_BITS(type, i) & DIRTY) && !IS_NILBFMHASHKEY(BI_KEY(type, i))) n++;
+    if (n == 0) return(eNOERROR);
+    maxEntries = n;
+
+    /* Error check whether using not supported functionality by EduBfM */
+    if (RM_IS_ROLLBACK_REQUIRED()) ERR(eNOTSUPPORTED_EDUBFM);
+
+    entries = (FlushEntry *)malloc(sizeof(FlushEntry) * n);
+    runs = (FlushRun *)malloc(sizeof(FlushRun) * n);
+    iov = (struct iovec *)malloc(sizeof(struct iovec) * n);
+    if (entries == NULL || runs == NULL || iov == NULL) {
+        free(entries);
+        free(runs);
+        free(iov);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (n = 0, i = 0; n < maxEntries && (i = flush_NextDirty(type, i)) != NIL; i++)
+        if ((BI_BITS(type, i) & DIRTY) && !IS_NILBFMHASHKEY(BI_KEY(type, i))) {
+            entries[n].volNo = BI_KEY(type, i).volNo;
+            entries[n].pageNo = BI_KEY(type, i).pageNo;
+            entries[n].idx = i;
+            entries[n].nPages = flush_TrainPages(type, i);
+            n++;
+        }
+
+    qsort(entries, n, sizeof(FlushEntry), flush_Compare);
+
+    /* write the trains on the volumes not attached; gather the runs of the others */
+    for (nRuns = 0, i = 0; i < n; i++) {
+        if (edubfm_FindDevice(entries[i].volNo) == NULL) {
+            (void) edubfm_MarkClean(type, entries[i].idx);
+            RDSM_LATCH();
+            e = RDsM_WriteTrain(BI_BUFFER(type, entries[i].idx), (TrainID *)&BI_KEY(type, entries[i].idx),
+                                entries[i].nPages);
+            RDSM_UNLATCH();
+            if (e < eNOERROR) {
+                (void) edubfm_MarkDirty(type, entries[i].idx);
+                if (eFirst == eNOERROR) eFirst = e;
+            }
+            continue;
+        }
+        else if (nRuns > 0 && runs[nRuns-1].n < FLUSH_MAX_RUN
+                 && entries[i].volNo == entries[i-1].volNo
+                 && entries[i].pageNo == entries[i-1].pageNo + entries[i-1].nPages
+                 && runs[nRuns-1].first + runs[nRuns-1].n == i) {
+            runs[nRuns-1].n++;
+        }
+        else {
+            runs[nRuns].first = i;
+            runs[nRuns].n = 1;
+            nRuns++;
+        }
+    }
+
+    for (k = 0; k < nRuns; k++)
+        for (i = runs[k].first; i < runs[k].first + runs[k].n; i++)
+            (void) edubfm_MarkClean(type, entries[i].idx);
+
+    flush_WriteRuns(type, entries, runs, nRuns, iov);
+
+    for (k = 0; k < nRuns; k++) {
+        if (runs[k].req.result < eNOERROR) {
+            if (eFirst == eNOERROR) eFirst = runs[k].req.result;
+            for (i = runs[k].first; i < runs[k].first + runs[k].n; i++)
+                (void) edubfm_MarkDirty(type, entries[i].idx);
+        }
+    }
+
+    free(entries);
+    free(runs);
+    free(iov);
+
+    if (eFirst < eNOERROR) ERR(eFirst);
+
+    return(eNOERROR);
+
+} /* edubfm_FlushPool() */
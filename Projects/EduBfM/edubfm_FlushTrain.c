@@ -54,6 +54,7 @@
  *
  * Exports:
  *  Four edubfm_FlushTrain(TrainID *, Four)
+ *  Four edubfm_FlushVictim(Four, Four)
  */
 
 #include "EduBfM_common.h"
@@ -61,6 +62,49 @@
 #include "RDsM.h"
 #include "RM.h"
 
+
+
+/*@================================
+ * flushtrain_Write()
+ *================================*/
+/*
+ * Function: static Four flushtrain_Write(TrainID *, char *, Four)
+ *
+ * Description:
+ *  Write the train from the buffer to its volume, to the device of the
+ *  volume if the pool uses the direct I/O, and by RDsM_WriteTrain()
+ *  otherwise.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four flushtrain_Write(
+    TrainID *trainId, /* IN train to be written */
+    char *aTrain,     /* IN buffer holding the train */
+    Four type)        /* IN buffer type */
+{
+    Four e;     /* for errors */
+    UEight start; /* time the write is started */
+    BfMDevice *dev; /* device of the volume if attached */
+
+    start = edubfm_Now();
+    if (BE_CFG(type).directIO && (dev = edubfm_FindDevice(trainId->volNo)) != NULL)
+        e = edubfm_DeviceIO(dev, type, BFM_IO_WRITE, trainId->pageNo, edubfm_TrainPages(type, trainId->volNo), aTrain);
+    else {
+        RDSM_LATCH();
+        e = RDsM_WriteTrain(aTrain, trainId, edubfm_TrainPages(type, trainId->volNo));
+        RDSM_UNLATCH();
+    }
+    if (e < 0) ERR(e);
+    BFM_COUNT_VALUE(type, writeNs, edubfm_Now() - start);
+
+    return (eNOERROR);
+
+} /* flushtrain_Write */
+
+
+
 /*@================================
  * edubfm_FlushTrain()
  *================================*/
@@ -76,6 +120,8 @@
  *  in order to look up the buffer in the buffer pool. If it is successfully
  *  found, then force it out to the disk using RDsM, especially
  *  RDsM_WriteTrain().
+ *  A buffer pool configured for the direct I/O (BfMConfig.directIO) writes
+ *  the trains of the attached volumes to their devices instead.
  *
  * Returns:
  *  error code
@@ -92,13 +138,18 @@ Four edubfm_FlushTrain(
     /* Error check whether using not supported functionality by EduBfM */
     if (RM_IS_ROLLBACK_REQUIRED()) ERR(eNOTSUPPORTED_EDUBFM);
 
-    index = edubfm_LookUp(trainId, type);
+    /* the background writer may be writing an older image of the train, or the buffer is written back as a victim */
+    while ((index = edubfm_LookUp(trainId, type)) >= 0 && BE_IOSTATE(type, index) == IO_WRITING)
+        edubfm_WaitWriter(type, index);
     if(index < 0) return(eNOTFOUND_BFM);
 
-    if(BI_BITS(type, index) & DIRTY != 0){
-        e = RDsM_WriteTrain(BI_BUFFER(type, index), trainId, BI_BUFSIZE(type));
-        if (e < 0) ERR(e);
-        BI_BITS(type,index) &= (~DIRTY);
+    /* clear the bit first so that an update made during the write is kept */
+    if(edubfm_MarkClean(type, index)){
+        e = flushtrain_Write(trainId, BI_BUFFER(type, index), type);
+        if (e < 0) {
+            (void) edubfm_MarkDirty(type, index);
+            ERR(e);
+        }
     }
     
     
@@ -106,3 +157,57 @@ Four edubfm_FlushTrain(
     return (eNOERROR);
 
 } /* edubfm_FlushTrain */
+
+
+
+/*@================================
+ * edubfm_FlushVictim()
+ *================================*/
+/*
+ * Function: Four edubfm_FlushVictim(Four, Four)
+ *
+ * Description:
+ *  Write back the dirty victim claimed by the caller (see
+ *  edubfm_ClaimVictim()). The pool latch, which the caller holds, is
+ *  released over the write so that the hits and the misses of the pool
+ *  do not wait for it; the victim stays claimed, and IO_WRITING so that
+ *  a flush of the pool waits for the write (see edubfm_WaitWriter()).
+ *  A victim dirtied again during the write is given up by the caller
+ *  (see edubfm_UnmapVictim()).
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubfm_FlushVictim(
+    Four type,        /* IN buffer type */
+    Four index)       /* IN claimed victim */
+{
+    Four e;     /* for errors */
+    BfMHashKey key; /* train of the victim */
+
+    if (RM_IS_ROLLBACK_REQUIRED()) ERR(eNOTSUPPORTED_EDUBFM);
+
+    /* clear the bit first so that an update made during the write is kept */
+    if (!edubfm_MarkClean(type, index)) return(eNOERROR);
+
+    key = BI_KEY(type, index);
+    BFM_ATOMIC_STORE(BE_IOSTATE(type, index), IO_WRITING);
+    BE_NIOS(type)++;
+    BFM_UNLATCH(type);
+
+    e = flushtrain_Write((TrainID *)&key, BI_BUFFER(type, index), type);
+
+    BFM_LATCH(type);
+    BFM_ATOMIC_STORE(BE_IOSTATE(type, index), IO_NONE);
+    BE_NIOS(type)--;
+    pthread_cond_broadcast(&BE_WRITEDONE(type));
+
+    if (e < 0) {
+        (void) edubfm_MarkDirty(type, index);
+        ERR(e);
+    }
+
+    return (eNOERROR);
+
+} /* edubfm_FlushVictim */
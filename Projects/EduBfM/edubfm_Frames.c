@@ -0,0 +1,1080 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Frames.c
+ *
+ * Description:
+ *  Back the frames of a buffer pool by huge pages and spread them over
+ *  the NUMA nodes (BfMConfig.hugePages and BfMConfig.numaNodes).
+ *  The frames this module gives a pool are always new mappings: reserved
+ *  huge pages (hugetlbfs) of 1 GB or 2 MB are tried first if asked for,
+ *  then transparent huge pages, and the mappings are bound to the nodes
+ *  before they are touched. The frames of the buffer table of the storage
+ *  system, which it allocated and frees by free(), are never remapped;
+ *  the trains are copied onto new frames, BI_BUFFERPOOL(type) points to
+ *  them, and the frames of the storage system are set aside in
+ *  BE_SYSFRAMES(type) until edubfm_GiveBackFrames() puts them back when
+ *  the pool is released (see EduBfM_Final()). The frames added by
+ *  EduBfM_ResizePool() are mapped the same way when they are reserved.
+ *  With more than one node, the frames are bound to the nodes in turn,
+ *  BE_NUMASTRIDE(type) bytes at a time, so that each node holds a
+ *  sub-pool of the frames; the pages are placed on the node when they are
+ *  faulted in. A miss takes a free buffer on the node of the calling
+ *  thread if there is one near the top of the free buffer list; the
+ *  victims of the buffer replacement are taken from the whole pool.
+ *  For the direct I/O (BfMConfig.directIO), the frames of the buffer table
+ *  are moved onto new frames unless they are aligned to the pages of the
+ *  system already.
+ *  The frames of a pool are made larger or smaller for the page sizes of
+ *  the volumes it holds trains of (BfMConfig.pageSize) by giving the pool
+ *  new frames the same way, once its trains are evicted.
+ *  The frames of the buffers beyond the buffer table are reserved for
+ *  BfMConfig.maxBufs buffers; if it is raised beyond them, the buffers in
+ *  use there are moved onto a larger reservation.
+ *  Since an optimistic read follows the frames without any latch, the
+ *  frames replaced are never released while the pool is used; every one
+ *  of them is kept on BE_RETIREDFRAMES(type) until edubfm_FinalPool().
+ *
+ * Exports:
+ *  Four edubfm_RemapFrames(Four, Four, Four)
+ *  Four edubfm_AlignFrames(Four)
+ *  Four edubfm_ResizeFrames(Four, Four)
+ *  Four edubfm_ReserveFrames(Four, Four)
+ *  Four edubfm_MapFrames(Four, size_t, char **, size_t *)
+ *  void edubfm_GiveBackFrames(Four)
+ *  void edubfm_FreeRetiredFrames(Four)
+ *  Four edubfm_NumaNodes(void)
+ *  void edubfm_LocalFreeBufFirst(Four)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h> /* for memcpy */
+#include <stdint.h> /* for uintptr_t */
+#include <unistd.h>
+#include <sys/mman.h> /* for mmap & madvise */
+#include <sys/syscall.h> /* for mbind & getcpu */
+#include <linux/mempolicy.h>
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/*@
+ * constant definitions
+ */
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT          26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB            (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB            (30 << MAP_HUGE_SHIFT)
+#endif
+
+#define FRAMES_SMALL_PAGE       ((size_t)4096)
+#define FRAMES_2MB              ((size_t)2 << 20)
+#define FRAMES_1GB              ((size_t)1 << 30)
+
+/* # of free buffers looked at from the top of the free buffer list for one on the caller's node */
+#define FRAMES_LOCAL_SCAN       64
+
+/* file listing the NUMA nodes online, e.g. "0-1" */
+#define FRAMES_NODES_ONLINE     "/sys/devices/system/node/online"
+
+
+/*@
+ * type definitions
+ */
+/* frames replaced, linked on BE_RETIREDFRAMES(type) */
+typedef struct FramesRetired {
+    char                *frames;        /* start of the frames */
+    size_t              size;           /* length of the frames mapped */
+    struct FramesRetired *next;
+} FramesRetired;
+
+
+/*@
+ * internal function prototypes
+ */
+static void frames_LoadNodes(void);
+static size_t frames_PageBytes(Four);
+static char *frames_Map(size_t, Four *, size_t *);
+static void frames_Bind(Four, char *, size_t);
+static Four frames_New(Four, size_t, Four, char **, size_t *);
+static void frames_Retire(Four, FramesRetired *, char *, size_t);
+static void frames_Replace(Four, FramesRetired *, char *, size_t);
+static void frames_EvictAll(Four);
+static Four frames_Node(Four, Four);
+static Four frames_MyNode(Four);
+
+
+/* NUMA nodes online, read once */
+static struct {
+    pthread_once_t      once;
+    Four                nNodes;
+    Four                nodeIds[BFM_MAX_NUMA_NODES];
+} numa = { PTHREAD_ONCE_INIT, 0 };
+
+
+
+/*@================================
+ * frames_LoadNodes()
+ *================================*/
+/*
+ * Function: static void frames_LoadNodes(void)
+ *
+ * Description:
+ *  Read the list of the NUMA nodes online. A host not telling it is
+ *  taken as having node 0 only.
+ *
+ * Returns:
+ *  None
+ */
+static void frames_LoadNodes(void)
+{
+    FILE                *fp;
+    int                 from, to, c;
+
+
+    numa.nNodes = 0;
+
+    fp = fopen(FRAMES_NODES_ONLINE, "r");
+    if (fp != NULL) {
+        while (fscanf(fp, "%d", &from) == 1) {
+            to = from;
+            c = fgetc(fp);
+            if (c == '-' && fscanf(fp, "%d", &to) == 1) c = fgetc(fp);
+            for (; from <= to && from < BFM_MAX_NUMA_NODES && numa.nNodes < BFM_MAX_NUMA_NODES; from++)
+                numa.nodeIds[numa.nNodes++] = from;
+            if (c != ',') break;
+        }
+        fclose(fp);
+    }
+
+    if (numa.nNodes == 0) {
+        numa.nodeIds[0] = 0;
+        numa.nNodes = 1;
+    }
+
+} /* frames_LoadNodes() */
+
+
+
+/*@================================
+ * edubfm_NumaNodes()
+ *================================*/
+/*
+ * Function: Four edubfm_NumaNodes(void)
+ *
+ * Description:
+ *  Return the number of NUMA nodes online.
+ *
+ * Returns:
+ *  # of nodes
+ */
+Four edubfm_NumaNodes(void)
+{
+    pthread_once(&numa.once, frames_LoadNodes);
+
+    return(numa.nNodes);
+
+} /* edubfm_NumaNodes() */
+
+
+
+/*@================================
+ * frames_PageBytes()
+ *================================*/
+/*
+ * Function: static size_t frames_PageBytes(Four)
+ *
+ * Description:
+ *  Return the size of the pages of a kind, which the part of the frames
+ *  mapped anew is aligned to.
+ *
+ * Returns:
+ *  size of the pages in bytes
+ */
+static size_t frames_PageBytes(
+    Four                pages)          /* IN BFM_PAGES_xxx */
+{
+    switch (pages) {
+      case BFM_PAGES_1GB:
+        return(FRAMES_1GB);
+      case BFM_PAGES_2MB:
+      case BFM_PAGES_THP:
+        return(FRAMES_2MB);
+      default:
+        return(FRAMES_SMALL_PAGE);
+    }
+
+} /* frames_PageBytes() */
+
+
+
+/*@================================
+ * frames_Map()
+ *================================*/
+/*
+ * Function: static char *frames_Map(size_t, Four *, size_t *)
+ *
+ * Description:
+ *  Map new anonymous memory of at least 'len' bytes backed by pages of
+ *  the given kind and aligned to them, falling back to the next smaller
+ *  kind while the pages cannot be had. Reserved huge pages are mapped
+ *  only if the system has enough of them; the others are taken as they
+ *  are touched.
+ *
+ * Returns:
+ *  start of the memory (NULL if it could not be mapped)
+ */
+static char *frames_Map(
+    size_t              len,            /* IN length of the memory */
+    Four                *pages,         /* INOUT BFM_PAGES_xxx asked for and had */
+    size_t              *mapped)        /* OUT length of the memory mapped */
+{
+    int                 flags;
+    size_t              bytes;          /* size of the pages */
+    size_t              size;           /* 'len' rounded up to the pages */
+    char                *p, *start;
+
+
+    for (;; (*pages)--) {
+        bytes = frames_PageBytes(*pages);
+        size = (len + bytes - 1) / bytes * bytes;
+
+        flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if (*pages == BFM_PAGES_1GB) flags |= MAP_HUGETLB | MAP_HUGE_1GB;
+        else if (*pages == BFM_PAGES_2MB) flags |= MAP_HUGETLB | MAP_HUGE_2MB;
+        else flags |= MAP_NORESERVE;
+
+        if (*pages == BFM_PAGES_THP) {
+            /* a larger mapping is trimmed to the huge pages */
+            p = (char *)mmap(NULL, size + bytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (p != MAP_FAILED) {
+                start = (char *)(((uintptr_t)p + bytes - 1) / bytes * bytes);
+                if (start > p) munmap(p, start - p);
+                if (p + bytes > start) munmap(start + size, p + bytes - start);
+                (void) madvise(start, size, MADV_HUGEPAGE);
+                break;
+            }
+        }
+        else {
+            start = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (start != MAP_FAILED) break;
+        }
+
+        if (*pages == BFM_PAGES_DEFAULT) return(NULL);
+    }
+
+    *mapped = size;
+
+    return(start);
+
+} /* frames_Map() */
+
+
+
+/*@================================
+ * frames_Bind()
+ *================================*/
+/*
+ * Function: static void frames_Bind(Four, char *, size_t)
+ *
+ * Description:
+ *  Bind each BE_NUMASTRIDE(type) bytes of [addr, addr+len) to the node of
+ *  its sub-pool, so that its pages are placed there when they are faulted
+ *  in. The binding is a preference; a full node lends pages of another.
+ *
+ * Returns:
+ *  None
+ */
+static void frames_Bind(
+    Four                type,           /* IN buffer type */
+    char                *addr,          /* IN start of the frames, aligned to the pages */
+    size_t              len)            /* IN length of the frames */
+{
+    uintptr_t           p, end, next;
+    unsigned long       mask;
+
+
+    if (BE_NUMANODES(type) <= 1) return;
+
+    for (p = (uintptr_t)addr, end = (uintptr_t)addr + len; p < end; p = next) {
+        next = (p / BE_NUMASTRIDE(type) + 1) * BE_NUMASTRIDE(type);
+        if (next > end) next = end;
+
+        mask = 1UL << numa.nodeIds[(p / BE_NUMASTRIDE(type)) % BE_NUMANODES(type)];
+        (void) syscall(SYS_mbind, p, next - p, MPOL_PREFERRED, &mask, BFM_MAX_NUMA_NODES + 1, 0);
+    }
+
+} /* frames_Bind() */
+
+
+
+/*@================================
+ * frames_New()
+ *================================*/
+/*
+ * Function: static Four frames_New(Four, size_t, Four, char **, size_t *)
+ *
+ * Description:
+ *  Map new frames of 'size' bytes for the buffer pool, backed by pages of
+ *  the given kind as far as they can be had, and bind them to the NUMA
+ *  nodes of the pool before they are touched.
+ *
+ * Returns:
+ *  kind of pages the frames are backed by (BFM_PAGES_xxx)
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - the frames could not be mapped
+ */
+static Four frames_New(
+    Four                type,           /* IN buffer type */
+    size_t              size,           /* IN length of the frames */
+    Four                pages,          /* IN BFM_PAGES_xxx asked for */
+    char                **frames,       /* OUT start of the frames */
+    size_t              *mapped)        /* OUT length of the frames mapped */
+{
+    *frames = frames_Map(size, &pages, mapped);
+    if (*frames == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    frames_Bind(type, *frames, *mapped);
+
+    return(pages);
+
+} /* frames_New() */
+
+
+
+/*@================================
+ * edubfm_MapFrames()
+ *================================*/
+/*
+ * Function: Four edubfm_MapFrames(Four, size_t, char **, size_t *)
+ *
+ * Description:
+ *  Map new frames for the buffer pool, backed by the pages and the nodes
+ *  of its configuration. The frames are released by munmap().
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - the frames could not be mapped
+ */
+Four edubfm_MapFrames(
+    Four                type,           /* IN buffer type */
+    size_t              size,           /* IN length of the frames */
+    char                **frames,       /* OUT start of the frames */
+    size_t              *mapped)        /* OUT length of the frames mapped */
+{
+    Four                pages;
+
+
+    pages = frames_New(type, size, BE_CFG(type).hugePages, frames, mapped);
+    if (pages < eNOERROR) ERR(pages);
+
+    if (pages < BE_PAGES(type)) BE_PAGES(type) = pages;
+
+    return(eNOERROR);
+
+} /* edubfm_MapFrames() */
+
+
+
+/*@================================
+ * frames_Retire()
+ *================================*/
+/*
+ * Function: static void frames_Retire(Four, FramesRetired *, char *, size_t)
+ *
+ * Description:
+ *  Put the mapped frames being replaced on BE_RETIREDFRAMES(type), using
+ *  the entry allocated by the caller before the frames were replaced, so
+ *  that they are released by edubfm_FreeRetiredFrames() only.
+ *
+ * Returns:
+ *  None
+ */
+static void frames_Retire(
+    Four                type,           /* IN buffer type */
+    FramesRetired       *retired,       /* IN entry to be linked */
+    char                *frames,        /* IN start of the frames */
+    size_t              size)           /* IN length of the frames mapped */
+{
+    retired->frames = frames;
+    retired->size = size;
+    retired->next = (FramesRetired *)BE_RETIREDFRAMES(type);
+    BE_RETIREDFRAMES(type) = retired;
+
+} /* frames_Retire() */
+
+
+
+/*@================================
+ * frames_Replace()
+ *================================*/
+/*
+ * Function: static void frames_Replace(Four, FramesRetired *, char *, size_t)
+ *
+ * Description:
+ *  Make the new frames the frames of the buffer table. The frames of the
+ *  storage system are set aside in BE_SYSFRAMES(type) the first time, and
+ *  the frames given by this module before are retired, using the entry
+ *  allocated by the caller.
+ *
+ * Returns:
+ *  None
+ */
+static void frames_Replace(
+    Four                type,           /* IN buffer type */
+    FramesRetired       *retired,       /* IN entry for the old frames */
+    char                *frames,        /* IN start of the new frames */
+    size_t              mapped)         /* IN length of the new frames mapped */
+{
+    if (BE_SYSFRAMES(type) == NULL) {
+        BE_SYSFRAMES(type) = BI_BUFFERPOOL(type);
+        free(retired);
+    }
+    else
+        frames_Retire(type, retired, BI_BUFFERPOOL(type), BE_FRAMESSIZE(type));
+
+    BI_BUFFERPOOL(type) = frames;
+    BE_FRAMESSIZE(type) = mapped;
+
+} /* frames_Replace() */
+
+
+
+/*@================================
+ * frames_EvictAll()
+ *================================*/
+/*
+ * Function: static void frames_EvictAll(Four)
+ *
+ * Description:
+ *  Evict every train of the buffer pool, whose dirty trains are written.
+ *
+ * Returns:
+ *  None
+ */
+static void frames_EvictAll(
+    Four                type)           /* IN buffer type */
+{
+    Four                idx;
+
+
+    for (idx = 0; idx < BE_NBUFS(type); idx++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, idx))) continue;
+        (void) edubfm_Delete(&BI_KEY(type, idx), type);
+        SET_NILBFMHASHKEY(BI_KEY(type, idx));
+        BI_BITS(type, idx) = ALL_0;
+        BFM_COUNT(type, nEvictions);
+    }
+
+} /* frames_EvictAll() */
+
+
+
+/*@================================
+ * edubfm_RemapFrames()
+ *================================*/
+/*
+ * Function: Four edubfm_RemapFrames(Four, Four, Four)
+ *
+ * Description:
+ *  Move all the frames of the buffer pool onto new frames backed by pages
+ *  of the given kind and spread over the given number of NUMA nodes, and
+ *  make them the configuration of the pool. The hits are kept off the
+ *  frames while they move (see edubfm_HoldFrame()), so no buffer may be
+ *  fixed. The old frames are kept for the optimistic reads still on them.
+ *  The number of nodes is limited to the nodes online.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    eREMAPFIXEDBUF_EDUBFM - a buffer is fixed
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_RemapFrames(
+    Four                type,           /* IN buffer type */
+    Four                pages,          /* IN BFM_PAGES_xxx */
+    Four                numaNodes)      /* IN # of NUMA nodes (0: not bound) */
+{
+    Four                e = eNOERROR;   /* error code */
+    Four                idx, n;
+    Four                nExtUsed;       /* # of buffers in use beyond the buffer table */
+    Four                got;            /* kind of pages the frames are backed by */
+    Four                extGot;         /* kind of pages the frames beyond it are backed by */
+    Four                oldNodes = BE_NUMANODES(type);
+    size_t              oldStride = BE_NUMASTRIDE(type);
+    size_t              frameSize = (size_t)PAGESIZE * BI_BUFSIZE(type);
+    size_t              mapped, extMapped;      /* bytes of the new frames mapped */
+    char                *frames = NULL; /* the new frames of the buffer table */
+    char                *extFrames = NULL;      /* the new frames beyond it */
+    One                 *states;        /* former I/O states of the buffers */
+    FramesRetired       *retired[2];    /* entries of the old frames on BE_RETIREDFRAMES(type) */
+
+
+    if (numaNodes > edubfm_NumaNodes()) numaNodes = edubfm_NumaNodes();
+
+    /* the trains being written by the background writer or read ahead are in fixed buffers */
+    edubfm_WaitWriter(type, NIL);
+    edubfm_ReapPrefetches(type, TRUE);
+
+    states = (One *)malloc(BE_NBUFS(type));
+    retired[0] = (FramesRetired *)malloc(sizeof(FramesRetired));
+    retired[1] = (FramesRetired *)malloc(sizeof(FramesRetired));
+    if (states == NULL || retired[0] == NULL || retired[1] == NULL) {
+        free(states);
+        free(retired[0]);
+        free(retired[1]);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (n = 0; n < BE_NBUFS(type); n++)
+        if (!edubfm_HoldFrame(type, n, &states[n])) {
+            e = eREMAPFIXEDBUF_EDUBFM;
+            break;
+        }
+
+    if (e >= eNOERROR) {
+        BE_NUMANODES(type) = numaNodes;
+        BE_NUMASTRIDE(type) = (frames_PageBytes(pages) > FRAMES_2MB) ? frames_PageBytes(pages) : FRAMES_2MB;
+
+        got = frames_New(type, frameSize * BE_NBASEBUFS(type), pages, &frames, &mapped);
+
+        if (got >= eNOERROR && BE_EXTFRAMES(type) != NULL) {
+            extGot = frames_New(type, frameSize * (BE_MAXBUFS(type) - BE_NBASEBUFS(type)), pages, &extFrames, &extMapped);
+            if (extGot < eNOERROR) munmap(frames, mapped);
+            if (extGot < got) got = extGot;
+        }
+
+        if (got < eNOERROR) {
+            e = got;
+            BE_NUMANODES(type) = oldNodes;
+            BE_NUMASTRIDE(type) = oldStride;
+        }
+    }
+
+    if (e >= eNOERROR) {
+        memcpy(frames, BI_BUFFERPOOL(type), frameSize * BE_NBASEBUFS(type));
+        frames_Replace(type, retired[0], frames, mapped);
+        retired[0] = NULL;
+
+        if (extFrames != NULL) {
+            nExtUsed = (BE_NBUFS(type) > BE_NBASEBUFS(type)) ? BE_NBUFS(type) - BE_NBASEBUFS(type) : 0;
+            memcpy(extFrames, BE_EXTFRAMES(type), frameSize * nExtUsed);
+            frames_Retire(type, retired[1], BE_EXTFRAMES(type), BE_EXTSIZE(type));
+            retired[1] = NULL;
+            BE_EXTFRAMES(type) = extFrames;
+            BE_EXTSIZE(type) = extMapped;
+        }
+
+        BE_PAGES(type) = got;
+        BE_CFG(type).hugePages = pages;
+        BE_CFG(type).numaNodes = numaNodes;
+    }
+    free(retired[0]);
+    free(retired[1]);
+
+    for (idx = 0; idx < n; idx++) {
+        BFM_ATOMIC_ADD(BE_VERSION(type, idx), 2);
+        BFM_ATOMIC_STORE(BE_IOSTATE(type, idx), states[idx]);
+    }
+    free(states);
+
+    /* the I/O engine is told the frames at their new place */
+    edubfm_IOSetBuffers();
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_RemapFrames() */
+
+
+
+/*@================================
+ * edubfm_AlignFrames()
+ *================================*/
+/*
+ * Function: Four edubfm_AlignFrames(Four)
+ *
+ * Description:
+ *  Move the frames of the buffer table of the storage system onto new
+ *  frames, which are aligned to the pages of the system as the direct
+ *  I/O needs, unless they are already aligned. The frames given by this
+ *  module are mapped and thus always aligned. The hits are kept off the
+ *  frames while they move (see edubfm_HoldFrame()), so no buffer may be
+ *  fixed. The old frames are kept for the optimistic reads still on them.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    eREMAPFIXEDBUF_EDUBFM - a buffer is fixed
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_AlignFrames(
+    Four                type)           /* IN buffer type */
+{
+    Four                e = eNOERROR;   /* error code */
+    Four                idx, n;
+    size_t              size = (size_t)PAGESIZE * BI_BUFSIZE(type) * BE_NBASEBUFS(type);
+    size_t              mapped;         /* bytes of the new frames mapped */
+    One                 *states;        /* former I/O states of the buffers */
+    char                *frames;        /* the aligned frames */
+    FramesRetired       *retired;       /* entry of the old frames on BE_RETIREDFRAMES(type) */
+
+
+    if ((uintptr_t)BI_BUFFERPOOL(type) % FRAMES_SMALL_PAGE == 0) return(eNOERROR);
+
+    /* the trains being written by the background writer or read ahead are in fixed buffers */
+    edubfm_WaitWriter(type, NIL);
+    edubfm_ReapPrefetches(type, TRUE);
+
+    states = (One *)malloc(BE_NBUFS(type));
+    retired = (FramesRetired *)malloc(sizeof(FramesRetired));
+    if (states == NULL || retired == NULL) {
+        free(states);
+        free(retired);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (n = 0; n < BE_NBUFS(type); n++)
+        if (!edubfm_HoldFrame(type, n, &states[n])) {
+            e = eREMAPFIXEDBUF_EDUBFM;
+            break;
+        }
+
+    if (e >= eNOERROR) e = edubfm_MapFrames(type, size, &frames, &mapped);
+
+    if (e >= eNOERROR) {
+        memcpy(frames, BI_BUFFERPOOL(type), size);
+        frames_Replace(type, retired, frames, mapped);
+        retired = NULL;
+    }
+    free(retired);
+
+    for (idx = 0; idx < n; idx++) {
+        BFM_ATOMIC_ADD(BE_VERSION(type, idx), 2);
+        BFM_ATOMIC_STORE(BE_IOSTATE(type, idx), states[idx]);
+    }
+    free(states);
+
+    /* the I/O engine is told the frames at their new place */
+    edubfm_IOSetBuffers();
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_AlignFrames() */
+
+
+
+/*@================================
+ * edubfm_ResizeFrames()
+ *================================*/
+/*
+ * Function: Four edubfm_ResizeFrames(Four, Four)
+ *
+ * Description:
+ *  Make the frames of the buffer pool 'bufSize' pages large. The dirty
+ *  trains are written and every train is evicted; then the buffer table
+ *  and the buffers beyond it get new frames, backed by the pages and the
+ *  nodes of the configuration. The old frames are kept for the optimistic
+ *  reads still on them. The pool keeps its buffers, and the buffer
+ *  replacement policy starts over. The hits are kept off the frames
+ *  meanwhile (see edubfm_HoldFrame()), so no buffer may be fixed.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    eREMAPFIXEDBUF_EDUBFM - a buffer is fixed
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_ResizeFrames(
+    Four                type,           /* IN buffer type */
+    Four                bufSize)        /* IN new size of a frame in pages */
+{
+    Four                e = eNOERROR;   /* error code */
+    Four                idx, n;
+    size_t              size = (size_t)PAGESIZE * bufSize * BE_NBASEBUFS(type);
+    size_t              extSize = (size_t)PAGESIZE * bufSize * (BE_MAXBUFS(type) - BE_NBASEBUFS(type));
+    size_t              mapped, extMapped;      /* bytes of the new frames mapped */
+    One                 *states;        /* former I/O states of the buffers */
+    char                *frames = NULL; /* the new frames of the buffer table */
+    char                *extFrames = NULL;      /* the new frames beyond it */
+    FramesRetired       *retired[2];    /* entries of the old frames on BE_RETIREDFRAMES(type) */
+
+
+    if (bufSize == BI_BUFSIZE(type)) return(eNOERROR);
+
+    /* the trains being written by the background writer or read ahead are in fixed buffers */
+    edubfm_WaitWriter(type, NIL);
+    edubfm_ReapPrefetches(type, TRUE);
+
+    states = (One *)malloc(BE_NBUFS(type));
+    retired[0] = (FramesRetired *)malloc(sizeof(FramesRetired));
+    retired[1] = (FramesRetired *)malloc(sizeof(FramesRetired));
+    if (states == NULL || retired[0] == NULL || retired[1] == NULL) {
+        free(states);
+        free(retired[0]);
+        free(retired[1]);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (n = 0; n < BE_NBUFS(type); n++)
+        if (!edubfm_HoldFrame(type, n, &states[n])) {
+            e = eREMAPFIXEDBUF_EDUBFM;
+            break;
+        }
+
+    if (e >= eNOERROR) e = edubfm_FlushPool(type);
+
+    if (e >= eNOERROR) e = edubfm_MapFrames(type, size, &frames, &mapped);
+    if (e >= eNOERROR && BE_EXTFRAMES(type) != NULL) {
+        e = edubfm_MapFrames(type, extSize, &extFrames, &extMapped);
+        if (e < eNOERROR) munmap(frames, mapped);
+    }
+
+    if (e < eNOERROR) {
+        free(retired[0]);
+        free(retired[1]);
+        for (idx = 0; idx < n; idx++)
+            BFM_ATOMIC_STORE(BE_IOSTATE(type, idx), states[idx]);
+        free(states);
+        ERR(e);
+    }
+    free(states);
+
+    frames_EvictAll(type);
+
+    /* the slots of the extension file are as large as the frames */
+    edubfm_ExtensionClear(type);
+
+    frames_Replace(type, retired[0], frames, mapped);
+    if (extFrames != NULL) {
+        frames_Retire(type, retired[1], BE_EXTFRAMES(type), BE_EXTSIZE(type));
+        BE_EXTFRAMES(type) = extFrames;
+        BE_EXTSIZE(type) = extMapped;
+    }
+    else
+        free(retired[1]);
+
+    BI_BUFSIZE(type) = bufSize;
+
+    /* the buffers are empty; the I/O states are cleared and the versions advanced */
+    e = edubfm_ResetPool(type);
+
+    /* the I/O engine is told the new frames */
+    edubfm_IOSetBuffers();
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_ResizeFrames() */
+
+
+
+/*@================================
+ * edubfm_ReserveFrames()
+ *================================*/
+/*
+ * Function: Four edubfm_ReserveFrames(Four, Four)
+ *
+ * Description:
+ *  Make 'maxBufs' the number of buffers the pool may be resized to
+ *  (BfMConfig.maxBufs), which may not be fewer than the buffers it has.
+ *  If the frames beyond the buffer table of the
+ *  storage system have been reserved for fewer buffers, the buffers in
+ *  use there are moved onto new frames reserved for 'maxBufs' buffers,
+ *  backed by the pages and the nodes of the configuration. The hits are
+ *  kept off those frames while they move (see edubfm_HoldFrame()), so no
+ *  buffer beyond the buffer table may be fixed. The old frames are kept
+ *  for the optimistic reads still on them.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_EDUBFM - the pool has more buffers
+ *    eREMAPFIXEDBUF_EDUBFM - a buffer is fixed
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_ReserveFrames(
+    Four                type,           /* IN buffer type */
+    Four                maxBufs)        /* IN # of buffers the pool may have */
+{
+    Four                e = eNOERROR;   /* error code */
+    Four                idx, n;
+    Four                nExtUsed;       /* # of buffers in use beyond the buffer table */
+    size_t              frameSize = (size_t)PAGESIZE * BI_BUFSIZE(type);
+    size_t              extSize = frameSize * (maxBufs - BE_NBASEBUFS(type));
+    size_t              extMapped;      /* bytes of the new frames mapped */
+    char                *extFrames;     /* the new frames beyond the buffer table */
+    One                 *states;        /* former I/O states of the buffers */
+    FramesRetired       *retired;       /* entry of the old frames on BE_RETIREDFRAMES(type) */
+
+
+    if (maxBufs < BE_NBUFS(type)) ERR(eBADPARAMETER_EDUBFM);
+
+    if (BE_EXTFRAMES(type) == NULL || extSize <= BE_EXTSIZE(type)) {
+        BE_MAXBUFS(type) = maxBufs;
+        return(eNOERROR);
+    }
+
+    /* the trains being written by the background writer or read ahead are in fixed buffers */
+    edubfm_WaitWriter(type, NIL);
+    edubfm_ReapPrefetches(type, TRUE);
+
+    nExtUsed = (BE_NBUFS(type) > BE_NBASEBUFS(type)) ? BE_NBUFS(type) - BE_NBASEBUFS(type) : 0;
+
+    states = (One *)malloc(nExtUsed + 1);
+    retired = (FramesRetired *)malloc(sizeof(FramesRetired));
+    if (states == NULL || retired == NULL) {
+        free(states);
+        free(retired);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (n = 0; n < nExtUsed; n++)
+        if (!edubfm_HoldFrame(type, BE_NBASEBUFS(type) + n, &states[n])) {
+            e = eREMAPFIXEDBUF_EDUBFM;
+            break;
+        }
+
+    if (e >= eNOERROR) e = edubfm_MapFrames(type, extSize, &extFrames, &extMapped);
+
+    if (e >= eNOERROR) {
+        memcpy(extFrames, BE_EXTFRAMES(type), frameSize * nExtUsed);
+        frames_Retire(type, retired, BE_EXTFRAMES(type), BE_EXTSIZE(type));
+        retired = NULL;
+        BE_EXTFRAMES(type) = extFrames;
+        BE_EXTSIZE(type) = extMapped;
+        BE_MAXBUFS(type) = maxBufs;
+    }
+    free(retired);
+
+    for (idx = 0; idx < n; idx++) {
+        BFM_ATOMIC_ADD(BE_VERSION(type, BE_NBASEBUFS(type) + idx), 2);
+        BFM_ATOMIC_STORE(BE_IOSTATE(type, BE_NBASEBUFS(type) + idx), states[idx]);
+    }
+    free(states);
+
+    /* the I/O engine is told the frames at their new place */
+    edubfm_IOSetBuffers();
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_ReserveFrames() */
+
+
+
+/*@================================
+ * edubfm_GiveBackFrames()
+ *================================*/
+/*
+ * Function: void edubfm_GiveBackFrames(Four)
+ *
+ * Description:
+ *  Put the frames of the buffer table allocated by the storage system back
+ *  in place of the frames given by this module, so that the storage
+ *  system frees its own frames when it finishes. The trains of the buffer
+ *  table are copied back onto them; if the frames were made larger, the
+ *  dirty trains are written and every train is evicted instead.
+ *  The frames taken off are unmapped, so the pool is being released.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_GiveBackFrames(
+    Four                type)           /* IN buffer type */
+{
+    if (BE_SYSFRAMES(type) == NULL) return;
+
+    if (BI_BUFSIZE(type) == BE_BASEBUFSIZE(type))
+        memcpy(BE_SYSFRAMES(type), BI_BUFFERPOOL(type), (size_t)PAGESIZE * BI_BUFSIZE(type) * BE_NBASEBUFS(type));
+    else {
+        BFM_LATCH(type);
+        (void) edubfm_FlushPool(type);
+        frames_EvictAll(type);
+        BFM_UNLATCH(type);
+    }
+
+    munmap(BI_BUFFERPOOL(type), BE_FRAMESSIZE(type));
+    BI_BUFFERPOOL(type) = BE_SYSFRAMES(type);
+    BE_SYSFRAMES(type) = NULL;
+
+} /* edubfm_GiveBackFrames() */
+
+
+
+/*@================================
+ * edubfm_FreeRetiredFrames()
+ *================================*/
+/*
+ * Function: void edubfm_FreeRetiredFrames(Four)
+ *
+ * Description:
+ *  Unmap all the frames on BE_RETIREDFRAMES(type). No optimistic read
+ *  may be on them, i.e. the pool is being released.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_FreeRetiredFrames(
+    Four                type)           /* IN buffer type */
+{
+    FramesRetired       *retired;
+
+
+    while ((retired = (FramesRetired *)BE_RETIREDFRAMES(type)) != NULL) {
+        BE_RETIREDFRAMES(type) = retired->next;
+        munmap(retired->frames, retired->size);
+        free(retired);
+    }
+
+} /* edubfm_FreeRetiredFrames() */
+
+
+
+/*@================================
+ * frames_Node()
+ *================================*/
+/*
+ * Function: static Four frames_Node(Four, Four)
+ *
+ * Description:
+ *  Return the sub-pool, i.e. the index of the node in the nodes online,
+ *  the frame of a buffer is bound to.
+ *
+ * Returns:
+ *  index of the node
+ */
+static Four frames_Node(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    return(((uintptr_t)BI_BUFFER(type, idx) / BE_NUMASTRIDE(type)) % BE_NUMANODES(type));
+
+} /* frames_Node() */
+
+
+
+/*@================================
+ * frames_MyNode()
+ *================================*/
+/*
+ * Function: static Four frames_MyNode(Four)
+ *
+ * Description:
+ *  Return the sub-pool of the buffer pool on the node the calling thread
+ *  runs on.
+ *
+ * Returns:
+ *  index of the node
+ */
+static Four frames_MyNode(
+    Four                type)           /* IN buffer type */
+{
+    unsigned            cpu, node;
+    Four                i;
+
+
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) return(0);
+
+    for (i = 0; i < numa.nNodes; i++)
+        if (numa.nodeIds[i] == node) break;
+
+    return(i % BE_NUMANODES(type));
+
+} /* frames_MyNode() */
+
+
+
+/*@================================
+ * edubfm_LocalFreeBufFirst()
+ *================================*/
+/*
+ * Function: void edubfm_LocalFreeBufFirst(Four)
+ *
+ * Description:
+ *  Bring a free buffer whose frame is on the node of the calling thread
+ *  to the top of the free buffer list, if one is found among the first
+ *  FRAMES_LOCAL_SCAN buffers.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_LocalFreeBufFirst(
+    Four                type)           /* IN buffer type */
+{
+    Four                i, n, top, node;
+    Four                *bufs = BE_FREEBUFS(type);
+
+
+    if (BE_NUMANODES(type) <= 1 || BE_NFREEBUFS(type) <= 1) return;
+
+    node = frames_MyNode(type);
+    top = BE_NFREEBUFS(type) - 1;
+
+    for (i = top, n = 0; i >= 0 && n < FRAMES_LOCAL_SCAN; i--, n++)
+        if (frames_Node(type, bufs[i]) == node) {
+            n = bufs[i];
+            bufs[i] = bufs[top];
+            bufs[top] = n;
+            break;
+        }
+
+} /* edubfm_LocalFreeBufFirst() */
@@ -56,11 +56,38 @@
  *  An ordinary hashing method is used and linear probing strategy is
  *  used if collision has occurred.
  *
+ *  EduBfM looks up the keys in the page table of the buffer pool
+ *  (see edubfm_PageTable.c). The hash table is only maintained while the
+ *  pool is shared with the rest of the storage system (BfMConfig.shared);
+ *  then a key not found in the page table is looked up in the hash
+ *  table, and a key found there is added to the page table, and a miss
+ *  under the pool latch is told by the hash table alone while all the
+ *  buffers are on its chains, since a chain miss costs less than a page
+ *  table miss followed by it. A pool used by EduBfM alone has the page
+ *  table as its only index.
+ *
+ *  The page table is changed with the pool latch and the latch of the
+ *  partition of the key held, and the hash table with the pool latch
+ *  held. A hit is found by edubfm_Fix() with the partition latch only;
+ *  a buffer is pinned under the same latch, so that a buffer being
+ *  replaced is never pinned by a hit (see edubfm_UnmapVictim()).
+ *
  * Exports:
  *  Four edubfm_LookUp(BfMHashKey *, Four)
- *  Four edubfm_Insert(BfMHaskKey *, Two, Four)
+ *  Four edubfm_FastLookUp(BfMHashKey *, Four)
+ *  Four edubfm_Fix(BfMHashKey *, Four)
+ *  Four edubfm_FixAt(BfMHashKey *, Four, UFour, Four)
+ *  void edubfm_Referred(Four, Four)
+ *  Four edubfm_Unfix(BfMHashKey *, Four, Two *)
+ *  Boolean edubfm_ClaimVictim(Four, Four)
+ *  Boolean edubfm_UnmapVictim(Four, Four)
+ *  Boolean edubfm_HoldFrame(Four, Four, One *)
+ *  Four edubfm_ChainLookUp(BfMHashKey *, Four)
+ *  Four edubfm_Insert(BfMHaskKey *, Four, Four)
  *  Four edubfm_Delete(BfMHashKey *, Four)
  *  Four edubfm_DeleteAll(void)
+ *  Four edubfm_DeletePool(Four, Four **, Four *)
+ *  Four edubfm_SetShared(Four, Four)
  */
 
 
@@ -79,16 +106,33 @@
  * Parameters:
  *  BfMHashKey *k   : pointer to the key
  *  Four type       : buffer type
- * Returns: (Two) hash value
+ * Returns: (Four) hash value
  */
 #define BFM_HASH(k,type)	(((k)->volNo + (k)->pageNo) % HASHTABLESIZE(type))
 
+/* Macro: PT_LATCH(k,type), PT_UNLATCH(k,type)
+ * Description: acquire/release the latch of the page table partition
+ *              holding the key given as a parameter
+ * Parameters:
+ *  BfMHashKey *k   : pointer to the key
+ *  Four type       : buffer type
+ */
+#define PT_LATCH(k,type)    pthread_mutex_lock(edubfm_PageTableLatch(&BE_PAGETABLE(type), (k)))
+#define PT_UNLATCH(k,type)  pthread_mutex_unlock(edubfm_PageTableLatch(&BE_PAGETABLE(type), (k)))
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Boolean hash_ChainDelete(BfMHashKey *, Four);
+
 
 /*@================================
  * edubfm_Insert()
  *================================*/
 /*
- * Function: Four edubfm_Insert(BfMHashKey *, Two, Four)
+ * Function: Four edubfm_Insert(BfMHashKey *, Four, Four)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BfM.
@@ -96,6 +140,7 @@
  *
  *  Insert a new entry into the hash table.
  *  If collision occurs, then use the linear probing method.
+ *  The buffer, which has just got its train, is put on the clean list.
  *
  * Returns:
  *  error code
@@ -103,27 +148,35 @@
  */
 Four edubfm_Insert(
     BfMHashKey 		*key,			/* IN a hash key in Buffer Manager */
-    Two 		index,			/* IN an index used in the buffer pool */
+    Four 		index,			/* IN an index used in the buffer pool */
     Four 		type)			/* IN buffer type */
 {
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four 		i;			
-    Two  		hashValue;
+    Four  		hashValue;
+    Four                e;                      /* error code */
 
 
     CHECKKEY(key);    /*@ check validity of key */
 
-    if( (index < 0) || (index > BI_NBUFS(type)) )
+    if( (index < 0) || (IS_POOL_INITIALIZED(type) && index >= BE_NBUFS(type)) )
         ERR( eBADBUFINDEX_BFM );
 
-    hashValue = BFM_HASH(key, type);
-    if(BI_HASHTABLEENTRY(type, hashValue) == NIL){
-        BI_HASHTABLEENTRY(type, hashValue) = index;
-    }else{
-        i = BI_HASHTABLEENTRY(type, hashValue); // original array index which was in hashtable entry
+    if (IS_POOL_SHARED(type) && IS_CHAINED_BUFINDEX(type, index)) {
+        hashValue = BFM_HASH(key, type);
+        i = BI_HASHTABLEENTRY(type, hashValue); // original array index which was in hashtable entry (NIL if empty)
         BI_HASHTABLEENTRY(type, hashValue) = index;
         BI_NEXTHASHENTRY(type, index) = i;
     }
+
+    if (IS_POOL_INITIALIZED(type)) {
+        PT_LATCH(key, type);
+        e = edubfm_PageTableInsert(&BE_PAGETABLE(type), key, index);
+        PT_UNLATCH(key, type);
+        if (e < eNOERROR) ERR(e);
+
+        edubfm_CleanInsert(type, index);
+    }
    
 
     return( eNOERROR );
@@ -154,34 +207,66 @@ Four edubfm_Delete(
     Four                type )                  /* IN buffer type */
 {
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
-    Two                 i, prev;                
-    Two                 hashValue;
+    Boolean             inPageTable = FALSE;
 
     CHECKKEY(key);    /*@ check validity of key */
-    
+
+    if (IS_POOL_INITIALIZED(type)) {
+        PT_LATCH(key, type);
+        inPageTable = (edubfm_PageTableDelete(&BE_PAGETABLE(type), key) == eNOERROR);
+        PT_UNLATCH(key, type);
+    }
+
+    if (IS_POOL_SHARED(type) && hash_ChainDelete(key, type)) return(eNOERROR);
+
+    /* the buffers which cannot be chained are only in the page table */
+    if (inPageTable) return(eNOERROR);
+
+    ERR( eNOTFOUND_BFM );
+
+}  /* edubfm_Delete */
+
+
+
+/*@================================
+ * hash_ChainDelete()
+ *================================*/
+/*
+ * Function: static Boolean hash_ChainDelete(BfMHashKey *, Four)
+ *
+ * Description:
+ *  Delete the entry which corresponds to `key' from the chain of buffers
+ *  having the same hash value.
+ *
+ * Returns:
+ *  TRUE if the entry was in the hash table
+ */
+static Boolean hash_ChainDelete(
+    BfMHashKey          *key,                   /* IN a hash key in buffer manager */
+    Four                type )                  /* IN buffer type */
+{
+    Four                i, prev;                
+    Four                hashValue;
+
     hashValue = BFM_HASH(key, type);
-    //printf("hashValue: %d\n", hashValue);
     i = BI_HASHTABLEENTRY(type, hashValue);
-    if(EQUALKEY(&BI_KEY(type, i), key)){
+    if(i != NIL && EQUALKEY(&BI_KEY(type, i), key)){
         BI_HASHTABLEENTRY(type, hashValue) = BI_NEXTHASHENTRY(type, i);
-        //BI_NEXTHASHENTRY(type, i) = NIL;
-        return (eNOERROR);
+        return (TRUE);
     };
     while(i != NIL){
         if(EQUALKEY(&BI_KEY(type, i), key)){
             BI_NEXTHASHENTRY(type, prev) = BI_NEXTHASHENTRY(type, i);
-            //BI_NEXTHASHENTRY(type, i) = NIL;
-            return (eNOERROR);
+            return (TRUE);
         } else {
             prev = i;
             i = BI_NEXTHASHENTRY(type, i);
         }
     }
 
+    return(FALSE);
 
-    ERR( eNOTFOUND_BFM );
-
-}  /* edubfm_Delete */
+}  /* hash_ChainDelete */
 
 
 
@@ -207,8 +292,374 @@ Four edubfm_LookUp(
     Four                type)                   /* IN buffer type */
 {
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
-    Two                 i, j;                   /* indices */
-    Two                 hashValue;
+    Four                i;                      /* index */
+
+    CHECKKEY(key);    /*@ check validity of key */
+
+    if (!IS_POOL_INITIALIZED(type)) return(edubfm_ChainLookUp(key, type));
+
+    /* the callers come here when edubfm_Fix() missed, so a miss is the
+       common case; while every buffer is chained the chains alone tell it */
+    if (IS_POOL_CHAINED(type) && edubfm_ChainLookUp(key, type) == NOTFOUND_IN_HTABLE)
+        return(NOTFOUND_IN_HTABLE);
+
+    PT_LATCH(key, type);
+    i = edubfm_PageTableLookUp(&BE_PAGETABLE(type), key);
+    if (i != NOTFOUND_IN_HTABLE) {
+        if (EQUALKEY(&BI_KEY(type, i), key)) {
+            PT_UNLATCH(key, type);
+            return(i);
+        }
+
+        /* the buffer was reused by the rest of the storage system */
+        (void) edubfm_PageTableDelete(&BE_PAGETABLE(type), key);
+    }
+
+    /* the train may have been loaded by the rest of the storage system */
+    i = IS_POOL_SHARED(type) ? edubfm_ChainLookUp(key, type) : NOTFOUND_IN_HTABLE;
+    if (i != NOTFOUND_IN_HTABLE)
+        (void) edubfm_PageTableInsert(&BE_PAGETABLE(type), key, i);
+    PT_UNLATCH(key, type);
+
+    return(i);
+    
+}  /* edubfm_LookUp */
+
+
+
+/*@================================
+ * edubfm_FastLookUp()
+ *================================*/
+/*
+ * Function: Four edubfm_FastLookUp(BfMHashKey *, Four)
+ *
+ * Description:
+ *  Look up the given key in the page table holding only the latch of its
+ *  partition. Unlike edubfm_LookUp(), the hash table is not searched, so
+ *  the caller falls back on edubfm_LookUp() with the pool latch held if
+ *  the key is not found. The pool must have been initialized.
+ *
+ * Retruns:
+ *  index on buffer table entry holding the train specified by 'key'
+ *  (NOTFOUND_IN_HTABLE - The key isn't in the page table.)
+ */
+Four edubfm_FastLookUp(
+    BfMHashKey          *key,                   /* IN a hash key in Buffer Manager */
+    Four                type)                   /* IN buffer type */
+{
+    Four                i;                      /* index */
+
+    CHECKKEY(key);    /*@ check validity of key */
+
+    PT_LATCH(key, type);
+    i = edubfm_PageTableLookUp(&BE_PAGETABLE(type), key);
+    if (i != NOTFOUND_IN_HTABLE && !EQUALKEY(&BI_KEY(type, i), key))
+        i = NOTFOUND_IN_HTABLE;
+    PT_UNLATCH(key, type);
+
+    return(i);
+
+}  /* edubfm_FastLookUp */
+
+
+
+/*@================================
+ * edubfm_Fix()
+ *================================*/
+/*
+ * Function: Four edubfm_Fix(BfMHashKey *, Four)
+ *
+ * Description:
+ *  Look up the given key in the page table and pin the buffer holding
+ *  the train, holding only the latch of the partition of the key. A
+ *  buffer still being read by a prefetch is not pinned. The pool must
+ *  have been initialized.
+ *
+ * Retruns:
+ *  index on buffer table entry holding the train specified by 'key'
+ *  (NOTFOUND_IN_HTABLE - The train isn't in the page table or is
+ *   still being read; the caller takes the pool latch and retries.)
+ */
+Four edubfm_Fix(
+    BfMHashKey          *key,                   /* IN a hash key in Buffer Manager */
+    Four                type)                   /* IN buffer type */
+{
+    Four                i;                      /* index */
+
+    CHECKKEY(key);    /*@ check validity of key */
+
+    PT_LATCH(key, type);
+    i = edubfm_PageTableLookUp(&BE_PAGETABLE(type), key);
+    if (i != NOTFOUND_IN_HTABLE && EQUALKEY(&BI_KEY(type, i), key) &&
+        BFM_ATOMIC_LOAD(BE_IOSTATE(type, i)) != IO_READING &&
+        BFM_ATOMIC_LOAD(BE_IOSTATE(type, i)) != IO_MOVING)
+        BFM_ATOMIC_ADD(BI_FIXED(type, i), 1);
+    else
+        i = NOTFOUND_IN_HTABLE;
+    PT_UNLATCH(key, type);
+
+    return(i);
+
+}  /* edubfm_Fix */
+
+
+
+/*@================================
+ * edubfm_FixAt()
+ *================================*/
+/*
+ * Function: Four edubfm_FixAt(BfMHashKey *, Four, UFour, Four)
+ *
+ * Description:
+ *  Pin the given buffer if it still holds the train it held at the given
+ *  version, without looking the key up (see EduBfM_GetTrainSwizzled()).
+ *  The buffer is checked and pinned under the latch of the partition of
+ *  the key, which edubfm_UnmapVictim() holds while it unmaps the buffer
+ *  and advances its version, so that a buffer being replaced is never
+ *  pinned. The pool must have been initialized.
+ *
+ * Retruns:
+ *  index of the buffer
+ *  (NOTFOUND_IN_HTABLE - The buffer has changed since the version.)
+ */
+Four edubfm_FixAt(
+    BfMHashKey          *key,                   /* IN a hash key in Buffer Manager */
+    Four                index,                  /* IN buffer which held the train */
+    UFour               version,                /* IN version of the buffer then */
+    Four                type)                   /* IN buffer type */
+{
+    Four                i = NOTFOUND_IN_HTABLE; /* index */
+
+    if (index < 0 || index >= BFM_ATOMIC_LOAD(BE_NBUFS(type))) return(NOTFOUND_IN_HTABLE);
+
+    PT_LATCH(key, type);
+    if (BFM_ATOMIC_LOAD(BE_VERSION(type, index)) == version && EQUALKEY(&BI_KEY(type, index), key) &&
+        BFM_ATOMIC_LOAD(BE_IOSTATE(type, index)) != IO_READING &&
+        BFM_ATOMIC_LOAD(BE_IOSTATE(type, index)) != IO_MOVING) {
+        BFM_ATOMIC_ADD(BI_FIXED(type, index), 1);
+        i = index;
+    }
+    PT_UNLATCH(key, type);
+
+    return(i);
+
+}  /* edubfm_FixAt */
+
+
+
+/*@================================
+ * edubfm_Referred()
+ *================================*/
+/*
+ * Function: void edubfm_Referred(Four, Four)
+ *
+ * Description:
+ *  Set the reference bit of the pinned buffer and count the first use of
+ *  a prefetched train. The bit is only written if it is not set, so that
+ *  hits on a popular train do not keep writing its buffer table entry.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_Referred(
+    Four                type,                   /* IN buffer type */
+    Four                index)                  /* IN index of the pinned buffer */
+{
+    One                 state = IO_PREFETCHED;
+
+
+    if (BFM_ATOMIC_LOAD(BE_IOSTATE(type, index)) == IO_PREFETCHED &&
+        BFM_ATOMIC_CAS(BE_IOSTATE(type, index), state, IO_NONE))
+        BFM_COUNT(type, nPrefetchHits);
+
+    if (!(BFM_ATOMIC_LOAD(BI_BITS(type, index)) & REFER))
+        BI_SETBITS(type, index, REFER);
+
+}  /* edubfm_Referred */
+
+
+
+/*@================================
+ * edubfm_Unfix()
+ *================================*/
+/*
+ * Function: Four edubfm_Unfix(BfMHashKey *, Four, Two *)
+ *
+ * Description:
+ *  Look up the given key in the page table and unpin the buffer holding
+ *  the train. A buffer which is not pinned is left as it is. A resize
+ *  waiting for the buffer is woken when it is no longer pinned (see
+ *  edubfm_Unpinned()). The pool must have been initialized.
+ *
+ * Retruns:
+ *  index on buffer table entry holding the train specified by 'key'
+ *  (NOTFOUND_IN_HTABLE - The key isn't in the page table.)
+ */
+Four edubfm_Unfix(
+    BfMHashKey          *key,                   /* IN a hash key in Buffer Manager */
+    Four                type,                   /* IN buffer type */
+    Two                 *before)                /* OUT fix count before unpinning */
+{
+    Four                i;                      /* index */
+    Two                 fixed;
+
+    CHECKKEY(key);    /*@ check validity of key */
+
+    i = edubfm_FastLookUp(key, type);
+    if (i == NOTFOUND_IN_HTABLE) return(i);
+
+    fixed = BFM_ATOMIC_LOAD(BI_FIXED(type, i));
+    while (fixed > 0 && !BFM_ATOMIC_CAS(BI_FIXED(type, i), fixed, fixed - 1));
+    *before = fixed;
+
+    if (fixed == 1) edubfm_Unpinned(type);
+
+    return(i);
+
+}  /* edubfm_Unfix */
+
+
+
+/*@================================
+ * edubfm_ClaimVictim()
+ *================================*/
+/*
+ * Function: Boolean edubfm_ClaimVictim(Four, Four)
+ *
+ * Description:
+ *  Pin a buffer selected for replacement if no one has pinned it, so that
+ *  the buffer is neither selected again nor used while it is flushed.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  TRUE if the buffer has been pinned
+ */
+Boolean edubfm_ClaimVictim(
+    Four                type,                   /* IN buffer type */
+    Four                index)                  /* IN index of the buffer */
+{
+    Two                 unfixed = 0;
+
+    return(BFM_ATOMIC_CAS(BI_FIXED(type, index), unfixed, 1));
+
+}  /* edubfm_ClaimVictim */
+
+
+
+/*@================================
+ * edubfm_UnmapVictim()
+ *================================*/
+/*
+ * Function: Boolean edubfm_UnmapVictim(Four, Four)
+ *
+ * Description:
+ *  Delete the mapping of a buffer claimed by edubfm_ClaimVictim() and
+ *  release the claim. If the buffer has been pinned by a hit or dirtied
+ *  in the meantime, the mapping is kept and only the claim is released.
+ *  The key of the buffer is left for the replacement policy, and the
+ *  version of the buffer is advanced so that the optimistic reads begun
+ *  on the train fail (see EduBfM_OptimisticRead()). An unmapped buffer
+ *  leaves the clean list.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  TRUE if the buffer can be reused
+ */
+Boolean edubfm_UnmapVictim(
+    Four                type,                   /* IN buffer type */
+    Four                index)                  /* IN index of the buffer */
+{
+    BfMHashKey          *key = &BI_KEY(type, index);
+    Boolean             unmapped = FALSE;
+
+
+    if (IS_NILBFMHASHKEY(*key)) {
+        BFM_ATOMIC_STORE(BI_FIXED(type, index), 0);
+        return(TRUE);
+    }
+
+    PT_LATCH(key, type);
+    if (BFM_ATOMIC_LOAD(BI_FIXED(type, index)) == 1 &&
+        !(BFM_ATOMIC_LOAD(BI_BITS(type, index)) & DIRTY)) {
+        (void) edubfm_PageTableDelete(&BE_PAGETABLE(type), key);
+        BFM_ATOMIC_STORE(BI_FIXED(type, index), 0);
+        BFM_ATOMIC_ADD(BE_VERSION(type, index), 2);
+        unmapped = TRUE;
+    } else
+        BFM_ATOMIC_ADD(BI_FIXED(type, index), -1);
+    PT_UNLATCH(key, type);
+
+    if (unmapped) {
+        edubfm_CleanRemove(type, index);
+        (void) hash_ChainDelete(key, type);
+    }
+
+    return(unmapped);
+
+}  /* edubfm_UnmapVictim */
+
+
+
+/*@================================
+ * edubfm_HoldFrame()
+ *================================*/
+/*
+ * Function: Boolean edubfm_HoldFrame(Four, Four, One *)
+ *
+ * Description:
+ *  Keep the hits off the frame of an unfixed buffer while it is moved onto
+ *  other pages, by putting the buffer in the IO_MOVING state under the
+ *  latch a hit pins it with. The former state is returned in 'state' and
+ *  is put back by the caller when the frame has been moved.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  TRUE if the buffer is held, FALSE if it is fixed
+ */
+Boolean edubfm_HoldFrame(
+    Four                type,                   /* IN buffer type */
+    Four                index,                  /* IN index of the buffer */
+    One                 *state)                 /* OUT former I/O state of the buffer */
+{
+    BfMHashKey          key = BI_KEY(type, index);
+    Boolean             held = FALSE;
+
+
+    /* a buffer holding no train cannot be hit */
+    if (!IS_NILBFMHASHKEY(key)) PT_LATCH(&key, type);
+    if (BFM_ATOMIC_LOAD(BI_FIXED(type, index)) == 0) {
+        *state = BE_IOSTATE(type, index);
+        BFM_ATOMIC_STORE(BE_IOSTATE(type, index), IO_MOVING);
+        held = TRUE;
+    }
+    if (!IS_NILBFMHASHKEY(key)) PT_UNLATCH(&key, type);
+
+    return(held);
+
+}  /* edubfm_HoldFrame */
+
+
+
+/*@================================
+ * edubfm_ChainLookUp()
+ *================================*/
+/*
+ * Function: Four edubfm_ChainLookUp(BfMHashKey *, Four)
+ *
+ * Description:
+ *  Look up the given key in the hash table only, following the chain of
+ *  buffers having the same hash value.
+ *
+ * Retruns:
+ *  index on buffer table entry holding the train specified by 'key'
+ *  (NOTFOUND_IN_HTABLE - The key don't exist in the hash table.)
+ */
+Four edubfm_ChainLookUp(
+    BfMHashKey          *key,                   /* IN a hash key in Buffer Manager */
+    Four                type)                   /* IN buffer type */
+{
+    Four                i;                      /* index */
+    Four                hashValue;
 
     CHECKKEY(key);    /*@ check validity of key */
 
@@ -221,11 +672,9 @@ Four edubfm_LookUp(
         i = BI_NEXTHASHENTRY(type,i);
     }
 
-
-
     return(NOTFOUND_IN_HTABLE);
-    
-}  /* edubfm_LookUp */
+
+}  /* edubfm_ChainLookUp */
 
 
 
@@ -247,18 +696,138 @@ Four edubfm_LookUp(
 Four edubfm_DeleteAll(void)
 {
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
-    Two 	i;
     Four    tableSize;
     Four    type;
 
-    type = PAGE_BUF;
-    tableSize = HASHTABLESIZE(type);
-    while (tableSize > 0){
-        tableSize--;
-        BI_HASHTABLEENTRY(type, tableSize) = NIL;
-    }
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        tableSize = HASHTABLESIZE(type);
+        while (tableSize > 0){
+            tableSize--;
+            BI_HASHTABLEENTRY(type, tableSize) = NIL;
+        }
 
+        if (IS_POOL_INITIALIZED(type))
+            edubfm_PageTableClear(&BE_PAGETABLE(type));
+    }
 
     return(eNOERROR);
 
 } /* edubfm_DeleteAll() */ 
+
+
+
+/*@================================
+ * edubfm_DeletePool()
+ *================================*/
+/*
+ * Function: Four edubfm_DeletePool(Four, Four **, Four *)
+ *
+ * Description:
+ *  Delete the keys of all trains of the buffer pool from the page table
+ *  and the hash table, giving the indexes of the buffers holding them in
+ *  an array to be freed by the caller. The trains are found in the
+ *  occupied slots of the page table. In a pool shared with the storage
+ *  system (BfMConfig.shared), whose buffer manager chains the trains it
+ *  loads without the page table, the chains are walked and emptied too;
+ *  they only hold the buffers of the buffer table of bufInfo[]. A buffer
+ *  may thus be given twice, or be empty already.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_DeletePool(
+    Four                type,                   /* IN buffer type */
+    Four                **indexes,              /* OUT buffer indexes of the trains */
+    Four                *nIndexes)              /* OUT # of indexes */
+{
+    BfMPageTable        *pt = &BE_PAGETABLE(type);
+    Four                *idx;
+    Four                max, n, p, h, i;
+
+
+    for (max = 0, p = 0; p <= pt->partMask; p++) max += pt->part[p].nKeys;
+    if (IS_POOL_SHARED(type)) max += BI_NBUFS(type);
+
+    idx = (Four *)malloc(sizeof(Four) * (max + 1));
+    if (idx == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    n = edubfm_PageTableTake(pt, idx);
+
+    if (IS_POOL_SHARED(type)) {
+        for (h = 0; h < HASHTABLESIZE(type); h++) {
+            for (i = BI_HASHTABLEENTRY(type, h); i != NIL && n < max; i = BI_NEXTHASHENTRY(type, i))
+                idx[n++] = i;
+            BI_HASHTABLEENTRY(type, h) = NIL;
+        }
+    }
+
+    *indexes = idx;
+    *nIndexes = n;
+
+    return(eNOERROR);
+
+} /* edubfm_DeletePool() */
+
+
+
+/*@================================
+ * edubfm_SetShared()
+ *================================*/
+/*
+ * Function: Four edubfm_SetShared(Four, Four)
+ *
+ * Description:
+ *  Make the buffer pool shared with the storage system or used by EduBfM
+ *  alone (BfMConfig.shared). A pool being shared gets the trains of the
+ *  buffer table of bufInfo[] chained again on the hash table. A pool
+ *  being kept by EduBfM alone first adds the trains only on the chains,
+ *  loaded by the storage system, to the page table, and then empties the
+ *  hash table, which it stops maintaining.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubfm_SetShared(
+    Four                type,                   /* IN buffer type */
+    Four                shared)                 /* IN TRUE if the storage system may use the pool */
+{
+    Four                e = eNOERROR;           /* error code */
+    Four                h, i, j;
+
+
+    if (shared == BE_CFG(type).shared) return(eNOERROR);
+
+    for (h = 0; !shared && h < HASHTABLESIZE(type); h++) {
+        for (i = BI_HASHTABLEENTRY(type, h); i != NIL; i = BI_NEXTHASHENTRY(type, i)) {
+            PT_LATCH(&BI_KEY(type, i), type);
+            j = edubfm_PageTableLookUp(&BE_PAGETABLE(type), &BI_KEY(type, i));
+            if (j != i) {
+                /* the buffer the page table gives was reused by the rest of the storage system */
+                if (j != NOTFOUND_IN_HTABLE) (void) edubfm_PageTableDelete(&BE_PAGETABLE(type), &BI_KEY(type, i));
+                e = edubfm_PageTableInsert(&BE_PAGETABLE(type), &BI_KEY(type, i), i);
+            }
+            PT_UNLATCH(&BI_KEY(type, i), type);
+            if (e < eNOERROR) ERR(e);
+        }
+    }
+
+    for (h = 0; h < HASHTABLESIZE(type); h++) BI_HASHTABLEENTRY(type, h) = NIL;
+
+    BE_CFG(type).shared = shared;
+    if (!shared) return(eNOERROR);
+
+    for (i = 0; i < BE_NBUFS(type) && IS_CHAINED_BUFINDEX(type, i); i++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i))) continue;
+
+        h = BFM_HASH(&BI_KEY(type, i), type);
+        BI_NEXTHASHENTRY(type, i) = BI_HASHTABLEENTRY(type, h);
+        BI_HASHTABLEENTRY(type, h) = i;
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_SetShared() */
@@ -0,0 +1,489 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_IOEngine.c
+ *
+ * Description:
+ *  I/O engines reading and writing the trains on the devices of the
+ *  attached volumes for the read-ahead, the background writer, and
+ *  EduBfM_FlushAll(). A request is started by edubfm_IOSubmit() and the
+ *  engine calls its done() when it is over; BfMIOBatch waits for a set
+ *  of requests. The engine selected is started at the first request.
+ *  If io_uring is not available, the thread pool engine is used.
+ *
+ * Exports:
+ *  Four edubfm_SelectIOEngine(Four)
+ *  void edubfm_StopIOEngine(void)
+ *  void edubfm_IOSubmit(BfMIORequest **, Four)
+ *  void edubfm_IOSetBuffers(void)
+ *  void edubfm_IODo(BfMIORequest *, size_t)
+ *  void edubfm_IODone(BfMIORequest *)
+ *  void edubfm_IOBatchInit(BfMIOBatch *)
+ *  void edubfm_IOBatchAdd(BfMIOBatch *, BfMIORequest *)
+ *  Four edubfm_IOBatchWait(BfMIOBatch *)
+ */
+
+
+#include <errno.h>
+#include <sys/uio.h> /* for preadv & pwritev */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+extern BfMIOEngine edubfm_uringEngine;
+extern BfMIOEngine edubfm_threadsEngine;
+
+/* I/O engines indexed by BFM_IOENGINE_xxx */
+BfMIOEngine *edubfm_ioEngines[NUM_BFM_IOENGINES] = {
+    &edubfm_uringEngine,
+    &edubfm_threadsEngine
+};
+
+/* engine in use */
+static struct {
+    pthread_mutex_t     mutex;          /* protects the fields below */
+    Four                selected;       /* BFM_IOENGINE_xxx to be started */
+    BfMIOEngine         *running;       /* engine started (NULL if none) */
+} io = { PTHREAD_MUTEX_INITIALIZER, BFM_IOENGINE_URING, NULL };
+
+
+
+/*@================================
+ * io_SetBuffers()
+ *================================*/
+/*
+ * Function: static void io_SetBuffers(void)
+ *
+ * Description:
+ *  Tell the running engine the memory of the initialized buffer pools.
+ *  Only the buffer pool of the storage system is told; the buffers added
+ *  by EduBfM_ResizePool() are read and written as ordinary memory.
+ *  The caller holds the mutex of the engine in use.
+ *
+ * Returns:
+ *  None
+ */
+static void io_SetBuffers(void)
+{
+    Four                type, n;
+    struct iovec        bufs[NUM_BUF_TYPES];
+
+
+    if (io.running == NULL || io.running->setBuffers == NULL) return;
+
+    for (n = 0, type = 0; type < NUM_BUF_TYPES; type++)
+        if (IS_POOL_INITIALIZED(type)) {
+            bufs[n].iov_base = BI_BUFFER(type, 0);
+            bufs[n].iov_len = (size_t)PAGESIZE * BI_BUFSIZE(type) * BE_NBASEBUFS(type);
+            n++;
+        }
+
+    io.running->setBuffers(bufs, n);
+
+} /* io_SetBuffers() */
+
+
+
+/*@================================
+ * io_Start()
+ *================================*/
+/*
+ * Function: static BfMIOEngine *io_Start(void)
+ *
+ * Description:
+ *  Start the selected engine, or the thread pool engine if it fails,
+ *  unless an engine is running.
+ *
+ * Returns:
+ *  engine running (NULL if no engine can be started)
+ */
+static BfMIOEngine *io_Start(void)
+{
+    BfMIOEngine         *engine;
+
+
+    pthread_mutex_lock(&io.mutex);
+
+    if (io.running == NULL) {
+        if (edubfm_ioEngines[io.selected]->init() >= eNOERROR)
+            io.running = edubfm_ioEngines[io.selected];
+        else if (io.selected != BFM_IOENGINE_THREADS && edubfm_threadsEngine.init() >= eNOERROR)
+            io.running = &edubfm_threadsEngine;
+        io_SetBuffers();
+    }
+    engine = io.running;
+
+    pthread_mutex_unlock(&io.mutex);
+
+    return(engine);
+
+} /* io_Start() */
+
+
+
+/*@================================
+ * edubfm_SelectIOEngine()
+ *================================*/
+/*
+ * Function: Four edubfm_SelectIOEngine(Four)
+ *
+ * Description:
+ *  Stop the engine running and start the given one.
+ *  No request may be in flight.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubfm_SelectIOEngine(
+    Four                engine)         /* IN BFM_IOENGINE_xxx */
+{
+    Four                e;              /* error code */
+
+
+    edubfm_StopIOEngine();
+
+    pthread_mutex_lock(&io.mutex);
+
+    e = edubfm_ioEngines[engine]->init();
+    if (e >= eNOERROR) {
+        io.selected = engine;
+        io.running = edubfm_ioEngines[engine];
+        io_SetBuffers();
+    }
+
+    pthread_mutex_unlock(&io.mutex);
+
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_SelectIOEngine() */
+
+
+
+/*@================================
+ * edubfm_StopIOEngine()
+ *================================*/
+/*
+ * Function: void edubfm_StopIOEngine(void)
+ *
+ * Description:
+ *  Stop the engine running. No request may be in flight.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_StopIOEngine(void)
+{
+    pthread_mutex_lock(&io.mutex);
+
+    if (io.running != NULL) {
+        io.running->final();
+        io.running = NULL;
+    }
+
+    pthread_mutex_unlock(&io.mutex);
+
+} /* edubfm_StopIOEngine() */
+
+
+
+/*@================================
+ * edubfm_IOSubmit()
+ *================================*/
+/*
+ * Function: void edubfm_IOSubmit(BfMIORequest **, Four)
+ *
+ * Description:
+ *  Start the requests. done() of each request is called when it is over,
+ *  possibly before this function returns. The 'type' of each request is
+ *  set by the caller for the statistics.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_IOSubmit(
+    BfMIORequest        **reqs,         /* IN requests */
+    Four                n)              /* IN # of requests */
+{
+    BfMIOEngine         *engine;
+    Four                i;
+
+
+    engine = io_Start();
+
+    for (i = 0; i < n; i++) reqs[i]->start = edubfm_Now();
+
+    if (engine != NULL)
+        engine->submit(reqs, n);
+    else
+        for (i = 0; i < n; i++) {
+            edubfm_IODo(reqs[i], 0);
+            edubfm_IODone(reqs[i]);
+        }
+
+} /* edubfm_IOSubmit() */
+
+
+
+/*@================================
+ * edubfm_IOSetBuffers()
+ *================================*/
+/*
+ * Function: void edubfm_IOSetBuffers(void)
+ *
+ * Description:
+ *  Tell the running engine that buffer pools have been initialized or
+ *  finalized, e.g. for io_uring to register their memory.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_IOSetBuffers(void)
+{
+    pthread_mutex_lock(&io.mutex);
+    io_SetBuffers();
+    pthread_mutex_unlock(&io.mutex);
+
+} /* edubfm_IOSetBuffers() */
+
+
+
+/*@================================
+ * edubfm_IODo()
+ *================================*/
+/*
+ * Function: void edubfm_IODo(BfMIORequest *, size_t)
+ *
+ * Description:
+ *  Do the request synchronously, skipping the first 'done' bytes which
+ *  have been transferred already, and set its result. The buffers of the
+ *  request are modified.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_IODo(
+    BfMIORequest        *req,           /* INOUT request */
+    size_t              done)           /* IN # of bytes transferred */
+{
+    struct iovec        *iov = req->iov;
+    Four                nIov = req->nIov;
+    off_t               offset = req->offset + done;
+    ssize_t             n;
+
+
+    req->result = eNOERROR;
+
+    for (n = done; nIov > 0; ) {
+        /* skip what has been transferred */
+        for ( ; nIov > 0 && (size_t)n >= iov->iov_len; iov++, nIov--) n -= iov->iov_len;
+        if (nIov == 0) break;
+        iov->iov_base = (char *)iov->iov_base + n;
+        iov->iov_len -= n;
+
+        if (req->op == BFM_IO_READ)
+            n = preadv(req->fd, iov, nIov, offset);
+        else
+            n = pwritev(req->fd, iov, nIov, offset);
+
+        if (n < 0 && errno == EINTR) n = 0;
+        else if (n <= 0) {
+            req->result = eDEVICEIOERR_EDUBFM;
+            break;
+        }
+        offset += n;
+    }
+
+} /* edubfm_IODo() */
+
+
+
+/*@================================
+ * edubfm_IODone()
+ *================================*/
+/*
+ * Function: void edubfm_IODone(BfMIORequest *)
+ *
+ * Description:
+ *  Count the latency of the request over and call its done(). The
+ *  engines call it instead of done().
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_IODone(
+    BfMIORequest        *req)           /* IN request over */
+{
+    UEight              ns = edubfm_Now() - req->start;
+
+
+    if (req->op == BFM_IO_READ)
+        BFM_COUNT_VALUE(req->type, readNs, ns);
+    else
+        BFM_COUNT_VALUE(req->type, writeNs, ns);
+
+    req->done(req);
+
+} /* edubfm_IODone() */
+
+
+
+/*@================================
+ * io_BatchDone()
+ *================================*/
+/*
+ * Function: static void io_BatchDone(BfMIORequest *)
+ *
+ * Description:
+ *  done() of the requests of a BfMIOBatch.
+ *
+ * Returns:
+ *  None
+ */
+static void io_BatchDone(
+    BfMIORequest        *req)           /* IN request over */
+{
+    BfMIOBatch          *batch = (BfMIOBatch *)req->arg;
+
+
+    pthread_mutex_lock(&batch->mutex);
+
+    if (req->result < eNOERROR && batch->result == eNOERROR) batch->result = req->result;
+    if (--batch->nPending == 0) pthread_cond_broadcast(&batch->done);
+
+    pthread_mutex_unlock(&batch->mutex);
+
+} /* io_BatchDone() */
+
+
+
+/*@================================
+ * edubfm_IOBatchInit()
+ *================================*/
+/*
+ * Function: void edubfm_IOBatchInit(BfMIOBatch *)
+ *
+ * Description:
+ *  Initialize an empty batch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_IOBatchInit(
+    BfMIOBatch          *batch)         /* OUT batch */
+{
+    pthread_mutex_init(&batch->mutex, NULL);
+    pthread_cond_init(&batch->done, NULL);
+    batch->nPending = 0;
+    batch->result = eNOERROR;
+
+} /* edubfm_IOBatchInit() */
+
+
+
+/*@================================
+ * edubfm_IOBatchAdd()
+ *================================*/
+/*
+ * Function: void edubfm_IOBatchAdd(BfMIOBatch *, BfMIORequest *)
+ *
+ * Description:
+ *  Make the request a member of the batch. It is called before the
+ *  request is submitted.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_IOBatchAdd(
+    BfMIOBatch          *batch,         /* INOUT batch */
+    BfMIORequest        *req)           /* INOUT request */
+{
+    req->done = io_BatchDone;
+    req->arg = batch;
+
+    pthread_mutex_lock(&batch->mutex);
+    batch->nPending++;
+    pthread_mutex_unlock(&batch->mutex);
+
+} /* edubfm_IOBatchAdd() */
+
+
+
+/*@================================
+ * edubfm_IOBatchWait()
+ *================================*/
+/*
+ * Function: Four edubfm_IOBatchWait(BfMIOBatch *)
+ *
+ * Description:
+ *  Wait until all the requests of the batch are over, and release the
+ *  batch.
+ *
+ * Returns:
+ *  the first error of the requests
+ */
+Four edubfm_IOBatchWait(
+    BfMIOBatch          *batch)         /* INOUT batch */
+{
+    Four                e;              /* error code */
+
+
+    pthread_mutex_lock(&batch->mutex);
+    while (batch->nPending > 0) pthread_cond_wait(&batch->done, &batch->mutex);
+    e = batch->result;
+    pthread_mutex_unlock(&batch->mutex);
+
+    pthread_cond_destroy(&batch->done);
+    pthread_mutex_destroy(&batch->mutex);
+
+    return(e);
+
+} /* edubfm_IOBatchWait() */
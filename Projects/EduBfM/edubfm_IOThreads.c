@@ -0,0 +1,226 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_IOThreads.c
+ *
+ * Description:
+ *  Portable I/O engine: a pool of threads doing the requests with
+ *  preadv()/pwritev(). It is used where io_uring is not available.
+ *
+ * Exports:
+ *  BfMIOEngine edubfm_threadsEngine
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* state of the thread pool */
+static struct {
+    pthread_t           threads[BFM_IO_THREADS];
+    Boolean             stop;           /* the threads are asked to exit */
+    pthread_mutex_t     mutex;          /* protects the queue */
+    pthread_cond_t      queued;         /* signaled when requests are queued */
+    BfMIORequest        *head;          /* queue of requests */
+    BfMIORequest        *tail;
+} pool = { { 0 }, FALSE, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL };
+
+
+
+/*@================================
+ * threads_Main()
+ *================================*/
+/*
+ * Function: static void *threads_Main(void *)
+ *
+ * Description:
+ *  Body of the threads. The queue is emptied before they exit.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *threads_Main(
+    void                *arg)           /* IN not used */
+{
+    BfMIORequest        *req;
+
+
+    pthread_mutex_lock(&pool.mutex);
+
+    for (;;) {
+        if (pool.head == NULL) {
+            if (pool.stop) break;
+            pthread_cond_wait(&pool.queued, &pool.mutex);
+            continue;
+        }
+
+        req = pool.head;
+        pool.head = req->next;
+        if (pool.head == NULL) pool.tail = NULL;
+        pthread_mutex_unlock(&pool.mutex);
+
+        edubfm_IODo(req, 0);
+        edubfm_IODone(req);
+
+        pthread_mutex_lock(&pool.mutex);
+    }
+
+    pthread_mutex_unlock(&pool.mutex);
+
+    return(NULL);
+
+} /* threads_Main() */
+
+
+
+/*@================================
+ * threads_Init()
+ *================================*/
+/*
+ * Function: static Four threads_Init(void)
+ *
+ * Description:
+ *  Create the threads.
+ *
+ * Returns:
+ *  error code
+ *    eTHREADCREATEERR_EDUBFM - a thread cannot be created
+ */
+static Four threads_Init(void)
+{
+    Four                i;
+
+
+    pool.stop = FALSE;
+    for (i = 0; i < BFM_IO_THREADS; i++)
+        if (pthread_create(&pool.threads[i], NULL, threads_Main, NULL) != 0) break;
+
+    if (i < BFM_IO_THREADS) {
+        pthread_mutex_lock(&pool.mutex);
+        pool.stop = TRUE;
+        pthread_cond_broadcast(&pool.queued);
+        pthread_mutex_unlock(&pool.mutex);
+        while (--i >= 0) pthread_join(pool.threads[i], NULL);
+        ERR(eTHREADCREATEERR_EDUBFM);
+    }
+
+    return(eNOERROR);
+
+} /* threads_Init() */
+
+
+
+/*@================================
+ * threads_Final()
+ *================================*/
+/*
+ * Function: static void threads_Final(void)
+ *
+ * Description:
+ *  Stop the threads.
+ *
+ * Returns:
+ *  None
+ */
+static void threads_Final(void)
+{
+    Four                i;
+
+
+    pthread_mutex_lock(&pool.mutex);
+    pool.stop = TRUE;
+    pthread_cond_broadcast(&pool.queued);
+    pthread_mutex_unlock(&pool.mutex);
+
+    for (i = 0; i < BFM_IO_THREADS; i++) pthread_join(pool.threads[i], NULL);
+
+} /* threads_Final() */
+
+
+
+/*@================================
+ * threads_Submit()
+ *================================*/
+/*
+ * Function: static void threads_Submit(BfMIORequest **, Four)
+ *
+ * Description:
+ *  Queue the requests.
+ *
+ * Returns:
+ *  None
+ */
+static void threads_Submit(
+    BfMIORequest        **reqs,         /* IN requests */
+    Four                n)              /* IN # of requests */
+{
+    Four                i;
+
+
+    pthread_mutex_lock(&pool.mutex);
+
+    for (i = 0; i < n; i++) {
+        reqs[i]->next = NULL;
+        if (pool.tail == NULL) pool.head = reqs[i];
+        else pool.tail->next = reqs[i];
+        pool.tail = reqs[i];
+    }
+
+    if (n == 1) pthread_cond_signal(&pool.queued);
+    else pthread_cond_broadcast(&pool.queued);
+
+    pthread_mutex_unlock(&pool.mutex);
+
+} /* threads_Submit() */
+
+
+BfMIOEngine edubfm_threadsEngine = {
+    "threads", threads_Init, threads_Final, threads_Submit, NULL
+};
@@ -0,0 +1,539 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_IOUring.c
+ *
+ * Description:
+ *  I/O engine on io_uring of Linux, used through the system calls.
+ *  A batch of requests is put in the submission queue and submitted by
+ *  one io_uring_enter(). The memory of the buffer pools is registered so
+ *  that the read or write of a train in a buffer is a fixed buffer
+ *  operation. A reaper thread takes the completions and calls done() of
+ *  the requests. The # of requests in flight is kept within the size of
+ *  the completion queue.
+ *
+ * Exports:
+ *  BfMIOEngine edubfm_uringEngine
+ */
+
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* # of entries of the submission queue */
+#define URING_ENTRIES   256
+
+/* state of the ring */
+static struct {
+    Four                fd;             /* ring (NIL if not set up) */
+    void                *sqRing;        /* mapped rings */
+    size_t              sqRingSize;
+    void                *cqRing;
+    size_t              cqRingSize;
+    struct io_uring_sqe *sqes;
+    size_t              sqesSize;
+    unsigned            *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned            sqEntries;
+    unsigned            *cqHead, *cqTail, *cqMask;
+    struct io_uring_cqe *cqes;
+    unsigned            cqEntries;
+    pthread_t           reaper;
+    pthread_mutex_t     mutex;          /* protects the submission queue and the fields below */
+    pthread_cond_t      space;          /* signaled when requests are over */
+    unsigned            nInFlight;      /* # of requests submitted and not over */
+    struct iovec        bufs[NUM_BUF_TYPES];    /* registered memory */
+    Four                nBufs;
+} ring = { NIL };
+
+
+/* internal function prototypes */
+static Four uring_Enter(unsigned, unsigned, unsigned);
+
+
+
+/*@================================
+ * uring_Enter()
+ *================================*/
+/*
+ * Function: static Four uring_Enter(unsigned, unsigned, unsigned)
+ *
+ * Description:
+ *  io_uring_enter() retried when interrupted.
+ *
+ * Returns:
+ *  # of entries submitted (< 0 if failed)
+ */
+static Four uring_Enter(
+    unsigned            toSubmit,       /* IN # of entries to submit */
+    unsigned            minComplete,    /* IN # of completions to wait for */
+    unsigned            flags)          /* IN IORING_ENTER_xxx */
+{
+    Four                n;
+
+
+    do {
+        n = syscall(__NR_io_uring_enter, ring.fd, toSubmit, minComplete, flags, NULL, 0);
+    } while (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+
+    return(n);
+
+} /* uring_Enter() */
+
+
+
+/*@================================
+ * uring_GetSqe()
+ *================================*/
+/*
+ * Function: static struct io_uring_sqe *uring_GetSqe(void)
+ *
+ * Description:
+ *  Get a free entry of the submission queue, submitting the entries
+ *  queued if it is full. The caller holds the ring mutex.
+ *
+ * Returns:
+ *  the entry
+ */
+static struct io_uring_sqe *uring_GetSqe(void)
+{
+    unsigned            tail = *ring.sqTail;
+    unsigned            idx;
+
+
+    while (tail - __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE) == ring.sqEntries)
+        uring_Enter(ring.sqEntries, 0, 0);
+
+    idx = tail & *ring.sqMask;
+    ring.sqArray[idx] = idx;
+    memset(&ring.sqes[idx], 0, sizeof(struct io_uring_sqe));
+
+    return(&ring.sqes[idx]);
+
+} /* uring_GetSqe() */
+
+
+
+/*@================================
+ * uring_Push()
+ *================================*/
+/*
+ * Function: static void uring_Push(void)
+ *
+ * Description:
+ *  Make the entry got by uring_GetSqe() visible to the kernel.
+ *  The caller holds the ring mutex.
+ *
+ * Returns:
+ *  None
+ */
+static void uring_Push(void)
+{
+    __atomic_store_n(ring.sqTail, *ring.sqTail + 1, __ATOMIC_RELEASE);
+    ring.nInFlight++;
+
+} /* uring_Push() */
+
+
+
+/*@================================
+ * uring_Flush()
+ *================================*/
+/*
+ * Function: static void uring_Flush(void)
+ *
+ * Description:
+ *  Submit the entries queued. The caller holds the ring mutex.
+ *
+ * Returns:
+ *  None
+ */
+static void uring_Flush(void)
+{
+    unsigned            n;
+
+
+    while ((n = *ring.sqTail - __atomic_load_n(ring.sqHead, __ATOMIC_ACQUIRE)) > 0)
+        if (uring_Enter(n, 0, 0) < 0) break;
+
+} /* uring_Flush() */
+
+
+
+/*@================================
+ * uring_BufIndex()
+ *================================*/
+/*
+ * Function: static Four uring_BufIndex(struct iovec *)
+ *
+ * Description:
+ *  Find the registered memory containing the buffer.
+ *  The caller holds the ring mutex.
+ *
+ * Returns:
+ *  index of the registered memory (NIL if none)
+ */
+static Four uring_BufIndex(
+    struct iovec        *iov)           /* IN buffer */
+{
+    Four                k;
+    char                *base;
+
+
+    for (k = 0; k < ring.nBufs; k++) {
+        base = (char *)ring.bufs[k].iov_base;
+        if ((char *)iov->iov_base >= base &&
+            (char *)iov->iov_base + iov->iov_len <= base + ring.bufs[k].iov_len) return(k);
+    }
+
+    return(NIL);
+
+} /* uring_BufIndex() */
+
+
+
+/*@================================
+ * uring_Main()
+ *================================*/
+/*
+ * Function: static void *uring_Main(void *)
+ *
+ * Description:
+ *  Body of the reaper thread. A completion of user_data 0 stops it.
+ *  A request transferring less than asked is finished synchronously.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *uring_Main(
+    void                *arg)           /* IN not used */
+{
+    unsigned            head, tail;
+    struct io_uring_cqe *cqe;
+    BfMIORequest        *req;
+    Four                res, i;
+    size_t              len;
+    Boolean             stop = FALSE;
+
+
+    while (!stop) {
+        head = *ring.cqHead;
+        tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            uring_Enter(0, 1, IORING_ENTER_GETEVENTS);
+            continue;
+        }
+
+        for ( ; head != tail; head++) {
+            cqe = &ring.cqes[head & *ring.cqMask];
+            req = (BfMIORequest *)(uintptr_t)cqe->user_data;
+            res = cqe->res;
+            __atomic_store_n(ring.cqHead, head + 1, __ATOMIC_RELEASE);
+
+            if (req == NULL)
+                stop = TRUE;
+            else {
+                for (len = 0, i = 0; i < req->nIov; i++) len += req->iov[i].iov_len;
+
+                if (res == -EINTR || res == -EAGAIN) edubfm_IODo(req, 0);
+                else if (res < 0) req->result = eDEVICEIOERR_EDUBFM;
+                else if ((size_t)res < len) edubfm_IODo(req, res);
+                else req->result = eNOERROR;
+
+                edubfm_IODone(req);
+            }
+
+            pthread_mutex_lock(&ring.mutex);
+            ring.nInFlight--;
+            pthread_cond_broadcast(&ring.space);
+            pthread_mutex_unlock(&ring.mutex);
+        }
+    }
+
+    return(NULL);
+
+} /* uring_Main() */
+
+
+
+/*@================================
+ * uring_Final()
+ *================================*/
+/*
+ * Function: static void uring_Final(void)
+ *
+ * Description:
+ *  Stop the reaper thread and tear down the ring.
+ *
+ * Returns:
+ *  None
+ */
+static void uring_Final(void)
+{
+    struct io_uring_sqe *sqe;
+
+
+    if (ring.fd == NIL) return;
+
+    if (ring.cqEntries > 0) {
+        pthread_mutex_lock(&ring.mutex);
+        sqe = uring_GetSqe();
+        sqe->opcode = IORING_OP_NOP;
+        sqe->user_data = 0;
+        uring_Push();
+        uring_Flush();
+        pthread_mutex_unlock(&ring.mutex);
+
+        pthread_join(ring.reaper, NULL);
+        ring.cqEntries = 0;
+    }
+
+    if (ring.sqes != NULL) munmap(ring.sqes, ring.sqesSize);
+    if (ring.cqRing != NULL && ring.cqRing != ring.sqRing) munmap(ring.cqRing, ring.cqRingSize);
+    if (ring.sqRing != NULL) munmap(ring.sqRing, ring.sqRingSize);
+    close(ring.fd);     /* the registered memory is released with the ring */
+
+    pthread_cond_destroy(&ring.space);
+    pthread_mutex_destroy(&ring.mutex);
+    ring.fd = NIL;
+
+} /* uring_Final() */
+
+
+
+/*@================================
+ * uring_Init()
+ *================================*/
+/*
+ * Function: static Four uring_Init(void)
+ *
+ * Description:
+ *  Set up the ring and start the reaper thread.
+ *
+ * Returns:
+ *  error code
+ *    eNOTSUPPORTED_EDUBFM - io_uring is not available
+ *    eTHREADCREATEERR_EDUBFM - the reaper thread cannot be created
+ */
+static Four uring_Init(void)
+{
+    struct io_uring_params p;
+    char                *sq, *cq;
+
+
+    memset(&ring, 0, sizeof(ring));
+    pthread_mutex_init(&ring.mutex, NULL);
+    pthread_cond_init(&ring.space, NULL);
+
+    memset(&p, 0, sizeof(p));
+    ring.fd = syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+    if (ring.fd < 0) {
+        ring.fd = NIL;
+        pthread_cond_destroy(&ring.space);
+        pthread_mutex_destroy(&ring.mutex);
+        ERR(eNOTSUPPORTED_EDUBFM);
+    }
+
+    ring.sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    ring.cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring.cqRingSize > ring.sqRingSize) ring.sqRingSize = ring.cqRingSize;
+        ring.cqRingSize = ring.sqRingSize;
+    }
+    ring.sqesSize = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    ring.sqRing = mmap(NULL, ring.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring.fd, IORING_OFF_SQ_RING);
+    if (ring.sqRing == MAP_FAILED) { ring.sqRing = NULL; uring_Final(); ERR(eNOTSUPPORTED_EDUBFM); }
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+        ring.cqRing = ring.sqRing;
+    else {
+        ring.cqRing = mmap(NULL, ring.cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring.fd, IORING_OFF_CQ_RING);
+        if (ring.cqRing == MAP_FAILED) { ring.cqRing = NULL; uring_Final(); ERR(eNOTSUPPORTED_EDUBFM); }
+    }
+
+    ring.sqes = mmap(NULL, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring.fd, IORING_OFF_SQES);
+    if (ring.sqes == MAP_FAILED) { ring.sqes = NULL; uring_Final(); ERR(eNOTSUPPORTED_EDUBFM); }
+
+    sq = (char *)ring.sqRing;
+    ring.sqHead = (unsigned *)(sq + p.sq_off.head);
+    ring.sqTail = (unsigned *)(sq + p.sq_off.tail);
+    ring.sqMask = (unsigned *)(sq + p.sq_off.ring_mask);
+    ring.sqArray = (unsigned *)(sq + p.sq_off.array);
+    ring.sqEntries = p.sq_entries;
+
+    cq = (char *)ring.cqRing;
+    ring.cqHead = (unsigned *)(cq + p.cq_off.head);
+    ring.cqTail = (unsigned *)(cq + p.cq_off.tail);
+    ring.cqMask = (unsigned *)(cq + p.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    if (pthread_create(&ring.reaper, NULL, uring_Main, NULL) != 0) {
+        uring_Final();
+        ERR(eTHREADCREATEERR_EDUBFM);
+    }
+    ring.cqEntries = p.cq_entries;
+
+    return(eNOERROR);
+
+} /* uring_Init() */
+
+
+
+/*@================================
+ * uring_Submit()
+ *================================*/
+/*
+ * Function: static void uring_Submit(BfMIORequest **, Four)
+ *
+ * Description:
+ *  Put the requests in the submission queue and submit them together.
+ *
+ * Returns:
+ *  None
+ */
+static void uring_Submit(
+    BfMIORequest        **reqs,         /* IN requests */
+    Four                n)              /* IN # of requests */
+{
+    Four                i, k;
+    BfMIORequest        *req;
+    struct io_uring_sqe *sqe;
+
+
+    pthread_mutex_lock(&ring.mutex);
+
+    for (i = 0; i < n; i++) {
+        req = reqs[i];
+
+        /* the completion queue must not overflow */
+        if (ring.nInFlight >= ring.cqEntries) {
+            uring_Flush();
+            while (ring.nInFlight >= ring.cqEntries) pthread_cond_wait(&ring.space, &ring.mutex);
+        }
+
+        sqe = uring_GetSqe();
+        sqe->fd = req->fd;
+        sqe->off = req->offset;
+        sqe->user_data = (uintptr_t)req;
+
+        k = (req->nIov == 1) ? uring_BufIndex(req->iov) : NIL;
+        if (k != NIL) {
+            sqe->opcode = (req->op == BFM_IO_READ) ? IORING_OP_READ_FIXED : IORING_OP_WRITE_FIXED;
+            sqe->addr = (uintptr_t)req->iov[0].iov_base;
+            sqe->len = req->iov[0].iov_len;
+            sqe->buf_index = k;
+        } else {
+            sqe->opcode = (req->op == BFM_IO_READ) ? IORING_OP_READV : IORING_OP_WRITEV;
+            sqe->addr = (uintptr_t)req->iov;
+            sqe->len = req->nIov;
+        }
+
+        uring_Push();
+    }
+
+    uring_Flush();
+
+    pthread_mutex_unlock(&ring.mutex);
+
+} /* uring_Submit() */
+
+
+
+/*@================================
+ * uring_SetBuffers()
+ *================================*/
+/*
+ * Function: static void uring_SetBuffers(struct iovec *, Four)
+ *
+ * Description:
+ *  Register the memory of the buffer pools, replacing the memory
+ *  registered before. If the memory cannot be registered, e.g. beyond
+ *  the locked memory limit, requests use the vectored operations.
+ *
+ * Returns:
+ *  None
+ */
+static void uring_SetBuffers(
+    struct iovec        *bufs,          /* IN memory of the buffer pools */
+    Four                n)              /* IN # of elements of bufs */
+{
+    pthread_mutex_lock(&ring.mutex);
+
+    /* the kernel does not replace the buffers used by requests in flight */
+    while (ring.nInFlight > 0) pthread_cond_wait(&ring.space, &ring.mutex);
+
+    if (ring.nBufs > 0) {
+        syscall(__NR_io_uring_register, ring.fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+        ring.nBufs = 0;
+    }
+
+    if (n > 0 && syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, bufs, n) == 0) {
+        memcpy(ring.bufs, bufs, n * sizeof(struct iovec));
+        ring.nBufs = n;
+    }
+
+    pthread_mutex_unlock(&ring.mutex);
+
+} /* uring_SetBuffers() */
+
+
+BfMIOEngine edubfm_uringEngine = {
+    "io_uring", uring_Init, uring_Final, uring_Submit, uring_SetBuffers
+};
@@ -0,0 +1,415 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_LRUK.c
+ *
+ * Description:
+ *  LRU-K buffer replacement policy (O'Neil, O'Neil, and Weikum, SIGMOD 1993).
+ *  The victim is the unfixed buffer whose K-th most recent reference is
+ *  the oldest. Buffers referenced fewer than K times have an infinite
+ *  backward K-distance and are replaced first, in LRU order among them.
+ *  The reference history of a replaced train is retained in a ghost
+ *  directory so that a train re-read soon after its replacement keeps
+ *  its history, which is what lets LRU-K tell a hot page from a page
+ *  touched once by a sequential scan.
+ *
+ * Exports:
+ *  BfMPolicy edubfm_lruKPolicy
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h>
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* where a buffer is */
+#define LRUK_NONE       0       /* being replaced */
+#define LRUK_FREE       1       /* in the free list */
+#define LRUK_RESIDENT   2       /* holds a train */
+
+/* type definition for the state of the LRU-K policy */
+typedef struct {
+    Four        nBufs;                  /* # of buffers */
+    Four        k;                      /* K */
+    Eight       now;                    /* logical time advanced at every reference */
+    Eight       *hist;                  /* reference times of each buffer, most recent first */
+    One         *where;                 /* LRUK_xxx */
+    BfMLinks    links;
+    BfMList     freeList;               /* buffers holding no train */
+    BfMGhostDir ghost;                  /* histories of replaced trains */
+    Eight       pending[BFM_MAX_LRUK];  /* history of the train being loaded */
+} LRUKState;
+
+#define STATE(type)     ((LRUKState *)BE_POLICYSTATE(type))
+#define HIST(s, idx)    ((s)->hist + (idx) * (s)->k)
+
+
+static void lruk_Final(Four);
+
+
+
+/*@================================
+ * lruk_Init()
+ *================================*/
+/*
+ * Function: Four lruk_Init(Four)
+ *
+ * Description:
+ *  Build the LRU-K state. Trains already in the buffer pool are regarded
+ *  as referenced once, in the order of the buffer index.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four lruk_Init(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                i;
+    LRUKState           *s;
+
+
+    s = (LRUKState *)calloc(1, sizeof(LRUKState));
+    if (s == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    BE_POLICYSTATE(type) = s;
+
+    s->nBufs = BE_NBUFS(type);
+    s->k = BE_CFG(type).lruK;
+    s->hist = (Eight *)calloc(s->nBufs * s->k, sizeof(Eight));
+    s->where = (One *)malloc(sizeof(One) * s->nBufs);
+    if (s->hist == NULL || s->where == NULL) {
+        lruk_Final(type);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    e = edubfm_LinksInit(&s->links, s->nBufs);
+    if (e < eNOERROR) {
+        lruk_Final(type);
+        ERR(e);
+    }
+
+    e = edubfm_GhostInit(&s->ghost, s->nBufs, s->k);
+    if (e < eNOERROR) {
+        lruk_Final(type);
+        ERR(e);
+    }
+
+    edubfm_ListInit(&s->freeList);
+    for (i = 0; i < s->nBufs; i++) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, i))) {
+            s->where[i] = LRUK_FREE;
+            edubfm_ListInsertHead(&s->links, &s->freeList, i);
+        }
+        else {
+            s->where[i] = LRUK_RESIDENT;
+            HIST(s, i)[0] = ++s->now;
+        }
+    }
+
+    return(eNOERROR);
+
+} /* lruk_Init() */
+
+
+
+/*@================================
+ * lruk_Final()
+ *================================*/
+/*
+ * Function: void lruk_Final(Four)
+ *
+ * Description:
+ *  Release the LRU-K state.
+ *
+ * Returns:
+ *  None
+ */
+static void lruk_Final(
+    Four                type)           /* IN buffer type */
+{
+    LRUKState           *s = STATE(type);
+
+
+    if (s == NULL) return;
+
+    if (s->links.prev != NULL) edubfm_LinksFinal(&s->links);
+    if (s->ghost.listNo != NULL) edubfm_GhostFinal(&s->ghost);
+    free(s->hist);
+    free(s->where);
+    free(s);
+
+    BE_POLICYSTATE(type) = NULL;
+
+} /* lruk_Final() */
+
+
+
+/*@================================
+ * lruk_Access()
+ *================================*/
+/*
+ * Function: void lruk_Access(Four, Four)
+ *
+ * Description:
+ *  Record a reference to the train in the buffer.
+ *
+ * Returns:
+ *  None
+ */
+static void lruk_Access(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    LRUKState           *s = STATE(type);
+    Eight               *h;
+
+
+    /* a train loaded behind the policy's back; adopt it */
+    if (s->where[idx] == LRUK_FREE) {
+        edubfm_ListRemove(&s->links, &s->freeList, idx);
+        s->where[idx] = LRUK_RESIDENT;
+        memset(HIST(s, idx), 0, sizeof(Eight) * s->k);
+    }
+
+    h = HIST(s, idx);
+    memmove(h + 1, h, sizeof(Eight) * (s->k - 1));
+    h[0] = ++s->now;
+
+} /* lruk_Access() */
+
+
+
+/*@================================
+ * lruk_Miss()
+ *================================*/
+/*
+ * Function: void lruk_Miss(Four, BfMHashKey *)
+ *
+ * Description:
+ *  Prepare the history of the train to be loaded, using the retained
+ *  history if the train has been replaced recently.
+ *
+ * Returns:
+ *  None
+ */
+static void lruk_Miss(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key)           /* IN train to be loaded */
+{
+    LRUKState           *s = STATE(type);
+    Four                node;
+
+
+    memset(s->pending, 0, sizeof(s->pending));
+    s->pending[0] = ++s->now;
+
+    node = edubfm_GhostLookUp(&s->ghost, key);
+    if (node != NIL) {
+        memcpy(s->pending + 1, GHOST_AUX(&s->ghost, node), sizeof(Eight) * (s->k - 1));
+        edubfm_GhostDelete(&s->ghost, node);
+    }
+
+} /* lruk_Miss() */
+
+
+
+/*@================================
+ * lruk_Victim()
+ *================================*/
+/*
+ * Function: Four lruk_Victim(Four)
+ *
+ * Description:
+ *  Select an unfixed free buffer if any. Otherwise select the unfixed
+ *  buffer with the maximum backward K-distance; ties, including the
+ *  buffers referenced fewer than K times, are broken in favor of the
+ *  buffers on the clean list, then by LRU.
+ *
+ * Returns:
+ *  1) index of the selected buffer
+ *  2) eNOUNFIXEDBUF_BFM - There is no unfixed buffer.
+ */
+static Four lruk_Victim(
+    Four                type)           /* IN buffer type */
+{
+    LRUKState           *s = STATE(type);
+    Four                i;
+    Four                victim;
+    Boolean             clean, vClean = FALSE;  /* TRUE if buffer i, the victim, is on the clean list */
+    Eight               *h, *v;
+
+
+    victim = edubfm_ListUnfixedTail(type, &s->links, &s->freeList);
+    if (victim != NIL) return(victim);
+
+    for (i = 0; i < s->nBufs; i++) {
+        if (s->where[i] != LRUK_RESIDENT || BI_FIXED(type, i) != 0) continue;
+
+        h = HIST(s, i);
+        clean = IS_ON_CLEANLIST(type, i) && !(BFM_ATOMIC_LOAD(BI_BITS(type, i)) & DIRTY);
+        if (victim == NIL) {
+            victim = i;
+            vClean = clean;
+            continue;
+        }
+
+        v = HIST(s, victim);
+        if (h[s->k - 1] < v[s->k - 1] ||
+            (h[s->k - 1] == v[s->k - 1] && (clean > vClean || (clean == vClean && h[0] < v[0])))) {
+            victim = i;
+            vClean = clean;
+        }
+    }
+
+    if (victim == NIL) return(eNOUNFIXEDBUF_BFM);
+    if (vClean) BFM_COUNT(type, nCleanAllocs);
+
+    return(victim);
+
+} /* lruk_Victim() */
+
+
+
+/*@================================
+ * lruk_Evict()
+ *================================*/
+/*
+ * Function: void lruk_Evict(Four, Four)
+ *
+ * Description:
+ *  Retain the history of the train being replaced.
+ *
+ * Returns:
+ *  None
+ */
+static void lruk_Evict(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    LRUKState           *s = STATE(type);
+    Four                node;
+
+
+    if (s->where[idx] == LRUK_FREE)
+        edubfm_ListRemove(&s->links, &s->freeList, idx);
+    else if (s->where[idx] == LRUK_RESIDENT && !IS_NILBFMHASHKEY(BI_KEY(type, idx))) {
+        node = edubfm_GhostInsert(&s->ghost, 0, &BI_KEY(type, idx));
+        memcpy(GHOST_AUX(&s->ghost, node), HIST(s, idx), sizeof(Eight) * s->k);
+    }
+
+    s->where[idx] = LRUK_NONE;
+
+} /* lruk_Evict() */
+
+
+
+/*@================================
+ * lruk_Admit()
+ *================================*/
+/*
+ * Function: void lruk_Admit(Four, Four)
+ *
+ * Description:
+ *  Give the prepared history to the buffer holding the loaded train.
+ *
+ * Returns:
+ *  None
+ */
+static void lruk_Admit(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    LRUKState           *s = STATE(type);
+
+
+    memcpy(HIST(s, idx), s->pending, sizeof(Eight) * s->k);
+    s->where[idx] = LRUK_RESIDENT;
+
+} /* lruk_Admit() */
+
+
+
+/*@================================
+ * lruk_Release()
+ *================================*/
+/*
+ * Function: void lruk_Release(Four, Four)
+ *
+ * Description:
+ *  Return the buffer to the free list, also if it still holds a train,
+ *  e.g. one emptied by EduBfM_DiscardAll(); its history is forgotten.
+ *
+ * Returns:
+ *  None
+ */
+static void lruk_Release(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    LRUKState           *s = STATE(type);
+
+
+    if (s->where[idx] == LRUK_FREE) return;
+
+    memset(HIST(s, idx), 0, sizeof(Eight) * s->k);
+    s->where[idx] = LRUK_FREE;
+    edubfm_ListInsertHead(&s->links, &s->freeList, idx);
+
+} /* lruk_Release() */
+
+
+BfMPolicy edubfm_lruKPolicy = {
+    "LRU-K",
+    lruk_Init, lruk_Final, lruk_Access, lruk_Miss,
+    lruk_Victim, lruk_Evict, lruk_Admit, lruk_Release
+};
@@ -0,0 +1,728 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_List.c
+ *
+ * Description:
+ *  Some data structures are provided to support the buffer replacement
+ *  policies: doubly linked lists of array indices, a chained hash map from
+ *  BfMHashKey to a node index, and ghost directories which remember the
+ *  keys of recently replaced trains in LRU order.
+ *  All of them are built on arrays of indices so that a policy can link
+ *  buffers without touching the buffer table.
+ *
+ * Exports:
+ *  void edubfm_ListInit(BfMList *)
+ *  void edubfm_ListInsertHead(BfMLinks *, BfMList *, Four)
+ *  void edubfm_ListRemove(BfMLinks *, BfMList *, Four)
+ *  Four edubfm_ListUnfixedTail(Four, BfMLinks *, BfMList *)
+ *  Four edubfm_ListVictim(Four, BfMLinks *, BfMList *)
+ *  Four edubfm_LinksInit(BfMLinks *, Four)
+ *  Four edubfm_LinksGrow(BfMLinks *, Four, Four)
+ *  void edubfm_LinksFinal(BfMLinks *)
+ *  Four edubfm_MapInit(BfMKeyMap *, Four)
+ *  void edubfm_MapFinal(BfMKeyMap *)
+ *  Four edubfm_MapLookUp(BfMKeyMap *, BfMHashKey *)
+ *  void edubfm_MapInsert(BfMKeyMap *, BfMHashKey *, Four)
+ *  void edubfm_MapDelete(BfMKeyMap *, Four)
+ *  Four edubfm_GhostInit(BfMGhostDir *, Four, Four)
+ *  void edubfm_GhostFinal(BfMGhostDir *)
+ *  Four edubfm_GhostLookUp(BfMGhostDir *, BfMHashKey *)
+ *  Four edubfm_GhostInsert(BfMGhostDir *, Four, BfMHashKey *)
+ *  void edubfm_GhostDelete(BfMGhostDir *, Four)
+ *  void edubfm_GhostTrim(BfMGhostDir *, Four, Four)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * macro definitions
+ */
+
+/* Macro: MAP_HASH(m,k)
+ * Description: return the hash value of the key in the key map
+ * Parameters:
+ *  BfMKeyMap *m    : pointer to the key map
+ *  BfMHashKey *k   : pointer to the key
+ * Returns: (Four) hash value
+ */
+#define MAP_HASH(m,k) \
+    ((Four)((((UFour)(k)->pageNo * 2654435761U) ^ (UFour)(k)->volNo) % (UFour)(m)->nBuckets))
+
+
+
+/*@================================
+ * edubfm_ListInit()
+ *================================*/
+/*
+ * Function: void edubfm_ListInit(BfMList *)
+ *
+ * Description:
+ *  Make the list empty.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ListInit(
+    BfMList             *list)          /* INOUT list to be initialized */
+{
+    list->head = NIL;
+    list->tail = NIL;
+    list->len = 0;
+
+} /* edubfm_ListInit() */
+
+
+
+/*@================================
+ * edubfm_ListInsertHead()
+ *================================*/
+/*
+ * Function: void edubfm_ListInsertHead(BfMLinks *, BfMList *, Four)
+ *
+ * Description:
+ *  Insert the element at the head (most recent end) of the list.
+ *  The element must not belong to any list sharing the links.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ListInsertHead(
+    BfMLinks            *links,         /* INOUT link arrays */
+    BfMList             *list,          /* INOUT list */
+    Four                idx)            /* IN element to be inserted */
+{
+    links->prev[idx] = NIL;
+    links->next[idx] = list->head;
+
+    if (list->head != NIL)
+        links->prev[list->head] = idx;
+    else
+        list->tail = idx;
+
+    list->head = idx;
+    list->len++;
+
+} /* edubfm_ListInsertHead() */
+
+
+
+/*@================================
+ * edubfm_ListRemove()
+ *================================*/
+/*
+ * Function: void edubfm_ListRemove(BfMLinks *, BfMList *, Four)
+ *
+ * Description:
+ *  Unlink the element from the list.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ListRemove(
+    BfMLinks            *links,         /* INOUT link arrays */
+    BfMList             *list,          /* INOUT list */
+    Four                idx)            /* IN element to be removed */
+{
+    if (links->prev[idx] != NIL)
+        links->next[links->prev[idx]] = links->next[idx];
+    else
+        list->head = links->next[idx];
+
+    if (links->next[idx] != NIL)
+        links->prev[links->next[idx]] = links->prev[idx];
+    else
+        list->tail = links->prev[idx];
+
+    links->prev[idx] = NIL;
+    links->next[idx] = NIL;
+    list->len--;
+
+} /* edubfm_ListRemove() */
+
+
+
+/*@================================
+ * edubfm_ListUnfixedTail()
+ *================================*/
+/*
+ * Function: Four edubfm_ListUnfixedTail(Four, BfMLinks *, BfMList *)
+ *
+ * Description:
+ *  Return the least recent buffer of the list which is not fixed.
+ *  The elements of the list must be buffer indices of the given buffer type.
+ *
+ * Returns:
+ *  1) index of the buffer
+ *  2) NIL if every buffer in the list is fixed
+ */
+Four edubfm_ListUnfixedTail(
+    Four                type,           /* IN buffer type */
+    BfMLinks            *links,         /* IN link arrays */
+    BfMList             *list)          /* IN list of buffers */
+{
+    Four                idx;
+
+    for (idx = list->tail; idx != NIL; idx = links->prev[idx])
+        if (BI_FIXED(type, idx) == 0) return(idx);
+
+    return(NIL);
+
+} /* edubfm_ListUnfixedTail() */
+
+
+
+/*@================================
+ * edubfm_ListVictim()
+ *================================*/
+/*
+ * Function: Four edubfm_ListVictim(Four, BfMLinks *, BfMList *)
+ *
+ * Description:
+ *  Select the buffer to be replaced from the least recent end of the
+ *  list. Among the BFM_CLEAN_WINDOW least recent buffers which are not
+ *  fixed, the least recent one on the clean list of the pool is taken,
+ *  so that a miss does not wait for a write-back if it need not;
+ *  otherwise the least recent buffer which is not fixed is taken.
+ *  The elements of the list must be buffer indices of the given buffer type.
+ *
+ * Returns:
+ *  1) index of the buffer
+ *  2) NIL if every buffer in the list is fixed
+ */
+Four edubfm_ListVictim(
+    Four                type,           /* IN buffer type */
+    BfMLinks            *links,         /* IN link arrays */
+    BfMList             *list)          /* IN list of buffers */
+{
+    Four                idx;
+    Four                first = NIL;    /* least recent buffer not fixed */
+    Four                n = 0;          /* # of buffers not fixed looked at */
+
+    for (idx = list->tail; idx != NIL && n < BFM_CLEAN_WINDOW; idx = links->prev[idx]) {
+        if (BI_FIXED(type, idx) != 0) continue;
+
+        if (IS_ON_CLEANLIST(type, idx) && !(BFM_ATOMIC_LOAD(BI_BITS(type, idx)) & DIRTY)) {
+            BFM_COUNT(type, nCleanAllocs);
+            return(idx);
+        }
+
+        if (first == NIL) first = idx;
+        n++;
+    }
+
+    return(first);
+
+} /* edubfm_ListVictim() */
+
+
+
+/*@================================
+ * edubfm_LinksInit()
+ *================================*/
+/*
+ * Function: Four edubfm_LinksInit(BfMLinks *, Four)
+ *
+ * Description:
+ *  Allocate link arrays for 'n' elements. Every element is unlinked.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_LinksInit(
+    BfMLinks            *links,         /* OUT link arrays */
+    Four                n)              /* IN # of elements */
+{
+    Four                i;
+
+    links->prev = (Four *)malloc(sizeof(Four) * n);
+    links->next = (Four *)malloc(sizeof(Four) * n);
+    if (links->prev == NULL || links->next == NULL) {
+        edubfm_LinksFinal(links);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (i = 0; i < n; i++)
+        links->prev[i] = links->next[i] = NIL;
+
+    return(eNOERROR);
+
+} /* edubfm_LinksInit() */
+
+
+
+/*@================================
+ * edubfm_LinksGrow()
+ *================================*/
+/*
+ * Function: Four edubfm_LinksGrow(BfMLinks *, Four, Four)
+ *
+ * Description:
+ *  Make the link arrays of 'oldN' elements hold 'n' elements. The new
+ *  elements are unlinked, and the lists over the arrays are kept. The
+ *  arrays may move, so no list over them may be used meanwhile. On
+ *  failure, the arrays are left as they were.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_LinksGrow(
+    BfMLinks            *links,         /* INOUT link arrays */
+    Four                oldN,           /* IN # of elements */
+    Four                n)              /* IN new # of elements */
+{
+    Four                i;
+    Four                *p;
+
+    p = (Four *)realloc(links->prev, sizeof(Four) * n);
+    if (p == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    links->prev = p;
+
+    p = (Four *)realloc(links->next, sizeof(Four) * n);
+    if (p == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    links->next = p;
+
+    for (i = oldN; i < n; i++)
+        links->prev[i] = links->next[i] = NIL;
+
+    return(eNOERROR);
+
+} /* edubfm_LinksGrow() */
+
+
+
+/*@================================
+ * edubfm_LinksFinal()
+ *================================*/
+/*
+ * Function: void edubfm_LinksFinal(BfMLinks *)
+ *
+ * Description:
+ *  Free the link arrays.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_LinksFinal(
+    BfMLinks            *links)         /* INOUT link arrays */
+{
+    free(links->prev);
+    free(links->next);
+    links->prev = links->next = NULL;
+
+} /* edubfm_LinksFinal() */
+
+
+
+/*@================================
+ * edubfm_MapInit()
+ *================================*/
+/*
+ * Function: Four edubfm_MapInit(BfMKeyMap *, Four)
+ *
+ * Description:
+ *  Build an empty key map for node indices 0 ~ nNodes-1.
+ *  Like the buffer hash table, the map has about three times as many
+ *  hash chains as nodes.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_MapInit(
+    BfMKeyMap           *map,           /* OUT key map */
+    Four                nNodes)         /* IN # of nodes */
+{
+    Four                i;
+
+    map->nBuckets = HASHTABLESIZE_TO_NBUFS(nNodes > 0 ? nNodes : 1);
+    map->bucket = (Four *)malloc(sizeof(Four) * map->nBuckets);
+    map->next = (Four *)malloc(sizeof(Four) * (nNodes > 0 ? nNodes : 1));
+    map->key = (BfMHashKey *)malloc(sizeof(BfMHashKey) * (nNodes > 0 ? nNodes : 1));
+    if (map->bucket == NULL || map->next == NULL || map->key == NULL) {
+        edubfm_MapFinal(map);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (i = 0; i < map->nBuckets; i++) map->bucket[i] = NIL;
+    for (i = 0; i < nNodes; i++) {
+        map->next[i] = NIL;
+        SET_NILBFMHASHKEY(map->key[i]);
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_MapInit() */
+
+
+
+/*@================================
+ * edubfm_MapFinal()
+ *================================*/
+/*
+ * Function: void edubfm_MapFinal(BfMKeyMap *)
+ *
+ * Description:
+ *  Free the key map.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_MapFinal(
+    BfMKeyMap           *map)           /* INOUT key map */
+{
+    free(map->bucket);
+    free(map->next);
+    free(map->key);
+    map->bucket = map->next = NULL;
+    map->key = NULL;
+
+} /* edubfm_MapFinal() */
+
+
+
+/*@================================
+ * edubfm_MapLookUp()
+ *================================*/
+/*
+ * Function: Four edubfm_MapLookUp(BfMKeyMap *, BfMHashKey *)
+ *
+ * Description:
+ *  Look up the node having the given key.
+ *
+ * Returns:
+ *  1) node index
+ *  2) NIL if the key is not in the map
+ */
+Four edubfm_MapLookUp(
+    BfMKeyMap           *map,           /* IN key map */
+    BfMHashKey          *key)           /* IN key to look up */
+{
+    Four                i;
+
+    for (i = map->bucket[MAP_HASH(map, key)]; i != NIL; i = map->next[i])
+        if (EQUALKEY(&map->key[i], key)) return(i);
+
+    return(NIL);
+
+} /* edubfm_MapLookUp() */
+
+
+
+/*@================================
+ * edubfm_MapInsert()
+ *================================*/
+/*
+ * Function: void edubfm_MapInsert(BfMKeyMap *, BfMHashKey *, Four)
+ *
+ * Description:
+ *  Associate the key with the node. The node must not be in the map.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_MapInsert(
+    BfMKeyMap           *map,           /* INOUT key map */
+    BfMHashKey          *key,           /* IN key */
+    Four                node)           /* IN node index */
+{
+    Four                hashValue;
+
+    hashValue = MAP_HASH(map, key);
+    map->key[node] = *key;
+    map->next[node] = map->bucket[hashValue];
+    map->bucket[hashValue] = node;
+
+} /* edubfm_MapInsert() */
+
+
+
+/*@================================
+ * edubfm_MapDelete()
+ *================================*/
+/*
+ * Function: void edubfm_MapDelete(BfMKeyMap *, Four)
+ *
+ * Description:
+ *  Remove the node from the map.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_MapDelete(
+    BfMKeyMap           *map,           /* INOUT key map */
+    Four                node)           /* IN node index */
+{
+    Four                *p;
+
+    for (p = &map->bucket[MAP_HASH(map, &map->key[node])]; *p != NIL; p = &map->next[*p])
+        if (*p == node) {
+            *p = map->next[node];
+            break;
+        }
+
+    map->next[node] = NIL;
+    SET_NILBFMHASHKEY(map->key[node]);
+
+} /* edubfm_MapDelete() */
+
+
+
+/*@================================
+ * edubfm_GhostInit()
+ *================================*/
+/*
+ * Function: Four edubfm_GhostInit(BfMGhostDir *, Four, Four)
+ *
+ * Description:
+ *  Build an empty ghost directory which can hold 'nNodes' keys with
+ *  'auxLen' words of auxiliary data each.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_GhostInit(
+    BfMGhostDir         *g,             /* OUT ghost directory */
+    Four                nNodes,         /* IN capacity */
+    Four                auxLen)         /* IN # of Eight words per node */
+{
+    Four                e;              /* error code */
+    Four                i;
+
+    if (nNodes < 1) nNodes = 1;
+
+    g->nNodes = nNodes;
+    g->auxLen = auxLen;
+    g->listNo = NULL;
+    g->aux = NULL;
+
+    e = edubfm_MapInit(&g->map, nNodes);
+    if (e < eNOERROR) ERR(e);
+
+    e = edubfm_LinksInit(&g->links, nNodes);
+    if (e < eNOERROR) {
+        edubfm_MapFinal(&g->map);
+        ERR(e);
+    }
+
+    g->listNo = (One *)malloc(sizeof(One) * nNodes);
+    if (auxLen > 0) g->aux = (Eight *)malloc(sizeof(Eight) * nNodes * auxLen);
+    if (g->listNo == NULL || (auxLen > 0 && g->aux == NULL)) {
+        edubfm_GhostFinal(g);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    for (i = 0; i < BFM_MAX_GHOSTLISTS; i++)
+        edubfm_ListInit(&g->list[i]);
+
+    /* chain all nodes into the free node chain */
+    for (i = 0; i < nNodes; i++) {
+        g->listNo[i] = NIL;
+        g->links.next[i] = (i + 1 < nNodes) ? i + 1 : NIL;
+    }
+    g->freeNode = 0;
+
+    return(eNOERROR);
+
+} /* edubfm_GhostInit() */
+
+
+
+/*@================================
+ * edubfm_GhostFinal()
+ *================================*/
+/*
+ * Function: void edubfm_GhostFinal(BfMGhostDir *)
+ *
+ * Description:
+ *  Free the ghost directory.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_GhostFinal(
+    BfMGhostDir         *g)             /* INOUT ghost directory */
+{
+    edubfm_MapFinal(&g->map);
+    edubfm_LinksFinal(&g->links);
+    free(g->listNo);
+    free(g->aux);
+    g->listNo = NULL;
+    g->aux = NULL;
+
+} /* edubfm_GhostFinal() */
+
+
+
+/*@================================
+ * edubfm_GhostLookUp()
+ *================================*/
+/*
+ * Function: Four edubfm_GhostLookUp(BfMGhostDir *, BfMHashKey *)
+ *
+ * Description:
+ *  Look up the node remembering the given key.
+ *  The list of the node is given by g->listNo[node].
+ *
+ * Returns:
+ *  1) node index
+ *  2) NIL if the key is not remembered
+ */
+Four edubfm_GhostLookUp(
+    BfMGhostDir         *g,             /* IN ghost directory */
+    BfMHashKey          *key)           /* IN key to look up */
+{
+    return(edubfm_MapLookUp(&g->map, key));
+
+} /* edubfm_GhostLookUp() */
+
+
+
+/*@================================
+ * edubfm_GhostInsert()
+ *================================*/
+/*
+ * Function: Four edubfm_GhostInsert(BfMGhostDir *, Four, BfMHashKey *)
+ *
+ * Description:
+ *  Remember the key at the head of the given list.
+ *  If the directory is full, the least recent key of the longest list
+ *  is forgotten first.
+ *
+ * Returns:
+ *  node index of the key
+ */
+Four edubfm_GhostInsert(
+    BfMGhostDir         *g,             /* INOUT ghost directory */
+    Four                listNo,         /* IN list to insert into */
+    BfMHashKey          *key)           /* IN key to remember */
+{
+    Four                node;
+    Four                i, longest;
+
+    node = edubfm_MapLookUp(&g->map, key);
+    if (node != NIL) edubfm_GhostDelete(g, node);
+
+    if (g->freeNode == NIL) {
+        for (longest = 0, i = 1; i < BFM_MAX_GHOSTLISTS; i++)
+            if (g->list[i].len > g->list[longest].len) longest = i;
+        edubfm_GhostDelete(g, g->list[longest].tail);
+    }
+
+    node = g->freeNode;
+    g->freeNode = g->links.next[node];
+
+    edubfm_MapInsert(&g->map, key, node);
+    edubfm_ListInsertHead(&g->links, &g->list[listNo], node);
+    g->listNo[node] = listNo;
+
+    return(node);
+
+} /* edubfm_GhostInsert() */
+
+
+
+/*@================================
+ * edubfm_GhostDelete()
+ *================================*/
+/*
+ * Function: void edubfm_GhostDelete(BfMGhostDir *, Four)
+ *
+ * Description:
+ *  Forget the key of the node.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_GhostDelete(
+    BfMGhostDir         *g,             /* INOUT ghost directory */
+    Four                node)           /* IN node to be deleted */
+{
+    edubfm_MapDelete(&g->map, node);
+    edubfm_ListRemove(&g->links, &g->list[(UOne)g->listNo[node]], node);
+    g->listNo[node] = NIL;
+
+    g->links.next[node] = g->freeNode;
+    g->freeNode = node;
+
+} /* edubfm_GhostDelete() */
+
+
+
+/*@================================
+ * edubfm_GhostTrim()
+ *================================*/
+/*
+ * Function: void edubfm_GhostTrim(BfMGhostDir *, Four, Four)
+ *
+ * Description:
+ *  Forget the least recent keys of the list until it has at most
+ *  'maxLen' keys.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_GhostTrim(
+    BfMGhostDir         *g,             /* INOUT ghost directory */
+    Four                listNo,         /* IN list to be trimmed */
+    Four                maxLen)         /* IN maximum length of the list */
+{
+    while (g->list[listNo].len > maxLen && g->list[listNo].len > 0)
+        edubfm_GhostDelete(g, g->list[listNo].tail);
+
+} /* edubfm_GhostTrim() */
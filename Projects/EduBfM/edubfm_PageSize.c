@@ -0,0 +1,203 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_PageSize.c
+ *
+ * Description:
+ *  Page sizes of the volumes (see EduBfM_SetPageSize()). The storage
+ *  system pages a volume by PAGESIZE, which the slotted pages and the
+ *  B+-tree nodes are laid out for; a volume with a larger page size is
+ *  paged by trains of pageSize / PAGESIZE consecutive such pages, and a
+ *  page of it is read and written as one train. A train of a
+ *  buffer pool on such a volume is as many times larger, e.g. a large
+ *  object leaf of LOT_LEAF_BUF. The volumes of PAGESIZE are not listed,
+ *  so that a lookup costs nothing until a page size is set.
+ *  A page of such a volume is identified by the first of its pages of
+ *  PAGESIZE, whose page number is a multiple of pageSize / PAGESIZE; the
+ *  callers allocate the pages so (see EduBfM_SetPageSize()), and a train
+ *  not aligned so is never read into the buffer pools.
+ *  The table is changed and read with the latches of the buffer pools
+ *  held: EduBfM_SetPageSize() holds them all.
+ *
+ * Exports:
+ *  Four edubfm_SetPageSize(VolNo, Four)
+ *  Four edubfm_TrainPages(Four, VolNo)
+ *  Four edubfm_CheckTrain(Four, TrainID *)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* # of volumes whose page size may be set */
+#define PAGESIZE_MAX_VOLUMES    BFM_MAX_ATTACHED_VOLUMES
+
+/* volumes of pages larger than PAGESIZE */
+static struct {
+    VolNo       volNo;          /* volume number (NIL if the entry is free) */
+    Four        nPages;         /* pages of PAGESIZE per page of the volume */
+} pageSizes[PAGESIZE_MAX_VOLUMES] = {
+    { NIL, 0 }, { NIL, 0 }, { NIL, 0 }, { NIL, 0 },
+    { NIL, 0 }, { NIL, 0 }, { NIL, 0 }, { NIL, 0 },
+    { NIL, 0 }, { NIL, 0 }, { NIL, 0 }, { NIL, 0 },
+    { NIL, 0 }, { NIL, 0 }, { NIL, 0 }, { NIL, 0 }
+};
+static Four nPageSizes = 0;     /* # of entries in use */
+
+
+
+/*@================================
+ * edubfm_SetPageSize()
+ *================================*/
+/*
+ * Function: Four edubfm_SetPageSize(VolNo, Four)
+ *
+ * Description:
+ *  Make a page of the volume 'nPages' pages of PAGESIZE large.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_EDUBFM - too many volumes of larger pages
+ */
+Four edubfm_SetPageSize(
+    VolNo               volNo,          /* IN volume number */
+    Four                nPages)         /* IN pages of PAGESIZE per page */
+{
+    Four                i;
+    Four                slot = NIL;     /* free entry */
+
+
+    for (i = 0; i < PAGESIZE_MAX_VOLUMES; i++) {
+        if (pageSizes[i].volNo == volNo) {
+            if (nPages > 1) pageSizes[i].nPages = nPages;
+            else {
+                pageSizes[i].volNo = NIL;
+                nPageSizes--;
+            }
+            return(eNOERROR);
+        }
+        if (pageSizes[i].volNo == NIL && slot == NIL) slot = i;
+    }
+
+    if (nPages <= 1) return(eNOERROR);
+    if (slot == NIL) ERR(eBADPARAMETER_EDUBFM);
+
+    pageSizes[slot].volNo = volNo;
+    pageSizes[slot].nPages = nPages;
+    nPageSizes++;
+
+    return(eNOERROR);
+
+} /* edubfm_SetPageSize() */
+
+
+
+/*@================================
+ * edubfm_TrainPages()
+ *================================*/
+/*
+ * Function: Four edubfm_TrainPages(Four, VolNo)
+ *
+ * Description:
+ *  Return the size of a train of the volume in the buffer pool, which
+ *  is read and written at once. It is not larger than the frames of the
+ *  pool if the train may be in the pool (see EduBfM_GetTrain()).
+ *
+ * Returns:
+ *  size of the train in pages of PAGESIZE
+ */
+Four edubfm_TrainPages(
+    Four                type,           /* IN buffer type */
+    VolNo               volNo)          /* IN volume number */
+{
+    Four                i;
+
+
+    if (nPageSizes > 0)
+        for (i = 0; i < PAGESIZE_MAX_VOLUMES; i++)
+            if (pageSizes[i].volNo == volNo) return(BE_BASEBUFSIZE(type) * pageSizes[i].nPages);
+
+    return(BE_BASEBUFSIZE(type));
+
+} /* edubfm_TrainPages() */
+
+
+
+/*@================================
+ * edubfm_CheckTrain()
+ *================================*/
+/*
+ * Function: Four edubfm_CheckTrain(Four, TrainID *)
+ *
+ * Description:
+ *  Check that the train may be read into the buffer pool: the pages of
+ *  its volume are not larger than the frames of the pool, and the train
+ *  is the first page of PAGESIZE of a page of the volume.
+ *
+ * Returns:
+ *  error code
+ *    eBADPAGESIZE_EDUBFM - the pages of the volume are larger than the
+ *                          frames, or the train is not aligned to them
+ */
+Four edubfm_CheckTrain(
+    Four                type,           /* IN buffer type */
+    TrainID             *trainId)       /* IN train to be read */
+{
+    Four                nPages;         /* size of a train of the volume in pages */
+
+
+    nPages = edubfm_TrainPages(type, trainId->volNo);
+    if (nPages > BI_BUFSIZE(type)) return(eBADPAGESIZE_EDUBFM);
+    if (nPages > BE_BASEBUFSIZE(type) && trainId->pageNo % (nPages / BE_BASEBUFSIZE(type)) != 0)
+        return(eBADPAGESIZE_EDUBFM);
+
+    return(eNOERROR);
+
+} /* edubfm_CheckTrain() */
@@ -0,0 +1,737 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_PageTable.c
+ *
+ * Description:
+ *  The page table maps a BfMHashKey to the index of the buffer holding the
+ *  train. It is an open addressing hash table whose buckets fill a cache
+ *  line each and hold the keys inline (see BfMPageTableBucket).
+ *  A key is placed in the first bucket having an empty slot, starting from
+ *  its home bucket chosen by a 64-bit multiplicative hash of (volNo,
+ *  pageNo), which costs one multiplication and no call.
+ *  Each bucket counts the keys that passed over it while it was full, so a
+ *  lookup stops at the first bucket with no overflow and no tombstones are
+ *  needed. The tags of a bucket are compared at once as one 64-bit word,
+ *  which needs no SIMD instructions and stays cheap in an unoptimized
+ *  build.
+ *  The table has room for twice as many keys as requested, so almost all
+ *  keys are found in their home bucket.
+ *
+ *  The table is split into up to BFM_PT_PARTITIONS independent partitions
+ *  chosen by other bits of the hash value, each with its own latch, so
+ *  that threads looking up different keys seldom share a latch. A
+ *  partition which gets more than half full is doubled. The functions do
+ *  not latch; the caller holds the latch of the partition of the key
+ *  (edubfm_PageTableLatch()) if other threads use the table.
+ *  edubfm_PageTableProbe() looks a key up without the latch for the
+ *  optimistic reads (see EduBfM_OptimisticRead()), which validate what it
+ *  finds. So that such a probe never reads freed memory, the bucket array
+ *  a partition outgrows is kept until the table is freed or cleared; the
+ *  arrays kept sum to less than the current ones.
+ *
+ * Exports:
+ *  Four edubfm_PageTableInit(BfMPageTable *, Four)
+ *  void edubfm_PageTableFinal(BfMPageTable *)
+ *  void edubfm_PageTableClear(BfMPageTable *)
+ *  Four edubfm_PageTableTake(BfMPageTable *, Four *)
+ *  Four edubfm_PageTableLookUp(BfMPageTable *, BfMHashKey *)
+ *  Four edubfm_PageTableInsert(BfMPageTable *, BfMHashKey *, Four)
+ *  Four edubfm_PageTableDelete(BfMPageTable *, BfMHashKey *)
+ *  pthread_mutex_t *edubfm_PageTableLatch(BfMPageTable *, BfMHashKey *)
+ *  Four edubfm_PageTableProbe(BfMPageTable *, BfMHashKey *)
+ */
+
+
+#include <stdlib.h> /* for posix_memalign & free */
+#include <string.h> /* for memset */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@
+ * macro definitions
+ */
+
+/* a byte set to 1 in each slot of a word of tags */
+#define PT_ONES                 0x0101010101010101ULL
+
+/* bit mask of the slots in the result of PT_MATCHSLOTS(): bit 8*s+7 for slot s */
+#define PT_SLOTMASK             ((((UEight)1 << (8 * BFM_PT_SLOTS)) - 1) & (PT_ONES << 7))
+
+/* saturated value of the overflow count; it is never decremented again */
+#define PT_MAX_OVERFLOW         0xffff
+
+/* minimum # of keys per partition; smaller tables have fewer partitions */
+#define PT_MIN_PART_KEYS        64
+
+/* multiplier of the hash: 2^64 divided by the golden ratio, an odd number */
+#define PT_GOLDEN               0x9e3779b97f4a7c15ULL
+
+/* Macro: PT_FOLD(p)
+ * Description: fold the high half of a product into its low half, whose
+ *              bits only depend on the low bits of the key otherwise
+ * Parameter:
+ *  UEight p        : product of the key and PT_GOLDEN
+ * Returns: (UEight) hash value
+ */
+#define PT_FOLD(p)              ((p) ^ ((p) >> 32))
+
+/* Macro: PT_HASH(k)
+ * Description: return the 64-bit hash value of the key, a multiplicative
+ *              hash of (volNo, pageNo). The tag and the partition are
+ *              taken from the high bits, where every bit of the key is
+ *              mixed, and the bucket from the folded low bits.
+ * Parameter:
+ *  BfMHashKey *k   : pointer to the key
+ * Returns: (UEight) hash value
+ */
+#define PT_HASH(k)              PT_FOLD((((UEight)(UTwo)(k)->volNo << 32) | (UFour)(k)->pageNo) * PT_GOLDEN)
+
+/* Macro: PT_TAG(h)
+ * Description: return the tag of a hash value; the top bit is always set
+ *              so that a tag is never equal to the tag of an empty slot
+ * Parameter:
+ *  UEight h        : hash value
+ * Returns: (UOne) tag
+ */
+#define PT_TAG(h)               ((UOne)(((h) >> 56) | 0x80))
+
+/* Macro: PT_PART(pt, h)
+ * Description: return the partition of a hash value
+ * Parameters:
+ *  BfMPageTable *pt : page table
+ *  UEight h        : hash value
+ * Returns: (BfMPageTablePart *) partition
+ */
+#define PT_PART(pt, h)          (&(pt)->part[(Four)((h) >> 40) & (pt)->partMask])
+
+/* Macro: PT_MATCHSLOTS(w)
+ * Description: return the slots of a word of tags which are zero, so that
+ *              the tags of all slots of a bucket are compared with a tag at
+ *              once by the word of the bucket's tags XORed with the tag in
+ *              every byte. The slot above a matching one may be reported
+ *              too, so the caller still compares the keys, but the lowest
+ *              slot reported always matches. (The tags are in slot order on
+ *              the little-endian hosts the storage system runs on.)
+ * Parameter:
+ *  UEight w        : word of tags
+ * Returns: (UEight) bit 8*s+7 set for each slot s reported
+ */
+#define PT_MATCHSLOTS(w)        (((w) - PT_ONES) & ~(w) & PT_SLOTMASK)
+
+
+
+/* type definition for the tags of a bucket read as one word */
+typedef UEight __attribute__((__may_alias__)) PtTags;
+
+/* type definition for a bucket array a partition has outgrown */
+typedef struct PtRetired {
+    BfMPageTableBucket  *bucket;
+    struct PtRetired    *next;
+} PtRetired;
+
+
+
+/*@================================
+ * pt_FreeRetired()
+ *================================*/
+/*
+ * Function: static void pt_FreeRetired(BfMPageTablePart *)
+ *
+ * Description:
+ *  Free the bucket arrays the partition has outgrown. It is called only
+ *  when the page table is freed, since a probe without the latch may read
+ *  any of them until then.
+ *
+ * Returns:
+ *  None
+ */
+static void pt_FreeRetired(
+    BfMPageTablePart    *part)          /* INOUT partition */
+{
+    PtRetired           *r;
+
+
+    while ((r = (PtRetired *)part->retired) != NULL) {
+        part->retired = r->next;
+        free(r->bucket);
+        free(r);
+    }
+
+} /* pt_FreeRetired() */
+
+
+
+/*@================================
+ * pt_Find()
+ *================================*/
+/*
+ * Function: static Four pt_Find(BfMPageTablePart *, BfMHashKey *, UEight, Four *)
+ *
+ * Description:
+ *  Find the bucket and the slot holding the key in its partition.
+ *
+ * Returns:
+ *  bucket number (NIL if the key is not in the partition)
+ */
+static Four pt_Find(
+    BfMPageTablePart    *part,          /* IN partition of the key */
+    BfMHashKey          *key,           /* IN key to be found */
+    UEight              h,              /* IN hash value of the key */
+    Four                *slot)          /* OUT slot holding the key */
+{
+    BfMPageTableBucket  *bucket;
+    BfMPageTableBucket  *buckets;
+    UEight              tags = PT_ONES * PT_TAG(h); /* the tag in every slot */
+    UEight              w, match;
+    Four                mask;
+    Four                b, s;
+    Four                nProbes;
+
+
+    /* the mask is published after the larger bucket array (see pt_Grow()) */
+    mask = BFM_ATOMIC_LOAD(part->mask);
+    buckets = BFM_ATOMIC_LOAD(part->bucket);
+
+    b = (Four)h & mask;
+    for (nProbes = 0; nProbes <= mask; nProbes++) {
+
+        bucket = &buckets[b];
+        w = *(PtTags *)bucket->tag ^ tags;
+        for (match = PT_MATCHSLOTS(w); match != 0; match &= match - 1) {
+            s = __builtin_ctzll(match) >> 3;
+            if (bucket->pageNo[s] == key->pageNo && bucket->volNo[s] == key->volNo) {
+                *slot = s;
+                return(b);
+            }
+        }
+
+        if (bucket->overflow == 0) break;
+        b = (b + 1) & mask;
+    }
+
+    return(NIL);
+
+} /* pt_Find() */
+
+
+
+/*@================================
+ * pt_Place()
+ *================================*/
+/*
+ * Function: static void pt_Place(BfMPageTablePart *, BfMHashKey *, UEight, Four)
+ *
+ * Description:
+ *  Put the key in the first bucket having an empty slot, starting from
+ *  its home bucket. The partition has an empty slot.
+ *
+ * Returns:
+ *  None
+ */
+static void pt_Place(
+    BfMPageTablePart    *part,          /* INOUT partition of the key */
+    BfMHashKey          *key,           /* IN key to be inserted */
+    UEight              h,              /* IN hash value of the key */
+    Four                index)          /* IN buffer index of the key */
+{
+    BfMPageTableBucket  *bucket;
+    UEight              empty;
+    Four                b, s;
+
+
+    for (b = (Four)h & part->mask; ; b = (b + 1) & part->mask) {
+
+        bucket = &part->bucket[b];
+        empty = PT_MATCHSLOTS(*(PtTags *)bucket->tag);
+        if (empty != 0) break;
+
+        if (bucket->overflow < PT_MAX_OVERFLOW) bucket->overflow++;
+    }
+
+    for (s = 0; !(empty & ((UEight)0x80 << (8 * s))); s++);
+
+    bucket->tag[s] = PT_TAG(h);
+    bucket->pageNo[s] = key->pageNo;
+    bucket->volNo[s] = key->volNo;
+    bucket->index[s] = index;
+    part->nKeys++;
+
+} /* pt_Place() */
+
+
+
+/*@================================
+ * pt_Alloc()
+ *================================*/
+/*
+ * Function: static Four pt_Alloc(BfMPageTablePart *, Four)
+ *
+ * Description:
+ *  Give the partition an empty array of nBuckets buckets.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+static Four pt_Alloc(
+    BfMPageTablePart    *part,          /* OUT partition */
+    Four                nBuckets)       /* IN # of buckets, a power of 2 */
+{
+    void                *mem;
+
+
+    if (posix_memalign(&mem, 64, sizeof(BfMPageTableBucket) * nBuckets) != 0) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    memset(mem, 0, sizeof(BfMPageTableBucket) * nBuckets);
+    part->bucket = (BfMPageTableBucket *)mem;
+    part->mask = nBuckets - 1;
+    part->nKeys = 0;
+
+    return(eNOERROR);
+
+} /* pt_Alloc() */
+
+
+
+/*@================================
+ * pt_Grow()
+ *================================*/
+/*
+ * Function: static Four pt_Grow(BfMPageTablePart *)
+ *
+ * Description:
+ *  Double the # of buckets of the partition and put its keys again.
+ *  The keys are put into the new bucket array before it replaces the old
+ *  one, which is kept for the probes without the latch.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+static Four pt_Grow(
+    BfMPageTablePart    *part)          /* INOUT partition */
+{
+    Four                e;              /* error code */
+    BfMPageTablePart    grown;          /* new bucket array being filled */
+    BfMPageTableBucket  *bucket;
+    PtRetired           *retired;
+    BfMHashKey          key;
+    Four                b, s;
+
+
+    retired = (PtRetired *)malloc(sizeof(PtRetired));
+    if (retired == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+    e = pt_Alloc(&grown, (part->mask + 1) * 2);
+    if (e < eNOERROR) {
+        free(retired);
+        ERR(e);
+    }
+
+    for (b = 0; b <= part->mask; b++) {
+        bucket = &part->bucket[b];
+        for (s = 0; s < BFM_PT_SLOTS; s++)
+            if (bucket->tag[s] != 0) {
+                key.volNo = bucket->volNo[s];
+                key.pageNo = bucket->pageNo[s];
+                pt_Place(&grown, &key, PT_HASH(&key), bucket->index[s]);
+            }
+    }
+
+    /* a probe without the latch may still read the old array */
+    retired->bucket = part->bucket;
+    retired->next = part->retired;
+    part->retired = retired;
+
+    BFM_ATOMIC_STORE(part->bucket, grown.bucket);
+    BFM_ATOMIC_STORE(part->mask, grown.mask);
+    part->nKeys = grown.nKeys;
+
+    return(eNOERROR);
+
+} /* pt_Grow() */
+
+
+
+/*@================================
+ * edubfm_PageTableInit()
+ *================================*/
+/*
+ * Function: Four edubfm_PageTableInit(BfMPageTable *, Four)
+ *
+ * Description:
+ *  Build an empty page table for up to nKeys keys.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_PageTableInit(
+    BfMPageTable        *pt,            /* OUT page table */
+    Four                nKeys)          /* IN maximum # of keys */
+{
+    Four                e;              /* error code */
+    Four                nParts, nBuckets, p;
+
+
+    for (nParts = 1; nParts < BFM_PT_PARTITIONS && nParts * 2 * PT_MIN_PART_KEYS <= nKeys; nParts <<= 1);
+
+    /* half of the slots are kept empty */
+    for (nBuckets = 1; nBuckets * BFM_PT_SLOTS * nParts < 2 * nKeys; nBuckets <<= 1);
+
+    pt->partMask = nParts - 1;
+    for (p = 0; p < nParts; p++) {
+        e = pt_Alloc(&pt->part[p], nBuckets);
+        if (e < eNOERROR) {
+            while (--p >= 0) free(pt->part[p].bucket);
+            pt->part[0].bucket = NULL;
+            ERR(e);
+        }
+        pthread_mutex_init(&pt->part[p].latch, NULL);
+        pt->part[p].retired = NULL;
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_PageTableInit() */
+
+
+
+/*@================================
+ * edubfm_PageTableFinal()
+ *================================*/
+/*
+ * Function: void edubfm_PageTableFinal(BfMPageTable *)
+ *
+ * Description:
+ *  Free the page table.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_PageTableFinal(
+    BfMPageTable        *pt)            /* INOUT page table */
+{
+    Four                p;
+
+
+    if (pt->part[0].bucket == NULL) return;
+
+    for (p = 0; p <= pt->partMask; p++) {
+        pthread_mutex_destroy(&pt->part[p].latch);
+        pt_FreeRetired(&pt->part[p]);
+        free(pt->part[p].bucket);
+        pt->part[p].bucket = NULL;
+    }
+
+} /* edubfm_PageTableFinal() */
+
+
+
+/*@================================
+ * edubfm_PageTableClear()
+ *================================*/
+/*
+ * Function: void edubfm_PageTableClear(BfMPageTable *)
+ *
+ * Description:
+ *  Delete all keys from the page table. A probe without the latch, e.g.
+ *  of EduBfM_OptimisticRead(), may run meanwhile; it checks the key of the
+ *  buffer it finds, and the bucket arrays the partitions have outgrown are
+ *  kept until edubfm_PageTableFinal() as it may still read them.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_PageTableClear(
+    BfMPageTable        *pt)            /* INOUT page table */
+{
+    Four                p;
+
+
+    for (p = 0; p <= pt->partMask; p++) {
+        memset(pt->part[p].bucket, 0, sizeof(BfMPageTableBucket) * (pt->part[p].mask + 1));
+        pt->part[p].nKeys = 0;
+    }
+
+} /* edubfm_PageTableClear() */
+
+
+
+/*@================================
+ * edubfm_PageTableTake()
+ *================================*/
+/*
+ * Function: Four edubfm_PageTableTake(BfMPageTable *, Four *)
+ *
+ * Description:
+ *  Delete all keys from the page table as edubfm_PageTableClear() does,
+ *  giving the buffer indexes of the keys in 'indexes', which has room
+ *  for as many indexes as there are keys. Only the occupied slots are
+ *  read: a bucket whose word of tags is zero is passed over at once, and
+ *  an empty partition is not visited at all. Each partition is latched
+ *  while it is emptied.
+ *
+ * Returns:
+ *  # of indexes given
+ */
+Four edubfm_PageTableTake(
+    BfMPageTable        *pt,            /* INOUT page table */
+    Four                *indexes)       /* OUT buffer indexes of the keys */
+{
+    BfMPageTablePart    *part;
+    BfMPageTableBucket  *bucket;
+    UEight              w;
+    Four                n = 0;
+    Four                p, b, s;
+
+
+    for (p = 0; p <= pt->partMask; p++) {
+        part = &pt->part[p];
+        if (part->nKeys == 0) continue;
+
+        pthread_mutex_lock(&part->latch);
+        for (b = 0; b <= part->mask; b++) {
+            bucket = &part->bucket[b];
+            for (w = *(PtTags *)bucket->tag, s = 0; w != 0; w >>= 8, s++)
+                if (w & 0xff) indexes[n++] = bucket->index[s];
+        }
+        memset(part->bucket, 0, sizeof(BfMPageTableBucket) * (part->mask + 1));
+        part->nKeys = 0;
+        pthread_mutex_unlock(&part->latch);
+    }
+
+    return(n);
+
+} /* edubfm_PageTableTake() */
+
+
+
+/*@================================
+ * edubfm_PageTableLookUp()
+ *================================*/
+/*
+ * Function: Four edubfm_PageTableLookUp(BfMPageTable *, BfMHashKey *)
+ *
+ * Description:
+ *  Look up the key in the page table. The home bucket of the key is
+ *  looked at in line, since it holds almost every key and tells almost
+ *  every miss; pt_Find() probes on only if it is not enough.
+ *
+ * Returns:
+ *  buffer index of the key
+ *  (NOTFOUND_IN_HTABLE - The key doesn't exist in the page table.)
+ */
+Four edubfm_PageTableLookUp(
+    BfMPageTable        *pt,            /* IN page table */
+    BfMHashKey          *key)           /* IN key to be found */
+{
+    UEight              h = PT_HASH(key);
+    BfMPageTablePart    *part = PT_PART(pt, h);
+    BfMPageTableBucket  *bucket = &part->bucket[(Four)h & part->mask];
+    UEight              match;
+    Four                b, s;
+
+
+    /* the first slot of the home bucket matching the tag */
+    match = PT_MATCHSLOTS(*(PtTags *)bucket->tag ^ (PT_ONES * PT_TAG(h)));
+    if (match != 0) {
+        s = __builtin_ctzll(match) >> 3;
+        if (bucket->pageNo[s] == key->pageNo && bucket->volNo[s] == key->volNo) return(bucket->index[s]);
+    }
+    else if (bucket->overflow == 0)
+        return(NOTFOUND_IN_HTABLE);
+
+    b = pt_Find(part, key, h, &s);
+    if (b == NIL) return(NOTFOUND_IN_HTABLE);
+
+    return(part->bucket[b].index[s]);
+
+} /* edubfm_PageTableLookUp() */
+
+
+
+/*@================================
+ * edubfm_PageTableInsert()
+ *================================*/
+/*
+ * Function: Four edubfm_PageTableInsert(BfMPageTable *, BfMHashKey *, Four)
+ *
+ * Description:
+ *  Insert the key with its buffer index into the page table.
+ *  The key must not be in the table.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - the partition cannot grow
+ */
+Four edubfm_PageTableInsert(
+    BfMPageTable        *pt,            /* INOUT page table */
+    BfMHashKey          *key,           /* IN key to be inserted */
+    Four                index)          /* IN buffer index of the key */
+{
+    Four                e;              /* error code */
+    UEight              h = PT_HASH(key);
+    BfMPageTablePart    *part = PT_PART(pt, h);
+
+
+    if (part->nKeys * 2 >= (part->mask + 1) * BFM_PT_SLOTS) {
+        e = pt_Grow(part);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    pt_Place(part, key, h, index);
+
+    return(eNOERROR);
+
+} /* edubfm_PageTableInsert() */
+
+
+
+/*@================================
+ * edubfm_PageTableDelete()
+ *================================*/
+/*
+ * Function: Four edubfm_PageTableDelete(BfMPageTable *, BfMHashKey *)
+ *
+ * Description:
+ *  Delete the key from the page table and decrease the overflow counts
+ *  of the buckets between its home bucket and its bucket.
+ *
+ * Returns:
+ *  error code
+ *    eNOTFOUND_BFM - The key isn't in the page table.
+ */
+Four edubfm_PageTableDelete(
+    BfMPageTable        *pt,            /* INOUT page table */
+    BfMHashKey          *key)           /* IN key to be deleted */
+{
+    UEight              h = PT_HASH(key);
+    BfMPageTablePart    *part = PT_PART(pt, h);
+    Four                found, b, s;
+
+
+    found = pt_Find(part, key, h, &s);
+    if (found == NIL) return(eNOTFOUND_BFM);
+
+    part->bucket[found].tag[s] = 0;
+    part->nKeys--;
+
+    for (b = (Four)h & part->mask; b != found; b = (b + 1) & part->mask)
+        if (part->bucket[b].overflow < PT_MAX_OVERFLOW) part->bucket[b].overflow--;
+
+    return(eNOERROR);
+
+} /* edubfm_PageTableDelete() */
+
+
+
+/*@================================
+ * edubfm_PageTableLatch()
+ *================================*/
+/*
+ * Function: pthread_mutex_t *edubfm_PageTableLatch(BfMPageTable *, BfMHashKey *)
+ *
+ * Description:
+ *  Return the latch of the partition of the key.
+ *
+ * Returns:
+ *  partition latch
+ */
+pthread_mutex_t *edubfm_PageTableLatch(
+    BfMPageTable        *pt,            /* IN page table */
+    BfMHashKey          *key)           /* IN key */
+{
+    UEight              h = PT_HASH(key);
+
+
+    return(&PT_PART(pt, h)->latch);
+
+} /* edubfm_PageTableLatch() */
+
+
+
+/*@================================
+ * edubfm_PageTableProbe()
+ *================================*/
+/*
+ * Function: Four edubfm_PageTableProbe(BfMPageTable *, BfMHashKey *)
+ *
+ * Description:
+ *  Look up the key in the page table without the latch of its partition.
+ *  The lookup may race with an update of the partition, so it may miss a
+ *  key which is there or return an index which is not the key's any more;
+ *  the caller checks the key of the buffer.
+ *
+ * Returns:
+ *  buffer index of the key, possibly stale
+ *  (NOTFOUND_IN_HTABLE - The key was not found.)
+ */
+Four edubfm_PageTableProbe(
+    BfMPageTable        *pt,            /* IN page table */
+    BfMHashKey          *key)           /* IN key to be found */
+{
+    UEight              h = PT_HASH(key);
+    BfMPageTablePart    *part = PT_PART(pt, h);
+    BfMPageTableBucket  *buckets;
+    Four                b, s;
+
+
+    b = pt_Find(part, key, h, &s);
+    if (b == NIL) return(NOTFOUND_IN_HTABLE);
+
+    /* if the partition has grown since, the larger array gives a stale index */
+    buckets = BFM_ATOMIC_LOAD(part->bucket);
+
+    return(BFM_ATOMIC_LOAD(buckets[b].index[s]));
+
+} /* edubfm_PageTableProbe() */
@@ -0,0 +1,1247 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Pool.c
+ *
+ * Description:
+ *  Build and release the EduBfM-private information of the buffer pools.
+ *  The buffer table, the buffer pool, and the hash table (bufInfo[]) are
+ *  set up by the storage system when it is initialized. EduBfM keeps its
+ *  own information, e.g. the buffer replacement policy, in bufExt[] and
+ *  builds it when a buffer pool is used for the first time.
+ *  The page table of a buffer pool is loaded from the hash table, which
+ *  holds the trains read by the storage system before EduBfM is used.
+ *  The buffers holding no train are kept on a free buffer list so that
+ *  they are allocated without running the buffer replacement.
+ *  A buffer pool may be resized while it is used (see EduBfM_ResizePool()).
+ *  The information EduBfM keeps for each buffer, and the elements of the
+ *  buffer table of the buffers beyond the buffer table of the storage
+ *  system, are allocated in chunks of BFM_CHUNK_BUFS buffers as the pool
+ *  grows, up to BfMConfig.maxBufs buffers; the chunks never move under
+ *  the threads pinning buffers. The frames of the buffers beyond the
+ *  buffer table are kept in BE_EXTFRAMES(type), which is reserved when
+ *  the pool first grows beyond it.
+ *  The dirty buffers are also kept on a bitmap, the dirty map, so that a
+ *  flush looks at the dirty buffers only rather than at the whole pool.
+ *  The buffers holding a clean train are kept on the clean list, from
+ *  which the replacement policies prefer to take their victims so that a
+ *  miss does not wait for the write-back of a dirty one. A train enters
+ *  the list when it is mapped to a buffer and when it is written, and
+ *  leaves it when it is dirtied and when it is evicted.
+ *
+ * Exports:
+ *  Four edubfm_InitPool(Four)
+ *  Four edubfm_ResetPool(Four)
+ *  Four edubfm_EmptyPool(Four)
+ *  void edubfm_FinalPool(Four)
+ *  Four edubfm_GrowPool(Four, Four)
+ *  Four edubfm_ShrinkPool(Four, Four)
+ *  void edubfm_PushFreeBuf(Four, Four)
+ *  Four edubfm_PopFreeBuf(Four)
+ *  void edubfm_CountDirty(Four)
+ *  Boolean edubfm_MarkDirty(Four, Four)
+ *  Boolean edubfm_MarkClean(Four, Four)
+ *  Four edubfm_NextDirty(Four, Four, Four)
+ *  void edubfm_CleanInsert(Four, Four)
+ *  void edubfm_CleanRemove(Four, Four)
+ *  Four edubfm_CleanVictim(Four)
+ *  void edubfm_Unpinned(Four)
+ *  Boolean edubfm_WaitUnpinned(Four, UFour, struct timespec *)
+ */
+
+
+#include <stdlib.h> /* for malloc, free & qsort */
+#include <string.h> /* for memset */
+#include <sys/mman.h> /* for munmap & madvise */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+extern BfMPolicy edubfm_clockPolicy;
+extern BfMPolicy edubfm_lruKPolicy;
+extern BfMPolicy edubfm_2QPolicy;
+extern BfMPolicy edubfm_arcPolicy;
+extern BfMPolicy edubfm_clockProPolicy;
+
+/* EduBfM-private information of the buffer pools */
+BufferExtInfo bufExt[NUM_BUF_TYPES];
+
+/* buffer replacement policies indexed by BFM_POLICY_xxx */
+BfMPolicy *edubfm_policies[NUM_BFM_POLICIES] = {
+    &edubfm_clockPolicy,
+    &edubfm_lruKPolicy,
+    &edubfm_2QPolicy,
+    &edubfm_arcPolicy,
+    &edubfm_clockProPolicy
+};
+
+
+
+/*@
+ * internal function prototypes
+ */
+static Four pool_AddChunks(Four, Four);
+static void pool_FinalChunks(Four);
+static void pool_FinalExt(Four);
+static Four pool_Rebuild(Four, Four);
+static int pool_CompareDown(const void *, const void *);
+static void pool_LoadCleanList(Four);
+
+
+
+/*@================================
+ * pool_LoadPageTable()
+ *================================*/
+/*
+ * Function: static Four pool_LoadPageTable(Four)
+ *
+ * Description:
+ *  Make the page table hold the trains in the hash table of the buffer pool.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four pool_LoadPageTable(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                h, i;
+
+
+    edubfm_PageTableClear(&BE_PAGETABLE(type));
+
+    for (h = 0; h < HASHTABLESIZE(type); h++) {
+        for (i = BI_HASHTABLEENTRY(type, h); i != NIL; i = BI_NEXTHASHENTRY(type, i)) {
+            e = edubfm_PageTableInsert(&BE_PAGETABLE(type), &BI_KEY(type, i), i);
+            if (e < eNOERROR) ERR(e);
+        }
+    }
+
+    return(eNOERROR);
+
+} /* pool_LoadPageTable() */
+
+
+
+/*@================================
+ * pool_LoadFreeBufs()
+ *================================*/
+/*
+ * Function: static void pool_LoadFreeBufs(Four)
+ *
+ * Description:
+ *  Make the free buffer list hold the unfixed buffers having no train.
+ *  They are pushed so that they are popped in the order the clock hand
+ *  would visit them.
+ *
+ * Returns:
+ *  None
+ */
+static void pool_LoadFreeBufs(
+    Four                type)           /* IN buffer type */
+{
+    Four                i, idx;
+
+
+    BE_NFREEBUFS(type) = 0;
+
+    for (i = BE_NBUFS(type) - 1; i >= 0; i--) {
+        idx = (BE_NEXTVICTIM(type) + i) % BE_NBUFS(type);
+        if (IS_NILBFMHASHKEY(BI_KEY(type, idx)) && BI_FIXED(type, idx) == 0)
+            BE_FREEBUFS(type)[BE_NFREEBUFS(type)++] = idx;
+    }
+
+} /* pool_LoadFreeBufs() */
+
+
+
+/*@================================
+ * pool_LoadCleanList()
+ *================================*/
+/*
+ * Function: static void pool_LoadCleanList(Four)
+ *
+ * Description:
+ *  Make the clean list hold the buffers having a train which is not
+ *  dirty. They are inserted so that they are taken in the order the
+ *  clock hand would visit them.
+ *
+ * Returns:
+ *  None
+ */
+static void pool_LoadCleanList(
+    Four                type)           /* IN buffer type */
+{
+    Four                i, idx;
+
+
+    for (idx = 0; idx < BE_NCHUNKS(type) * BFM_CHUNK_BUFS; idx++)
+        BE_CLEANLINKS(type).prev[idx] = BE_CLEANLINKS(type).next[idx] = NIL;
+    edubfm_ListInit(&BE_CLEANLIST(type));
+
+    for (i = 0; i < BE_NBUFS(type); i++) {
+        idx = (BE_NEXTVICTIM(type) + i) % BE_NBUFS(type);
+        if (!IS_NILBFMHASHKEY(BI_KEY(type, idx)) && !(BI_BITS(type, idx) & DIRTY))
+            edubfm_ListInsertHead(&BE_CLEANLINKS(type), &BE_CLEANLIST(type), idx);
+    }
+
+} /* pool_LoadCleanList() */
+
+
+
+/*@================================
+ * pool_CompareDown()
+ *================================*/
+/*
+ * Function: static int pool_CompareDown(const void *, const void *)
+ *
+ * Description:
+ *  Order buffer indexes from the highest down for qsort().
+ *
+ * Returns:
+ *  negative, 0, or positive
+ */
+static int pool_CompareDown(
+    const void          *a,             /* IN buffer index */
+    const void          *b)             /* IN buffer index */
+{
+    Four                x = *(const Four *)a;
+    Four                y = *(const Four *)b;
+
+
+    return((x > y) ? -1 : (x < y) ? 1 : 0);
+
+} /* pool_CompareDown() */
+
+
+
+/*@================================
+ * edubfm_InitPool()
+ *================================*/
+/*
+ * Function: Four edubfm_InitPool(Four)
+ *
+ * Description:
+ *  Build the EduBfM-private information of the buffer pool.
+ *  If the pool has not been configured by EduBfM_SetConfig(), the default
+ *  configuration is used, i.e. the second chance buffer replacement.
+ *
+ * Returns:
+ *  error code
+ *    eBADBUFFERTYPE_BFM - bad buffer type
+ *    some errors caused by function calls
+ */
+Four edubfm_InitPool(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+
+
+    if (IS_BAD_BUFFERTYPE(type)) ERR(eBADBUFFERTYPE_BFM);
+
+    if (IS_POOL_INITIALIZED(type)) return(eNOERROR);
+
+    BE_CFG(type).policy = BFM_POLICY_CLOCK;
+    BE_CFG(type).lruK = 2;
+    BE_CFG(type).dirtyLow = 0;
+    BE_CFG(type).dirtyHigh = 0;
+    BE_CFG(type).flushDepth = 0;
+    BE_CFG(type).hugePages = BFM_PAGES_DEFAULT;
+    BE_CFG(type).numaNodes = 0;
+    BE_CFG(type).directIO = FALSE;
+    BE_CFG(type).pageSize = PAGESIZE;
+    BE_CFG(type).shared = TRUE;
+    BE_CFG(type).maxBufs = (BI_NBUFS(type) > BFM_DEFAULT_MAX_BUFS) ? BI_NBUFS(type) : BFM_DEFAULT_MAX_BUFS;
+    BE_PAGES(type) = BFM_PAGES_DEFAULT;
+    BE_NUMANODES(type) = 0;
+
+    BE_NBUFS(type) = BI_NBUFS(type);
+    BE_NBASEBUFS(type) = BI_NBUFS(type);
+    BE_EXTFRAMES(type) = NULL;
+    BE_EXTSIZE(type) = 0;
+    BE_SYSFRAMES(type) = NULL;
+    BE_RETIREDFRAMES(type) = NULL;
+    BE_BASEBUFSIZE(type) = BI_BUFSIZE(type);
+    BE_NEXTVICTIM(type) = BI_NEXTVICTIM(type) % BE_NBUFS(type);
+
+    e = edubfm_PageTableInit(&BE_PAGETABLE(type), BE_NBUFS(type));
+    if (e < eNOERROR) ERR(e);
+
+    e = pool_LoadPageTable(type);
+    if (e < eNOERROR) {
+        edubfm_PageTableFinal(&BE_PAGETABLE(type));
+        ERR(e);
+    }
+
+    /* the directory is mapped as it is touched, a page for every 2M buffers */
+    BE_CHUNKS(type) = (BufferChunk **)calloc(BFM_MAX_CHUNKS, sizeof(BufferChunk *));
+    if (BE_CHUNKS(type) == NULL) {
+        edubfm_PageTableFinal(&BE_PAGETABLE(type));
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+    BE_NCHUNKS(type) = 0;
+    BE_FREEBUFS(type) = NULL;
+    BE_CLEANLINKS(type).prev = BE_CLEANLINKS(type).next = NULL;
+    pthread_mutex_init(&BE_CLEANLATCH(type), NULL);
+
+    e = pool_AddChunks(type, BE_NBUFS(type));
+    if (e < eNOERROR) {
+        pool_FinalChunks(type);
+        edubfm_PageTableFinal(&BE_PAGETABLE(type));
+        ERR(e);
+    }
+    pool_LoadFreeBufs(type);
+    edubfm_CountDirty(type);
+    pool_LoadCleanList(type);
+
+    BE_NPREFETCHES(type) = 0;
+    memset(bufExt[type].prefetches, 0, sizeof(bufExt[type].prefetches));
+
+    BE_WRITERON(type) = FALSE;
+    pthread_mutex_init(&BE_LATCH(type), NULL);
+    pthread_cond_init(&BE_WRITEDONE(type), NULL);
+    BE_NIOS(type) = 0;
+    pthread_mutex_init(&BE_UNPINLATCH(type), NULL);
+    pthread_cond_init(&BE_UNPINNED(type), NULL);
+    BE_NUNPINWAITS(type) = 0;
+    BE_NUNPINS(type) = 0;
+
+    BE_POLICYSTATE(type) = NULL;
+    e = edubfm_policies[BE_CFG(type).policy]->init(type);
+    if (e < eNOERROR) {
+        pthread_cond_destroy(&BE_UNPINNED(type));
+        pthread_mutex_destroy(&BE_UNPINLATCH(type));
+        pthread_cond_destroy(&BE_WRITEDONE(type));
+        pthread_mutex_destroy(&BE_LATCH(type));
+        pool_FinalChunks(type);
+        edubfm_PageTableFinal(&BE_PAGETABLE(type));
+        ERR(e);
+    }
+    BE_POLICY(type) = edubfm_policies[BE_CFG(type).policy];
+
+    /* the I/O engine may read into and write from the new buffers directly */
+    edubfm_IOSetBuffers();
+
+    return(eNOERROR);
+
+} /* edubfm_InitPool() */
+
+
+
+/*@================================
+ * edubfm_ResetPool()
+ *================================*/
+/*
+ * Function: Four edubfm_ResetPool(Four)
+ *
+ * Description:
+ *  Rebuild the EduBfM-private information of the buffer pool from the
+ *  current contents of the buffer table and the hash table, keeping the
+ *  configuration.
+ *  It is used after the buffer table has been changed as a whole,
+ *  e.g. by EduBfM_DiscardAll().
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubfm_ResetPool(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                i;
+
+
+    if (!IS_POOL_INITIALIZED(type)) return(eNOERROR);
+
+    BE_POLICY(type)->final(type);
+
+    pool_LoadFreeBufs(type);
+
+    edubfm_CountDirty(type);
+
+    for (i = 0; i < BE_NBUFS(type); i++) {
+        BE_CLEANED(type, i) = FALSE;
+        BE_IOSTATE(type, i) = IO_NONE;
+
+        /* the optimistic reads begun on the old contents fail */
+        BFM_ATOMIC_ADD(BE_VERSION(type, i), 2);
+    }
+
+    e = pool_LoadPageTable(type);
+    if (e >= eNOERROR) pool_LoadCleanList(type);
+    if (e >= eNOERROR) e = BE_POLICY(type)->init(type);
+    if (e < eNOERROR) {
+        pool_FinalChunks(type);
+        edubfm_PageTableFinal(&BE_PAGETABLE(type));
+        pool_FinalExt(type);
+        BE_POLICY(type) = NULL;
+        ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubfm_ResetPool() */
+
+
+
+/*@================================
+ * edubfm_EmptyPool()
+ *================================*/
+/*
+ * Function: Four edubfm_EmptyPool(Four)
+ *
+ * Description:
+ *  Discard the trains of the buffer pool without writing them. Only the
+ *  buffers holding a train are visited, as edubfm_DeletePool() finds them,
+ *  and the dirty map is cleared word by word, so that the cost is that
+ *  of the trains in the pool, not of the whole pool. Each emptied buffer
+ *  is given back to the replacement policy and, if it is not fixed, put
+ *  on the free buffer list so that the lowest buffers are popped first,
+ *  as from a pool just built; a shrink of the pool then finds the trains
+ *  loaded next out of its way.
+ *  The caller holds the pool latch, with no write-back or read ahead in
+ *  flight.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubfm_EmptyPool(
+    Four                type)           /* IN buffer type */
+{
+    Four                e;              /* error code */
+    Four                *indexes;
+    Four                i, n, nFree, idx, w;
+
+
+    if (!IS_POOL_INITIALIZED(type)) return(eNOERROR);
+
+    e = edubfm_DeletePool(type, &indexes, &n);
+    if (e < eNOERROR) ERR(e);
+
+    for (nFree = 0, i = 0; i < n; i++) {
+        idx = indexes[i];
+        if (IS_NILBFMHASHKEY(BI_KEY(type, idx))) continue;
+
+        BE_POLICY(type)->release(type, idx);
+        edubfm_CleanRemove(type, idx);
+        SET_NILBFMHASHKEY(BI_KEY(type, idx));
+        BI_BITS(type, idx) = ALL_0;
+        BE_CLEANED(type, idx) = FALSE;
+        BE_IOSTATE(type, idx) = IO_NONE;
+
+        /* the optimistic reads begun on the old contents fail */
+        BFM_ATOMIC_ADD(BE_VERSION(type, idx), 2);
+
+        if (BI_FIXED(type, idx) == 0) indexes[nFree++] = idx;
+    }
+
+    qsort(indexes, nFree, sizeof(Four), pool_CompareDown);
+    for (i = 0; i < nFree; i++) edubfm_PushFreeBuf(type, indexes[i]);
+
+    free(indexes);
+
+    for (w = edubfm_NextDirty(type, 0, BE_NBUFS(type)); w != NIL; w = edubfm_NextDirty(type, w, BE_NBUFS(type))) {
+        BE_DIRTYMAP(type, w / 64) = 0;
+        w = (w / 64 + 1) * 64;
+    }
+    BE_NDIRTY(type) = 0;
+
+    return(eNOERROR);
+
+} /* edubfm_EmptyPool() */
+
+
+
+/*@================================
+ * edubfm_FinalPool()
+ *================================*/
+/*
+ * Function: void edubfm_FinalPool(Four)
+ *
+ * Description:
+ *  Release the EduBfM-private information of the buffer pool. The trains
+ *  of a pool used by EduBfM alone are chained on the hash table again for
+ *  the storage system.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_FinalPool(
+    Four                type)           /* IN buffer type */
+{
+    if (!IS_POOL_INITIALIZED(type)) return;
+
+    edubfm_ReapPrefetches(type, TRUE);
+    (void) edubfm_SetShared(type, TRUE);
+
+    /* the storage system frees the frames of its buffer table by free() */
+    edubfm_GiveBackFrames(type);
+
+    BE_POLICY(type)->final(type);
+    pthread_cond_destroy(&BE_UNPINNED(type));
+    pthread_mutex_destroy(&BE_UNPINLATCH(type));
+    pthread_cond_destroy(&BE_WRITEDONE(type));
+    pthread_mutex_destroy(&BE_LATCH(type));
+    pool_FinalChunks(type);
+    edubfm_PageTableFinal(&BE_PAGETABLE(type));
+    pool_FinalExt(type);
+    BE_POLICY(type) = NULL;
+
+    /* the frames may have been made larger (see edubfm_ResizeFrames()) */
+    BI_BUFSIZE(type) = BE_BASEBUFSIZE(type);
+
+    edubfm_IOSetBuffers();
+
+} /* edubfm_FinalPool() */
+
+
+
+/*@================================
+ * edubfm_PushFreeBuf()
+ *================================*/
+/*
+ * Function: void edubfm_PushFreeBuf(Four, Four)
+ *
+ * Description:
+ *  Put the buffer, which holds no train any more, on the free buffer list
+ *  and take it off the clean list.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_PushFreeBuf(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    edubfm_CleanRemove(type, idx);
+
+    if (BE_NFREEBUFS(type) < BE_NBUFS(type))
+        BE_FREEBUFS(type)[BE_NFREEBUFS(type)++] = idx;
+
+} /* edubfm_PushFreeBuf() */
+
+
+
+/*@================================
+ * edubfm_PopFreeBuf()
+ *================================*/
+/*
+ * Function: Four edubfm_PopFreeBuf(Four)
+ *
+ * Description:
+ *  Take a buffer from the free buffer list, preferring one on the NUMA
+ *  node of the calling thread (see edubfm_Frames.c). A buffer which has
+ *  been used by the rest of the storage system in the meantime is dropped.
+ *
+ * Returns:
+ *  index of the buffer (NIL if the list is empty)
+ */
+Four edubfm_PopFreeBuf(
+    Four                type)           /* IN buffer type */
+{
+    Four                idx;
+
+
+    edubfm_LocalFreeBufFirst(type);
+
+    while (BE_NFREEBUFS(type) > 0) {
+        idx = BE_FREEBUFS(type)[--BE_NFREEBUFS(type)];
+        if (IS_NILBFMHASHKEY(BI_KEY(type, idx)) && BI_FIXED(type, idx) == 0) return(idx);
+    }
+
+    return(NIL);
+
+} /* edubfm_PopFreeBuf() */
+
+
+
+/*@================================
+ * edubfm_CountDirty()
+ *================================*/
+/*
+ * Function: void edubfm_CountDirty(Four)
+ *
+ * Description:
+ *  Set the number of dirty buffers of the pool and the dirty map from the
+ *  buffer table.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_CountDirty(
+    Four                type)           /* IN buffer type */
+{
+    Four                i;
+
+
+    BE_NDIRTY(type) = 0;
+    for (i = 0; i < BE_NCHUNKS(type); i++)
+        memset(BE_CHUNKS(type)[i]->dirtyMap, 0, sizeof(BE_CHUNKS(type)[i]->dirtyMap));
+    for (i = 0; i < BE_NBUFS(type); i++)
+        if (BI_BITS(type, i) & DIRTY) {
+            BE_NDIRTY(type)++;
+            BE_DIRTYMAP(type, i / 64) |= DIRTYMAP_BIT(i);
+        }
+
+} /* edubfm_CountDirty() */
+
+
+
+/*@================================
+ * pool_AddChunks()
+ *================================*/
+/*
+ * Function: static Four pool_AddChunks(Four, Four)
+ *
+ * Description:
+ *  Allocate the chunks of the buffers up to 'nBufs' which have none yet,
+ *  and make the free buffer list and the link arrays of the clean list
+ *  have room for the buffers of the chunks. A new chunk is zeroed, i.e.
+ *  its buffers are clean, in IO_NONE and of version 0, and its content
+ *  latches are initialized. The chunks are not released before
+ *  edubfm_FinalPool(), whereas the free buffer list and the link arrays,
+ *  which are used under the pool latch, may move.
+ *  The caller holds the pool latch unless the pool is being built.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four pool_AddChunks(
+    Four                type,           /* IN buffer type */
+    Four                nBufs)          /* IN # of buffers to have chunks */
+{
+    Four                e;              /* error code */
+    Four                i, n;
+    Four                nChunks = (nBufs + BFM_CHUNK_BUFS - 1) / BFM_CHUNK_BUFS;
+    Four                *freeBufs;
+    BufferChunk         *chunk;
+
+
+    if (nChunks <= BE_NCHUNKS(type)) return(eNOERROR);
+
+    freeBufs = (Four *)realloc(BE_FREEBUFS(type), sizeof(Four) * nChunks * BFM_CHUNK_BUFS);
+    if (freeBufs == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    BE_FREEBUFS(type) = freeBufs;
+
+    pthread_mutex_lock(&BE_CLEANLATCH(type));
+    e = edubfm_LinksGrow(&BE_CLEANLINKS(type), BE_NCHUNKS(type) * BFM_CHUNK_BUFS, nChunks * BFM_CHUNK_BUFS);
+    pthread_mutex_unlock(&BE_CLEANLATCH(type));
+    if (e < eNOERROR) ERR(e);
+
+    for (n = BE_NCHUNKS(type); n < nChunks; n++) {
+        chunk = (BufferChunk *)calloc(1, sizeof(BufferChunk));
+        if (chunk == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+
+        for (i = 0; i < BFM_CHUNK_BUFS; i++)
+            pthread_rwlock_init(&chunk->contentLatches[i], NULL);
+
+        BE_CHUNKS(type)[n] = chunk;
+        BE_NCHUNKS(type) = n + 1;
+    }
+
+    return(eNOERROR);
+
+} /* pool_AddChunks() */
+
+
+
+/*@================================
+ * pool_FinalChunks()
+ *================================*/
+/*
+ * Function: static void pool_FinalChunks(Four)
+ *
+ * Description:
+ *  Release the chunks of the buffers with their content latches, the
+ *  free buffer list and the clean list.
+ *
+ * Returns:
+ *  None
+ */
+static void pool_FinalChunks(
+    Four                type)           /* IN buffer type */
+{
+    Four                i, n;
+
+
+    for (n = 0; n < BE_NCHUNKS(type); n++) {
+        for (i = 0; i < BFM_CHUNK_BUFS; i++)
+            pthread_rwlock_destroy(&BE_CHUNKS(type)[n]->contentLatches[i]);
+        free(BE_CHUNKS(type)[n]);
+    }
+    free(BE_CHUNKS(type));
+    BE_CHUNKS(type) = NULL;
+    BE_NCHUNKS(type) = 0;
+
+    free(BE_FREEBUFS(type));
+    BE_FREEBUFS(type) = NULL;
+
+    pthread_mutex_destroy(&BE_CLEANLATCH(type));
+    edubfm_LinksFinal(&BE_CLEANLINKS(type));
+
+} /* pool_FinalChunks() */
+
+
+
+/*@================================
+ * pool_FinalExt()
+ *================================*/
+/*
+ * Function: static void pool_FinalExt(Four)
+ *
+ * Description:
+ *  Release the buffers added beyond the buffer table of the storage system,
+ *  and all the frames left by edubfm_AlignFrames() and edubfm_ResizeFrames().
+ *
+ * Returns:
+ *  None
+ */
+static void pool_FinalExt(
+    Four                type)           /* IN buffer type */
+{
+    if (BE_EXTFRAMES(type) != NULL) munmap(BE_EXTFRAMES(type), BE_EXTSIZE(type));
+    edubfm_FreeRetiredFrames(type);
+
+    BE_EXTFRAMES(type) = NULL;
+
+} /* pool_FinalExt() */
+
+
+
+/*@================================
+ * pool_Rebuild()
+ *================================*/
+/*
+ * Function: static Four pool_Rebuild(Four, Four)
+ *
+ * Description:
+ *  Make the pool have 'nBufs' buffers, whose elements of the buffer table
+ *  are valid, and rebuild the free buffer list and the state of the
+ *  buffer replacement policy. The new state of the policy is built before
+ *  the old one is released, so that the pool keeps its size and its old
+ *  state if there is not enough memory.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+static Four pool_Rebuild(
+    Four                type,           /* IN buffer type */
+    Four                nBufs)          /* IN new # of buffers */
+{
+    Four                e;              /* error code */
+    Four                oldNBufs = BE_NBUFS(type);
+    void                *oldState = BE_POLICYSTATE(type);
+    void                *newState;
+
+
+    BE_NBUFS(type) = nBufs;
+
+    e = BE_POLICY(type)->init(type);
+    if (e < eNOERROR) {
+        BE_POLICYSTATE(type) = oldState;
+        BE_NBUFS(type) = oldNBufs;
+        pool_LoadFreeBufs(type);
+        ERR(e);
+    }
+
+    newState = BE_POLICYSTATE(type);
+    BE_POLICYSTATE(type) = oldState;
+    BE_POLICY(type)->final(type);
+    BE_POLICYSTATE(type) = newState;
+
+    BE_NEXTVICTIM(type) %= nBufs;
+    pool_LoadFreeBufs(type);
+    edubfm_CountDirty(type);
+
+    return(eNOERROR);
+
+} /* pool_Rebuild() */
+
+
+
+/*@================================
+ * edubfm_GrowPool()
+ *================================*/
+/*
+ * Function: Four edubfm_GrowPool(Four, Four)
+ *
+ * Description:
+ *  Add empty buffers to the pool so that it has 'nBufs' buffers, up to
+ *  BE_MAXBUFS(type). The chunks of the added buffers are allocated as they
+ *  are needed. The frames of the buffers beyond the buffer table of the
+ *  storage system are reserved for BE_MAXBUFS(type) buffers at once,
+ *  backed by the pages and the NUMA nodes of the configuration (see
+ *  edubfm_Frames.c), and their memory is committed as it is used.
+ *  The added buffers are never chained on the hash table;
+ *  the page table grows its partitions as the trains are inserted.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_GrowPool(
+    Four                type,           /* IN buffer type */
+    Four                nBufs)          /* IN new # of buffers */
+{
+    Four                e;              /* error code */
+    Four                idx;
+    size_t              extSize;        /* size of the frames beyond the buffer table */
+    char                *frames;
+    size_t              mapped;         /* bytes of the frames mapped */
+
+
+    e = pool_AddChunks(type, nBufs);
+    if (e < eNOERROR) ERR(e);
+
+    if (nBufs > BE_NBASEBUFS(type) && BE_EXTFRAMES(type) == NULL) {
+        extSize = (size_t)PAGESIZE * BI_BUFSIZE(type) * (BE_MAXBUFS(type) - BE_NBASEBUFS(type));
+
+        e = edubfm_MapFrames(type, extSize, &frames, &mapped);
+        if (e < eNOERROR) ERR(e);
+
+        BE_EXTFRAMES(type) = frames;
+        BE_EXTSIZE(type) = mapped;
+    }
+
+    for (idx = BE_NBUFS(type); idx < nBufs; idx++) {
+        SET_NILBFMHASHKEY(BI_KEY(type, idx));
+        BI_FIXED(type, idx) = 0;
+        BI_BITS(type, idx) = ALL_0;
+        BI_NEXTHASHENTRY(type, idx) = NIL;
+        BE_CLEANED(type, idx) = FALSE;
+        BE_IOSTATE(type, idx) = IO_NONE;
+    }
+
+    e = pool_Rebuild(type, nBufs);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_GrowPool() */
+
+
+
+/*@================================
+ * edubfm_ShrinkPool()
+ *================================*/
+/*
+ * Function: Four edubfm_ShrinkPool(Four, Four)
+ *
+ * Description:
+ *  Remove the buffers from 'nBufs' on from the pool. The trains in them
+ *  are evicted, the dirty ones being written first. Since a hit pins a
+ *  buffer without the pool latch, each buffer is claimed as a victim of
+ *  the buffer replacement is; if one of them is pinned, the pool keeps
+ *  its size and the buffers evicted so far stay in it empty.
+ *  The memory of the removed frames beyond the buffer table of the
+ *  storage system is given back to the system.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    eRESIZEFIXEDBUF_EDUBFM - a buffer to be removed is fixed
+ *    some errors caused by function calls
+ */
+Four edubfm_ShrinkPool(
+    Four                type,           /* IN buffer type */
+    Four                nBufs)          /* IN new # of buffers */
+{
+    Four                e = eNOERROR;   /* error code */
+    Four                e2;
+    Four                idx;
+    Four                oldNBufs = BE_NBUFS(type);
+    Four                from;
+
+
+    /* the trains being written by the background writer or read ahead are in fixed buffers */
+    edubfm_WaitWriter(type, NIL);
+    edubfm_ReapPrefetches(type, TRUE);
+
+    for (idx = oldNBufs - 1; idx >= nBufs; idx--) {
+        if (IS_NILBFMHASHKEY(BI_KEY(type, idx)) && BFM_ATOMIC_LOAD(BI_FIXED(type, idx)) == 0) continue;
+
+        if (!edubfm_ClaimVictim(type, idx)) {
+            e = eRESIZEFIXEDBUF_EDUBFM;
+            break;
+        }
+
+        if (BI_BITS(type, idx) & DIRTY) {
+            e = edubfm_FlushTrain(&BI_KEY(type, idx), type);
+            if (e < eNOERROR) {
+                BFM_ATOMIC_ADD(BI_FIXED(type, idx), -1);
+                break;
+            }
+        }
+
+        if (!edubfm_UnmapVictim(type, idx)) {
+            e = eRESIZEFIXEDBUF_EDUBFM;
+            break;
+        }
+        BFM_COUNT(type, nEvictions);
+        edubfm_BalanceEvict(type, idx);
+
+        BI_BITS(type, idx) = ALL_0;
+        SET_NILBFMHASHKEY(BI_KEY(type, idx));
+        BE_CLEANED(type, idx) = FALSE;
+        BE_IOSTATE(type, idx) = IO_NONE;
+    }
+
+    /* the old policy state may still hold the evicted buffers */
+    e2 = pool_Rebuild(type, (e < eNOERROR) ? oldNBufs : nBufs);
+    if (e >= eNOERROR) e = e2;
+    if (e < eNOERROR) ERR(e);
+
+    from = (nBufs > BE_NBASEBUFS(type)) ? nBufs : BE_NBASEBUFS(type);
+    if (from < oldNBufs)
+        (void) madvise(BI_BUFFER(type, from), (size_t)PAGESIZE * BI_BUFSIZE(type) * (oldNBufs - from), MADV_DONTNEED);
+
+    return(eNOERROR);
+
+} /* edubfm_ShrinkPool() */
+
+
+
+/*@================================
+ * edubfm_MarkDirty()
+ *================================*/
+/*
+ * Function: Boolean edubfm_MarkDirty(Four, Four)
+ *
+ * Description:
+ *  Set the dirty bit of the buffer and count the buffer as dirty, and put
+ *  it on the dirty map instead of the clean list, if the bit was not set.
+ *  It may be called without the pool latch.
+ *
+ * Returns:
+ *  TRUE if the buffer has become dirty
+ */
+Boolean edubfm_MarkDirty(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    if (BI_SETBITS(type, idx, DIRTY) & DIRTY) return(FALSE);
+
+    if (IS_POOL_INITIALIZED(type)) {
+        BFM_ATOMIC_STORE(BE_CLEANED(type, idx), FALSE);
+        BFM_ATOMIC_ADD(BE_NDIRTY(type), 1);
+        BFM_ATOMIC_OR(BE_DIRTYMAP(type, idx / 64), DIRTYMAP_BIT(idx));
+        edubfm_CleanRemove(type, idx);
+    }
+
+    return(TRUE);
+
+} /* edubfm_MarkDirty() */
+
+
+
+/*@================================
+ * edubfm_MarkClean()
+ *================================*/
+/*
+ * Function: Boolean edubfm_MarkClean(Four, Four)
+ *
+ * Description:
+ *  Clear the dirty bit of the buffer before its contents are written, so
+ *  that an update made during the write dirties the buffer again.
+ *  The buffer is counted as clean only if it was on the dirty map, since
+ *  the storage system sets the dirty bits of the buffers it fixes
+ *  without EduBfM. It is put on the clean list unless it has been
+ *  dirtied again.
+ *
+ * Returns:
+ *  TRUE if the buffer was dirty
+ */
+Boolean edubfm_MarkClean(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    if (!(BI_CLEARBITS(type, idx, DIRTY) & DIRTY)) return(FALSE);
+
+    if (IS_POOL_INITIALIZED(type)) {
+        if (BFM_ATOMIC_AND(BE_DIRTYMAP(type, idx / 64), ~DIRTYMAP_BIT(idx)) & DIRTYMAP_BIT(idx))
+            BFM_ATOMIC_ADD(BE_NDIRTY(type), -1);
+
+        /* the buffer may have been dirtied again before its bit was cleared */
+        if (BFM_ATOMIC_LOAD(BI_BITS(type, idx)) & DIRTY)
+            BFM_ATOMIC_OR(BE_DIRTYMAP(type, idx / 64), DIRTYMAP_BIT(idx));
+        else
+            edubfm_CleanInsert(type, idx);
+    }
+
+    return(TRUE);
+
+} /* edubfm_MarkClean() */
+
+
+
+/*@================================
+ * edubfm_NextDirty()
+ *================================*/
+/*
+ * Function: Four edubfm_NextDirty(Four, Four, Four)
+ *
+ * Description:
+ *  Find the first buffer from 'from' up to 'to', exclusive, on the dirty
+ *  map, skipping 64 clean buffers at a time. The buffer may have been
+ *  cleaned since, so the caller checks its dirty bit.
+ *
+ * Returns:
+ *  buffer index, or NIL if there is none
+ */
+Four edubfm_NextDirty(
+    Four                type,           /* IN buffer type */
+    Four                from,           /* IN first buffer to look at */
+    Four                to)             /* IN buffer to stop at */
+{
+    Four                w;              /* word of the dirty map */
+    UEight              bits;
+
+
+    if (from >= to) return(NIL);
+
+    w = from / 64;
+    bits = BFM_ATOMIC_LOAD(BE_DIRTYMAP(type, w)) & (~(UEight)0 << (from % 64));
+    while (bits == 0) {
+        if (++w * 64 >= to) return(NIL);
+        bits = BFM_ATOMIC_LOAD(BE_DIRTYMAP(type, w));
+    }
+
+    from = w * 64 + __builtin_ctzll(bits);
+
+    return((from < to) ? from : NIL);
+
+} /* edubfm_NextDirty() */
+
+
+
+/*@================================
+ * edubfm_CleanInsert()
+ *================================*/
+/*
+ * Function: void edubfm_CleanInsert(Four, Four)
+ *
+ * Description:
+ *  Put the buffer at the head of the clean list if it holds a train
+ *  which is not dirty. The dirty bit is tested under the latch of the
+ *  list, which edubfm_MarkDirty() takes after setting it, so that a
+ *  buffer dirtied meanwhile does not stay on the list. It may be called
+ *  without the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_CleanInsert(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    pthread_mutex_lock(&BE_CLEANLATCH(type));
+    if (!IS_ON_CLEANLIST(type, idx) && !IS_NILBFMHASHKEY(BI_KEY(type, idx)) &&
+        !(BFM_ATOMIC_LOAD(BI_BITS(type, idx)) & DIRTY))
+        edubfm_ListInsertHead(&BE_CLEANLINKS(type), &BE_CLEANLIST(type), idx);
+    pthread_mutex_unlock(&BE_CLEANLATCH(type));
+
+} /* edubfm_CleanInsert() */
+
+
+
+/*@================================
+ * edubfm_CleanRemove()
+ *================================*/
+/*
+ * Function: void edubfm_CleanRemove(Four, Four)
+ *
+ * Description:
+ *  Take the buffer off the clean list if it is on it. It may be called
+ *  without the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_CleanRemove(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    pthread_mutex_lock(&BE_CLEANLATCH(type));
+    if (IS_ON_CLEANLIST(type, idx))
+        edubfm_ListRemove(&BE_CLEANLINKS(type), &BE_CLEANLIST(type), idx);
+    pthread_mutex_unlock(&BE_CLEANLATCH(type));
+
+} /* edubfm_CleanRemove() */
+
+
+
+/*@================================
+ * edubfm_CleanVictim()
+ *================================*/
+/*
+ * Function: Four edubfm_CleanVictim(Four)
+ *
+ * Description:
+ *  Select the least recently cleaned buffer of the clean list which is
+ *  neither fixed nor referenced, giving the others a second chance:
+ *  a fixed or referenced buffer met on the way moves to the head of the
+ *  list, and its REFER bit is cleared. A buffer dirtied by the storage
+ *  system, which does not call edubfm_MarkDirty(), is dropped. Every
+ *  buffer of the list is visited at most twice, so that the buffers
+ *  loaded since the last replacement, whose REFER bits are all set, do
+ *  not make the caller fall back to its own search.
+ *  The buffer stays on the list until it is evicted. The caller holds
+ *  the pool latch.
+ *
+ * Returns:
+ *  index of the buffer (NIL if there is none)
+ */
+Four edubfm_CleanVictim(
+    Four                type)           /* IN buffer type */
+{
+    BfMList             *list = &BE_CLEANLIST(type);
+    BfMLinks            *links = &BE_CLEANLINKS(type);
+    Four                idx;
+    Four                n;
+    One                 bits;
+
+
+    pthread_mutex_lock(&BE_CLEANLATCH(type));
+
+    for (n = 2 * list->len; n > 0 && list->len > 0; n--) {
+        idx = list->tail;
+        bits = BFM_ATOMIC_LOAD(BI_BITS(type, idx));
+        if (BFM_ATOMIC_LOAD(BI_FIXED(type, idx)) == 0 && !(bits & (REFER | DIRTY))) {
+            pthread_mutex_unlock(&BE_CLEANLATCH(type));
+            return(idx);
+        }
+
+        edubfm_ListRemove(links, list, idx);
+        if (bits & DIRTY) continue;
+
+        if (BFM_ATOMIC_LOAD(BI_FIXED(type, idx)) == 0) BI_CLEARBITS(type, idx, REFER);
+        edubfm_ListInsertHead(links, list, idx);
+    }
+
+    pthread_mutex_unlock(&BE_CLEANLATCH(type));
+
+    return(NIL);
+
+} /* edubfm_CleanVictim() */
+
+
+
+/*@================================
+ * edubfm_Unpinned()
+ *================================*/
+/*
+ * Function: void edubfm_Unpinned(Four)
+ *
+ * Description:
+ *  Wake the resizes of the pool waiting for a buffer to be unpinned (see
+ *  edubfm_WaitUnpinned()), after the fix count of a buffer has dropped
+ *  to 0. Unless a resize waits, it only loads the number of waiters.
+ *  The load is sequentially consistent, as the atomic decrement of the
+ *  fix count before it and the increment of the waiters by the resize
+ *  are, so that either the resize sees the buffer unpinned or it is
+ *  woken. It may be called with or without the pool latch.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_Unpinned(
+    Four                type)           /* IN buffer type */
+{
+    if (__atomic_load_n(&BE_NUNPINWAITS(type), __ATOMIC_SEQ_CST) == 0) return;
+
+    pthread_mutex_lock(&BE_UNPINLATCH(type));
+    BE_NUNPINS(type)++;
+    pthread_cond_broadcast(&BE_UNPINNED(type));
+    pthread_mutex_unlock(&BE_UNPINLATCH(type));
+
+} /* edubfm_Unpinned() */
+
+
+
+/*@================================
+ * edubfm_WaitUnpinned()
+ *================================*/
+/*
+ * Function: Boolean edubfm_WaitUnpinned(Four, UFour, struct timespec *)
+ *
+ * Description:
+ *  Wait until a buffer of the pool is unpinned after BE_NUNPINS(type) was
+ *  'seen', or until the deadline. The caller has counted itself in
+ *  BE_NUNPINWAITS(type) before it read 'seen', and does not hold the pool
+ *  latch.
+ *
+ * Returns:
+ *  TRUE if a buffer has been unpinned, FALSE at the deadline
+ */
+Boolean edubfm_WaitUnpinned(
+    Four                type,           /* IN buffer type */
+    UFour               seen,           /* IN BE_NUNPINS(type) before the buffers were looked at */
+    struct timespec     *deadline)      /* IN time to give up at (CLOCK_REALTIME) */
+{
+    Boolean             unpinned;
+
+
+    pthread_mutex_lock(&BE_UNPINLATCH(type));
+    while (BE_NUNPINS(type) == seen)
+        if (pthread_cond_timedwait(&BE_UNPINNED(type), &BE_UNPINLATCH(type), deadline) != 0) break;
+    unpinned = (BE_NUNPINS(type) != seen);
+    pthread_mutex_unlock(&BE_UNPINLATCH(type));
+
+    return(unpinned);
+
+} /* edubfm_WaitUnpinned() */
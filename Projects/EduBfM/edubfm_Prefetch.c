@@ -0,0 +1,575 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Prefetch.c
+ *
+ * Description:
+ *  Reads started by EduBfM_PrefetchTrains() and EduBfM_GetTrainAsync().
+ *  A train read ahead gets a buffer which is fixed, entered in the hash
+ *  table, and marked IO_READING; the read of the train from the device of
+ *  its attached volume is submitted to the I/O engine.
+ *  Only the foreground changes the buffer table: it completes the
+ *  requests whose reads are over (edubfm_ReapPrefetches()), unfixing the
+ *  buffer, or removing the train if the read failed. A fix of a train
+ *  being read waits for that read only (edubfm_WaitPrefetch()), which
+ *  may also be the read of a miss (see EduBfM_GetTrainWithStrategy()).
+ *  The requests of EduBfM_GetTrainAsync() waiting for a read are fixed
+ *  when the read is completed, by whichever thread completes it, and put
+ *  on the completed list of their queue, which only the thread owning
+ *  the queue takes (edubfm_TakeCompleted()).
+ *
+ * Exports:
+ *  Four edubfm_StartRead(TrainID *, Four)
+ *  Four edubfm_StartPrefetch(Four, Four)
+ *  void edubfm_ReapPrefetches(Four, Boolean)
+ *  void edubfm_WaitPrefetch(Four, Four)
+ *  void edubfm_StopPrefetcher(void)
+ *  void edubfm_AddPrefetchWaiter(Four, Four, BfMAsyncGet *)
+ *  Boolean edubfm_IsPrefetching(Four, Four)
+ *  UEight edubfm_PrefetchEpoch(void)
+ *  BfMAsyncGet *edubfm_TakeCompleted(BfMAsyncQueue *, UEight, Boolean)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* state of the read-ahead */
+static struct {
+    pthread_mutex_t     mutex;          /* protects the states of the requests and the completed lists */
+    pthread_cond_t      done;           /* signaled when a read is over */
+    UEight              epoch;          /* # of reads over */
+} prefetcher = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0 };
+
+
+
+/*@================================
+ * prefetch_Done()
+ *================================*/
+/*
+ * Function: static void prefetch_Done(BfMIORequest *)
+ *
+ * Description:
+ *  done() of the reads, called by the I/O engine.
+ *
+ * Returns:
+ *  None
+ */
+static void prefetch_Done(
+    BfMIORequest        *req)           /* IN read over */
+{
+    BfMPrefetch         *p = (BfMPrefetch *)req->arg;
+
+
+    pthread_mutex_lock(&prefetcher.mutex);
+    p->state = (req->result < eNOERROR) ? PREFETCH_FAILED : PREFETCH_DONE;
+    prefetcher.epoch++;
+    pthread_cond_broadcast(&prefetcher.done);
+    pthread_mutex_unlock(&prefetcher.mutex);
+
+} /* prefetch_Done() */
+
+
+
+/*@================================
+ * prefetch_Complete()
+ *================================*/
+/*
+ * Function: static void prefetch_Complete(BfMPrefetch *)
+ *
+ * Description:
+ *  Complete a request whose read is over. The buffer is unfixed, and if
+ *  the read failed, it is emptied and put on the free buffer list.
+ *  The requests of EduBfM_GetTrainAsync() waiting for the read get the
+ *  buffer fixed, or the error of the read, and are put on the completed
+ *  lists of their queues.
+ *  The caller holds the pool latch and the prefetcher mutex.
+ *
+ * Returns:
+ *  None
+ */
+static void prefetch_Complete(
+    BfMPrefetch         *p)             /* INOUT request */
+{
+    Four                type = p->type;
+    Four                idx = p->idx;
+    BfMAsyncGet         *w;             /* request waiting for the read */
+    BfMAsyncGet         *next;
+
+
+    for (w = p->waiters; w != NULL; w = next) {
+        next = w->next;
+        if (p->state == PREFETCH_DONE) {
+            BFM_ATOMIC_ADD(BI_FIXED(type, idx), 1);
+            w->retBuf = BI_BUFFER(type, idx);
+            w->result = eNOERROR;
+        }
+        else {
+            w->retBuf = NULL;
+            w->result = p->req.result;
+        }
+        w->next = w->queue->completed;
+        w->queue->completed = w;
+    }
+
+    if (p->state == PREFETCH_DONE) {
+        /* a train read for its requests is not a prefetch hit when it is fixed again */
+        BFM_ATOMIC_STORE(BE_IOSTATE(type, idx), (p->waiters != NULL) ? IO_NONE : IO_PREFETCHED);
+        BFM_ATOMIC_ADD(BI_FIXED(type, idx), -1);
+    }
+    else {
+        /* delete the mapping while edubfm_Fix() still ignores the buffer */
+        BE_POLICY(type)->release(type, idx);
+        edubfm_Delete(&BI_KEY(type, idx), type);
+        SET_NILBFMHASHKEY(BI_KEY(type, idx));
+        BI_BITS(type, idx) = ALL_0;
+        BFM_ATOMIC_STORE(BE_IOSTATE(type, idx), IO_NONE);
+        BFM_ATOMIC_ADD(BI_FIXED(type, idx), -1);
+        edubfm_PushFreeBuf(type, idx);
+    }
+
+    p->state = PREFETCH_FREE;
+    BE_NPREFETCHES(type)--;
+
+} /* prefetch_Complete() */
+
+
+
+/*@================================
+ * edubfm_StartRead()
+ *================================*/
+/*
+ * Function: Four edubfm_StartRead(TrainID *, Four)
+ *
+ * Description:
+ *  Allocate a buffer to the train, which is not in the pool, and start
+ *  its read (see edubfm_StartPrefetch()). The caller holds the pool
+ *  latch and has checked that the pool has a free request and that the
+ *  volume of the train is attached.
+ *  Since the pool latch is released over the write-back of a dirty
+ *  victim (see edubfm_AllocTrain()), the train may have been read in,
+ *  or the requests of the pool taken, by then; the buffer is given back
+ *  and no read is started.
+ *
+ * Returns:
+ *  index of the buffer
+ *  NIL if no read has been started
+ *  error code
+ *    eNOUNFIXEDBUF_BFM - no buffer can be allocated
+ *    some errors caused by function calls
+ */
+Four edubfm_StartRead(
+    TrainID             *trainId,       /* IN train to be read */
+    Four                type)           /* IN buffer type */
+{
+    Four                e;
+    Four                index;          /* index of the buffer pool */
+
+
+    BE_POLICY(type)->miss(type, (BfMHashKey *)trainId);
+    index = edubfm_AllocTrain(type);
+    if (index < 0) return(index);
+
+    if (edubfm_LookUp((BfMHashKey *)trainId, type) != NOTFOUND_IN_HTABLE ||
+        BE_NPREFETCHES(type) >= BE_MAXPREFETCHES(type)) {
+        BE_POLICY(type)->release(type, index);
+        edubfm_PushFreeBuf(type, index);
+        return(NIL);
+    }
+
+    BI_KEY(type, index).volNo = trainId->volNo;
+    BI_KEY(type, index).pageNo = trainId->pageNo;
+    BI_FIXED(type, index) = 1;
+    BI_BITS(type, index) |= REFER;
+
+    /* a hit must not use the buffer before the read is over */
+    BFM_ATOMIC_STORE(BE_IOSTATE(type, index), IO_READING);
+
+    e = edubfm_Insert((BfMHashKey *)trainId, index, type);
+    if (e < eNOERROR) {
+        SET_NILBFMHASHKEY(BI_KEY(type, index));
+        BE_IOSTATE(type, index) = IO_NONE;
+        BI_FIXED(type, index) = 0;
+        BE_POLICY(type)->release(type, index);
+        edubfm_PushFreeBuf(type, index);
+        ERR(e);
+    }
+
+    BE_POLICY(type)->admit(type, index);
+
+    e = edubfm_StartPrefetch(type, index);
+    if (e < eNOERROR) {
+        BE_POLICY(type)->release(type, index);
+        edubfm_Delete(&BI_KEY(type, index), type);
+        SET_NILBFMHASHKEY(BI_KEY(type, index));
+        BE_IOSTATE(type, index) = IO_NONE;
+        BI_FIXED(type, index) = 0;
+        edubfm_PushFreeBuf(type, index);
+        ERR(e);
+    }
+
+    return(index);
+
+} /* edubfm_StartRead() */
+
+
+
+/*@================================
+ * edubfm_StartPrefetch()
+ *================================*/
+/*
+ * Function: Four edubfm_StartPrefetch(Four, Four)
+ *
+ * Description:
+ *  Submit the read of the train held by the buffer, which has been fixed
+ *  and entered in the hash table by the caller, to the I/O engine.
+ *  The caller has checked that the pool has a free request.
+ *
+ * Returns:
+ *  error code
+ *    eNOTATTACHEDVOLUME_EDUBFM - the volume is not attached
+ */
+Four edubfm_StartPrefetch(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    Four                i;
+    BfMPrefetch         *p;
+    BfMIORequest        *req;
+    BfMDevice           *dev;
+
+
+    dev = edubfm_FindDevice(BI_KEY(type, idx).volNo);
+    if (dev == NULL) ERR(eNOTATTACHEDVOLUME_EDUBFM);
+
+    for (i = 0; BE_PREFETCH(type, i).state != PREFETCH_FREE; i++);
+    p = &BE_PREFETCH(type, i);
+    p->type = type;
+    p->idx = idx;
+    p->key = BI_KEY(type, idx);
+    p->state = PREFETCH_BUSY;
+    p->waiters = NULL;
+
+    /* the train is read from the device, not taken out of the compressed cache or the extension file */
+    edubfm_ZCacheDelete(&p->key);
+    edubfm_ExtensionDelete(type, &p->key);
+
+    BE_NPREFETCHES(type)++;
+    BE_IOSTATE(type, idx) = IO_READING;
+
+    p->iov.iov_base = BI_BUFFER(type, idx);
+    p->iov.iov_len = (size_t)PAGESIZE * edubfm_TrainPages(type, p->key.volNo);
+    req = &p->req;
+    req->op = BFM_IO_READ;
+    req->type = type;
+    req->fd = edubfm_DeviceFd(dev, type);
+    req->offset = (off_t)p->key.pageNo * PAGESIZE;
+    req->iov = &p->iov;
+    req->nIov = 1;
+    req->done = prefetch_Done;
+    req->arg = p;
+
+    edubfm_IOSubmit(&req, 1);
+
+    return(eNOERROR);
+
+} /* edubfm_StartPrefetch() */
+
+
+
+/*@================================
+ * edubfm_ReapPrefetches()
+ *================================*/
+/*
+ * Function: void edubfm_ReapPrefetches(Four, Boolean)
+ *
+ * Description:
+ *  Complete the requests of the pool whose reads are over. If 'wait' is
+ *  TRUE, wait for all the reads of the pool.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ReapPrefetches(
+    Four                type,           /* IN buffer type */
+    Boolean             wait)           /* IN TRUE to wait for the reads in flight */
+{
+    Four                i;
+
+
+    if (BE_NPREFETCHES(type) == 0) return;
+
+    pthread_mutex_lock(&prefetcher.mutex);
+
+    for (;;) {
+        for (i = 0; i < BFM_MAX_PREFETCHES; i++)
+            if (BE_PREFETCH(type, i).state == PREFETCH_DONE || BE_PREFETCH(type, i).state == PREFETCH_FAILED)
+                prefetch_Complete(&BE_PREFETCH(type, i));
+
+        if (!wait || BE_NPREFETCHES(type) == 0) break;
+        pthread_cond_wait(&prefetcher.done, &prefetcher.mutex);
+    }
+
+    pthread_mutex_unlock(&prefetcher.mutex);
+
+} /* edubfm_ReapPrefetches() */
+
+
+
+/*@================================
+ * edubfm_WaitPrefetch()
+ *================================*/
+/*
+ * Function: void edubfm_WaitPrefetch(Four, Four)
+ *
+ * Description:
+ *  Wait for the read of the train into the buffer, which is IO_READING,
+ *  and complete the request. A buffer being read by a miss has no
+ *  request; the pool latch, which the caller holds, is released until
+ *  the miss is over with it (see EduBfM_GetTrainWithStrategy()), and the
+ *  caller looks the train up again since the read may have failed.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_WaitPrefetch(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    Four                i;
+    BfMPrefetch         *p;
+
+
+    pthread_mutex_lock(&prefetcher.mutex);
+
+    for (i = 0; i < BFM_MAX_PREFETCHES; i++)
+        if (BE_PREFETCH(type, i).state != PREFETCH_FREE && BE_PREFETCH(type, i).idx == idx) break;
+
+    if (i < BFM_MAX_PREFETCHES) {
+        p = &BE_PREFETCH(type, i);
+        if (p->state == PREFETCH_BUSY) BFM_COUNT(type, nPrefetchWaits);
+        while (p->state == PREFETCH_BUSY)
+            pthread_cond_wait(&prefetcher.done, &prefetcher.mutex);
+        prefetch_Complete(p);
+    }
+
+    pthread_mutex_unlock(&prefetcher.mutex);
+
+    if (i == BFM_MAX_PREFETCHES)
+        while (BFM_ATOMIC_LOAD(BE_IOSTATE(type, idx)) == IO_READING)
+            pthread_cond_wait(&BE_WRITEDONE(type), &BE_LATCH(type));
+
+} /* edubfm_WaitPrefetch() */
+
+
+
+/*@================================
+ * edubfm_StopPrefetcher()
+ *================================*/
+/*
+ * Function: void edubfm_StopPrefetcher(void)
+ *
+ * Description:
+ *  Complete all the requests.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_StopPrefetcher(void)
+{
+    Four                type;
+
+
+    for (type = 0; type < NUM_BUF_TYPES; type++)
+        if (IS_POOL_INITIALIZED(type)) {
+            BFM_LATCH(type);
+            edubfm_ReapPrefetches(type, TRUE);
+            BFM_UNLATCH(type);
+        }
+
+} /* edubfm_StopPrefetcher() */
+
+
+
+/*@================================
+ * edubfm_AddPrefetchWaiter()
+ *================================*/
+/*
+ * Function: void edubfm_AddPrefetchWaiter(Four, Four, BfMAsyncGet *)
+ *
+ * Description:
+ *  Make the request of EduBfM_GetTrainAsync() wait for the read of the
+ *  train into the buffer, which is IO_READING. The caller holds the pool
+ *  latch, so that the read is not completed in the meantime.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_AddPrefetchWaiter(
+    Four                type,           /* IN buffer type */
+    Four                idx,            /* IN buffer index */
+    BfMAsyncGet         *req)           /* INOUT request */
+{
+    Four                i;
+    BfMPrefetch         *p;
+
+
+    pthread_mutex_lock(&prefetcher.mutex);
+
+    for (i = 0; BE_PREFETCH(type, i).state == PREFETCH_FREE || BE_PREFETCH(type, i).idx != idx; i++);
+    p = &BE_PREFETCH(type, i);
+    req->next = p->waiters;
+    p->waiters = req;
+
+    pthread_mutex_unlock(&prefetcher.mutex);
+
+} /* edubfm_AddPrefetchWaiter() */
+
+
+
+/*@================================
+ * edubfm_IsPrefetching()
+ *================================*/
+/*
+ * Function: Boolean edubfm_IsPrefetching(Four, Four)
+ *
+ * Description:
+ *  Return whether the buffer, which is IO_READING, is read by a request
+ *  of the pool, to which a request of EduBfM_GetTrainAsync() can be
+ *  added (see edubfm_AddPrefetchWaiter()), rather than by a miss.
+ *  The caller holds the pool latch.
+ *
+ * Returns:
+ *  TRUE if a request reads the buffer
+ */
+Boolean edubfm_IsPrefetching(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index */
+{
+    Four                i;
+
+
+    pthread_mutex_lock(&prefetcher.mutex);
+
+    for (i = 0; i < BFM_MAX_PREFETCHES; i++)
+        if (BE_PREFETCH(type, i).state != PREFETCH_FREE && BE_PREFETCH(type, i).idx == idx) break;
+
+    pthread_mutex_unlock(&prefetcher.mutex);
+
+    return(i < BFM_MAX_PREFETCHES);
+
+} /* edubfm_IsPrefetching() */
+
+
+
+/*@================================
+ * edubfm_PrefetchEpoch()
+ *================================*/
+/*
+ * Function: UEight edubfm_PrefetchEpoch(void)
+ *
+ * Description:
+ *  Return the number of reads over so far, to be given to
+ *  edubfm_TakeCompleted() later.
+ *
+ * Returns:
+ *  the number of reads over
+ */
+UEight edubfm_PrefetchEpoch(void)
+{
+    UEight              epoch;
+
+
+    pthread_mutex_lock(&prefetcher.mutex);
+    epoch = prefetcher.epoch;
+    pthread_mutex_unlock(&prefetcher.mutex);
+
+    return(epoch);
+
+} /* edubfm_PrefetchEpoch() */
+
+
+
+/*@================================
+ * edubfm_TakeCompleted()
+ *================================*/
+/*
+ * Function: BfMAsyncGet *edubfm_TakeCompleted(BfMAsyncQueue *, UEight, Boolean)
+ *
+ * Description:
+ *  Take the completed list of the queue. If 'wait' is TRUE and the list
+ *  is empty, first wait until a read is over after 'epoch' (see
+ *  edubfm_PrefetchEpoch()); the read is completed by the next
+ *  edubfm_ReapPrefetches() of its pool.
+ *
+ * Returns:
+ *  the requests completed (NULL if none)
+ */
+BfMAsyncGet *edubfm_TakeCompleted(
+    BfMAsyncQueue       *queue,         /* INOUT queue */
+    UEight              epoch,          /* IN # of reads over when the caller last reaped the pools */
+    Boolean             wait)           /* IN TRUE to wait for a read if no request is completed */
+{
+    BfMAsyncGet         *list;
+
+
+    pthread_mutex_lock(&prefetcher.mutex);
+
+    while (wait && queue->completed == NULL && prefetcher.epoch == epoch)
+        pthread_cond_wait(&prefetcher.done, &prefetcher.mutex);
+
+    list = queue->completed;
+    queue->completed = NULL;
+
+    pthread_mutex_unlock(&prefetcher.mutex);
+
+    return(list);
+
+} /* edubfm_TakeCompleted() */
@@ -54,6 +54,8 @@
  *
  * Exports:
  *  edubfm_ReadTrain()
+ *  Boolean edubfm_ReadCached(TrainID *, char *, Four)
+ *  Four edubfm_ReadVolume(TrainID *, char *, Four)
  */
 
 #include "EduBfM_common.h"
@@ -76,6 +78,14 @@
  *  when RDsM_ReadTrain() is called, simply return it.  The function has
  *  no code for checking input parameters since this will be done RDsM,
  *  especially RDsM_ReadTrain().
+ *  A buffer pool configured for the direct I/O (BfMConfig.directIO) reads
+ *  the trains of the attached volumes from their devices instead.
+ *  A train kept by the compressed cache is taken from it without a read
+ *  (see edubfm_ZCache.c).
+ *  It is edubfm_ReadCached() followed by edubfm_ReadVolume() if the train
+ *  is not cached; a miss of EduBfM_GetTrainWithStrategy() calls them
+ *  apart to read the volume without the pool latch. The caller holds the
+ *  pool latch.
  *
  * Returns;
  *  error code
@@ -90,14 +100,88 @@ Four edubfm_ReadTrain(
     char *aTrain,     /* OUT a pointer to buffer */
     Four type)        /* IN buffer type */
 {
-    /* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
+    /* Error check whether using not supported functionality by EduBfM */
+    if (RM_IS_ROLLBACK_REQUIRED()) ERR(eNOTSUPPORTED_EDUBFM);
+    if (edubfm_ReadCached(trainId, aTrain, type)) return(eNOERROR);
+
+    return (edubfm_ReadVolume(trainId, aTrain, type));
+
+} /* edubfm_ReadTrain */
+
+
+
+/*@================================
+ * edubfm_ReadCached()
+ *================================*/
+/*
+ * Function: Boolean edubfm_ReadCached(TrainID*, char*, Four)
+ *
+ * Description:
+ *  Take the train out of the compressed cache (see edubfm_ZCache.c) or
+ *  the extension file of the pool (see edubfm_Extension.c) into the
+ *  buffer if either keeps it. The caller holds the pool latch.
+ *
+ * Returns:
+ *  TRUE if the train has been taken into the buffer
+ */
+Boolean edubfm_ReadCached(
+    TrainID *trainId, /* IN which train? */
+    char *aTrain,     /* OUT a pointer to buffer */
+    Four type)        /* IN buffer type */
+{
+    if (edubfm_ZCacheLookUp(type, (BfMHashKey *)trainId, aTrain)) {
+        edubfm_ExtensionDelete(type, (BfMHashKey *)trainId);
+        return(TRUE);
+    }
+
+    return (edubfm_ExtensionLookUp(type, (BfMHashKey *)trainId, aTrain));
+
+} /* edubfm_ReadCached */
+
+
+
+/*@================================
+ * edubfm_ReadVolume()
+ *================================*/
+/*
+ * Function: Four edubfm_ReadVolume(TrainID*, char*, Four)
+ *
+ * Description:
+ *  Read the train from its volume into the buffer, from the device of
+ *  the volume if the pool uses the direct I/O, and by RDsM_ReadTrain()
+ *  otherwise. The caller need not hold the pool latch.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects
+ *  1) parameter aTrain
+ *     a buffer specified by 'aTrain' is filled with a disk content
+ */
+Four edubfm_ReadVolume(
+    TrainID *trainId, /* IN which train? */
+    char *aTrain,     /* OUT a pointer to buffer */
+    Four type)        /* IN buffer type */
+{
     Four e; /* for error */
+    UEight start; /* time the read is started */
+    BfMDevice *dev; /* device of the volume if attached */
 
     /* Error check whether using not supported functionality by EduBfM */
     if (RM_IS_ROLLBACK_REQUIRED()) ERR(eNOTSUPPORTED_EDUBFM);
-    e = RDsM_ReadTrain(trainId, aTrain, BI_BUFSIZE(type));
+
+    start = edubfm_Now();
+    if (BE_CFG(type).directIO && (dev = edubfm_FindDevice(trainId->volNo)) != NULL)
+        e = edubfm_DeviceIO(dev, type, BFM_IO_READ, trainId->pageNo, edubfm_TrainPages(type, trainId->volNo), aTrain);
+    else {
+        RDSM_LATCH();
+        e = RDsM_ReadTrain(trainId, aTrain, edubfm_TrainPages(type, trainId->volNo));
+        RDSM_UNLATCH();
+    }
     if (e < 0) ERR(e);
+    BFM_COUNT_VALUE(type, readNs, edubfm_Now() - start);
 
     return (eNOERROR);
 
-} /* edubfm_ReadTrain */
+} /* edubfm_ReadVolume */
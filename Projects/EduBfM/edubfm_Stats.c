@@ -0,0 +1,347 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Stats.c
+ *
+ * Description:
+ *  Statistics of the buffer pools. Each thread counts in a block of its
+ *  own (BE_MYSTATS()), allocated at its first count, so that counting
+ *  takes no latch and writes no cache line shared with other threads.
+ *  EduBfM_GetStats() adds up the blocks of the running threads and the
+ *  counters of the threads which have exited; the block of a thread is
+ *  added to the latter when the thread exits.
+ *
+ *  The histograms count values in buckets of powers of 2 (see
+ *  BFM_NUM_HIST_BUCKETS), e.g. latencies measured with edubfm_Now().
+ *  Reading the clock costs about as much as a hit, so the latency of
+ *  EduBfM_GetTrain() is measured for a sample of the calls only.
+ *
+ * Exports:
+ *  BfMThreadStats *edubfm_NewThreadStats(void)
+ *  void edubfm_SumStats(Four, BfMStats *)
+ *  UEight edubfm_Now(void)
+ *  UEight edubfm_SampleStart(void)
+ *  void edubfm_CountValue(UEight *, UEight)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h> /* for memset */
+#include <time.h>
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* # of counters in BfMStats */
+#define NUM_COUNTERS    (sizeof(BfMStats) / sizeof(UEight))
+
+/* counter block of the calling thread (NULL until its first count) */
+__thread BfMThreadStats *edubfm_myStats = NULL;
+
+/* blocks of the threads */
+static struct {
+    pthread_mutex_t     mutex;          /* protects the fields below */
+    pthread_once_t      once;
+    pthread_key_t       key;            /* calls stats_Exit() when a thread exits */
+    BfMThreadStats      *threads;       /* blocks of the running threads */
+    BfMThreadStats      exited;         /* counters of the exited threads */
+} stats = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_ONCE_INIT };
+
+
+/*@
+ * internal function prototypes
+ */
+static void stats_Add(BfMStats *, BfMStats *);
+static void stats_Exit(void *);
+static void stats_CreateKey(void);
+
+
+
+/*@================================
+ * stats_Add()
+ *================================*/
+/*
+ * Function: static void stats_Add(BfMStats *, BfMStats *)
+ *
+ * Description:
+ *  Add the counters of 'from', which its thread may be changing, to 'sum'.
+ *
+ * Returns:
+ *  None
+ */
+static void stats_Add(
+    BfMStats            *sum,           /* INOUT sum */
+    BfMStats            *from)          /* IN counters added */
+{
+    Four                i;
+
+
+    for (i = 0; i < NUM_COUNTERS; i++)
+        ((UEight *)sum)[i] += __atomic_load_n(&((UEight *)from)[i], __ATOMIC_RELAXED);
+
+} /* stats_Add() */
+
+
+
+/*@================================
+ * stats_Exit()
+ *================================*/
+/*
+ * Function: static void stats_Exit(void *)
+ *
+ * Description:
+ *  Move the counters of an exiting thread to the counters of the exited
+ *  threads and free its block.
+ *
+ * Returns:
+ *  None
+ */
+static void stats_Exit(
+    void                *arg)           /* IN block of the thread */
+{
+    BfMThreadStats      *t = (BfMThreadStats *)arg;
+    Four                type;
+
+
+    pthread_mutex_lock(&stats.mutex);
+
+    for (type = 0; type < NUM_BUF_TYPES; type++)
+        stats_Add(&stats.exited.pool[type], &t->pool[type]);
+
+    if (t->prev != NULL) t->prev->next = t->next;
+    else stats.threads = t->next;
+    if (t->next != NULL) t->next->prev = t->prev;
+
+    pthread_mutex_unlock(&stats.mutex);
+
+    free(t);
+
+} /* stats_Exit() */
+
+
+
+/*@================================
+ * stats_CreateKey()
+ *================================*/
+/*
+ * Function: static void stats_CreateKey(void)
+ *
+ * Description:
+ *  Create the key whose destructor is called when a thread exits.
+ *
+ * Returns:
+ *  None
+ */
+static void stats_CreateKey(void)
+{
+    (void) pthread_key_create(&stats.key, stats_Exit);
+
+} /* stats_CreateKey() */
+
+
+
+/*@================================
+ * edubfm_NewThreadStats()
+ *================================*/
+/*
+ * Function: BfMThreadStats *edubfm_NewThreadStats(void)
+ *
+ * Description:
+ *  Allocate the counter block of the calling thread at its first count.
+ *  If the memory is not available, the thread counts in the counters of
+ *  the exited threads, where counts made at the same time may be lost.
+ *
+ * Returns:
+ *  counter block of the calling thread
+ */
+BfMThreadStats *edubfm_NewThreadStats(void)
+{
+    BfMThreadStats      *t;
+
+
+    pthread_once(&stats.once, stats_CreateKey);
+
+    t = (BfMThreadStats *)malloc(sizeof(BfMThreadStats));
+    if (t == NULL) return(&stats.exited);
+    memset(t, 0, sizeof(BfMThreadStats));
+
+    pthread_mutex_lock(&stats.mutex);
+    t->prev = NULL;
+    t->next = stats.threads;
+    if (stats.threads != NULL) stats.threads->prev = t;
+    stats.threads = t;
+    pthread_mutex_unlock(&stats.mutex);
+
+    (void) pthread_setspecific(stats.key, t);
+    edubfm_myStats = t;
+
+    return(t);
+
+} /* edubfm_NewThreadStats() */
+
+
+
+/*@================================
+ * edubfm_SumStats()
+ *================================*/
+/*
+ * Function: void edubfm_SumStats(Four, BfMStats *)
+ *
+ * Description:
+ *  Add up the counters of a buffer pool kept by all the threads.
+ *
+ * Returns:
+ *  None
+ *
+ * Side effects:
+ *  1) parameter sum
+ *     statistics of the buffer pool
+ */
+void edubfm_SumStats(
+    Four                type,           /* IN buffer type */
+    BfMStats            *sum)           /* OUT statistics */
+{
+    BfMThreadStats      *t;
+
+
+    memset(sum, 0, sizeof(BfMStats));
+
+    pthread_mutex_lock(&stats.mutex);
+
+    stats_Add(sum, &stats.exited.pool[type]);
+    for (t = stats.threads; t != NULL; t = t->next)
+        stats_Add(sum, &t->pool[type]);
+
+    pthread_mutex_unlock(&stats.mutex);
+
+} /* edubfm_SumStats() */
+
+
+
+/*@================================
+ * edubfm_Now()
+ *================================*/
+/*
+ * Function: UEight edubfm_Now(void)
+ *
+ * Description:
+ *  Return the time of a monotonic clock for measuring latencies.
+ *
+ * Returns:
+ *  time in nanoseconds
+ */
+UEight edubfm_Now(void)
+{
+    struct timespec     ts;
+
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return((UEight)ts.tv_sec * 1000000000 + ts.tv_nsec);
+
+} /* edubfm_Now() */
+
+
+
+/*@================================
+ * edubfm_SampleStart()
+ *================================*/
+/*
+ * Function: UEight edubfm_SampleStart(void)
+ *
+ * Description:
+ *  Return the time a call of EduBfM_GetTrain() starts if the call is one
+ *  of the BFM_GETTRAIN_SAMPLE calls of the thread whose latency is
+ *  measured.
+ *
+ * Returns:
+ *  time in nanoseconds, or 0 if the latency of the call is not measured
+ */
+UEight edubfm_SampleStart(void)
+{
+    BfMThreadStats      *t = edubfm_myStats;
+
+
+    if (t == NULL) t = edubfm_NewThreadStats();
+
+    if (--t->nUntilSample > 0) return(0);
+    t->nUntilSample = BFM_GETTRAIN_SAMPLE;
+
+    return(edubfm_Now());
+
+} /* edubfm_SampleStart() */
+
+
+
+/*@================================
+ * edubfm_CountValue()
+ *================================*/
+/*
+ * Function: void edubfm_CountValue(UEight *, UEight)
+ *
+ * Description:
+ *  Count the value in its bucket of a histogram of the calling thread
+ *  (see BFM_NUM_HIST_BUCKETS).
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_CountValue(
+    UEight              *hist,          /* INOUT histogram of the calling thread */
+    UEight              value)          /* IN value counted */
+{
+    Four                b;
+
+
+    b = (value < 2) ? 0 : 63 - __builtin_clzll(value);
+    if (b >= BFM_NUM_HIST_BUCKETS) b = BFM_NUM_HIST_BUCKETS - 1;
+
+    __atomic_store_n(&hist[b], __atomic_load_n(&hist[b], __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+
+} /* edubfm_CountValue() */
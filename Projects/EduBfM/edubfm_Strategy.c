@@ -0,0 +1,217 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Strategy.c
+ *
+ * Description:
+ *  Rings of buffers recycled by the access strategies of bulk scans.
+ *  A scan reading every page of a file once would otherwise take a new
+ *  buffer from the buffer replacement policy on every miss and push the
+ *  working set of the other transactions out of the pool. With an access
+ *  strategy, the train missed by the scan is loaded into the buffer the
+ *  scan used a ring ago, as long as no one else has used that buffer in
+ *  the meantime; the buffers loaded by the scan are not marked referenced.
+ *  So the scan keeps at most a ring of buffers, which the replacement
+ *  policy also finds cold if it needs them.
+ *
+ * Exports:
+ *  Four edubfm_RingAlloc(BfMAccessStrategy *)
+ *  void edubfm_RingAdd(BfMAccessStrategy *, Four)
+ *  Boolean edubfm_RingHit(BfMAccessStrategy *, Four)
+ */
+
+
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+
+/*@================================
+ * edubfm_RingAlloc()
+ *================================*/
+/*
+ * Function: Four edubfm_RingAlloc(BfMAccessStrategy *)
+ *
+ * Description:
+ *  Take the buffer in the current slot of the ring for a new train, in
+ *  the way edubfm_AllocTrain() takes a victim. The buffer is not taken
+ *  if it does not hold the train the strategy loaded into it any more,
+ *  or if it has been referenced or fixed by someone else; the slot is
+ *  emptied then. The caller holds the pool latch, which is released over
+ *  the write-back of a dirty buffer (see edubfm_FlushVictim()).
+ *
+ * Returns:
+ *  1) index of the buffer
+ *  2) NIL if the caller allocates a buffer by edubfm_AllocTrain()
+ *  3) some errors caused by function calls
+ */
+Four edubfm_RingAlloc(
+    BfMAccessStrategy   *strategy)      /* INOUT access strategy */
+{
+    Four                e;              /* error code */
+    Four                type;
+    Four                idx;
+    BfMRingSlot         *slot;
+
+
+    if (strategy == NULL) return(NIL);
+
+    type = strategy->type;
+    slot = &strategy->ring[strategy->current];
+    idx = slot->idx;
+    slot->idx = NIL;
+
+    if (idx == NIL || idx >= BE_NBUFS(type)) return(NIL);
+    if (!EQUALKEY(&BI_KEY(type, idx), &slot->key)) return(NIL);
+
+    /* a buffer used by others stays with the replacement policy */
+    if (BFM_ATOMIC_LOAD(BI_BITS(type, idx)) & REFER) return(NIL);
+    if (!edubfm_ClaimVictim(type, idx)) return(NIL);
+
+    edubfm_WaitWriter(type, idx);
+    if (BFM_ATOMIC_LOAD(BI_BITS(type, idx)) & DIRTY) {
+        e = edubfm_FlushVictim(type, idx);
+        if (e < eNOERROR) {
+            BFM_ATOMIC_ADD(BI_FIXED(type, idx), -1);
+            ERR(e);
+        }
+        BFM_COUNT(type, nVictimFlushes);
+    }
+
+    if (!edubfm_UnmapVictim(type, idx)) return(NIL);
+
+    BE_CLEANED(type, idx) = FALSE;
+    BE_IOSTATE(type, idx) = IO_NONE;
+
+    BE_POLICY(type)->evict(type, idx);
+
+    BI_BITS(type, idx) = ALL_0;
+    SET_NILBFMHASHKEY(BI_KEY(type, idx));
+
+    BFM_COUNT(type, nRingReuses);
+    BFM_COUNT(type, nEvictions);
+
+    return(idx);
+
+} /* edubfm_RingAlloc() */
+
+
+
+/*@================================
+ * edubfm_RingAdd()
+ *================================*/
+/*
+ * Function: void edubfm_RingAdd(BfMAccessStrategy *, Four)
+ *
+ * Description:
+ *  Put the buffer holding a train loaded for the strategy in the current
+ *  slot of the ring and advance the ring. A buffer which was in the slot
+ *  is left to the replacement policy.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_RingAdd(
+    BfMAccessStrategy   *strategy,      /* INOUT access strategy */
+    Four                idx)            /* IN buffer index */
+{
+    BfMRingSlot         *slot = &strategy->ring[strategy->current];
+
+
+    slot->idx = idx;
+    slot->key = BI_KEY(strategy->type, idx);
+    strategy->current = (strategy->current + 1) % strategy->size;
+
+} /* edubfm_RingAdd() */
+
+
+
+/*@================================
+ * edubfm_RingHit()
+ *================================*/
+/*
+ * Function: Boolean edubfm_RingHit(BfMAccessStrategy *, Four)
+ *
+ * Description:
+ *  Tell whether a hit of the strategy on the fixed buffer is a hit on
+ *  its own ring, which must not mark the buffer referenced. A train read
+ *  ahead by EduBfM_PrefetchTrains() and not used yet is put on the ring,
+ *  since the prefetch was made for the scan.
+ *
+ * Returns:
+ *  TRUE if the buffer is on the ring
+ */
+Boolean edubfm_RingHit(
+    BfMAccessStrategy   *strategy,      /* INOUT access strategy (may be NULL) */
+    Four                idx)            /* IN index of the fixed buffer */
+{
+    Four                type;
+    Four                i;
+    One                 state = IO_PREFETCHED;
+
+
+    if (strategy == NULL) return(FALSE);
+
+    type = strategy->type;
+
+    if (BFM_ATOMIC_LOAD(BE_IOSTATE(type, idx)) == IO_PREFETCHED &&
+        BFM_ATOMIC_CAS(BE_IOSTATE(type, idx), state, IO_NONE)) {
+        BFM_COUNT(type, nPrefetchHits);
+        BI_CLEARBITS(type, idx, REFER);
+        edubfm_RingAdd(strategy, idx);
+        return(TRUE);
+    }
+
+    for (i = 0; i < strategy->size; i++)
+        if (strategy->ring[i].idx == idx && EQUALKEY(&strategy->ring[i].key, &BI_KEY(type, idx)))
+            return(TRUE);
+
+    return(FALSE);
+
+} /* edubfm_RingHit() */
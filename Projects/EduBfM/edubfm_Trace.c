@@ -0,0 +1,242 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Trace.c
+ *
+ * Description:
+ *  Trace of the buffer accesses (see EduBfM_SetTrace()).
+ *  EduBfM_GetTrain(), EduBfM_FreeTrain(), and EduBfM_SetDirty() record
+ *  each call as a BfMTraceRecord of eight bytes: the train, the buffer
+ *  type, and the call, after a header giving the sizes of the buffers of
+ *  the pools. The records of all threads go in the order they
+ *  are recorded to a buffer of TRACE_BUFFER_RECORDS records, which is
+ *  written to the trace file when it is full.
+ *  While no trace is captured, a call only tests edubfm_tracing
+ *  (see BFM_TRACE()); a recorded call takes the mutex of the trace.
+ *  The trace is replayed by EduBfM_Sim.
+ *
+ * Exports:
+ *  Four edubfm_StartTrace(char *)
+ *  Four edubfm_StopTrace(void)
+ *  void edubfm_Trace(Four, BfMHashKey *, Four)
+ */
+
+
+#include <stdio.h>
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* # of records written to the trace file at a time */
+#define TRACE_BUFFER_RECORDS    65536
+
+/* TRUE while a trace is captured */
+Four edubfm_tracing = FALSE;
+
+/* trace being captured */
+static struct {
+    pthread_mutex_t     mutex;          /* protects the buffer and the file */
+    FILE                *fp;            /* trace file (NULL if no trace is captured) */
+    Four                nRecords;       /* # of records in the buffer */
+    Boolean             failed;         /* TRUE if a write to the file failed */
+    BfMTraceRecord      records[TRACE_BUFFER_RECORDS];
+} trace = { PTHREAD_MUTEX_INITIALIZER, NULL, 0, FALSE };
+
+
+
+/*@================================
+ * trace_Write()
+ *================================*/
+/*
+ * Function: static void trace_Write(void)
+ *
+ * Description:
+ *  Write the records in the buffer to the trace file.
+ *  The caller holds the mutex of the trace.
+ *
+ * Returns:
+ *  None
+ */
+static void trace_Write(void)
+{
+    if (fwrite(trace.records, sizeof(BfMTraceRecord), trace.nRecords, trace.fp) != (size_t)trace.nRecords)
+        trace.failed = TRUE;
+    trace.nRecords = 0;
+
+} /* trace_Write() */
+
+
+
+/*@================================
+ * edubfm_StartTrace()
+ *================================*/
+/*
+ * Function: Four edubfm_StartTrace(char *)
+ *
+ * Description:
+ *  Start capturing the trace into the file, which is truncated.
+ *  A trace being captured is stopped first.
+ *
+ * Returns:
+ *  error code
+ *    eDEVICEIOERR_EDUBFM - the file cannot be written
+ *    some errors caused by function calls
+ */
+Four edubfm_StartTrace(
+    char                *fileName)      /* IN name of the trace file */
+{
+    Four                e;              /* error code */
+    Four                type;           /* buffer type */
+    BfMTraceHeader      header;
+    FILE                *fp;
+
+
+    e = edubfm_StopTrace();
+    if (e < eNOERROR) ERR(e);
+
+    header.magic = BFM_TRACE_MAGIC;
+    for (type = 0; type < NUM_BUF_TYPES; type++)
+        header.bufSize[type] = (BI_BUFSIZE(type) > 0) ? BI_BUFSIZE(type) : 1;
+
+    fp = fopen(fileName, "wb");
+    if (fp == NULL) ERR(eDEVICEIOERR_EDUBFM);
+    if (fwrite(&header, sizeof(BfMTraceHeader), 1, fp) != 1) {
+        fclose(fp);
+        ERR(eDEVICEIOERR_EDUBFM);
+    }
+
+    pthread_mutex_lock(&trace.mutex);
+    trace.fp = fp;
+    trace.nRecords = 0;
+    trace.failed = FALSE;
+    BFM_ATOMIC_STORE(edubfm_tracing, TRUE);
+    pthread_mutex_unlock(&trace.mutex);
+
+    return(eNOERROR);
+
+} /* edubfm_StartTrace() */
+
+
+
+/*@================================
+ * edubfm_StopTrace()
+ *================================*/
+/*
+ * Function: Four edubfm_StopTrace(void)
+ *
+ * Description:
+ *  Stop capturing the trace, if one is captured, and close the file after
+ *  writing the rest of the records.
+ *
+ * Returns:
+ *  error code
+ *    eDEVICEIOERR_EDUBFM - a write to the file failed
+ */
+Four edubfm_StopTrace(void)
+{
+    Boolean             failed;
+
+
+    pthread_mutex_lock(&trace.mutex);
+
+    if (trace.fp == NULL) {
+        pthread_mutex_unlock(&trace.mutex);
+        return(eNOERROR);
+    }
+
+    BFM_ATOMIC_STORE(edubfm_tracing, FALSE);
+    trace_Write();
+    if (fclose(trace.fp) != 0) trace.failed = TRUE;
+    trace.fp = NULL;
+    failed = trace.failed;
+
+    pthread_mutex_unlock(&trace.mutex);
+
+    if (failed) ERR(eDEVICEIOERR_EDUBFM);
+
+    return(eNOERROR);
+
+} /* edubfm_StopTrace() */
+
+
+
+/*@================================
+ * edubfm_Trace()
+ *================================*/
+/*
+ * Function: void edubfm_Trace(Four, BfMHashKey *, Four)
+ *
+ * Description:
+ *  Record a call in the trace, if one is captured.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_Trace(
+    Four                op,             /* IN BFM_TRACE_xxx */
+    BfMHashKey          *key,           /* IN train */
+    Four                type)           /* IN buffer type */
+{
+    BfMTraceRecord      *r;
+
+
+    pthread_mutex_lock(&trace.mutex);
+
+    if (trace.fp != NULL) {
+        r = &trace.records[trace.nRecords++];
+        r->pageNo = key->pageNo;
+        r->volNo = key->volNo;
+        r->type = (One)type;
+        r->op = (One)op;
+        if (trace.nRecords == TRACE_BUFFER_RECORDS) trace_Write();
+    }
+
+    pthread_mutex_unlock(&trace.mutex);
+
+} /* edubfm_Trace() */
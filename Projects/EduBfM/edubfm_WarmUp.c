@@ -0,0 +1,462 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_WarmUp.c
+ *
+ * Description:
+ *  Warm-up of the buffer pools across restarts (see EduBfM_SetWarmUpFile()).
+ *  EduBfM_FlushAll() saves the keys of the trains resident in the pools,
+ *  with their reference bits, to the warm-up file, and EduBfM_AttachVolume()
+ *  reads the trains of the volume listed in the file back before the
+ *  volume is used, so that the catalog pages and the upper levels of the
+ *  B+-trees are hits from the start.
+ *  The trains are read by EduBfM_PrefetchTrains() in batches as large as
+ *  the read-ahead of the pool allows, sorted by page number so that the
+ *  device sees ascending offsets. If a pool is smaller than it was when
+ *  the file was saved, the referenced trains are read first. A train whose
+ *  reference bit was clear gets it cleared again, so the replacement
+ *  policy evicts it first.
+ *  The file is written under another name and renamed, so a crash while
+ *  it is saved leaves the previous one.
+ *
+ * Exports:
+ *  Four edubfm_SetWarmUpFile(char *)
+ *  Four edubfm_SaveWarmUp(void)
+ *  Four edubfm_LoadWarmUp(VolNo)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* first word of a warm-up file */
+#define WARMUP_MAGIC            0x42664d57
+
+/* suffix of the name under which the warm-up file is written */
+#define WARMUP_TMP_SUFFIX       ".tmp"
+
+/* type definition for a train listed in the warm-up file */
+typedef struct {
+    BfMHashKey  key;            /* train */
+    One         type;           /* buffer type */
+    One         bits;           /* REFER bit of the buffer */
+} WarmUpEntry;
+
+/* warm-up file */
+static struct {
+    pthread_mutex_t     mutex;          /* serializes the saves and loads */
+    char                *fileName;      /* name of the file (NULL: no warm-up) */
+} warmUp = { PTHREAD_MUTEX_INITIALIZER, NULL };
+
+
+
+/*@================================
+ * warmUp_Compare()
+ *================================*/
+/*
+ * Function: static int warmUp_Compare(const void *, const void *)
+ *
+ * Description:
+ *  qsort() comparison of two entries by buffer type, volume number, and
+ *  page number.
+ *
+ * Returns:
+ *  <0, 0, >0 as the first entry is before, equal to, or after the second
+ */
+static int warmUp_Compare(
+    const void          *a,             /* IN entry */
+    const void          *b)             /* IN entry */
+{
+    const WarmUpEntry   *x = (const WarmUpEntry *)a;
+    const WarmUpEntry   *y = (const WarmUpEntry *)b;
+
+
+    if (x->type != y->type) return(x->type - y->type);
+    if (x->key.volNo != y->key.volNo) return(x->key.volNo - y->key.volNo);
+    if (x->key.pageNo != y->key.pageNo) return((x->key.pageNo < y->key.pageNo) ? -1 : 1);
+
+    return(0);
+
+} /* warmUp_Compare() */
+
+
+
+/*@================================
+ * warmUp_Read()
+ *================================*/
+/*
+ * Function: static Four warmUp_Read(Four *, WarmUpEntry **)
+ *
+ * Description:
+ *  Read the entries of the warm-up file into an array allocated by
+ *  malloc(). A missing file has no entries.
+ *  The caller holds the mutex of the warm-up.
+ *
+ * Returns:
+ *  error code
+ *    eBADWARMUPFILE_EDUBFM - the file is not a warm-up file
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+static Four warmUp_Read(
+    Four                *nEntries,      /* OUT # of entries */
+    WarmUpEntry         **entries)      /* OUT entries */
+{
+    FILE                *fp;
+    Four                header[2];      /* magic and # of entries */
+    Four                i;
+
+
+    *nEntries = 0;
+    *entries = NULL;
+
+    fp = fopen(warmUp.fileName, "rb");
+    if (fp == NULL) return(eNOERROR);
+
+    if (fread(header, sizeof(Four), 2, fp) != 2 || header[0] != WARMUP_MAGIC || header[1] < 0) {
+        fclose(fp);
+        ERR(eBADWARMUPFILE_EDUBFM);
+    }
+
+    *entries = (WarmUpEntry *)malloc(sizeof(WarmUpEntry) * (header[1] > 0 ? header[1] : 1));
+    if (*entries == NULL) {
+        fclose(fp);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    if (fread(*entries, sizeof(WarmUpEntry), header[1], fp) != (size_t)header[1]) {
+        free(*entries);
+        *entries = NULL;
+        fclose(fp);
+        ERR(eBADWARMUPFILE_EDUBFM);
+    }
+    fclose(fp);
+
+    for (i = 0; i < header[1]; i++)
+        if (IS_BAD_BUFFERTYPE((*entries)[i].type)) {
+            free(*entries);
+            *entries = NULL;
+            ERR(eBADWARMUPFILE_EDUBFM);
+        }
+
+    *nEntries = header[1];
+
+    return(eNOERROR);
+
+} /* warmUp_Read() */
+
+
+
+/*@================================
+ * warmUp_Pool()
+ *================================*/
+/*
+ * Function: static Four warmUp_Pool(Four, WarmUpEntry *, Four)
+ *
+ * Description:
+ *  Read the trains of the entries, all of the given buffer type and
+ *  volume, into the pool, and restore their reference bits.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+static Four warmUp_Pool(
+    Four                type,           /* IN buffer type */
+    WarmUpEntry         *entries,       /* INOUT entries of the volume */
+    Four                n)              /* IN # of entries */
+{
+    Four                e;              /* error code */
+    Four                i, j;
+    Four                index;          /* index of the buffer pool */
+    Four                batch;          /* # of trains read at a time */
+    TrainID             *trainIds;
+    WarmUpEntry         tmp;
+
+
+    if (!IS_POOL_INITIALIZED(type)) {
+        e = edubfm_InitPool(type);
+        if (e < eNOERROR) ERR(e);
+    }
+
+    /* keep the referenced trains if the pool cannot hold all of them */
+    if (n > BE_NBUFS(type)) {
+        for (i = 0, j = 0; i < n; i++)
+            if (entries[i].bits & REFER) {
+                tmp = entries[j]; entries[j] = entries[i]; entries[i] = tmp;
+                j++;
+            }
+        n = BE_NBUFS(type);
+    }
+    qsort(entries, n, sizeof(WarmUpEntry), warmUp_Compare);
+
+    trainIds = (TrainID *)malloc(sizeof(TrainID) * (n > 0 ? n : 1));
+    if (trainIds == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    for (i = 0; i < n; i++) {
+        trainIds[i].volNo = entries[i].key.volNo;
+        trainIds[i].pageNo = entries[i].key.pageNo;
+    }
+
+    /* EduBfM_PrefetchTrains() reads this many trains at a time */
+    batch = (BE_NBUFS(type) / 2 < BFM_MAX_PREFETCHES) ? BE_NBUFS(type) / 2 : BFM_MAX_PREFETCHES;
+    if (batch < 1) batch = 1;
+
+    for (i = 0; i < n; i += batch) {
+        e = EduBfM_PrefetchTrains(&trainIds[i], (n - i < batch) ? n - i : batch, type);
+        if (e < eNOERROR) {
+            free(trainIds);
+            ERR(e);
+        }
+
+        BFM_LATCH(type);
+        edubfm_ReapPrefetches(type, TRUE);
+        BFM_UNLATCH(type);
+    }
+    free(trainIds);
+
+    BFM_LATCH(type);
+    for (i = 0; i < n; i++) {
+        if (entries[i].bits & REFER) continue;
+        index = edubfm_LookUp(&entries[i].key, type);
+        if (index != NOTFOUND_IN_HTABLE && BE_IOSTATE(type, index) == IO_PREFETCHED)
+            BI_BITS(type, index) &= ~REFER;
+    }
+    BFM_UNLATCH(type);
+
+    return(eNOERROR);
+
+} /* warmUp_Pool() */
+
+
+
+/*@================================
+ * edubfm_SetWarmUpFile()
+ *================================*/
+/*
+ * Function: Four edubfm_SetWarmUpFile(char *)
+ *
+ * Description:
+ *  Set the name of the warm-up file; NULL turns the warm-up off.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_SetWarmUpFile(
+    char                *fileName)      /* IN name of the file or NULL */
+{
+    char                *copy = NULL;
+
+
+    if (fileName != NULL) {
+        copy = strdup(fileName);
+        if (copy == NULL) ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+
+    pthread_mutex_lock(&warmUp.mutex);
+    free(warmUp.fileName);
+    warmUp.fileName = copy;
+    pthread_mutex_unlock(&warmUp.mutex);
+
+    return(eNOERROR);
+
+} /* edubfm_SetWarmUpFile() */
+
+
+
+/*@================================
+ * edubfm_SaveWarmUp()
+ *================================*/
+/*
+ * Function: Four edubfm_SaveWarmUp(void)
+ *
+ * Description:
+ *  Save the trains resident in the initialized pools to the warm-up
+ *  file, if there is one.
+ *
+ * Returns:
+ *  error code
+ *    eDEVICEIOERR_EDUBFM - the file cannot be written
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ */
+Four edubfm_SaveWarmUp(void)
+{
+    Four                e = eNOERROR;   /* error code */
+    Four                type;           /* buffer type */
+    Four                i;
+    Four                header[2];      /* magic and # of entries */
+    char                *tmpName;
+    FILE                *fp;
+    WarmUpEntry         entry;
+
+
+    pthread_mutex_lock(&warmUp.mutex);
+
+    if (warmUp.fileName == NULL) {
+        pthread_mutex_unlock(&warmUp.mutex);
+        return(eNOERROR);
+    }
+
+    tmpName = (char *)malloc(strlen(warmUp.fileName) + sizeof(WARMUP_TMP_SUFFIX));
+    if (tmpName == NULL) {
+        pthread_mutex_unlock(&warmUp.mutex);
+        ERR(eMEMORYALLOCERR_EDUBFM);
+    }
+    strcpy(tmpName, warmUp.fileName);
+    strcat(tmpName, WARMUP_TMP_SUFFIX);
+
+    fp = fopen(tmpName, "wb");
+    if (fp == NULL) {
+        free(tmpName);
+        pthread_mutex_unlock(&warmUp.mutex);
+        ERR(eDEVICEIOERR_EDUBFM);
+    }
+
+    /* the # of entries is written when it is known */
+    header[0] = WARMUP_MAGIC;
+    header[1] = 0;
+    if (fwrite(header, sizeof(Four), 2, fp) != 2) e = eDEVICEIOERR_EDUBFM;
+
+    for (type = 0; type < NUM_BUF_TYPES && e >= eNOERROR; type++) {
+        if (!IS_POOL_INITIALIZED(type)) continue;
+
+        BFM_LATCH(type);
+        for (i = 0; i < BE_NBUFS(type); i++) {
+            if (IS_NILBFMHASHKEY(BI_KEY(type, i))) continue;
+
+            memset(&entry, 0, sizeof(WarmUpEntry));
+            entry.key = BI_KEY(type, i);
+            entry.type = (One)type;
+            entry.bits = (One)(BI_BITS(type, i) & REFER);
+            if (fwrite(&entry, sizeof(WarmUpEntry), 1, fp) != 1) {
+                e = eDEVICEIOERR_EDUBFM;
+                break;
+            }
+            header[1]++;
+        }
+        BFM_UNLATCH(type);
+    }
+
+    if (e >= eNOERROR && (fseek(fp, 0, SEEK_SET) != 0 || fwrite(header, sizeof(Four), 2, fp) != 2))
+        e = eDEVICEIOERR_EDUBFM;
+    if (fclose(fp) != 0) e = eDEVICEIOERR_EDUBFM;
+    if (e >= eNOERROR && rename(tmpName, warmUp.fileName) != 0) e = eDEVICEIOERR_EDUBFM;
+    if (e < eNOERROR) remove(tmpName);
+
+    free(tmpName);
+    pthread_mutex_unlock(&warmUp.mutex);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_SaveWarmUp() */
+
+
+
+/*@================================
+ * edubfm_LoadWarmUp()
+ *================================*/
+/*
+ * Function: Four edubfm_LoadWarmUp(VolNo)
+ *
+ * Description:
+ *  Read the trains of the attached volume listed in the warm-up file, if
+ *  there is one, into their pools.
+ *
+ * Returns:
+ *  error code
+ *    eBADWARMUPFILE_EDUBFM - the file is not a warm-up file
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    some errors caused by function calls
+ */
+Four edubfm_LoadWarmUp(
+    VolNo               volNo)          /* IN volume number */
+{
+    Four                e;              /* error code */
+    Four                type;           /* buffer type */
+    Four                i, n;
+    Four                nEntries;
+    WarmUpEntry         *entries;
+    WarmUpEntry         *selected;      /* entries of a pool on the volume */
+
+
+    pthread_mutex_lock(&warmUp.mutex);
+
+    if (warmUp.fileName == NULL) {
+        pthread_mutex_unlock(&warmUp.mutex);
+        return(eNOERROR);
+    }
+
+    e = warmUp_Read(&nEntries, &entries);
+    if (e < eNOERROR) {
+        pthread_mutex_unlock(&warmUp.mutex);
+        ERR(e);
+    }
+
+    selected = (WarmUpEntry *)malloc(sizeof(WarmUpEntry) * (nEntries > 0 ? nEntries : 1));
+    if (selected == NULL) e = eMEMORYALLOCERR_EDUBFM;
+
+    for (type = 0; type < NUM_BUF_TYPES && e >= eNOERROR; type++) {
+        for (i = 0, n = 0; i < nEntries; i++)
+            if (entries[i].type == type && entries[i].key.volNo == volNo) selected[n++] = entries[i];
+        if (n > 0) e = warmUp_Pool(type, selected, n);
+    }
+
+    free(selected);
+    free(entries);
+    pthread_mutex_unlock(&warmUp.mutex);
+    if (e < eNOERROR) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubfm_LoadWarmUp() */
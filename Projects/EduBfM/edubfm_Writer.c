@@ -0,0 +1,402 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_Writer.c
+ *
+ * Description:
+ *  Background writer which writes dirty buffers out ahead of the clock
+ *  hand so that a miss seldom has to write its victim before reading.
+ *  The writer serves the buffer pools whose dirtyHigh is not 0. When the
+ *  percentage of dirty buffers in a pool reaches dirtyHigh, it writes the
+ *  unfixed dirty buffers in the order the hand will visit them until the
+ *  percentage falls to dirtyLow. It wakes up periodically and whenever
+ *  EduBfM_SetDirty() finds the pool at its high watermark.
+ *
+ *  The writer copies up to WRITER_BATCH buffers and clears their dirty
+ *  bits while holding the pool latch, marking them IO_WRITING, and after
+ *  releasing it submits the writes of the copies to the I/O engine
+ *  together. A buffer being written is not replaced or flushed by the
+ *  foreground until its write completes (edubfm_WaitWriter()).
+ *
+ * Exports:
+ *  Four edubfm_StartWriter(void)
+ *  void edubfm_StopWriter(void)
+ *  void edubfm_KickWriter(Four)
+ *  void edubfm_WaitWriter(Four, Four)
+ */
+
+
+#include <stdlib.h> /* for malloc & free */
+#include <string.h> /* for memcpy */
+#include <time.h>
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* interval of the periodic wake-ups in milliseconds */
+#define WRITER_INTERVAL_MSEC    20
+
+/* maximum # of buffers written together */
+#define WRITER_BATCH            16
+
+/* state of the background writer */
+static struct {
+    pthread_t           thread;
+    Boolean             running;        /* TRUE if the thread exists */
+    Boolean             stop;           /* the thread is asked to exit */
+    Boolean             kicked;         /* the thread is asked to look at the pools */
+    pthread_mutex_t     mutex;          /* protects stop and kicked */
+    pthread_cond_t      wakeUp;
+    Boolean             cleaning[NUM_BUF_TYPES];  /* the pool is between the watermarks, going down */
+    Four                nWriting[NUM_BUF_TYPES];  /* # of buffers IO_WRITING (protected by the pool latch) */
+    char                *buf;           /* copies of the buffers being written */
+    Four                idx[WRITER_BATCH];              /* buffers being written */
+    BfMIORequest        reqs[WRITER_BATCH];
+    struct iovec        iov[WRITER_BATCH];
+} writer = {
+    0, FALSE, FALSE, FALSE, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+    { FALSE, FALSE }, { 0, 0 }, NULL
+};
+
+
+
+/*@================================
+ * writer_Clean()
+ *================================*/
+/*
+ * Function: static void writer_Clean(Four)
+ *
+ * Description:
+ *  Write dirty buffers of the pool if it is over its high watermark,
+ *  until it is at its low watermark.
+ *
+ * Returns:
+ *  None
+ */
+static void writer_Clean(
+    Four                type)           /* IN buffer type */
+{
+    Four                idx, n, k, nBatch;
+    Four                start, end;     /* buffers up to the hand or the end of the pool */
+    size_t              len = (size_t)PAGESIZE * BI_BUFSIZE(type);   /* room for a train on the buffer */
+    BfMDevice           *dev;
+    BfMIORequest        *reqs[WRITER_BATCH];
+    BfMIOBatch          batch;
+
+
+    pthread_mutex_lock(&BE_LATCH(type));
+
+    if (BE_NDIRTY(type) * 100 >= BE_CFG(type).dirtyHigh * BE_NBUFS(type))
+        writer.cleaning[type] = TRUE;
+
+    for (n = 0; writer.cleaning[type] && n < BE_NBUFS(type); ) {
+
+        /* copy a batch of buffers in the order the hand will visit them */
+        for (nBatch = 0; nBatch < WRITER_BATCH && n < BE_NBUFS(type); n++) {
+
+            if (BE_NDIRTY(type) * 100 <= BE_CFG(type).dirtyLow * BE_NBUFS(type)) {
+                writer.cleaning[type] = FALSE;
+                break;
+            }
+
+            /* skip to the next buffer on the dirty map before the hand comes back */
+            start = (BE_NEXTVICTIM(type) + n) % BE_NBUFS(type);
+            end = (start < BE_NEXTVICTIM(type)) ? BE_NEXTVICTIM(type) : BE_NBUFS(type);
+            idx = edubfm_NextDirty(type, start, end);
+            if (idx == NIL) {
+                n += end - start - 1;
+                continue;
+            }
+            n += idx - start;
+
+            if (!(BI_BITS(type, idx) & DIRTY) || BI_FIXED(type, idx) != 0) continue;
+            if (BE_IOSTATE(type, idx) != IO_NONE) continue;
+            if ((dev = edubfm_FindDevice(BI_KEY(type, idx).volNo)) == NULL) continue;
+
+            /* clear the bit first so that an update made during the copy is kept */
+            (void) edubfm_MarkClean(type, idx);
+
+            writer.idx[nBatch] = idx;
+            writer.iov[nBatch].iov_base = writer.buf + len * nBatch;
+            writer.iov[nBatch].iov_len = (size_t)PAGESIZE * edubfm_TrainPages(type, dev->volNo);
+            memcpy(writer.iov[nBatch].iov_base, BI_BUFFER(type, idx), writer.iov[nBatch].iov_len);
+            writer.reqs[nBatch].op = BFM_IO_WRITE;
+            writer.reqs[nBatch].type = type;
+            writer.reqs[nBatch].fd = edubfm_DeviceFd(dev, type);
+            writer.reqs[nBatch].offset = (off_t)BI_KEY(type, idx).pageNo * PAGESIZE;
+            writer.reqs[nBatch].iov = &writer.iov[nBatch];
+            writer.reqs[nBatch].nIov = 1;
+            reqs[nBatch] = &writer.reqs[nBatch];
+
+            BFM_ATOMIC_STORE(BE_IOSTATE(type, idx), IO_WRITING);
+            nBatch++;
+        }
+        if (nBatch == 0) break;
+        writer.nWriting[type] = nBatch;
+
+        pthread_mutex_unlock(&BE_LATCH(type));
+        edubfm_IOBatchInit(&batch);
+        for (k = 0; k < nBatch; k++) edubfm_IOBatchAdd(&batch, reqs[k]);
+        edubfm_IOSubmit(reqs, nBatch);
+        (void) edubfm_IOBatchWait(&batch);
+        pthread_mutex_lock(&BE_LATCH(type));
+
+        for (k = 0; k < nBatch; k++) {
+            idx = writer.idx[k];
+            BFM_ATOMIC_STORE(BE_IOSTATE(type, idx), IO_NONE);
+
+            /* the buffer may have been dirtied again during the write */
+            if (writer.reqs[k].result < eNOERROR) {
+                (void) edubfm_MarkDirty(type, idx);
+                writer.cleaning[type] = FALSE;
+                continue;
+            }
+
+            BFM_COUNT(type, nWriterFlushes);
+            if (!(BFM_ATOMIC_LOAD(BI_BITS(type, idx)) & DIRTY)) BE_CLEANED(type, idx) = TRUE;
+        }
+        writer.nWriting[type] = 0;
+        pthread_cond_broadcast(&BE_WRITEDONE(type));
+    }
+
+    pthread_mutex_unlock(&BE_LATCH(type));
+
+} /* writer_Clean() */
+
+
+
+/*@================================
+ * writer_Main()
+ *================================*/
+/*
+ * Function: static void *writer_Main(void *)
+ *
+ * Description:
+ *  Body of the background writer thread.
+ *
+ * Returns:
+ *  NULL
+ */
+static void *writer_Main(
+    void                *arg)           /* IN not used */
+{
+    Four                type;
+    struct timespec     ts;
+
+
+    pthread_mutex_lock(&writer.mutex);
+
+    while (!writer.stop) {
+        writer.kicked = FALSE;
+        pthread_mutex_unlock(&writer.mutex);
+
+        for (type = 0; type < NUM_BUF_TYPES; type++)
+            if (BE_WRITERON(type)) writer_Clean(type);
+
+        pthread_mutex_lock(&writer.mutex);
+        if (!writer.stop && !writer.kicked) {
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += WRITER_INTERVAL_MSEC * 1000000L;
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&writer.wakeUp, &writer.mutex, &ts);
+        }
+    }
+
+    pthread_mutex_unlock(&writer.mutex);
+
+    return(NULL);
+
+} /* writer_Main() */
+
+
+
+/*@================================
+ * edubfm_StartWriter()
+ *================================*/
+/*
+ * Function: Four edubfm_StartWriter(void)
+ *
+ * Description:
+ *  Start the background writer if a buffer pool is configured to use it
+ *  and it is not running.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_EDUBFM - memory allocation failed
+ *    eTHREADCREATEERR_EDUBFM - the thread cannot be created
+ */
+Four edubfm_StartWriter(void)
+{
+    Four                type;
+    Four                maxBufSize = 0;
+
+
+    if (writer.running) return(eNOERROR);
+
+    for (type = 0; type < NUM_BUF_TYPES; type++)
+        if (IS_POOL_INITIALIZED(type) && BE_CFG(type).dirtyHigh > 0 && BI_BUFSIZE(type) > maxBufSize)
+            maxBufSize = BI_BUFSIZE(type);
+
+    if (maxBufSize == 0) return(eNOERROR);
+
+    /* the copies are aligned for the direct I/O (BfMConfig.directIO) */
+    if (posix_memalign((void **)&writer.buf, PAGESIZE, (size_t)PAGESIZE * maxBufSize * WRITER_BATCH) != 0)
+        ERR(eMEMORYALLOCERR_EDUBFM);
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) {
+        BE_WRITERON(type) = (IS_POOL_INITIALIZED(type) && BE_CFG(type).dirtyHigh > 0);
+        writer.cleaning[type] = FALSE;
+    }
+    writer.stop = FALSE;
+    writer.kicked = FALSE;
+
+    if (pthread_create(&writer.thread, NULL, writer_Main, NULL) != 0) {
+        for (type = 0; type < NUM_BUF_TYPES; type++) BE_WRITERON(type) = FALSE;
+        free(writer.buf);
+        writer.buf = NULL;
+        ERR(eTHREADCREATEERR_EDUBFM);
+    }
+    writer.running = TRUE;
+
+    return(eNOERROR);
+
+} /* edubfm_StartWriter() */
+
+
+
+/*@================================
+ * edubfm_StopWriter()
+ *================================*/
+/*
+ * Function: void edubfm_StopWriter(void)
+ *
+ * Description:
+ *  Stop the background writer and wait for it to exit.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_StopWriter(void)
+{
+    Four                type;
+
+
+    if (!writer.running) return;
+
+    pthread_mutex_lock(&writer.mutex);
+    writer.stop = TRUE;
+    pthread_cond_signal(&writer.wakeUp);
+    pthread_mutex_unlock(&writer.mutex);
+
+    pthread_join(writer.thread, NULL);
+    writer.running = FALSE;
+
+    for (type = 0; type < NUM_BUF_TYPES; type++) BE_WRITERON(type) = FALSE;
+    free(writer.buf);
+    writer.buf = NULL;
+
+} /* edubfm_StopWriter() */
+
+
+
+/*@================================
+ * edubfm_KickWriter()
+ *================================*/
+/*
+ * Function: void edubfm_KickWriter(Four)
+ *
+ * Description:
+ *  Wake the background writer up if the pool is at its high watermark.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_KickWriter(
+    Four                type)           /* IN buffer type */
+{
+    if (!BE_WRITERON(type)) return;
+    if (BE_NDIRTY(type) * 100 < BE_CFG(type).dirtyHigh * BE_NBUFS(type)) return;
+
+    pthread_mutex_lock(&writer.mutex);
+    writer.kicked = TRUE;
+    pthread_cond_signal(&writer.wakeUp);
+    pthread_mutex_unlock(&writer.mutex);
+
+} /* edubfm_KickWriter() */
+
+
+
+/*@================================
+ * edubfm_WaitWriter()
+ *================================*/
+/*
+ * Function: void edubfm_WaitWriter(Four, Four)
+ *
+ * Description:
+ *  Wait until the background writer is not writing the buffer 'idx' of
+ *  the pool, nor is it written back as a victim (see edubfm_FlushVictim()).
+ *  If 'idx' is NIL, wait until no I/O of the pool is in flight without
+ *  the pool latch: no write of the writer, no write-back of a victim, and
+ *  no read of a miss (see EduBfM_GetTrainWithStrategy()).
+ *  The caller holds the pool latch, which is released while it waits.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_WaitWriter(
+    Four                type,           /* IN buffer type */
+    Four                idx)            /* IN buffer index or NIL */
+{
+    while ((idx == NIL) ? writer.nWriting[type] > 0 || BE_NIOS(type) > 0 : BE_IOSTATE(type, idx) == IO_WRITING)
+        pthread_cond_wait(&BE_WRITEDONE(type), &BE_LATCH(type));
+
+} /* edubfm_WaitWriter() */
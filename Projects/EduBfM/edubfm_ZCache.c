@@ -0,0 +1,522 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubfm_ZCache.c
+ *
+ * Description:
+ *  Compressed cache of the trains evicted from the buffer pools (see
+ *  EduBfM_SetCompressedCache()). A train is compressed when it is evicted
+ *  clean, or after its dirty image is written (see edubfm_AllocTrain()),
+ *  and a miss looks it up before reading the disk (see edubfm_ReadTrain()).
+ *  The cache is exclusive: a train found is taken out of it, and a train
+ *  read ahead by EduBfM_PrefetchTrains() is dropped from it, so that a
+ *  train is never both in a buffer pool and in the cache and the image in
+ *  the cache is always the one on the disk.
+ *  The images are kept on an LRU list of a ghost directory keyed by the
+ *  trains, whose second list remembers the trains dropped from the cache
+ *  lately. The cache may take the memory of its budget, but keeps its
+ *  images within a target which follows the hit rate: every
+ *  ZCACHE_INTERVAL lookups, the target grows by a step if misses on
+ *  trains dropped lately, i.e. ghost hits, show that more room would
+ *  have paid, and shrinks by a step if few lookups hit, giving back the
+ *  memory and the work of compressing trains nobody asks for again.
+ *  The cache is shared by the buffer pools and protected by its mutex;
+ *  the trains are compressed and decompressed outside it.
+ *
+ * Exports:
+ *  Four edubfm_SetZCache(Four)
+ *  void edubfm_ZCacheInsert(Four, BfMHashKey *, char *)
+ *  Boolean edubfm_ZCacheLookUp(Four, BfMHashKey *, char *)
+ *  void edubfm_ZCacheDelete(BfMHashKey *)
+ *  void edubfm_ZCacheClear(void)
+ *  void edubfm_ZCacheUsage(Four *, Eight *, Eight *)
+ */
+
+
+#include <stdlib.h> /* for malloc, realloc & free */
+#include <stdint.h> /* for intptr_t */
+#include "EduBfM_common.h"
+#include "EduBfM_Internal.h"
+
+
+/* lists of the ghost directory of the cache */
+#define ZCACHE_RESIDENT         0       /* trains whose images are kept */
+#define ZCACHE_GHOST            1       /* trains dropped lately */
+
+/* words of auxiliary data of a resident train: image, and length << 8 | buffer type */
+#define ZCACHE_AUX_LEN          2
+
+/* a train is kept only if its image takes at most this % of the train */
+#define ZCACHE_MAX_PERCENT      75
+
+/* the directory holds as many trains as images of PAGESIZE/ZCACHE_MIN_RATIO bytes fill the budget */
+#define ZCACHE_MIN_RATIO        16
+
+/* # of lookups between two adaptations of the target */
+#define ZCACHE_INTERVAL         1024
+
+/* the target moves by 1/ZCACHE_STEPS of the budget at a time, down to 1/ZCACHE_MIN_SHARE */
+#define ZCACHE_STEPS            16
+#define ZCACHE_MIN_SHARE        16
+
+/* the target grows after ZCACHE_GROW_HITS ghost hits, and shrinks if
+ * fewer than 1/ZCACHE_SHRINK_RATIO of the lookups hit
+ */
+#define ZCACHE_GROW_HITS        8
+#define ZCACHE_SHRINK_RATIO     32
+
+/* compressed cache */
+static struct {
+    pthread_mutex_t     mutex;          /* protects the cache */
+    Eight               budget;         /* bytes the images may take at most (0: no cache) */
+    Eight               target;         /* bytes the images may take now */
+    Eight               bytes;          /* bytes taken by the images */
+    Four                nLookups;       /* lookups since the last adaptation */
+    Four                nHits;          /* hits since the last adaptation */
+    Four                nGhostHits;     /* ghost hits since the last adaptation */
+    BfMGhostDir         dir;            /* resident trains and trains dropped lately */
+} zc = { PTHREAD_MUTEX_INITIALIZER, 0 };
+
+
+/*@
+ * macro definitions
+ */
+
+/* Macro: ZCACHE_IMAGE(node)
+ * Description: return the image of a resident train
+ * Parameters:
+ *  Four node       : node of the train
+ * Returns: (char *) image
+ */
+#define ZCACHE_IMAGE(node)      ((char *)(intptr_t)GHOST_AUX(&zc.dir, node)[0])
+
+/* Macro: ZCACHE_LENGTH(node), ZCACHE_TYPE(node)
+ * Description: return the length of the image and the buffer type of a resident train
+ * Parameters:
+ *  Four node       : node of the train
+ * Returns: (Four)
+ */
+#define ZCACHE_LENGTH(node)     ((Four)(GHOST_AUX(&zc.dir, node)[1] >> 8))
+#define ZCACHE_TYPE(node)       ((Four)(GHOST_AUX(&zc.dir, node)[1] & 0xff))
+
+
+
+/*@================================
+ * zcache_Drop()
+ *================================*/
+/*
+ * Function: static void zcache_Drop(Four, Boolean)
+ *
+ * Description:
+ *  Free the image of a resident train and forget the train, or remember
+ *  it as dropped lately if 'ghost' is TRUE.
+ *  The caller holds the mutex of the cache.
+ *
+ * Returns:
+ *  None
+ */
+static void zcache_Drop(
+    Four                node,           /* IN node of the train */
+    Boolean             ghost)          /* IN TRUE to remember the train */
+{
+    BfMHashKey          key;
+
+
+    free(ZCACHE_IMAGE(node));
+    zc.bytes -= ZCACHE_LENGTH(node);
+
+    key = zc.dir.map.key[node];
+    edubfm_GhostDelete(&zc.dir, node);
+    if (ghost) (void) edubfm_GhostInsert(&zc.dir, ZCACHE_GHOST, &key);
+
+} /* zcache_Drop() */
+
+
+
+/*@================================
+ * zcache_Fit()
+ *================================*/
+/*
+ * Function: static void zcache_Fit(Eight)
+ *
+ * Description:
+ *  Drop the least recent trains until the images leave room for 'len'
+ *  bytes within the target, and the directory has a free node. The
+ *  ghosts are kept as many as the resident trains.
+ *  The caller holds the mutex of the cache.
+ *
+ * Returns:
+ *  None
+ */
+static void zcache_Fit(
+    Eight               len)            /* IN bytes to make room for */
+{
+    BfMList             *resident = &zc.dir.list[ZCACHE_RESIDENT];
+    BfMList             *ghosts = &zc.dir.list[ZCACHE_GHOST];
+
+
+    while (resident->len > 0 && zc.bytes + len > zc.target) zcache_Drop(resident->tail, TRUE);
+
+    edubfm_GhostTrim(&zc.dir, ZCACHE_GHOST, resident->len);
+
+    if (zc.dir.freeNode == NIL) {
+        if (ghosts->len > 0) edubfm_GhostDelete(&zc.dir, ghosts->tail);
+        else zcache_Drop(resident->tail, FALSE);
+    }
+
+} /* zcache_Fit() */
+
+
+
+/*@================================
+ * zcache_Adapt()
+ *================================*/
+/*
+ * Function: static void zcache_Adapt(void)
+ *
+ * Description:
+ *  Move the target after ZCACHE_INTERVAL lookups: up a step if there were
+ *  ghost hits enough, down a step if few lookups hit.
+ *  The caller holds the mutex of the cache.
+ *
+ * Returns:
+ *  None
+ */
+static void zcache_Adapt(void)
+{
+    Eight               step = zc.budget / ZCACHE_STEPS;
+    Eight               least = zc.budget / ZCACHE_MIN_SHARE;
+
+
+    if (zc.nGhostHits >= ZCACHE_GROW_HITS)
+        zc.target = (zc.target + step < zc.budget) ? zc.target + step : zc.budget;
+    else if (zc.nHits * ZCACHE_SHRINK_RATIO < zc.nLookups) {
+        zc.target = (zc.target - step > least) ? zc.target - step : least;
+        zcache_Fit(0);
+    }
+
+    zc.nLookups = zc.nHits = zc.nGhostHits = 0;
+
+} /* zcache_Adapt() */
+
+
+
+/*@================================
+ * edubfm_SetZCache()
+ *================================*/
+/*
+ * Function: Four edubfm_SetZCache(Four)
+ *
+ * Description:
+ *  Give the compressed cache a budget of 'nPages' pages, dropping the
+ *  trains it keeps, or remove it if 'nPages' is 0.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubfm_SetZCache(
+    Four                nPages)         /* IN # of pages of memory of the cache (0: none) */
+{
+    Four                e;              /* error code */
+
+
+    pthread_mutex_lock(&zc.mutex);
+
+    if (zc.budget > 0) {
+        while (zc.dir.list[ZCACHE_RESIDENT].len > 0) zcache_Drop(zc.dir.list[ZCACHE_RESIDENT].tail, FALSE);
+        edubfm_GhostFinal(&zc.dir);
+        zc.budget = 0;
+    }
+
+    if (nPages > 0) {
+        e = edubfm_GhostInit(&zc.dir, nPages * ZCACHE_MIN_RATIO * 2, ZCACHE_AUX_LEN);
+        if (e < eNOERROR) {
+            pthread_mutex_unlock(&zc.mutex);
+            ERR(e);
+        }
+
+        zc.budget = zc.target = (Eight)nPages * PAGESIZE;
+        zc.bytes = 0;
+        zc.nLookups = zc.nHits = zc.nGhostHits = 0;
+    }
+
+    pthread_mutex_unlock(&zc.mutex);
+
+    return(eNOERROR);
+
+} /* edubfm_SetZCache() */
+
+
+
+/*@================================
+ * edubfm_ZCacheInsert()
+ *================================*/
+/*
+ * Function: void edubfm_ZCacheInsert(Four, BfMHashKey *, char *)
+ *
+ * Description:
+ *  Keep the compressed image of a clean train evicted from the buffer
+ *  pool, unless it does not shrink enough. Nothing is done if there is
+ *  no compressed cache.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ZCacheInsert(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key,           /* IN train evicted */
+    char                *frame)         /* IN frame holding the train */
+{
+    Four                size = PAGESIZE * edubfm_TrainPages(type, key->volNo);
+    Four                len;            /* length of the image */
+    Four                node;
+    char                *image;
+
+
+    if (zc.budget == 0) return;
+
+    image = (char *)malloc(size * ZCACHE_MAX_PERCENT / 100);
+    if (image == NULL) return;
+
+    len = edubfm_Compress(frame, size, image, size * ZCACHE_MAX_PERCENT / 100);
+    if (len == 0) {
+        free(image);
+        return;
+    }
+    image = (char *)realloc(image, len);
+
+    pthread_mutex_lock(&zc.mutex);
+
+    if (zc.budget == 0 || len > zc.target) {
+        pthread_mutex_unlock(&zc.mutex);
+        free(image);
+        return;
+    }
+
+    node = edubfm_GhostLookUp(&zc.dir, key);
+    if (node != NIL) {
+        if (zc.dir.listNo[node] == ZCACHE_RESIDENT) zcache_Drop(node, FALSE);
+        else edubfm_GhostDelete(&zc.dir, node);
+    }
+
+    zcache_Fit(len);
+
+    node = edubfm_GhostInsert(&zc.dir, ZCACHE_RESIDENT, key);
+    GHOST_AUX(&zc.dir, node)[0] = (Eight)(intptr_t)image;
+    GHOST_AUX(&zc.dir, node)[1] = ((Eight)len << 8) | type;
+    zc.bytes += len;
+
+    pthread_mutex_unlock(&zc.mutex);
+
+    BFM_COUNT(type, nCompressedStores);
+
+} /* edubfm_ZCacheInsert() */
+
+
+
+/*@================================
+ * edubfm_ZCacheLookUp()
+ *================================*/
+/*
+ * Function: Boolean edubfm_ZCacheLookUp(Four, BfMHashKey *, char *)
+ *
+ * Description:
+ *  Take the train out of the compressed cache and decompress it into the
+ *  frame, if the cache keeps it.
+ *
+ * Returns:
+ *  TRUE if the train has been put into the frame
+ */
+Boolean edubfm_ZCacheLookUp(
+    Four                type,           /* IN buffer type */
+    BfMHashKey          *key,           /* IN train missed */
+    char                *frame)         /* OUT frame for the train */
+{
+    Four                node;
+    Four                len = 0;        /* length of the image */
+    char                *image = NULL;
+    Boolean             found;
+
+
+    if (zc.budget == 0) return(FALSE);
+
+    pthread_mutex_lock(&zc.mutex);
+
+    if (zc.budget == 0) {
+        pthread_mutex_unlock(&zc.mutex);
+        return(FALSE);
+    }
+
+    zc.nLookups++;
+
+    node = edubfm_GhostLookUp(&zc.dir, key);
+    if (node != NIL && zc.dir.listNo[node] == ZCACHE_GHOST) {
+        edubfm_GhostDelete(&zc.dir, node);
+        zc.nGhostHits++;
+    }
+    else if (node != NIL && ZCACHE_TYPE(node) != type)
+        zcache_Drop(node, FALSE);
+    else if (node != NIL) {
+        image = ZCACHE_IMAGE(node);
+        len = ZCACHE_LENGTH(node);
+        zc.bytes -= len;
+        edubfm_GhostDelete(&zc.dir, node);
+        zc.nHits++;
+    }
+
+    if (zc.nLookups >= ZCACHE_INTERVAL) zcache_Adapt();
+
+    pthread_mutex_unlock(&zc.mutex);
+
+    if (image == NULL) return(FALSE);
+
+    found = edubfm_Decompress(image, len, frame, PAGESIZE * BI_BUFSIZE(type));
+    free(image);
+
+    if (found) BFM_COUNT(type, nCompressedHits);
+
+    return(found);
+
+} /* edubfm_ZCacheLookUp() */
+
+
+
+/*@================================
+ * edubfm_ZCacheDelete()
+ *================================*/
+/*
+ * Function: void edubfm_ZCacheDelete(BfMHashKey *)
+ *
+ * Description:
+ *  Drop the train from the compressed cache, if it keeps it, because the
+ *  train is being read into a buffer pool by another way.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ZCacheDelete(
+    BfMHashKey          *key)           /* IN train */
+{
+    Four                node;
+
+
+    if (zc.budget == 0) return;
+
+    pthread_mutex_lock(&zc.mutex);
+
+    if (zc.budget > 0) {
+        node = edubfm_GhostLookUp(&zc.dir, key);
+        if (node != NIL && zc.dir.listNo[node] == ZCACHE_RESIDENT) zcache_Drop(node, FALSE);
+    }
+
+    pthread_mutex_unlock(&zc.mutex);
+
+} /* edubfm_ZCacheDelete() */
+
+
+
+/*@================================
+ * edubfm_ZCacheClear()
+ *================================*/
+/*
+ * Function: void edubfm_ZCacheClear(void)
+ *
+ * Description:
+ *  Drop every train from the compressed cache, keeping its budget.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ZCacheClear(void)
+{
+    if (zc.budget == 0) return;
+
+    pthread_mutex_lock(&zc.mutex);
+
+    if (zc.budget > 0) {
+        while (zc.dir.list[ZCACHE_RESIDENT].len > 0) zcache_Drop(zc.dir.list[ZCACHE_RESIDENT].tail, FALSE);
+        edubfm_GhostTrim(&zc.dir, ZCACHE_GHOST, 0);
+        zc.target = zc.budget;
+        zc.nLookups = zc.nHits = zc.nGhostHits = 0;
+    }
+
+    pthread_mutex_unlock(&zc.mutex);
+
+} /* edubfm_ZCacheClear() */
+
+
+
+/*@================================
+ * edubfm_ZCacheUsage()
+ *================================*/
+/*
+ * Function: void edubfm_ZCacheUsage(Four *, Eight *, Eight *)
+ *
+ * Description:
+ *  Report the trains kept by the compressed cache, the bytes of their
+ *  images, and the target of the cache.
+ *
+ * Returns:
+ *  None
+ */
+void edubfm_ZCacheUsage(
+    Four                *nTrains,       /* OUT # of trains kept */
+    Eight               *bytes,         /* OUT bytes of their images */
+    Eight               *target)        /* OUT bytes the images may take now */
+{
+    pthread_mutex_lock(&zc.mutex);
+
+    *nTrains = (zc.budget > 0) ? zc.dir.list[ZCACHE_RESIDENT].len : 0;
+    *bytes = zc.bytes;
+    *target = (zc.budget > 0) ? zc.target : 0;
+
+    pthread_mutex_unlock(&zc.mutex);
+
+} /* edubfm_ZCacheUsage() */
@@ -130,8 +130,6 @@ Four EduOM_DestroyObject(
     Object *obj;                    /* points to the object in data area */
     Four alignedLen;                /* aligned length of object */
     Boolean last;                   /* indicates the object is the last one */
-    SlottedPage *catPage;           /* buffer page containing the catalog object */
-    sm_CatOverlayForData *catEntry; /* overlay structure for catalog object access */
     DeallocListElem *dlElem;        /* pointer to element of dealloc list */
     PhysicalFileID pFid;            /* physical ID of file */
 
@@ -140,13 +138,9 @@ Four EduOM_DestroyObject(
 
     if (oid == NULL) ERR(eBADOBJECTID_OM);
 
-    // Find Object
-    e = BfM_GetTrain((TrainID *)catObjForFile, (char **)&catPage, PAGE_BUF);
+    // Get the volume and the first page of the file, cached in memory
+    e = eduom_GetPhysicalFileID(catObjForFile, &pFid);
     if (e < 0) ERR(e);
-    offset = catPage->slot[-(catObjForFile->slotNo)].offset;
-    obj = (Object *)&(catPage->data[offset]);
-    catEntry = (sm_CatOverlayForData *)obj->data;
-    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
 
     MAKE_PAGEID(pid, oid->volNo, oid->pageNo);
     e = BfM_GetTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
@@ -173,7 +167,7 @@ Four EduOM_DestroyObject(
 
     // If deleted object is the only object in the page,
     // which is not the first page of the file
-    if ((apage->header.nSlots == 0) && (pid.pageNo != catEntry->firstPage)) {
+    if ((apage->header.nSlots == 0) && (pid.pageNo != pFid.pageNo)) {
         e = om_FileMapDeletePage(catObjForFile, &pid);
         if (e < 0) ERRB1(e, &pid, PAGE_BUF);
         e = Util_getElementFromPool(dlPool, &dlElem);
@@ -196,8 +190,6 @@ Four EduOM_DestroyObject(
     // Free the allocated things
     e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
     if (e < 0) ERR(e);
-    e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-    if (e < 0) ERR(e);
 
     return (eNOERROR);
 
@@ -103,8 +103,6 @@ Four EduOM_NextObject(
     SlottedPage *apage;             /* a pointer to the data page */
     Object *obj;                    /* a pointer to the Object */
     PhysicalFileID pFid;            /* file in which the objects are located */
-    SlottedPage *catPage;           /* buffer page containing the catalog object */
-    sm_CatOverlayForData *catEntry; /* data structure for catalog object access */
 
     /*@
      * parameter checking
@@ -113,17 +111,13 @@ Four EduOM_NextObject(
 
     if (nextOID == NULL) ERR(eBADOBJECTID_OM);
 
-    // Get the sm_CatOverlayForData "catEntry" by searching catObjForFile objectID
-    e = BfM_GetTrain((TrainID *)catObjForFile, (char **)&catPage, PAGE_BUF);
+    // Get the volume and the first page of the file, cached in memory
+    e = eduom_GetPhysicalFileID(catObjForFile, &pFid);
     if (e < 0) ERR(e);
-    offset = catPage->slot[-(catObjForFile->slotNo)].offset;
-    obj = (Object *)&(catPage->data[offset]);
-    catEntry = (sm_CatOverlayForData *)obj->data;
-    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);  // Get the File
 
     if (curOID == NULL) {
-        pageNo = catEntry->firstPage;
-        while (pageNo != catEntry->lastPage) {
+        pageNo = pFid.pageNo;
+        while (pageNo != NIL) {
             MAKE_PAGEID(pid, pFid.volNo, pageNo);
             e = BfM_GetTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
             if (e < 0) ERR(e);
@@ -134,16 +128,13 @@ Four EduOM_NextObject(
                 objHdr = &(obj->header);
                 e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
                 if (e < 0) ERR(e);
-                e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-                if (e < 0) ERR(e);
 
                 return (eNOERROR);
             }
-            e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
             pageNo = apage->header.nextPage;
+            e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
+            if (e < 0) ERR(e);
         }
-        e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-        if (e < 0) ERR(e);
 
         return (EOS);
     } else {
@@ -152,12 +143,10 @@ Four EduOM_NextObject(
         e = BfM_GetTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
         if (e < 0) ERR(e);
         if ((curOID->slotNo) + 1 == apage->header.nSlots) {
-            if (pid.pageNo == catEntry->lastPage) {
+            if (apage->header.nextPage == NIL) {
                 // Object is Last object in Last page
                 e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
                 if (e < 0) ERR(e);
-                e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-                if (e < 0) ERR(e);
 
                 return (EOS);
             }
@@ -179,8 +168,6 @@ Four EduOM_NextObject(
         objHdr = &(obj->header);
         e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
         if (e < 0) ERR(e);
-        e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-        if (e < 0) ERR(e);
 
         return (eNOERROR);
     }
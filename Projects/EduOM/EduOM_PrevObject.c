@@ -112,17 +112,20 @@ Four EduOM_PrevObject(
 
     if (prevOID == NULL) ERR(eBADOBJECTID_OM);
 
-    // Get the sm_CatOverlayForData "catEntry" by searching catObjForFile objectID
-    e = BfM_GetTrain((TrainID *)catObjForFile, (char **)&catPage, PAGE_BUF);
+    // Get the volume and the first page of the file, cached in memory
+    e = eduom_GetPhysicalFileID(catObjForFile, &pFid);
     if (e < 0) ERR(e);
-    offset = catPage->slot[-(catObjForFile->slotNo)].offset;
-    obj = (Object *)&(catPage->data[offset]);
-    catEntry = (sm_CatOverlayForData *)obj->data;
-    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);  // Get the File
 
     if (curOID == NULL) {
+        // The last page changes as the file grows, so read it from the catalog object
+        e = BfM_GetTrain((TrainID *)catObjForFile, (char **)&catPage, PAGE_BUF);
+        if (e < 0) ERR(e);
+        GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, catEntry);
         pageNo = catEntry->lastPage;
-        while (pageNo != catEntry->firstPage) {
+        e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        while (pageNo != pFid.pageNo) {
             MAKE_PAGEID(pid, pFid.volNo, pageNo);
             e = BfM_GetTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
             if (e < 0) ERR(e);
@@ -134,16 +137,12 @@ Four EduOM_PrevObject(
                 objHdr = &(obj->header);
                 e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
                 if (e < 0) ERR(e);
-                e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-                if (e < 0) ERR(e);
 
                 return (eNOERROR);
             }
             e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
             pageNo = apage->header.prevPage;
         }
-        e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-        if (e < 0) ERR(e);
 
         return (EOS);
     } else {
@@ -153,12 +152,10 @@ Four EduOM_PrevObject(
         if (e < 0) ERR(e);
 
         if ((curOID->slotNo) == 0) {
-            if (pid.pageNo == catEntry->firstPage) {
+            if (pid.pageNo == pFid.pageNo) {
                 // Object is First object in First page
                 e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
                 if (e < 0) ERR(e);
-                e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-                if (e < 0) ERR(e);
 
                 return (EOS);
             }
@@ -175,8 +172,6 @@ Four EduOM_PrevObject(
                 // If previous page is empty
                 e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
                 if (e < 0) ERR(e);
-                e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-                if (e < 0) ERR(e);
 
                 return (EOS);
             }
@@ -191,8 +186,6 @@ Four EduOM_PrevObject(
         objHdr = &(obj->header);
         e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
         if (e < 0) ERR(e);
-        e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-        if (e < 0) ERR(e);
 
         return (eNOERROR);
     }
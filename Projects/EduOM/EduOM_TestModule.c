@@ -114,6 +114,8 @@ Four main()
 		LRDS_Final();
 		exit(1);
 	}
+	/* the catalog objects of the volume belong to new files */
+	eduom_ClearCatalogCache(volId);
 
 	/*  Mount volume */
 	e = LRDS_Mount(numDevices, devNames, &volId);
@@ -154,6 +156,7 @@ Four main()
 	}
 
 	/* Dismount volume */
+	eduom_ClearCatalogCache(volId);
 	e= LRDS_Dismount(volId);
 	if (e < eNOERROR){
 		printf("LRDS_Dismount failed!!!\n");
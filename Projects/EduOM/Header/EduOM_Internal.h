@@ -160,11 +160,18 @@ typedef struct {
 }
 
 
+/* # of catalog entries of the data files cached in memory (see eduom_CatalogCache.c) */
+#define CATALOG_CACHE_SIZE 64
+
+
 /*@
  * Function Prototypes
  */
 /* internal function prototypes */
 Four eduom_CreateObject(ObjectID*, ObjectID*, ObjectHdr*, Four, char*, ObjectID*);
+Four eduom_GetFileInfo(ObjectID*, PhysicalFileID*, FileID*, Two*);
+Four eduom_GetPhysicalFileID(ObjectID*, PhysicalFileID*);
+void eduom_ClearCatalogCache(Four);
 
 Four om_FileMapAddPage(ObjectID*, PageID*, PageID*);
 Four om_FileMapDeletePage(ObjectID*, PageID*);
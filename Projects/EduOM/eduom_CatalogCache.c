@@ -0,0 +1,232 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: eduom_CatalogCache.c
+ *
+ * Description:
+ *  In-memory cache of the catalog entries of the data files
+ *  (sm_CatOverlayForData), keyed by the ObjectID of the catalog object,
+ *  so that an operation on a file does not fix the catalog page and
+ *  follow its slot to the entry every time.
+ *  Only the fields which never change while the file exists are cached:
+ *  the file ID, the extent fill factor, and the first page.
+ *  The last page and the heads of the available space lists are written
+ *  by om_FileMapAddPage(), om_FileMapDeletePage(),
+ *  om_PutInAvailSpaceList(), om_RemoveFromAvailSpaceList(), and the
+ *  storage system, so they are always read from the catalog page. The
+ *  unique number of the catalog object is part of the key, so the entry
+ *  of a destroyed file is never taken for the file whose catalog object
+ *  reuses its slot.
+ *  A volume which is formatted again or dismounted may give the same
+ *  catalog objects to other files, so the entries of the volume are
+ *  cleared by eduom_ClearCatalogCache() then.
+ *
+ * Exports:
+ *  Four eduom_GetFileInfo(ObjectID*, PhysicalFileID*, FileID*, Two*)
+ *  Four eduom_GetPhysicalFileID(ObjectID*, PhysicalFileID*)
+ *  void eduom_ClearCatalogCache(Four)
+ */
+
+#include "EduOM_common.h"
+// Intellisense Padding
+#include "BfM.h" /* for the buffer manager call */
+// Intellisense Padding
+#include "EduOM_Internal.h"
+
+
+/* cached catalog entry */
+typedef struct {
+    Boolean valid;                  /* TRUE if the entry holds a catalog entry */
+    ObjectID catObj;                /* catalog object of the file */
+    PhysicalFileID pFid;            /* volume and first page of the file */
+    FileID fid;                     /* file ID of the file */
+    Two eff;                        /* extent fill factor of the file */
+} CatalogCacheEntry;
+
+/* the cache; a catalog object has one place, taken over by the last one used there */
+static CatalogCacheEntry catalogCache[CATALOG_CACHE_SIZE];
+
+/* Macro: CATALOG_CACHE_SLOT(catObj)
+ * Description: return the place of the catalog object in the cache
+ * Parameter:
+ *  ObjectID *catObj    : pointer to the catalog object
+ * Returns: (CatalogCacheEntry *) the place in the cache
+ */
+#define CATALOG_CACHE_SLOT(catObj) \
+	(&catalogCache[((UFour)(catObj)->pageNo * 31 + (UFour)(catObj)->slotNo) % CATALOG_CACHE_SIZE])
+
+/* Macro: EQUAL_CATALOG_OBJECT(x, y)
+ * Description: check whether the two catalog objects are the same one
+ * Parameters:
+ *  ObjectID *x, *y     : pointers to the catalog objects
+ * Returns: TRUE(1) if they are equal, otherwise FALSE(0)
+ */
+#define EQUAL_CATALOG_OBJECT(x, y) \
+	((x)->pageNo == (y)->pageNo && (x)->volNo == (y)->volNo && \
+	 (x)->slotNo == (y)->slotNo && (x)->unique == (y)->unique)
+
+
+
+/*@================================
+ * eduom_GetFileInfo()
+ *================================*/
+/*
+ * Function: Four eduom_GetFileInfo(ObjectID*, PhysicalFileID*, FileID*, Two*)
+ *
+ * Description:
+ *  Get the physical file ID, the file ID, and the extent fill factor of
+ *  the data file out of the cache, reading its catalog entry from the
+ *  catalog page into the cache if it is not there. The outputs not
+ *  wanted may be NULL.
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter pFid
+ *     the volume and the first page of the file
+ *  2) parameter fid
+ *     the file ID of the file
+ *  3) parameter eff
+ *     the extent fill factor of the file
+ */
+Four eduom_GetFileInfo(
+    ObjectID *catObjForFile,        /* IN catalog object of the data file */
+    PhysicalFileID *pFid,           /* OUT physical file ID of the file */
+    FileID *fid,                    /* OUT file ID of the file */
+    Two *eff)                       /* OUT extent fill factor of the file */
+{
+    Four e;                         /* error number */
+    SlottedPage *catPage;           /* buffer page containing the catalog object */
+    sm_CatOverlayForData *catEntry; /* the entry on the catalog page */
+    CatalogCacheEntry *c;           /* place of the file in the cache */
+
+    if (catObjForFile == NULL) ERR(eBADCATALOGOBJECT_OM);
+
+    c = CATALOG_CACHE_SLOT(catObjForFile);
+
+    if (!c->valid || !EQUAL_CATALOG_OBJECT(&c->catObj, catObjForFile)) {
+        e = BfM_GetTrain((TrainID *)catObjForFile, (char **)&catPage, PAGE_BUF);
+        if (e < 0) ERR(e);
+        GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, catEntry);
+        MAKE_PHYSICALFILEID(c->pFid, catEntry->fid.volNo, catEntry->firstPage);
+        c->fid = catEntry->fid;
+        c->eff = catEntry->eff;
+        e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
+        if (e < 0) ERR(e);
+
+        c->catObj = *catObjForFile;
+        c->valid = TRUE;
+    }
+
+    if (pFid != NULL) *pFid = c->pFid;
+    if (fid != NULL) *fid = c->fid;
+    if (eff != NULL) *eff = c->eff;
+
+    return (eNOERROR);
+
+} /* eduom_GetFileInfo() */
+
+
+
+/*@================================
+ * eduom_GetPhysicalFileID()
+ *================================*/
+/*
+ * Function: Four eduom_GetPhysicalFileID(ObjectID*, PhysicalFileID*)
+ *
+ * Description:
+ *  Get the physical file ID of the data file out of the cache (see
+ *  eduom_GetFileInfo()).
+ *
+ * Returns:
+ *  error code
+ *    eBADCATALOGOBJECT_OM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) parameter pFid
+ *     the volume and the first page of the file
+ */
+Four eduom_GetPhysicalFileID(
+    ObjectID *catObjForFile,        /* IN catalog object of the data file */
+    PhysicalFileID *pFid)           /* OUT physical file ID of the file */
+{
+    return (eduom_GetFileInfo(catObjForFile, pFid, NULL, NULL));
+
+} /* eduom_GetPhysicalFileID() */
+
+
+
+/*@================================
+ * eduom_ClearCatalogCache()
+ *================================*/
+/*
+ * Function: void eduom_ClearCatalogCache(Four)
+ *
+ * Description:
+ *  Drop the cached catalog entries of the files on the volume. Called
+ *  when the volume is formatted or dismounted, after which its catalog
+ *  objects may belong to other files.
+ *
+ * Returns:
+ *  None
+ */
+void eduom_ClearCatalogCache(
+    Four volNo)                     /* IN volume whose files are forgotten */
+{
+    Four i;
+
+    for (i = 0; i < CATALOG_CACHE_SIZE; i++)
+        if (catalogCache[i].valid && catalogCache[i].catObj.volNo == volNo)
+            catalogCache[i].valid = FALSE;
+
+} /* eduom_ClearCatalogCache() */
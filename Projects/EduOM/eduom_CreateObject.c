@@ -119,8 +119,8 @@ Four eduom_CreateObject(
     Two eff;                        /* extent fill factor of file */
     Boolean isTmp;
     PhysicalFileID pFid;
-
-    Two offset;  // Variable of offset
+    ShortPageID lastPage;           /* last page of the file */
+    ShortPageID availPageNo;        /* first page of the available space list fitting the object */
 
     /*@ parameter checking */
 
@@ -131,13 +131,9 @@ Four eduom_CreateObject(
     /* Error check whether using not supported functionality by EduOM */
     if (ALIGNED_LENGTH(length) > LRGOBJ_THRESHOLD) ERR(eNOTSUPPORTED_EDUOM);
 
-    // Load Basic Page Data
-    e = BfM_GetTrain((TrainID *)catObjForFile, (char **)&catPage, PAGE_BUF);
+    // Get the file ID, the extent fill factor, and the first page of the file, cached in memory
+    e = eduom_GetFileInfo(catObjForFile, &pFid, &fid, &eff);
     if (e < 0) ERR(e);
-    offset = catPage->slot[-(catObjForFile->slotNo)].offset;
-    obj = (Object *)&(catPage->data[offset]);
-    catEntry = (sm_CatOverlayForData *)obj->data;
-    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
     /*Get the first extent number of the file */
     e = RDsM_PageIdToExtNo((PageID *)&pFid, &firstExt);
     if (e < 0) ERR(e);
@@ -171,41 +167,48 @@ Four eduom_CreateObject(
             if (e < 0) ERR(e);
 
             /*Allocate a new page */
-            e = RDsM_AllocTrains(catEntry->fid.volNo, firstExt, &nearPid, catEntry->eff, 1, PAGESIZE2, &pid);
+            e = RDsM_AllocTrains(pFid.volNo, firstExt, &nearPid, eff, 1, PAGESIZE2, &pid);
             if (e < 0) ERR(e);
 
             // Initialize header
             e = BfM_GetNewTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
             if (e < 0) ERR(e);
-            apage->header.fid = catEntry->fid;
+            apage->header.fid = fid;
             SET_PAGE_TYPE(apage, SLOTTED_PAGE_TYPE);
             apage->header.free = 0;
             apage->header.unused = 0;
 
             // Inserting page to File
-            om_FileMapAddPage(catObjForFile, (PageID *)nearObj, &pid);
+            e = om_FileMapAddPage(catObjForFile, (PageID *)nearObj, &pid);
             if (e < 0) ERRB1(e, &pid, PAGE_BUF);
         }
     } else {
         ////printf("nearObj is NILL\n");
+        // The last page and the available space lists change as the file grows, so they are read from the catalog page
+        e = BfM_GetTrain((TrainID *)catObjForFile, (char **)&catPage, PAGE_BUF);
+        if (e < 0) ERR(e);
+        GET_PTR_TO_CATENTRY_FOR_DATA(catObjForFile, catPage, catEntry);
+        lastPage = catEntry->lastPage;
+        if (neededSpace <= SP_10SIZE) {
+            availPageNo = catEntry->availSpaceList10;
+        } else if (neededSpace <= SP_20SIZE) {
+            availPageNo = catEntry->availSpaceList20;
+        } else if (neededSpace <= SP_30SIZE) {
+            availPageNo = catEntry->availSpaceList30;
+        } else if (neededSpace <= SP_40SIZE) {
+            availPageNo = catEntry->availSpaceList40;
+        } else {
+            availPageNo = catEntry->availSpaceList50;
+        }
+        e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
+        if (e < 0) ERR(e);
+
         if (neededSpace <= SP_50SIZE) {
             //printf("Able to get page in availSpaceList\n");
             // If there is page  to put in - type 1
-            ShortPageID availPageNo;
-            if (neededSpace <= SP_10SIZE) {
-                availPageNo = catEntry->availSpaceList10;
-            } else if (neededSpace <= SP_20SIZE) {
-                availPageNo = catEntry->availSpaceList20;
-            } else if (neededSpace <= SP_30SIZE) {
-                availPageNo = catEntry->availSpaceList30;
-            } else if (neededSpace <= SP_40SIZE) {
-                availPageNo = catEntry->availSpaceList40;
-            } else {
-                availPageNo = catEntry->availSpaceList50;
-            }
             //printf("availPageNo from availSpaceList %d\n", availPageNo);
             if (availPageNo == NIL) {
-                MAKE_PAGEID(pid, pFid.volNo, catEntry->lastPage);
+                MAKE_PAGEID(pid, pFid.volNo, lastPage);
                 e = BfM_GetTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
                 if (e < 0) ERR(e);
                 // If there is space in the last page - type 2
@@ -223,17 +226,17 @@ Four eduom_CreateObject(
                     e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);  // GiveUp pid
                     if (e < 0) ERR(e);
 
-                    MAKE_PAGEID(nearPid, pFid.volNo, catEntry->lastPage);  // set nearPid as the last page of file, just like compact page
+                    MAKE_PAGEID(nearPid, pFid.volNo, lastPage);  // set nearPid as the last page of file, just like compact page
 
                     // Allocate new page
-                    e = RDsM_AllocTrains(catEntry->fid.volNo, firstExt, &nearPid, catEntry->eff, 1, PAGESIZE2, &pid);
+                    e = RDsM_AllocTrains(pFid.volNo, firstExt, &nearPid, eff, 1, PAGESIZE2, &pid);
                     if (e < 0) ERR(e);
 
                     // Initialize page header
                     e = BfM_GetNewTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
                     if (e < 0) ERR(e);
 
-                    apage->header.fid = catEntry->fid;
+                    apage->header.fid = fid;
                     SET_PAGE_TYPE(apage, SLOTTED_PAGE_TYPE);
                     apage->header.free = 0;
                     apage->header.unused = 0;
@@ -253,7 +256,7 @@ Four eduom_CreateObject(
                 }
             }
         } else {
-            MAKE_PAGEID(pid, pFid.volNo, catEntry->lastPage);
+            MAKE_PAGEID(pid, pFid.volNo, lastPage);
             e = BfM_GetTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
             if (e < 0) ERR(e);
             // If there is space in the last page - type 2
@@ -271,17 +274,17 @@ Four eduom_CreateObject(
                 e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);  // GiveUp pid
                 if (e < 0) ERR(e);
 
-                MAKE_PAGEID(nearPid, pFid.volNo, catEntry->lastPage);  // set nearPid as the last page of file, just like compact page
+                MAKE_PAGEID(nearPid, pFid.volNo, lastPage);  // set nearPid as the last page of file, just like compact page
 
                 // Allocate new page
-                e = RDsM_AllocTrains(catEntry->fid.volNo, firstExt, &nearPid, catEntry->eff, 1, PAGESIZE2, &pid);
+                e = RDsM_AllocTrains(pFid.volNo, firstExt, &nearPid, eff, 1, PAGESIZE2, &pid);
                 if (e < 0) ERR(e);
 
                 // Initialize page header
                 e = BfM_GetNewTrain((TrainID *)&pid, (char **)&apage, PAGE_BUF);
                 if (e < 0) ERR(e);
 
-                apage->header.fid = catEntry->fid;
+                apage->header.fid = fid;
                 SET_PAGE_TYPE(apage, SLOTTED_PAGE_TYPE);
                 apage->header.free = 0;
                 apage->header.unused = 0;
@@ -325,8 +328,6 @@ Four eduom_CreateObject(
     if (e < 0) ERR(e);
     e = BfM_FreeTrain((TrainID *)&pid, PAGE_BUF);
     if (e < 0) ERR(e);
-    e = BfM_FreeTrain((TrainID *)catObjForFile, PAGE_BUF);
-    if (e < 0) ERR(e);
 
     return (eNOERROR);
 